@@ -31,6 +31,8 @@
 #include <polyfem/basis/PolygonalBasis2d.hpp>
 #include <polyfem/basis/PolygonalBasis3d.hpp>
 
+#include <polyfem/basis/DofReordering.hpp>
+
 #include <polyfem/autogen/auto_p_bases.hpp>
 #include <polyfem/autogen/auto_q_bases.hpp>
 
@@ -41,6 +43,7 @@
 
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/Timer.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <polysolve/linear/FEMSolver.hpp>
 
@@ -223,6 +226,41 @@ namespace polyfem
 
 			return true;
 		}
+
+		/// Positions of the nodes with global ids node_ids, as stored in the bases
+		std::vector<RowVectorNd> nodal_positions(const std::vector<basis::ElementBases> &bases, const std::vector<int> &node_ids)
+		{
+			std::vector<RowVectorNd> positions(node_ids.size());
+			for (int n = 0; n < node_ids.size(); ++n)
+			{
+				const int n_id = node_ids[n];
+				bool found = false;
+				for (const auto &bs : bases)
+				{
+					for (const auto &b : bs.bases)
+					{
+						for (const auto &lg : b.global())
+						{
+							if (lg.index == n_id)
+							{
+								positions[n] = lg.node;
+								found = true;
+								break;
+							}
+						}
+
+						if (found)
+							break;
+					}
+
+					if (found)
+						break;
+				}
+
+				assert(found);
+			}
+			return positions;
+		}
 	} // namespace
 
 	std::vector<int> State::primitive_to_node() const
@@ -528,6 +566,10 @@ namespace polyfem
 		poly_edge_to_data.clear();
 		rhs.resize(0, 0);
 		basis_nodes_to_gbasis_nodes.resize(0, 0);
+		// the snapshots are numbered with the old nodes
+		surrogate_snapshots.clear();
+		surrogate_hessian.resize(0, 0);
+		surrogate_solver.reset();
 
 		if (assembler::MultiModel *mm = dynamic_cast<assembler::MultiModel *>(assembler.get()))
 		{
@@ -753,6 +795,8 @@ namespace polyfem
 
 		build_polygonal_basis();
 
+		reorder_dofs();
+
 		if (n_geom_bases == 0)
 			n_geom_bases = n_bases;
 
@@ -875,67 +919,8 @@ namespace polyfem
 						  dirichlet_nodes, neumann_nodes);
 
 		// setp nodal values
-		{
-			dirichlet_nodes_position.resize(dirichlet_nodes.size());
-			for (int n = 0; n < dirichlet_nodes.size(); ++n)
-			{
-				const int n_id = dirichlet_nodes[n];
-				bool found = false;
-				for (const auto &bs : bases)
-				{
-					for (const auto &b : bs.bases)
-					{
-						for (const auto &lg : b.global())
-						{
-							if (lg.index == n_id)
-							{
-								dirichlet_nodes_position[n] = lg.node;
-								found = true;
-								break;
-							}
-						}
-
-						if (found)
-							break;
-					}
-
-					if (found)
-						break;
-				}
-
-				assert(found);
-			}
-
-			neumann_nodes_position.resize(neumann_nodes.size());
-			for (int n = 0; n < neumann_nodes.size(); ++n)
-			{
-				const int n_id = neumann_nodes[n];
-				bool found = false;
-				for (const auto &bs : bases)
-				{
-					for (const auto &b : bs.bases)
-					{
-						for (const auto &lg : b.global())
-						{
-							if (lg.index == n_id)
-							{
-								neumann_nodes_position[n] = lg.node;
-								found = true;
-								break;
-							}
-						}
-
-						if (found)
-							break;
-					}
-
-					if (found)
-						break;
-				}
-
-				assert(found);
-			}
-		}
+		dirichlet_nodes_position = nodal_positions(bases, dirichlet_nodes);
+		neumann_nodes_position = nodal_positions(bases, neumann_nodes);
 
 		const bool has_neumann = local_neumann_boundary.size() > 0 || local_boundary.size() < prev_b_size;
 		use_avg_pressure = !has_neumann;
@@ -981,8 +966,51 @@ namespace polyfem
 		}
 
 		const auto &curret_bases = geom_bases();
+		compute_mesh_size_and_dhat();
+
+		logger().info("n_bases {}", n_bases);
+
+		timings.building_basis_time = timer.getElapsedTime();
+		logger().info(" took {}s", timings.building_basis_time);
+
+		logger().info("flipped elements {}", stats.n_flipped);
+		logger().info("h: {}", stats.mesh_size);
+		logger().info("n bases: {}", n_bases);
+		logger().info("n pressure bases: {}", n_pressure_bases);
+
+		get_vertices(basis_vertices);
+		mass_mat_cache.reset();
+		stiffness_mat_cache.reset();
+
+		ass_vals_cache.clear();
+		mass_ass_vals_cache.clear();
+		if (n_bases <= args["solver"]["advanced"]["cache_size"])
+		{
+			timer.start();
+			logger().info("Building cache...");
+			ass_vals_cache.init(mesh->is_volume(), bases, curret_bases);
+			mass_ass_vals_cache.init(mesh->is_volume(), bases, curret_bases, true);
+			if (mixed_assembler != nullptr)
+				pressure_ass_vals_cache.init(mesh->is_volume(), pressure_bases, curret_bases);
+
+			logger().info(" took {}s", timer.getElapsedTime());
+		}
+
+		out_geom.build_grid(*mesh, args["output"]["advanced"]["sol_on_grid"]);
+
+		if ((!problem->is_time_dependent() || args["time"]["quasistatic"]) && boundary_nodes.empty())
+		{
+			if (has_periodic_bc())
+				logger().warn("(Quasi-)Static problem without Dirichlet nodes, will fix solution at one node to find a unique solution!");
+			else
+				log_and_throw_error("Static problem need to have some Dirichlet nodes!");
+		}
+	}
+
+	void State::compute_mesh_size_and_dhat()
+	{
 		const int n_samples = 10;
-		stats.compute_mesh_size(*mesh, curret_bases, n_samples, args["output"]["advanced"]["curved_mesh_size"]);
+		stats.compute_mesh_size(*mesh, geom_bases(), n_samples, args["output"]["advanced"]["curved_mesh_size"]);
 		if (starting_min_edge_length < 0)
 		{
 			starting_min_edge_length = stats.min_edge_length;
@@ -1017,40 +1045,161 @@ namespace polyfem
 					logger().warn("dhat larger than min boundary edge, {} > {}", dhat, min_boundary_edge_length);
 			}
 		}
+	}
 
-		logger().info("n_bases {}", n_bases);
+	void State::update_basis_geometry()
+	{
+		if (!mesh)
+		{
+			logger().error("Load the mesh first!");
+			return;
+		}
 
-		timings.building_basis_time = timer.getElapsedTime();
-		logger().info(" took {}s", timings.building_basis_time);
+		const bool can_move_bases = !bases.empty()
+									&& basis_vertices.rows() == mesh->n_vertices()
+									&& mesh->is_simplicial()
+									&& !mesh->has_poly()
+									&& !mesh->is_rational()
+									&& (mesh->orders().size() <= 0 || mesh->orders().maxCoeff() <= 1)
+									&& args["space"]["basis_type"] != "Spline"
+									&& !has_periodic_bc();
+		if (!can_move_bases)
+		{
+			build_basis();
+			return;
+		}
 
-		logger().info("flipped elements {}", stats.n_flipped);
-		logger().info("h: {}", stats.mesh_size);
-		logger().info("n bases: {}", n_bases);
-		logger().info("n pressure bases: {}", n_pressure_bases);
+		igl::Timer timer;
+		timer.start();
+		logger().info("Updating basis geometry...");
 
-		ass_vals_cache.clear();
-		mass_ass_vals_cache.clear();
-		if (n_bases <= args["solver"]["advanced"]["cache_size"])
-		{
-			timer.start();
-			logger().info("Building cache...");
-			ass_vals_cache.init(mesh->is_volume(), bases, curret_bases);
-			mass_ass_vals_cache.init(mesh->is_volume(), bases, curret_bases, true);
-			if (mixed_assembler != nullptr)
-				pressure_ass_vals_cache.init(mesh->is_volume(), pressure_bases, curret_bases);
+		const int dim = mesh->dimension();
+		Eigen::MatrixXd vertices;
+		get_vertices(vertices);
+
+		// the nodes of straight simplices are affine combinations of the element vertices
+		const auto move_nodes = [&](std::vector<basis::ElementBases> &element_bases) {
+			maybe_parallel_for(element_bases.size(), [&](int start, int end, int thread_id) {
+				Eigen::MatrixXd old_frame(dim, dim), new_frame(dim, dim);
+				for (int e = start; e < end; ++e)
+				{
+					const std::vector<int> vids = mesh->element_vertices(e);
+					assert(vids.size() == size_t(dim + 1));
+					for (int d = 0; d < dim; ++d)
+					{
+						old_frame.col(d) = (basis_vertices.row(vids[d + 1]) - basis_vertices.row(vids[0])).transpose();
+						new_frame.col(d) = (vertices.row(vids[d + 1]) - vertices.row(vids[0])).transpose();
+					}
+					const Eigen::MatrixXd affine = new_frame * old_frame.inverse();
 
-			logger().info(" took {}s", timer.getElapsedTime());
+					for (auto &b : element_bases[e].bases)
+						for (auto &g : b.global())
+							g.node = vertices.row(vids[0]) + (g.node - basis_vertices.row(vids[0])) * affine.transpose();
+				}
+			});
+		};
+
+		const auto node_positions = [&](const std::vector<basis::ElementBases> &element_bases, const int n_nodes) {
+			Eigen::MatrixXd nodes = Eigen::MatrixXd::Zero(n_nodes, dim);
+			for (const auto &eb : element_bases)
+				for (const auto &b : eb.bases)
+					for (const auto &g : b.global())
+						nodes.row(g.index) = g.node;
+			return nodes;
+		};
+
+		const auto update_mesh_nodes = [&](const std::vector<basis::ElementBases> &element_bases, const int n_nodes, polyfem::mesh::MeshNodes *nodes) {
+			if (!nodes || nodes->n_nodes() != n_nodes)
+				return;
+			for (const auto &eb : element_bases)
+				for (const auto &b : eb.bases)
+					for (const auto &g : b.global())
+						nodes->set_node_position(g.index, g.node);
+		};
+
+		const int n_fe_bases = n_bases - obstacle.n_vertices();
+		const Eigen::MatrixXd old_nodes = node_positions(bases, n_bases);
+
+		move_nodes(bases);
+		update_mesh_nodes(bases, n_fe_bases, mesh_nodes.get());
+		if (!iso_parametric())
+		{
+			move_nodes(geom_bases_);
+			update_mesh_nodes(geom_bases_, n_geom_bases, geom_mesh_nodes.get());
+		}
+		if (!pressure_bases.empty())
+		{
+			move_nodes(pressure_bases);
+			update_mesh_nodes(pressure_bases, n_pressure_bases, pressure_mesh_nodes.get());
 		}
+		basis_vertices = vertices;
 
-		out_geom.build_grid(*mesh, args["output"]["advanced"]["sol_on_grid"]);
+		// the nodal boundary conditions are evaluated at the node positions
+		dirichlet_nodes_position = nodal_positions(bases, dirichlet_nodes);
+		neumann_nodes_position = nodal_positions(bases, neumann_nodes);
 
-		if ((!problem->is_time_dependent() || args["time"]["quasistatic"]) && boundary_nodes.empty())
+		ass_vals_cache.update_geometry(bases, geom_bases());
+		mass_ass_vals_cache.update_geometry(bases, geom_bases());
+		if (mixed_assembler != nullptr)
+			pressure_ass_vals_cache.update_geometry(pressure_bases, geom_bases());
+
+		// the collision vertices are linear in the FE nodes, the obstacle does not move
+		const Eigen::MatrixXd node_displacement = node_positions(bases, n_bases) - old_nodes;
+		if (collision_mesh_data.displacement_map.size() > 0 || collision_mesh_data.vertices.rows() == node_displacement.rows())
 		{
-			if (has_periodic_bc())
-				logger().warn("(Quasi-)Static problem without Dirichlet nodes, will fix solution at one node to find a unique solution!");
+			if (collision_mesh_data.displacement_map.size() > 0)
+				collision_mesh_data.vertices += collision_mesh_data.displacement_map * node_displacement;
 			else
-				log_and_throw_error("Static problem need to have some Dirichlet nodes!");
+				collision_mesh_data.vertices += node_displacement;
+			build_collision_mesh(collision_mesh_data, collision_mesh);
 		}
+		else
+			build_collision_mesh();
+
+		compute_mesh_size_and_dhat();
+
+		rhs.resize(0, 0);
+
+		timer.stop();
+		logger().info(" took {}s", timer.getElapsedTime());
+	}
+
+	void State::reorder_dofs()
+	{
+		dof_ordering.clear();
+
+		const std::string method = args["space"]["advanced"]["dof_reordering"];
+		if (method == "none")
+			return;
+
+		if (args["space"]["basis_type"] == "Spline")
+		{
+			logger().warn("DOF reordering disabled, it does not work for splines!");
+			return;
+		}
+
+		if (mesh->has_poly())
+		{
+			logger().warn("DOF reordering disabled, not supported for polygonal meshes!");
+			return;
+		}
+
+		if (!mesh_nodes || mesh_nodes->n_nodes() != n_bases)
+		{
+			logger().warn("DOF reordering disabled, bases do not match the mesh nodes!");
+			return;
+		}
+
+		igl::Timer timer;
+		timer.start();
+		logger().debug("Reordering dofs ({})...", method);
+
+		dof_ordering = basis::compute_dof_ordering(method, n_bases, bases);
+		basis::apply_dof_ordering(dof_ordering, bases);
+		mesh_nodes->permute_nodes(dof_ordering);
+
+		timer.stop();
+		logger().debug("Done (took {}s)", timer.getElapsedTime());
 	}
 
 	void State::build_polygonal_basis()
@@ -1351,10 +1500,11 @@ namespace polyfem
 
 	void State::build_collision_mesh()
 	{
-		build_collision_mesh(
+		build_collision_mesh_data(
 			*mesh, n_bases, bases, geom_bases(), total_local_boundary, obstacle,
 			args, [this](const std::string &p) { return resolve_input_path(p); },
-			in_node_to_node, collision_mesh);
+			in_node_to_node, collision_mesh_data);
+		build_collision_mesh(collision_mesh_data, collision_mesh);
 	}
 
 	void State::build_collision_mesh(
@@ -1368,6 +1518,25 @@ namespace polyfem
 		const std::function<std::string(const std::string &)> &resolve_input_path,
 		const Eigen::VectorXi &in_node_to_node,
 		ipc::CollisionMesh &collision_mesh)
+	{
+		CollisionMeshData data;
+		build_collision_mesh_data(
+			mesh, n_bases, bases, geom_bases, total_local_boundary, obstacle,
+			args, resolve_input_path, in_node_to_node, data);
+		build_collision_mesh(data, collision_mesh);
+	}
+
+	void State::build_collision_mesh_data(
+		const mesh::Mesh &mesh,
+		const int n_bases,
+		const std::vector<basis::ElementBases> &bases,
+		const std::vector<basis::ElementBases> &geom_bases,
+		const std::vector<mesh::LocalBoundary> &total_local_boundary,
+		const mesh::Obstacle &obstacle,
+		const json &args,
+		const std::function<std::string(const std::string &)> &resolve_input_path,
+		const Eigen::VectorXi &in_node_to_node,
+		CollisionMeshData &data)
 	{
 		Eigen::MatrixXd collision_vertices;
 		Eigen::VectorXi collision_codim_vids;
@@ -1445,24 +1614,33 @@ namespace polyfem
 			}
 		}
 
-		std::vector<bool> is_on_surface = ipc::CollisionMesh::construct_is_on_surface(
+		data.is_on_surface = ipc::CollisionMesh::construct_is_on_surface(
 			collision_vertices.rows(), collision_edges);
 		for (const int vid : collision_codim_vids)
 		{
-			is_on_surface[vid] = true;
+			data.is_on_surface[vid] = true;
 		}
 
-		Eigen::SparseMatrix<double> displacement_map;
+		data.displacement_map.resize(0, 0);
 		if (!displacement_map_entries.empty())
 		{
-			displacement_map.resize(collision_vertices.rows(), n_bases);
-			displacement_map.setFromTriplets(displacement_map_entries.begin(), displacement_map_entries.end());
+			data.displacement_map.resize(collision_vertices.rows(), n_bases);
+			data.displacement_map.setFromTriplets(displacement_map_entries.begin(), displacement_map_entries.end());
 		}
 
+		data.vertices = std::move(collision_vertices);
+		data.edges = std::move(collision_edges);
+		data.triangles = std::move(collision_triangles);
+		data.num_fe_collision_vertices = num_fe_collision_vertices;
+	}
+
+	void State::build_collision_mesh(const CollisionMeshData &data, ipc::CollisionMesh &collision_mesh)
+	{
 		collision_mesh = ipc::CollisionMesh(
-			is_on_surface, collision_vertices, collision_edges, collision_triangles,
-			displacement_map);
+			data.is_on_surface, data.vertices, data.edges, data.triangles,
+			data.displacement_map);
 
+		const int num_fe_collision_vertices = data.num_fe_collision_vertices;
 		collision_mesh.can_collide = [&collision_mesh, num_fe_collision_vertices](size_t vi, size_t vj) {
 			// obstacles do not collide with other obstacles
 			return collision_mesh.to_full_vertex_id(vi) < num_fe_collision_vertices
@@ -1507,7 +1685,9 @@ namespace polyfem
 		if (mixed_assembler != nullptr)
 		{
 			StiffnessMatrix velocity_mass;
-			mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases, geom_bases(), mass_ass_vals_cache, 0, velocity_mass, true);
+			if (!mass_mat_cache)
+				mass_mat_cache = std::make_unique<utils::SparseMatrixCache>();
+			mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases, geom_bases(), mass_ass_vals_cache, 0, *mass_mat_cache, velocity_mass, true);
 
 			std::vector<Eigen::Triplet<double>> mass_blocks;
 			mass_blocks.reserve(velocity_mass.nonZeros());
@@ -1526,7 +1706,9 @@ namespace polyfem
 		}
 		else
 		{
-			mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases, geom_bases(), mass_ass_vals_cache, 0, mass, true);
+			if (!mass_mat_cache)
+				mass_mat_cache = std::make_unique<utils::SparseMatrixCache>();
+			mass_matrix_assembler->assemble(mesh->is_volume(), n_bases, bases, geom_bases(), mass_ass_vals_cache, 0, *mass_mat_cache, mass, true);
 		}
 
 		assert(mass.size() > 0);
@@ -1742,6 +1924,7 @@ namespace polyfem
 			{
 				init_nonlinear_tensor_solve(sol);
 				solve_tensor_nonlinear(sol);
+				store_surrogate_snapshot(sol);
 				if (optimization_enabled != solver::CacheLevel::None)
 					cache_transient_adjoint_quantities(0, sol, Eigen::MatrixXd::Zero(mesh->dimension(), mesh->dimension()));
 
@@ -1751,6 +1934,9 @@ namespace polyfem
 			}
 		}
 
+		// stored after the solve, build_basis can renumber the nodes before the next one
+		store_warm_start();
+
 		timer.stop();
 		timings.solving_time = timer.getElapsedTime();
 		logger().info(" took {}s", timings.solving_time);
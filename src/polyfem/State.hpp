@@ -191,6 +191,8 @@ namespace polyfem
 
 		/// Mapping from input nodes to FE nodes
 		std::shared_ptr<polyfem::mesh::MeshNodes> mesh_nodes, geom_mesh_nodes, pressure_mesh_nodes;
+		/// Renumbering of the FE nodes applied by reorder_dofs (old to new), empty if the nodes are not reordered
+		std::vector<int> dof_ordering;
 
 		/// used to store assembly values for small problems
 		assembler::AssemblyValsCache ass_vals_cache;
@@ -198,6 +200,12 @@ namespace polyfem
 		/// used to store assembly values for pressure for small problems
 		assembler::AssemblyValsCache pressure_ass_vals_cache;
 
+		/// mesh vertices the bases were built with, used to move the bases with the mesh
+		Eigen::MatrixXd basis_vertices;
+
+		/// matrix caches of the mass and stiffness matrices, they keep the sparsity pattern until the bases are rebuilt
+		std::unique_ptr<utils::MatrixCache> mass_mat_cache, stiffness_mat_cache;
+
 		/// Mass matrix, it is computed only for time dependent problems
 		StiffnessMatrix mass;
 		/// average system mass, used for contact with IPC
@@ -230,6 +238,13 @@ namespace polyfem
 		/// dirichlet_nodes, neumann_nodes, local_boundary, total_local_boundary
 		/// local_neumann_boundary, polys, poly_edge_to_data, rhs
 		void build_basis();
+		/// moves the bases, the assembly caches, and the collision mesh after the mesh vertices changed (e.g., set_mesh_vertex),
+		/// the topology, the boundary conditions, and the sparsity patterns are kept. Calls build_basis if the bases cannot be moved
+		/// (non-simplicial, curved, polygonal, or periodic meshes)
+		void update_basis_geometry();
+		/// computes the mesh size statistics and the minimal boundary edge length, and sets dhat from dhat_percentage
+		/// if it is not in the input and larger than that edge
+		void compute_mesh_size_and_dhat();
 		/// compute rhs, step 3 of solve
 		/// build rhs vector based on defined basis and given rhs of the problem
 		/// modifies rhs (and maybe more?)
@@ -279,6 +294,8 @@ namespace polyfem
 		void sol_to_pressure(Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure);
 		/// builds bases for polygons, called inside build_basis
 		void build_polygonal_basis();
+		/// renumbers the dofs of the bases and mesh nodes according to space/advanced/dof_reordering, called inside build_basis
+		void reorder_dofs();
 
 	public:
 		/// set the material and the problem dimension
@@ -380,6 +397,24 @@ namespace polyfem
 		/// @param[out] sol solution
 		/// @param[in] t (optional) time step id
 		void solve_tensor_nonlinear(Eigen::MatrixXd &sol, const int t = 0, const bool init_lagging = true);
+		/// stores the converged solution, barrier stiffnesses, and node ordering of the forward solve
+		/// to warm start the next one, if enabled with solver/advanced/warm_start
+		void store_warm_start();
+		/// replaces the initial guess of a time step with the stored converged solution
+		/// @param[in] t time step id
+		/// @param[in,out] sol initial guess, replaced only if the stored solution is intersection free
+		/// @return true if the initial guess was replaced
+		bool apply_warm_start(const int t, Eigen::MatrixXd &sol) const;
+		/// records a converged static solution as a snapshot of the reduced-order surrogate, if enabled
+		void store_surrogate_snapshot(const Eigen::MatrixXd &sol);
+		/// approximates the static nonlinear solve by a Galerkin projection on the span of the stored snapshots
+		/// and of the Newton direction at the most recent one, computed with the hessian factorized when it converged.
+		/// A few reduced steps are taken without assembling or factorizing a hessian, the result is cached like a full solve
+		/// @param[out] sol approximate solution
+		/// @return false if no surrogate is available for this problem, in which case nothing is cached
+		bool solve_surrogate(Eigen::MatrixXd &sol);
+		/// sets the maximal number of snapshots of the reduced-order surrogate, 0 disables it and drops the stored snapshots
+		void set_max_surrogate_snapshots(const int n);
 
 		/// factory to create the nl solver depending on input
 		/// @return nonlinear solver (eg newton or LBFGS)
@@ -405,6 +440,11 @@ namespace polyfem
 			Eigen::VectorXd &b,
 			const bool compute_spectrum,
 			Eigen::MatrixXd &sol, Eigen::MatrixXd &pressure);
+		/// @brief Solves the static linear problem by Jacobi preconditioned conjugate gradients on the sum-factorized
+		/// operator, without assembling the stiffness matrix, if enabled with solver/advanced/matrix_free
+		/// @param[out] sol solution
+		/// @return false if the problem is not supported, nothing is solved then
+		bool solve_linear_matrix_free(Eigen::MatrixXd &sol);
 
 		/// @brief Returns whether the system is linear. Collisions and pressure add nonlinearity to the problem.
 		bool is_problem_linear() const { return assembler->is_linear() && !is_contact_enabled() && !is_pressure_enabled(); }
@@ -519,6 +559,22 @@ namespace polyfem
 		/// index mapping from periodic 2x2 collision mesh to FE periodic mesh
 		Eigen::VectorXi periodic_collision_mesh_to_basis;
 
+		/// @brief vertices, topology and displacement map the collision mesh is constructed from
+		struct CollisionMeshData
+		{
+			/// full collision vertices, the obstacle vertices are at the bottom
+			Eigen::MatrixXd vertices;
+			Eigen::MatrixXi edges;
+			Eigen::MatrixXi triangles;
+			std::vector<bool> is_on_surface;
+			/// map from FE nodes to full collision vertices, empty if they are the same
+			Eigen::SparseMatrix<double> displacement_map;
+			int num_fe_collision_vertices = 0;
+		};
+
+		/// @brief data of the last collision mesh build, used to move the collision mesh with the geometry
+		CollisionMeshData collision_mesh_data;
+
 		/// @brief extracts the boundary mesh for collision, called in build_basis
 		static void build_collision_mesh(
 			const mesh::Mesh &mesh,
@@ -532,6 +588,22 @@ namespace polyfem
 			const Eigen::VectorXi &in_node_to_node,
 			ipc::CollisionMesh &collision_mesh);
 
+		/// @brief extracts the boundary mesh for collision without constructing the collision mesh
+		static void build_collision_mesh_data(
+			const mesh::Mesh &mesh,
+			const int n_bases,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &geom_bases,
+			const std::vector<mesh::LocalBoundary> &total_local_boundary,
+			const mesh::Obstacle &obstacle,
+			const json &args,
+			const std::function<std::string(const std::string &)> &resolve_input_path,
+			const Eigen::VectorXi &in_node_to_node,
+			CollisionMeshData &data);
+
+		/// @brief constructs the collision mesh from the extracted boundary mesh
+		static void build_collision_mesh(const CollisionMeshData &data, ipc::CollisionMesh &collision_mesh);
+
 		/// @brief extracts the boundary mesh for collision, called in build_basis
 		void build_collision_mesh();
 		void build_periodic_collision_mesh();
@@ -646,6 +718,8 @@ namespace polyfem
 	public:
 		solver::CacheLevel optimization_enabled = solver::CacheLevel::None;
 		void cache_transient_adjoint_quantities(const int current_step, const Eigen::MatrixXd &sol, const Eigen::MatrixXd &disp_grad);
+		/// recomputes the force Jacobian and collision sets of a time step evicted from diff_cached, by replaying the step from the cached trajectory
+		void recompute_transient_adjoint_quantities(const int step, StiffnessMatrix &gradu_h, ipc::Collisions &collision_set, ipc::FrictionCollisions &friction_collision_set);
 		solver::DiffCache diff_cached;
 
 		std::unique_ptr<polysolve::linear::Solver> lin_solver_cached; // matrix factorization of last linear solve
@@ -661,10 +735,12 @@ namespace polyfem
 
 		// Aux functions for setting up adjoint equations
 		void compute_force_jacobian(const Eigen::MatrixXd &sol, const Eigen::MatrixXd &disp_grad, StiffnessMatrix &hessian);
-		void compute_force_jacobian_prev(const int force_step, const int sol_step, StiffnessMatrix &hessian_prev) const;
+		void compute_force_jacobian_prev(const int force_step, const int sol_step, const ipc::FrictionCollisions &force_step_friction_collision_set, StiffnessMatrix &hessian_prev) const;
 		// Solves the adjoint PDE for derivatives and caches
 		void solve_adjoint_cached(const Eigen::MatrixXd &rhs);
-		Eigen::MatrixXd solve_adjoint(const Eigen::MatrixXd &rhs) const;
+		Eigen::MatrixXd solve_adjoint(const Eigen::MatrixXd &rhs);
+		// Solves the adjoint PDE for several right-hand sides at once, sharing the factorizations
+		std::vector<Eigen::MatrixXd> solve_adjoints(const std::vector<Eigen::MatrixXd> &rhs);
 		// Returns cached adjoint solve
 		Eigen::MatrixXd get_adjoint_mat(int type) const
 		{
@@ -682,7 +758,9 @@ namespace polyfem
 			return diff_cached.adjoint_mat();
 		}
 		Eigen::MatrixXd solve_static_adjoint(const Eigen::MatrixXd &adjoint_rhs) const;
-		Eigen::MatrixXd solve_transient_adjoint(const Eigen::MatrixXd &adjoint_rhs) const;
+		// not const, evicted time steps are loaded back into diff_cached
+		Eigen::MatrixXd solve_transient_adjoint(const Eigen::MatrixXd &adjoint_rhs);
+		std::vector<Eigen::MatrixXd> solve_transient_adjoints(const std::vector<Eigen::MatrixXd> &adjoint_rhs);
 		// Change geometric node positions
 		void set_mesh_vertex(int v_id, const Eigen::VectorXd &vertex);
 		void get_vertices(Eigen::MatrixXd &vertices) const;
@@ -695,6 +773,22 @@ namespace polyfem
 
 		// to replace the initial condition in json during initial condition optimization
 		Eigen::MatrixXd initial_sol_update, initial_vel_update;
+		// converged solution (one column per time step) of the last forward solve, to warm start the next one
+		Eigen::MatrixXd warm_start_sol;
+		// dof_ordering of the discretization warm_start_sol was computed on
+		std::vector<int> warm_start_dof_ordering;
+
+	private:
+		// previous converged static solutions spanning the reduced-order surrogate of the forward solve, most recent last
+		std::vector<Eigen::VectorXd> surrogate_snapshots;
+		// maximal number of surrogate snapshots, 0 disables the surrogate
+		int max_surrogate_snapshots = 0;
+		// reduced hessian at the most recent snapshot and its factorization, built by the first surrogate solve after the snapshot
+		// and shared by the following ones
+		StiffnessMatrix surrogate_hessian;
+		std::unique_ptr<polysolve::linear::Solver> surrogate_solver;
+
+	public:
 		// mapping from positions of FE basis nodes to positions of geometry nodes
 		StiffnessMatrix basis_nodes_to_gbasis_nodes;
 
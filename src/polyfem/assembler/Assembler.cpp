@@ -5,6 +5,8 @@
 
 #include <igl/Timer.h>
 
+#include <algorithm>
+
 #include <ipc/utils/eigen_ext.hpp>
 
 namespace polyfem::assembler
@@ -92,8 +94,257 @@ namespace polyfem::assembler
 				val = 0;
 			}
 		};
+
+		/// adds the local matrices of all elements of a linear assembler to the thread local caches
+		template <typename Storages>
+		void assemble_linear_elements(
+			const LinearAssembler &assembler,
+			const bool is_volume,
+			const std::vector<ElementBases> &bases,
+			const std::vector<ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			const long int max_triplets_size,
+			Storages &storage)
+		{
+			maybe_parallel_for(bases.size(), [&](int start, int end, int thread_id) {
+				LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
+				Eigen::MatrixXd element_mat;
+
+				for (int e = start; e < end; ++e)
+				{
+					ElementAssemblyValues &vals = local_storage.vals;
+					// igl::Timer timer; timer.start();
+					// vals.compute(e, is_volume, bases[e], gbases[e]);
+
+					// compute geometric mapping
+					// evaluate and store basis functions/their gradients at quadrature points
+					cache.compute(e, is_volume, bases[e], gbases[e], vals);
+
+					const Quadrature &quadrature = vals.quadrature;
+
+					assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+					local_storage.da = vals.det.array() * quadrature.weights.array();
+					const int n_loc_bases = int(vals.basis_values.size());
+					const bool whole_element = assembler.assemble_element(vals, t, local_storage.da, element_mat);
+
+					for (int i = 0; i < n_loc_bases; ++i)
+					{
+						// const AssemblyValues &values_i = vals.basis_values[i];
+						// const Eigen::MatrixXd &gradi = values_i.grad_t_m;
+						const auto &global_i = vals.basis_values[i].global;
+
+						// loop over other bases up to the current one, taking advantage of symmetry
+						for (int j = 0; j <= i; ++j)
+						{
+							// const AssemblyValues &values_j = vals.basis_values[j];
+							// const Eigen::MatrixXd &gradj = values_j.grad_t_m;
+							const auto &global_j = vals.basis_values[j].global;
+
+							// compute local entry in stiffness matrix
+							Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1> stiffness_val;
+							if (whole_element)
+							{
+								stiffness_val.resize(assembler.size() * assembler.size());
+								for (int n = 0; n < assembler.size(); ++n)
+									for (int m = 0; m < assembler.size(); ++m)
+										stiffness_val(n * assembler.size() + m) = element_mat(i * assembler.size() + m, j * assembler.size() + n);
+							}
+							else
+								stiffness_val = assembler.assemble(LinearAssemblerData(vals, t, i, j, local_storage.da));
+							assert(stiffness_val.size() == assembler.size() * assembler.size());
+
+							// igl::Timer t1; t1.start();
+							// loop over dimensions of the problem
+							for (int n = 0; n < assembler.size(); ++n)
+							{
+								for (int m = 0; m < assembler.size(); ++m)
+								{
+									const double local_value = stiffness_val(n * assembler.size() + m);
+
+									// loop over the global nodes corresponding to local element (useful for non-conforming cases)
+									for (size_t ii = 0; ii < global_i.size(); ++ii)
+									{
+										const auto gi = global_i[ii].index * assembler.size() + m;
+										const auto wi = global_i[ii].val;
+
+										for (size_t jj = 0; jj < global_j.size(); ++jj)
+										{
+											const auto gj = global_j[jj].index * assembler.size() + n;
+											const auto wj = global_j[jj].val;
+
+											// add local value to the global matrix (weighted by corresponding nodes)
+											local_storage.cache->add_value(e, gi, gj, local_value * wi * wj);
+											if (j < i)
+											{
+												local_storage.cache->add_value(e, gj, gi, local_value * wj * wi);
+											}
+
+											if (local_storage.cache->entries_size() >= max_triplets_size)
+											{
+												local_storage.cache->prune();
+												logger().trace("cleaning memory. Current storage: {}. mat nnz: {}", local_storage.cache->capacity(), local_storage.cache->non_zeros());
+											}
+										}
+									}
+								}
+							}
+
+							// t1.stop();
+							// if (!vals.has_parameterization) { std::cout << "-- t1: " << t1.getElapsedTime() << std::endl; }
+						}
+					}
+
+					// timer.stop();
+					// if (!vals.has_parameterization) { std::cout << "-- Timer: " << timer.getElapsedTime() << std::endl; }
+				}
+			});
+		}
+
+		/// current and previous values of the DOFs of the element, previous ones only if given
+		void gather_local_dofs(
+			const ElementBases &bs,
+			const int size,
+			const Eigen::MatrixXd &displacement,
+			const Eigen::MatrixXd &displacement_prev,
+			Eigen::VectorXd &dofs)
+		{
+			const bool has_prev = displacement_prev.size() == displacement.size();
+
+			int n_dofs = 0;
+			for (const auto &b : bs.bases)
+				n_dofs += b.global().size() * size;
+			dofs.resize(has_prev ? 2 * n_dofs : n_dofs);
+
+			int k = 0;
+			for (const auto &b : bs.bases)
+			{
+				for (const auto &g : b.global())
+				{
+					for (int d = 0; d < size; ++d, ++k)
+					{
+						dofs(k) = displacement(g.index * size + d);
+						if (has_prev)
+							dofs(n_dofs + k) = displacement_prev(g.index * size + d);
+					}
+				}
+			}
+		}
 	} // namespace
 
+	void ElementHessianCache::clear()
+	{
+		dofs_.clear();
+		hessians_.clear();
+		reused_.clear();
+	}
+
+	void ElementHessianCache::prepare(const int n_elements, const double t, const double dt, const bool project_to_psd)
+	{
+		if (int(hessians_.size()) != n_elements || t != t_ || dt != dt_ || project_to_psd != project_to_psd_)
+		{
+			clear();
+			dofs_.resize(n_elements);
+			hessians_.resize(n_elements);
+			t_ = t;
+			dt_ = dt;
+			project_to_psd_ = project_to_psd;
+		}
+		reused_.assign(n_elements, false);
+	}
+
+	const Eigen::MatrixXd *ElementHessianCache::find(const int e, const Eigen::VectorXd &dofs)
+	{
+		assert(e < hessians_.size());
+		if (hessians_[e].size() == 0 || dofs_[e].size() != dofs.size()
+			|| (dofs_[e] - dofs).lpNorm<Eigen::Infinity>() > tolerance_)
+			return nullptr;
+
+		reused_[e] = true;
+		return &hessians_[e];
+	}
+
+	void ElementHessianCache::store(const int e, const Eigen::VectorXd &dofs, const Eigen::MatrixXd &hessian)
+	{
+		assert(e < hessians_.size());
+		dofs_[e] = dofs;
+		hessians_[e] = hessian;
+	}
+
+	int ElementHessianCache::n_reused() const
+	{
+		return std::count(reused_.begin(), reused_.end(), true);
+	}
+
+	void ElementStiffnessStore::clear()
+	{
+		std::unique_lock lock(mutex_);
+		entries_.clear();
+		signatures_.clear();
+		values_.clear();
+	}
+
+	bool ElementStiffnessStore::find(const int e, const int n, const Eigen::VectorXd &signature, Eigen::MatrixXd &mat) const
+	{
+		std::shared_lock lock(mutex_);
+		if (e >= entries_.size())
+			return false;
+
+		const Entry &entry = entries_[e];
+		if (entry.n != n || entry.signature_size != signature.size()
+			|| !std::equal(signature.data(), signature.data() + signature.size(), signatures_.begin() + entry.signature_offset))
+			return false;
+
+		mat.resize(n, n);
+		long index = entry.values_offset;
+		for (int j = 0; j < n; ++j)
+		{
+			for (int i = 0; i <= j; ++i)
+			{
+				mat(i, j) = values_[index++];
+				mat(j, i) = mat(i, j);
+			}
+		}
+		return true;
+	}
+
+	void ElementStiffnessStore::store(const int e, const Eigen::VectorXd &signature, const Eigen::MatrixXd &mat)
+	{
+		assert(mat.rows() == mat.cols());
+		const int n = mat.rows();
+
+		std::unique_lock lock(mutex_);
+		if (e >= entries_.size())
+			entries_.resize(e + 1);
+
+		// overwrites in place if the sizes did not change, appends otherwise
+		Entry &entry = entries_[e];
+		if (entry.signature_size != signature.size())
+		{
+			entry.signature_offset = signatures_.size();
+			entry.signature_size = signature.size();
+			signatures_.resize(signatures_.size() + signature.size());
+		}
+		if (entry.n != n)
+		{
+			entry.values_offset = values_.size();
+			entry.n = n;
+			values_.resize(values_.size() + n * (n + 1) / 2);
+		}
+
+		std::copy(signature.data(), signature.data() + signature.size(), signatures_.begin() + entry.signature_offset);
+		long index = entry.values_offset;
+		for (int j = 0; j < n; ++j)
+			for (int i = 0; i <= j; ++i)
+				values_[index++] = mat(i, j);
+	}
+
+	int ElementStiffnessStore::n_stored() const
+	{
+		std::shared_lock lock(mutex_);
+		return std::count_if(entries_.begin(), entries_.end(), [](const Entry &entry) { return entry.n > 0; });
+	}
+
 	void Assembler::set_materials(const std::vector<int> &body_ids, const json &body_params, const Units &units)
 	{
 		if (!body_params.is_array())
@@ -179,95 +430,14 @@ namespace polyfem::assembler
 
 			auto storage = create_thread_storage(LocalThreadMatStorage(buffer_size, stiffness.rows(), stiffness.cols()));
 
-			const int n_bases = int(bases.size());
 			igl::Timer timer;
 			timer.start();
 			assert(cache.is_mass() == is_mass);
 
 			// (potentially parallel) loop over elements
-			// Note that n_bases is the number of elements since ach ElementBases object stores
+			// Note that bases.size() is the number of elements since ach ElementBases object stores
 			// all local basis functions on a given element
-			maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
-				LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
-
-				for (int e = start; e < end; ++e)
-				{
-					ElementAssemblyValues &vals = local_storage.vals;
-					// igl::Timer timer; timer.start();
-					// vals.compute(e, is_volume, bases[e], gbases[e]);
-
-					// compute geometric mapping
-					// evaluate and store basis functions/their gradients at quadrature points
-					cache.compute(e, is_volume, bases[e], gbases[e], vals);
-
-					const Quadrature &quadrature = vals.quadrature;
-
-					assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-					local_storage.da = vals.det.array() * quadrature.weights.array();
-					const int n_loc_bases = int(vals.basis_values.size());
-
-					for (int i = 0; i < n_loc_bases; ++i)
-					{
-						// const AssemblyValues &values_i = vals.basis_values[i];
-						// const Eigen::MatrixXd &gradi = values_i.grad_t_m;
-						const auto &global_i = vals.basis_values[i].global;
-
-						// loop over other bases up to the current one, taking advantage of symmetry
-						for (int j = 0; j <= i; ++j)
-						{
-							// const AssemblyValues &values_j = vals.basis_values[j];
-							// const Eigen::MatrixXd &gradj = values_j.grad_t_m;
-							const auto &global_j = vals.basis_values[j].global;
-
-							// compute local entry in stiffness matrix
-							const auto stiffness_val = assemble(LinearAssemblerData(vals, t, i, j, local_storage.da));
-							assert(stiffness_val.size() == size() * size());
-
-							// igl::Timer t1; t1.start();
-							// loop over dimensions of the problem
-							for (int n = 0; n < size(); ++n)
-							{
-								for (int m = 0; m < size(); ++m)
-								{
-									const double local_value = stiffness_val(n * size() + m);
-
-									// loop over the global nodes corresponding to local element (useful for non-conforming cases)
-									for (size_t ii = 0; ii < global_i.size(); ++ii)
-									{
-										const auto gi = global_i[ii].index * size() + m;
-										const auto wi = global_i[ii].val;
-
-										for (size_t jj = 0; jj < global_j.size(); ++jj)
-										{
-											const auto gj = global_j[jj].index * size() + n;
-											const auto wj = global_j[jj].val;
-
-											// add local value to the global matrix (weighted by corresponding nodes)
-											local_storage.cache->add_value(e, gi, gj, local_value * wi * wj);
-											if (j < i)
-											{
-												local_storage.cache->add_value(e, gj, gi, local_value * wj * wi);
-											}
-
-											if (local_storage.cache->entries_size() >= max_triplets_size)
-											{
-												local_storage.cache->prune();
-												logger().trace("cleaning memory. Current storage: {}. mat nnz: {}", local_storage.cache->capacity(), local_storage.cache->non_zeros());
-											}
-										}
-									}
-								}
-							}
-
-							// t1.stop();
-							// if (!vals.has_parameterization) { std::cout << "-- t1: " << t1.getElapsedTime() << std::endl; }
-						}
-					}
-
-					// timer.stop();
-					// if (!vals.has_parameterization) { std::cout << "-- Timer: " << timer.getElapsedTime() << std::endl; }
-				}
-			});
+			assemble_linear_elements(*this, is_volume, bases, gbases, cache, t, max_triplets_size, storage);
 
 			timer.stop();
 			logger().trace("done separate assembly {}s...", timer.getElapsedTime());
@@ -383,6 +553,50 @@ namespace polyfem::assembler
 		// stiffness.setFromTriplets(entries.begin(), entries.end());
 	}
 
+	void LinearAssembler::assemble(
+		const bool is_volume,
+		const int n_basis,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const AssemblyValsCache &cache,
+		const double t,
+		MatrixCache &mat_cache,
+		StiffnessMatrix &stiffness,
+		const bool is_mass) const
+	{
+		assert(size() > 0);
+		assert(cache.is_mass() == is_mass);
+
+		const long int max_triplets_size = long(1e7);
+		const long int buffer_size = std::min(long(max_triplets_size), long(n_basis) * size());
+
+		mat_cache.init(n_basis * size());
+		mat_cache.set_zero();
+
+		auto storage = create_thread_storage(LocalThreadMatStorage(buffer_size, mat_cache));
+
+		igl::Timer timer;
+		timer.start();
+
+		assemble_linear_elements(*this, is_volume, bases, gbases, cache, t, max_triplets_size, storage);
+
+		timer.stop();
+		logger().trace("done separate assembly {}s...", timer.getElapsedTime());
+
+		timer.start();
+
+		// Serially merge local storages
+		for (LocalThreadMatStorage &local_storage : storage)
+		{
+			local_storage.cache->prune();
+			mat_cache += *local_storage.cache;
+		}
+		stiffness = mat_cache.get_matrix();
+
+		timer.stop();
+		logger().trace("done merge assembly {}s...", timer.getElapsedTime());
+	}
+
 	MixedAssembler::MixedAssembler()
 	{
 	}
@@ -642,6 +856,11 @@ namespace polyfem::assembler
 			rhs += local_storage.vec;
 	}
 
+	Eigen::MatrixXd NLAssembler::assemble_projected_hessian(const NonLinearAssemblerData &data) const
+	{
+		return ipc::project_to_psd(assemble_hessian(data));
+	}
+
 	void NLAssembler::assemble_hessian(
 		const bool is_volume,
 		const int n_basis,
@@ -654,7 +873,8 @@ namespace polyfem::assembler
 		const Eigen::MatrixXd &displacement,
 		const Eigen::MatrixXd &displacement_prev,
 		MatrixCache &mat_cache,
-		StiffnessMatrix &hess) const
+		StiffnessMatrix &hess,
+		ElementHessianCache *element_cache) const
 	{
 		const int max_triplets_size = int(1e7);
 		const int buffer_size = std::min(long(max_triplets_size), long(n_basis) * size());
@@ -672,27 +892,51 @@ namespace polyfem::assembler
 		igl::Timer timer;
 		timer.start();
 
+		if (element_cache)
+			element_cache->prepare(n_bases, t, dt, project_to_psd);
+
 		maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
 			LocalThreadMatStorage &local_storage = get_local_thread_storage(storage, thread_id);
+			Eigen::VectorXd local_dofs;
+			Eigen::MatrixXd computed_val;
 
 			for (int e = start; e < end; ++e)
 			{
-				ElementAssemblyValues &vals = local_storage.vals;
-				cache.compute(e, is_volume, bases[e], gbases[e], vals);
+				const int n_loc_bases = int(bases[e].bases.size());
 
-				const Quadrature &quadrature = vals.quadrature;
+				const Eigen::MatrixXd *cached_val = nullptr;
+				if (element_cache)
+				{
+					gather_local_dofs(bases[e], size(), displacement, displacement_prev, local_dofs);
+					cached_val = element_cache->find(e, local_dofs);
+				}
 
-				assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
-				local_storage.da = vals.det.array() * quadrature.weights.array();
-				const int n_loc_bases = int(vals.basis_values.size());
+				if (!cached_val)
+				{
+					ElementAssemblyValues &vals = local_storage.vals;
+					cache.compute(e, is_volume, bases[e], gbases[e], vals);
+
+					const Quadrature &quadrature = vals.quadrature;
+
+					assert(MAX_QUAD_POINTS == -1 || quadrature.weights.size() < MAX_QUAD_POINTS);
+					local_storage.da = vals.det.array() * quadrature.weights.array();
 
-				auto stiffness_val = assemble_hessian(NonLinearAssemblerData(vals, t, dt, displacement, displacement_prev, local_storage.da));
+					const NonLinearAssemblerData data(vals, t, dt, displacement, displacement_prev, local_storage.da);
+					if (!project_to_psd)
+						computed_val = assemble_hessian(data);
+					else if (per_point_psd_projection_)
+						computed_val = assemble_projected_hessian(data);
+					else
+						computed_val = ipc::project_to_psd(assemble_hessian(data));
+
+					if (element_cache)
+						element_cache->store(e, local_dofs, computed_val);
+				}
+
+				const Eigen::MatrixXd &stiffness_val = cached_val ? *cached_val : computed_val;
 				assert(stiffness_val.rows() == n_loc_bases * size());
 				assert(stiffness_val.cols() == n_loc_bases * size());
 
-				if (project_to_psd)
-					stiffness_val = ipc::project_to_psd(stiffness_val);
-
 				// bool has_nan = false;
 				// for(int k = 0; k < stiffness_val.size(); ++k)
 				// {
@@ -711,12 +955,12 @@ namespace polyfem::assembler
 
 				for (int i = 0; i < n_loc_bases; ++i)
 				{
-					const auto &global_i = vals.basis_values[i].global;
+					const auto &global_i = bases[e].bases[i].global();
 
 					for (int j = 0; j < n_loc_bases; ++j)
 					// for(int j = 0; j <= i; ++j)
 					{
-						const auto &global_j = vals.basis_values[j].global;
+						const auto &global_j = bases[e].bases[j].global();
 
 						for (int n = 0; n < size(); ++n)
 						{
@@ -755,6 +999,8 @@ namespace polyfem::assembler
 
 		timer.stop();
 		logger().trace("done separate assembly {}s...", timer.getElapsedTime());
+		if (element_cache)
+			logger().trace("reused {}/{} element hessians", element_cache->n_reused(), n_bases);
 
 		timer.start();
 
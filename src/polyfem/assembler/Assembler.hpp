@@ -10,6 +10,8 @@
 #include <polyfem/utils/AutodiffTypes.hpp>
 #include <polyfem/utils/Logger.hpp>
 
+#include <shared_mutex>
+
 // this casses are instantiated in the cpp, cannot be used with generic assembler
 // without adding template instantiation
 namespace polyfem::assembler
@@ -49,6 +51,78 @@ namespace polyfem::assembler
 		virtual Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1> assemble(const MixedAssemblerData &data) const = 0;
 	};
 
+	/// Element hessians of the previous assemblies, the hessian of an element is reused as long as its local
+	/// DOFs (current and previous) are within tolerance, in max norm, of the ones it was computed at
+	class ElementHessianCache
+	{
+	public:
+		ElementHessianCache(const double tolerance) : tolerance_(tolerance) {}
+
+		double tolerance() const { return tolerance_; }
+
+		/// drops all the hessians, e.g., if the geometry or the material changed
+		void clear();
+
+		/// resizes the cache and drops the hessians if any of the assembly parameters changed
+		void prepare(const int n_elements, const double t, const double dt, const bool project_to_psd);
+
+		/// cached hessian of element e if dofs are within tolerance, nullptr otherwise
+		const Eigen::MatrixXd *find(const int e, const Eigen::VectorXd &dofs);
+		void store(const int e, const Eigen::VectorXd &dofs, const Eigen::MatrixXd &hessian);
+
+		/// number of hessians reused in the last assembly
+		int n_reused() const;
+
+	private:
+		double tolerance_;
+		double t_ = 0, dt_ = 0;
+		bool project_to_psd_ = false;
+
+		std::vector<Eigen::VectorXd> dofs_;
+		std::vector<Eigen::MatrixXd> hessians_;
+		std::vector<char> reused_;
+	};
+
+	/// Symmetric element matrices that depend only on the geometry and the material (e.g., BᵀCB of linear elasticity),
+	/// packed as upper triangles in one buffer. The matrix of an element is reused as long as the signature it was
+	/// stored with (quadrature points, weights, and material parameters) is unchanged, so only the elements whose
+	/// parameters changed are rebuilt. Lookups can run concurrently, stores are serialized.
+	class ElementStiffnessStore
+	{
+	public:
+		ElementStiffnessStore() = default;
+		// copies start empty
+		ElementStiffnessStore(const ElementStiffnessStore &) {}
+		ElementStiffnessStore &operator=(const ElementStiffnessStore &)
+		{
+			clear();
+			return *this;
+		}
+
+		void clear();
+
+		/// unpacks the n x n matrix of element e in mat if it was stored with the same signature
+		bool find(const int e, const int n, const Eigen::VectorXd &signature, Eigen::MatrixXd &mat) const;
+		void store(const int e, const Eigen::VectorXd &signature, const Eigen::MatrixXd &mat);
+
+		/// number of stored elements
+		int n_stored() const;
+
+	private:
+		struct Entry
+		{
+			long signature_offset = -1;
+			long values_offset = -1;
+			int signature_size = 0;
+			int n = 0;
+		};
+
+		std::vector<Entry> entries_;
+		std::vector<double> signatures_;
+		std::vector<double> values_;
+		mutable std::shared_mutex mutex_;
+	};
+
 	/// abstract class
 	class Assembler
 	{
@@ -75,6 +149,18 @@ namespace polyfem::assembler
 			StiffnessMatrix &stiffness,
 			const bool is_mass = false) const { log_and_throw_error("Assembler not implemented by {}!", name()); }
 
+		// same as above, the matrix is assembled in mat_cache to reuse its sparsity pattern across calls
+		virtual void assemble(
+			const bool is_volume,
+			const int n_basis,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			utils::MatrixCache &mat_cache,
+			StiffnessMatrix &stiffness,
+			const bool is_mass = false) const { log_and_throw_error("Assembler not implemented by {}!", name()); }
+
 		// assemble energy
 		virtual double assemble_energy(
 			const bool is_volume,
@@ -109,7 +195,7 @@ namespace polyfem::assembler
 			const Eigen::MatrixXd &displacement_prev,
 			Eigen::MatrixXd &rhs) const { log_and_throw_error("Assemble grad not implemented by {}!", name()); }
 
-		// assemble hessian of energy (grad)
+		// assemble hessian of energy (grad), element_cache (optional) provides the element hessians to reuse
 		virtual void assemble_hessian(
 			const bool is_volume,
 			const int n_basis,
@@ -122,7 +208,8 @@ namespace polyfem::assembler
 			const Eigen::MatrixXd &displacement,
 			const Eigen::MatrixXd &displacement_prev,
 			utils::MatrixCache &mat_cache,
-			StiffnessMatrix &grad) const { log_and_throw_error("Assemble hessian not implemented by {}!", name()); }
+			StiffnessMatrix &grad,
+			ElementHessianCache *element_cache = nullptr) const { log_and_throw_error("Assemble hessian not implemented by {}!", name()); }
 
 		// plotting (eg von mises), assembler is the name of the formulation
 		virtual void compute_scalar_value(
@@ -195,6 +282,8 @@ namespace polyfem::assembler
 		}
 
 		virtual bool is_linear() const = 0;
+		// true if the material parameters change with t, matrices assembled at another time are then stale
+		virtual bool has_time_dependent_params() const { return false; }
 		virtual bool is_solution_displacement() const { return false; }
 		virtual bool is_fluid() const { return false; }
 		virtual bool is_tensor() const { return false; }
@@ -227,11 +316,28 @@ namespace polyfem::assembler
 			StiffnessMatrix &stiffness,
 			const bool is_mass = false) const override;
 
+		/// same as above, but assembles in mat_cache, the sparsity pattern
+		/// is computed on the first call and reused afterwards
+		void assemble(
+			const bool is_volume,
+			const int n_basis,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const AssemblyValsCache &cache,
+			const double t,
+			utils::MatrixCache &mat_cache,
+			StiffnessMatrix &stiffness,
+			const bool is_mass = false) const override;
+
 		virtual bool is_linear() const override { return true; }
 
 		/// local assembly function that defines the bilinear form (LHS)
 		/// computes and returns a single local stiffness value
 		virtual Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1> assemble(const LinearAssemblerData &data) const = 0;
+
+		/// optional local matrix of a whole element, ordered as the element hessians (local basis i, component m at row i * size() + m)
+		/// @return false if the bilinear form is only given by the pairwise assemble above
+		virtual bool assemble_element(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &local) const { return false; }
 	};
 
 	// non-linear assembler (eg neohookean elasticity)
@@ -288,7 +394,8 @@ namespace polyfem::assembler
 			const Eigen::MatrixXd &displacement,
 			const Eigen::MatrixXd &displacement_prev,
 			utils::MatrixCache &mat_cache,
-			StiffnessMatrix &grad) const override;
+			StiffnessMatrix &grad,
+			ElementHessianCache *element_cache = nullptr) const override;
 
 		virtual bool is_linear() const override { return false; }
 
@@ -296,6 +403,16 @@ namespace polyfem::assembler
 		virtual double compute_energy(const NonLinearAssemblerData &data) const = 0;
 		virtual Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const = 0;
 		virtual Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const = 0;
+		// hessian projected to PSD, by default the element hessian is projected,
+		// materials can override it to project the per-point ∂²Ψ/∂F² before the contraction instead
+		virtual Eigen::MatrixXd assemble_projected_hessian(const NonLinearAssemblerData &data) const;
+
+		// if true, the assembly projects with assemble_projected_hessian, otherwise it projects the element hessian
+		void set_per_point_psd_projection(const bool val) { per_point_psd_projection_ = val; }
+		bool per_point_psd_projection() const { return per_point_psd_projection_; }
+
+	protected:
+		bool per_point_psd_projection_ = false;
 	};
 
 	class ElasticityAssembler : virtual public Assembler
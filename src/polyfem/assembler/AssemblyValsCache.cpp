@@ -42,6 +42,18 @@ namespace polyfem
 				cache[e].compute(e, is_volume, basis, gbasis);
 		}
 
+		void AssemblyValsCache::update_geometry(const std::vector<ElementBases> &bases, const std::vector<ElementBases> &gbases)
+		{
+			if (cache.empty())
+				return;
+
+			assert(cache.size() == bases.size());
+			utils::maybe_parallel_for(cache.size(), [&](int start, int end, int thread_id) {
+				for (int e = start; e < end; ++e)
+					cache[e].update_geometry(bases[e], gbases[e]);
+			});
+		}
+
 		void AssemblyValsCache::compute(const int el_index, const bool is_volume, const ElementBases &basis, const ElementBases &gbasis, ElementAssemblyValues &vals) const
 		{
 			if (cache.empty())
@@ -21,6 +21,10 @@ namespace polyfem
 
 			void update(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis);
 
+			/// recomputes the geometric mapping of every cached element after the nodes of the bases moved
+			/// the topology and the bases must be the same as the ones used in init
+			void update_geometry(const std::vector<basis::ElementBases> &bases, const std::vector<basis::ElementBases> &gbases);
+
 			void clear()
 			{
 				cache.clear();
@@ -176,7 +176,6 @@ namespace polyfem
 				g_basis_values_cache_.resize(gbasis.bases.size());
 
 			const int n_local_bases = int(basis.bases.size());
-			const int n_local_g_bases = int(gbasis.bases.size());
 
 			// evaluate on reference element
 			basis.evaluate_bases(pts, basis_values);
@@ -203,10 +202,30 @@ namespace polyfem
 				return;
 			}
 			
+			compute_geometric_mapping(is_volume, basis, gbasis);
+		}
+
+		void ElementAssemblyValues::update_geometry(const ElementBases &basis, const ElementBases &gbasis)
+		{
+			assert(basis_values.size() == basis.bases.size());
+			if (!gbasis.has_parameterization)
+				return;
+
+			for (int j = 0; j < int(basis.bases.size()); ++j)
+				basis_values[j].global = basis.bases[j].global();
+
+			compute_geometric_mapping(is_volume_, basis, gbasis);
+		}
+
+		void ElementAssemblyValues::compute_geometric_mapping(const bool is_volume, const ElementBases &basis, const ElementBases &gbasis)
+		{
+			const int n_local_g_bases = int(gbasis.bases.size());
+
 			// compute geometric mapping as linear combination of geometric basis functions
 			const auto &gbasis_values = (&basis == &gbasis) ? basis_values : g_basis_values_cache_;
 			assert(gbasis_values.size() == n_local_g_bases);
-			val.resize(pts.rows(), pts.cols());
+			assert(!gbasis_values.empty());
+			val.resize(gbasis_values.front().grad.rows(), gbasis_values.front().grad.cols());
 			val.setZero();
 
 			// loop over geometric basis functions
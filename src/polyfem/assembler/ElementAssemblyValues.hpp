@@ -42,6 +42,10 @@ namespace polyfem
 			/// computes quadrature points for given element then calls above (overloaded) compute function
 			void compute(const int el_index, const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis);
 			
+			/// recomputes the geometric mapping (val, det, jac_it, and grad_t_m) after the nodes of the bases moved,
+			/// the evaluations on the reference element are reused
+			void update_geometry(const basis::ElementBases &basis, const basis::ElementBases &gbasis);
+
 			/// check if the element is flipped
 			bool is_geom_mapping_positive(const bool is_volume, const basis::ElementBases &gbasis) const;
 
@@ -53,6 +57,9 @@ namespace polyfem
 
 			void finalize_global_element(const Eigen::MatrixXd &v);
 
+			/// maps the quadrature points and computes the Jacobians from the reference evaluations of the geometric bases
+			void compute_geometric_mapping(const bool is_volume, const basis::ElementBases &basis, const basis::ElementBases &gbasis);
+
 			/// void finalize(const Eigen::MatrixXd &v, const Eigen::MatrixXd &dx, const Eigen::MatrixXd &dy);
 			/// void finalize(const Eigen::MatrixXd &v, const Eigen::MatrixXd &dx, const Eigen::MatrixXd &dy, const Eigen::MatrixXd &dz);
 			
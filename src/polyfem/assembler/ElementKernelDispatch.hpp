@@ -0,0 +1,75 @@
+#pragma once
+
+#include <Eigen/Core>
+
+#include <array>
+#include <cassert>
+#include <type_traits>
+#include <utility>
+
+namespace polyfem::assembler
+{
+	/// Number of bases of the elements whose kernels are instantiated with compile-time sizes
+	template <int dim>
+	struct FixedSizeElements;
+
+	/// P1, Q1, P2, Q2, and P3 in 2D
+	template <>
+	struct FixedSizeElements<2>
+	{
+		using n_bases = std::integer_sequence<int, 3, 4, 6, 9, 10>;
+		static constexpr int max_n_bases = 10;
+	};
+
+	/// P1, Q1, P2, P3, and Q2 in 3D
+	template <>
+	struct FixedSizeElements<3>
+	{
+		using n_bases = std::integer_sequence<int, 4, 8, 10, 20, 27>;
+		static constexpr int max_n_bases = 27;
+	};
+
+	namespace internal
+	{
+		template <int n_basis, int dim, typename Kernel>
+		auto invoke_element_kernel(Kernel &kernel)
+		{
+			return kernel(std::integral_constant<int, n_basis>(), std::integral_constant<int, dim>());
+		}
+
+		template <int dim, typename Kernel, int... n_bases>
+		auto element_kernel_table(std::integer_sequence<int, n_bases...>)
+		{
+			using KernelPtr = decltype(&invoke_element_kernel<Eigen::Dynamic, dim, Kernel>);
+
+			std::array<KernelPtr, FixedSizeElements<dim>::max_n_bases + 1> table;
+			table.fill(&invoke_element_kernel<Eigen::Dynamic, dim, Kernel>);
+			((table[n_bases] = &invoke_element_kernel<n_bases, dim, Kernel>), ...);
+			return table;
+		}
+
+		template <int dim, typename Kernel>
+		auto dispatch_element_kernel(const int n_bases, Kernel &kernel)
+		{
+			static const auto table = element_kernel_table<dim, Kernel>(typename FixedSizeElements<dim>::n_bases());
+
+			if (n_bases < 0 || n_bases >= int(table.size()))
+				return invoke_element_kernel<Eigen::Dynamic, dim, Kernel>(kernel);
+			return table[n_bases](kernel);
+		}
+	} // namespace internal
+
+	/// Calls kernel(n_basis, dim) with std::integral_constant arguments, so that the kernel can use
+	/// n_basis and dim as template parameters of fixed-size Eigen types. The instantiation is picked
+	/// from a table indexed by the number of bases; elements not in FixedSizeElements get
+	/// n_basis = Eigen::Dynamic.
+	template <typename Kernel>
+	auto dispatch_element_kernel(const int dim, const int n_bases, Kernel &&kernel)
+	{
+		assert(dim == 2 || dim == 3);
+		if (dim == 2)
+			return internal::dispatch_element_kernel<2>(n_bases, kernel);
+		else
+			return internal::dispatch_element_kernel<3>(n_bases, kernel);
+	}
+} // namespace polyfem::assembler
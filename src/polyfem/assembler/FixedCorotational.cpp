@@ -1,6 +1,8 @@
 #include "FixedCorotational.hpp"
 
+#include <polyfem/assembler/ElementKernelDispatch.hpp>
 #include <polyfem/autogen/auto_elasticity_rhs.hpp>
+#include <polyfem/utils/SVDBatch.hpp>
 #include <polyfem/utils/svd.hpp>
 
 namespace polyfem::assembler
@@ -86,149 +88,34 @@ namespace polyfem::assembler
 	Eigen::VectorXd
 	FixedCorotational::assemble_gradient(const NonLinearAssemblerData &data) const
 	{
-		Eigen::Matrix<double, Eigen::Dynamic, 1> gradient;
-
-		if (size() == 2)
-		{
-			switch (data.vals.basis_values.size())
-			{
-			case 3:
-			{
-				gradient.resize(6);
-				compute_energy_aux_gradient_fast<3, 2>(data, gradient);
-				break;
-			}
-			case 6:
-			{
-				gradient.resize(12);
-				compute_energy_aux_gradient_fast<6, 2>(data, gradient);
-				break;
-			}
-			case 10:
-			{
-				gradient.resize(20);
-				compute_energy_aux_gradient_fast<10, 2>(data, gradient);
-				break;
-			}
-			default:
-			{
-				gradient.resize(data.vals.basis_values.size() * 2);
-				compute_energy_aux_gradient_fast<Eigen::Dynamic, 2>(data, gradient);
-				break;
-			}
-			}
-		}
-		else // if (size() == 3)
-		{
-			assert(size() == 3);
-			switch (data.vals.basis_values.size())
-			{
-			case 4:
-			{
-				gradient.resize(12);
-				compute_energy_aux_gradient_fast<4, 3>(data, gradient);
-				break;
-			}
-			case 10:
-			{
-				gradient.resize(30);
-				compute_energy_aux_gradient_fast<10, 3>(data, gradient);
-				break;
-			}
-			case 20:
-			{
-				gradient.resize(60);
-				compute_energy_aux_gradient_fast<20, 3>(data, gradient);
-				break;
-			}
-			default:
-			{
-				gradient.resize(data.vals.basis_values.size() * 3);
-				compute_energy_aux_gradient_fast<Eigen::Dynamic, 3>(data, gradient);
-				break;
-			}
-			}
-		}
-
-		return gradient;
+		return dispatch_element_kernel(size(), data.vals.basis_values.size(), [&](auto n_basis, auto dim) {
+			Eigen::Matrix<double, Eigen::Dynamic, 1> gradient(data.vals.basis_values.size() * dim.value);
+			compute_energy_aux_gradient_fast<n_basis.value, dim.value>(data, gradient);
+			return gradient;
+		});
 	}
 
 	Eigen::MatrixXd
 	FixedCorotational::assemble_hessian(const NonLinearAssemblerData &data) const
 	{
-		Eigen::MatrixXd hessian;
+		return compute_hessian(data, false);
+	}
 
-		if (size() == 2)
-		{
-			switch (data.vals.basis_values.size())
-			{
-			case 3:
-			{
-				hessian.resize(6, 6);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<3, 2>(data, hessian);
-				break;
-			}
-			case 6:
-			{
-				hessian.resize(12, 12);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<6, 2>(data, hessian);
-				break;
-			}
-			case 10:
-			{
-				hessian.resize(20, 20);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<10, 2>(data, hessian);
-				break;
-			}
-			default:
-			{
-				hessian.resize(data.vals.basis_values.size() * 2, data.vals.basis_values.size() * 2);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<Eigen::Dynamic, 2>(data, hessian);
-				break;
-			}
-			}
-		}
-		else // if (size() == 3)
-		{
-			assert(size() == 3);
-			switch (data.vals.basis_values.size())
-			{
-			case 4:
-			{
-				hessian.resize(12, 12);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<4, 3>(data, hessian);
-				break;
-			}
-			case 10:
-			{
-				hessian.resize(30, 30);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<10, 3>(data, hessian);
-				break;
-			}
-			case 20:
-			{
-				hessian.resize(60, 60);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<20, 3>(data, hessian);
-				break;
-			}
-			default:
-			{
-				hessian.resize(data.vals.basis_values.size() * 3, data.vals.basis_values.size() * 3);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<Eigen::Dynamic, 3>(data, hessian);
-				break;
-			}
-			}
-		}
+	Eigen::MatrixXd
+	FixedCorotational::assemble_projected_hessian(const NonLinearAssemblerData &data) const
+	{
+		return compute_hessian(data, true);
+	}
 
-		return hessian;
+	Eigen::MatrixXd
+	FixedCorotational::compute_hessian(const NonLinearAssemblerData &data, const bool project_to_psd) const
+	{
+		return dispatch_element_kernel(size(), data.vals.basis_values.size(), [&](auto n_basis, auto dim) {
+			const int n = data.vals.basis_values.size() * dim.value;
+			Eigen::MatrixXd hessian = Eigen::MatrixXd::Zero(n, n);
+			compute_energy_hessian_aux_fast<n_basis.value, dim.value>(data, project_to_psd, hessian);
+			return hessian;
+		});
 	}
 
 	void FixedCorotational::assign_stress_tensor(const OutputData &data,
@@ -236,6 +123,19 @@ namespace polyfem::assembler
 													const ElasticityTensorType &type,
 													Eigen::MatrixXd &all,
 													const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const
+	{
+		if (size() == 2)
+			assign_stress_tensor_aux<2>(data, all_size, type, all, fun);
+		else
+			assign_stress_tensor_aux<3>(data, all_size, type, all, fun);
+	}
+
+	template <int dim>
+	void FixedCorotational::assign_stress_tensor_aux(const OutputData &data,
+														const int all_size,
+														const ElasticityTensorType &type,
+														Eigen::MatrixXd &all,
+														const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const
 	{
 		const auto &displacement = data.fun;
 		const auto &local_pts = data.local_pts;
@@ -252,27 +152,33 @@ namespace polyfem::assembler
 
 		ElementAssemblyValues vals;
 		vals.compute(el_id, size() == 3, local_pts, bs, gbs);
-		const auto I = Eigen::MatrixXd::Identity(size(), size());
 
+		utils::TensorBatch<dim> F(local_pts.rows(), dim * dim);
 		for (long p = 0; p < local_pts.rows(); ++p)
 		{
 			compute_diplacement_grad(size(), bs, vals, local_pts, p, displacement, displacement_grad);
+			displacement_grad.diagonal().array() += 1;
+			F.row(p) = displacement_grad.reshaped().transpose();
+		}
 
-			const Eigen::MatrixXd def_grad = I + displacement_grad;
-			if (type == ElasticityTensorType::F)
-			{
-				all.row(p) = fun(def_grad);
-				continue;
-			}
+		if (type == ElasticityTensorType::F)
+		{
+			for (long p = 0; p < local_pts.rows(); ++p)
+				all.row(p) = fun(F.row(p).reshaped(dim, dim).matrix());
+			return;
+		}
 
-			double lambda, mu;
-			params_.lambda_mu(local_pts.row(p), vals.val.row(p), t, vals.element_id, lambda, mu);
+		Eigen::ArrayXd lambda(local_pts.rows()), mu(local_pts.rows());
+		for (long p = 0; p < local_pts.rows(); ++p)
+			params_.lambda_mu(local_pts.row(p), vals.val.row(p), t, vals.element_id, lambda(p), mu(p));
 
-			Eigen::MatrixXd stress_tensor;
-			if (size() == 2)
-				stress_tensor = compute_stress_from_def_grad<2>(def_grad, lambda, mu) * def_grad.transpose() / def_grad.determinant();
-			else
-				stress_tensor = compute_stress_from_def_grad<3>(def_grad, lambda, mu) * def_grad.transpose() / def_grad.determinant();
+		const utils::TensorBatch<dim> P = compute_stress_batch<dim>(F, lambda, mu);
+
+		for (long p = 0; p < local_pts.rows(); ++p)
+		{
+			const Eigen::Matrix<double, dim, dim> def_grad = F.row(p).reshaped(dim, dim);
+
+			Eigen::MatrixXd stress_tensor = P.row(p).reshaped(dim, dim).matrix() * def_grad.transpose() / def_grad.determinant();
 			if (type == ElasticityTensorType::PK1)
 				stress_tensor = pk1_from_cauchy(stress_tensor, def_grad);
 			else if (type == ElasticityTensorType::PK2)
@@ -284,42 +190,18 @@ namespace polyfem::assembler
 
 	double FixedCorotational::compute_energy(const NonLinearAssemblerData &data) const
 	{
-		if (size() == 2)
-			return compute_energy_aux<2>(data);
-		else
-			return compute_energy_aux<3>(data);
-	}
-
-	template <int dim>
-	double FixedCorotational::compute_energy_aux(const NonLinearAssemblerData &data) const
-	{
-		Eigen::VectorXd local_disp;
-		get_local_disp(data, dim, local_disp);
-
-		Eigen::Matrix<double, dim, dim> def_grad;
-
-		double energy = 0.0;
-
-		const int n_pts = data.da.size();
-		for (long p = 0; p < n_pts; ++p)
-		{
-			compute_disp_grad_at_quad(data, local_disp, p, dim, def_grad);
-
-			// Id + grad d
-			def_grad.diagonal().array() += 1.0;
-
-			double lambda, mu;
-			params_.lambda_mu(data.vals.quadrature.points.row(p), data.vals.val.row(p), data.t, data.vals.element_id, lambda, mu);
-
-			const double val = compute_energy_from_def_grad(def_grad, lambda, mu);
-
-			energy += val * data.da(p);
-		}
-		return energy;
+		return dispatch_element_kernel(size(), data.vals.basis_values.size(), [&](auto n_basis, auto dim) {
+			return compute_energy_aux<n_basis.value, dim.value>(data);
+		});
 	}
 
 	template <int n_basis, int dim>
-	void FixedCorotational::compute_energy_aux_gradient_fast(const NonLinearAssemblerData &data, Eigen::Matrix<double, Eigen::Dynamic, 1> &G_flattened) const
+	void FixedCorotational::quadrature_batch(
+		const NonLinearAssemblerData &data,
+		utils::BasisGradBatch<n_basis, dim> &G,
+		utils::TensorBatch<dim> &F,
+		Eigen::ArrayXd &lambda,
+		Eigen::ArrayXd &mu) const
 	{
 		assert(data.x.cols() == 1);
 
@@ -331,108 +213,86 @@ namespace polyfem::assembler
 		{
 			const auto &bs = data.vals.basis_values[i];
 			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-				}
-			}
+				local_disp.row(i) += bs.global[ii].val * data.x.block<dim, 1>(bs.global[ii].index * size(), 0).transpose();
 		}
 
-		Eigen::Matrix<double, dim, dim> def_grad(size(), size());
-
-		Eigen::Matrix<double, n_basis, dim> G(data.vals.basis_values.size(), size());
-		G.setZero();
+		utils::basis_grad_batch<n_basis, dim>(data.vals, G);
+		utils::def_grad_batch<n_basis, dim>(G, local_disp, F);
 
+		lambda.resize(n_pts);
+		mu.resize(n_pts);
 		for (long p = 0; p < n_pts; ++p)
-		{
-			Eigen::Matrix<double, n_basis, dim> grad(data.vals.basis_values.size(), size());
+			params_.lambda_mu(data.vals.quadrature.points.row(p), data.vals.val.row(p), data.t, data.vals.element_id, lambda(p), mu(p));
+	}
 
-			for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-			{
-				grad.row(i) = data.vals.basis_values[i].grad.row(p);
-			}
+	template <int dim>
+	utils::TensorBatch<dim> FixedCorotational::compute_stress_batch(const utils::TensorBatch<dim> &F, const Eigen::ArrayXd &lambda, const Eigen::ArrayXd &mu)
+	{
+		utils::TensorBatch<dim> U, V;
+		utils::SingularValueBatch<dim> sigmas;
+		utils::svd_batch<dim>(F, U, sigmas, V);
 
-			const Eigen::Matrix<double, dim, dim> jac_it = data.vals.jac_it[p];
-			const Eigen::Matrix<double, n_basis, dim> delF_delU = grad * jac_it;
+		// P = λ(Πσᵢ - 1) ∂J/∂F + 2μ(F - UVᵀ)
+		const Eigen::ArrayXd c = lambda * (sigmas.rowwise().prod() - 1);
+		return utils::cofactor_batch<dim>(F).colwise() * c + (F - utils::multiply_transpose_batch<dim>(U, V)).colwise() * (2 * mu);
+	}
 
-			// Id + grad d
-			def_grad = local_disp.transpose() * delF_delU + Eigen::Matrix<double, dim, dim>::Identity(size(), size());
+	// Compute ∫ μ Σ(σᵢ - 1)² + ½λ (Πσᵢ - 1)² du
+	template <int n_basis, int dim>
+	double FixedCorotational::compute_energy_aux(const NonLinearAssemblerData &data) const
+	{
+		utils::BasisGradBatch<n_basis, dim> G;
+		utils::TensorBatch<dim> F;
+		Eigen::ArrayXd lambda, mu;
+		quadrature_batch<n_basis, dim>(data, G, F, lambda, mu);
 
-			double lambda, mu;
-			params_.lambda_mu(data.vals.quadrature.points.row(p), data.vals.val.row(p), data.t, data.vals.element_id, lambda, mu);
+		utils::TensorBatch<dim> U, V;
+		utils::SingularValueBatch<dim> sigmas;
+		utils::svd_batch<dim>(F, U, sigmas, V);
 
-			Eigen::Matrix<double, dim, dim> gradient_temp = compute_stress_from_def_grad(def_grad, lambda, mu);
+		const Eigen::ArrayXd val = mu * (sigmas - 1).square().rowwise().sum() + lambda / 2 * (sigmas.rowwise().prod() - 1).square();
 
-			Eigen::Matrix<double, n_basis, dim> gradient = delF_delU * gradient_temp.transpose();
+		return (val * data.da.array()).sum();
+	}
 
-			G.noalias() += gradient * data.da(p);
-		}
+	template <int n_basis, int dim>
+	void FixedCorotational::compute_energy_aux_gradient_fast(const NonLinearAssemblerData &data, Eigen::Matrix<double, Eigen::Dynamic, 1> &G_flattened) const
+	{
+		utils::BasisGradBatch<n_basis, dim> G;
+		utils::TensorBatch<dim> F;
+		Eigen::ArrayXd lambda, mu;
+		quadrature_batch<n_basis, dim>(data, G, F, lambda, mu);
 
-		Eigen::Matrix<double, dim, n_basis> G_T = G.transpose();
+		const utils::TensorBatch<dim> P = compute_stress_batch<dim>(F, lambda, mu);
 
-		constexpr int N = (n_basis == Eigen::Dynamic) ? Eigen::Dynamic : n_basis * dim;
-		Eigen::Matrix<double, N, 1> temp(Eigen::Map<Eigen::Matrix<double, N, 1>>(G_T.data(), G_T.size()));
-		G_flattened = temp;
+		utils::gradient_from_stress_batch<n_basis, dim>(G, P, data.da, G_flattened);
 	}
 
 	template <int n_basis, int dim>
-	void FixedCorotational::compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, Eigen::MatrixXd &H) const
+	void FixedCorotational::compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, const bool project_to_psd, Eigen::MatrixXd &H) const
 	{
-		assert(data.x.cols() == 1);
+		constexpr int n = dim * dim;
 
-		constexpr int N = (n_basis == Eigen::Dynamic) ? Eigen::Dynamic : n_basis * dim;
-		const int n_pts = data.da.size();
+		utils::BasisGradBatch<n_basis, dim> G;
+		utils::TensorBatch<dim> F;
+		Eigen::ArrayXd lambda, mu;
+		quadrature_batch<n_basis, dim>(data, G, F, lambda, mu);
 
-		Eigen::Matrix<double, n_basis, dim> local_disp(data.vals.basis_values.size(), size());
-		local_disp.setZero();
-		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-		{
-			const auto &bs = data.vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				for (int d = 0; d < size(); ++d)
-				{
-					local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-				}
-			}
-		}
+		utils::TensorBatch<dim> U, V;
+		utils::SingularValueBatch<dim> sigmas;
+		utils::svd_batch<dim>(F, U, sigmas, V);
 
-		Eigen::Matrix<double, dim, dim> def_grad(size(), size());
-
-		for (long p = 0; p < n_pts; ++p)
+		utils::TensorBatch4<dim> hessian_temp(F.rows(), n * n);
+		for (long p = 0; p < F.rows(); ++p)
 		{
-			Eigen::Matrix<double, n_basis, dim> grad(data.vals.basis_values.size(), size());
-
-			for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-			{
-				grad.row(i) = data.vals.basis_values[i].grad.row(p);
-			}
-
-			Eigen::Matrix<double, dim, dim> jac_it = data.vals.jac_it[p];
-			const Eigen::Matrix<double, n_basis, dim> delF_delU = grad * jac_it;
-
-			// Id + grad d
-			def_grad = local_disp.transpose() * delF_delU + Eigen::Matrix<double, dim, dim>::Identity(size(), size());
-
-			double lambda, mu;
-			params_.lambda_mu(data.vals.quadrature.points.row(p), data.vals.val.row(p), data.t, data.vals.element_id, lambda, mu);
-
-			Eigen::Matrix<double, dim * dim, dim * dim> hessian_temp = compute_stiffness_from_def_grad(def_grad, lambda, mu);
-
-			Eigen::Matrix<double, dim * dim, N> delF_delU_tensor = Eigen::Matrix<double, dim * dim, N>::Zero(jac_it.size(), grad.size());
-
-			for (size_t i = 0; i < local_disp.rows(); ++i)
-			{
-				for (size_t j = 0; j < dim; ++j)
-					for (size_t k = 0; k < dim; ++k)
-						delF_delU_tensor(dim * k + j, i * dim + j) = delF_delU(i, k);
-			}
-
-			Eigen::Matrix<double, N, N> hessian = delF_delU_tensor.transpose() * hessian_temp * delF_delU_tensor;
-
-			H += hessian * data.da(p);
+			hessian_temp.row(p) = compute_stiffness_from_svd<dim>(
+									  U.row(p).reshaped(dim, dim), sigmas.row(p).transpose(), V.row(p).reshaped(dim, dim),
+									  lambda(p), mu(p), project_to_psd)
+									  .reshaped()
+									  .transpose();
 		}
+
+		utils::hessian_from_stiffness_batch<n_basis, dim>(G, hessian_temp, data.da, H);
 	}
 
 	void FixedCorotational::compute_stress_grad_multiply_mat(
@@ -660,13 +520,6 @@ namespace polyfem::assembler
 		return d2E_div_dsigma2;
 	}
 
-	template <int dim>
-	double FixedCorotational::compute_energy_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu)
-	{
-		const Eigen::Vector<double, dim> sigmas = utils::singular_values<dim>(F);
-		return compute_energy_from_singular_values(sigmas, lambda, mu);
-	}
-
 	template <int dim>
 	Eigen::Matrix<double, dim, dim> FixedCorotational::compute_stress_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu)
 	{
@@ -698,10 +551,15 @@ namespace polyfem::assembler
 	}
 
 	template <int dim>
-	Eigen::Matrix<double, dim*dim, dim*dim> FixedCorotational::compute_stiffness_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu)
+	Eigen::Matrix<double, dim*dim, dim*dim> FixedCorotational::compute_stiffness_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu, const bool project_to_psd)
 	{
 		utils::AutoFlipSVD<Eigen::Matrix<double, dim, dim>> svd(F, Eigen::ComputeFullU | Eigen::ComputeFullV);
-		const Eigen::Vector<double, dim> sigmas = svd.singularValues();
+		return compute_stiffness_from_svd<dim>(svd.matrixU(), svd.singularValues(), svd.matrixV(), lambda, mu, project_to_psd);
+	}
+
+	template <int dim>
+	Eigen::Matrix<double, dim*dim, dim*dim> FixedCorotational::compute_stiffness_from_svd(const Eigen::Matrix<double, dim, dim> &U, const Eigen::Vector<double, dim> &sigmas, const Eigen::Matrix<double, dim, dim> &V, const double lambda, const double mu, const bool project_to_psd)
+	{
 		Eigen::Matrix<double, dim, 1> dE_div_dsigma = compute_stress_from_singular_values(sigmas, lambda, mu);
 		Eigen::Matrix<double, dim, dim> d2E_div_dsigma2 = compute_stiffness_from_singular_values(sigmas, lambda, mu);
 
@@ -719,90 +577,7 @@ namespace polyfem::assembler
 				BLeftCoef[2] = mu - tmp * sigmas[1];
 			}
 		}
-		Eigen::Matrix2d B[Cdim2];
-		for (int cI = 0; cI < Cdim2; cI++) {
-			B[cI].setZero();
-			int cI_post = (cI + 1) % dim;
-
-			double rightCoef = dE_div_dsigma[cI] + dE_div_dsigma[cI_post];
-			double sum_sigma = sigmas[cI] + sigmas[cI_post];
-			rightCoef /= 2.0 * std::max(sum_sigma, 1.0e-12);
-
-			const double& leftCoef = BLeftCoef[cI];
-			B[cI](0, 0) = B[cI](1, 1) = leftCoef + rightCoef;
-			B[cI](0, 1) = B[cI](1, 0) = leftCoef - rightCoef;
-		}
-
-		// compute M using A(d2E_div_dsigma2) and B
-		Eigen::Matrix<double, dim * dim, dim * dim> M;
-		M.setZero();
-		if constexpr (dim == 2) {
-			M(0, 0) = d2E_div_dsigma2(0, 0);
-			M(0, 3) = d2E_div_dsigma2(0, 1);
-			M.block(1, 1, 2, 2) = B[0];
-			M(3, 0) = d2E_div_dsigma2(1, 0);
-			M(3, 3) = d2E_div_dsigma2(1, 1);
-		}
-		else {
-			// A
-			M(0, 0) = d2E_div_dsigma2(0, 0);
-			M(0, 4) = d2E_div_dsigma2(0, 1);
-			M(0, 8) = d2E_div_dsigma2(0, 2);
-			M(4, 0) = d2E_div_dsigma2(1, 0);
-			M(4, 4) = d2E_div_dsigma2(1, 1);
-			M(4, 8) = d2E_div_dsigma2(1, 2);
-			M(8, 0) = d2E_div_dsigma2(2, 0);
-			M(8, 4) = d2E_div_dsigma2(2, 1);
-			M(8, 8) = d2E_div_dsigma2(2, 2);
-			// B01
-			M(1, 1) = B[0](0, 0);
-			M(1, 3) = B[0](0, 1);
-			M(3, 1) = B[0](1, 0);
-			M(3, 3) = B[0](1, 1);
-			// B12
-			M(5, 5) = B[1](0, 0);
-			M(5, 7) = B[1](0, 1);
-			M(7, 5) = B[1](1, 0);
-			M(7, 7) = B[1](1, 1);
-			// B20
-			M(2, 2) = B[2](1, 1);
-			M(2, 6) = B[2](1, 0);
-			M(6, 2) = B[2](0, 1);
-			M(6, 6) = B[2](0, 0);
-		}
-
-		// compute hessian
-		Eigen::Matrix<double, dim*dim, dim*dim> hessian;
-		hessian.setZero();
-		const Eigen::Matrix<double, dim, dim>& U = svd.matrixU();
-		const Eigen::Matrix<double, dim, dim>& V = svd.matrixV();
-		for (int i = 0; i < dim; i++) {
-			// int _dim_i = i * dim;
-			for (int j = 0; j < dim; j++) {
-				int ij = i + j * dim;
-				for (int r = 0; r < dim; r++) {
-					// int _dim_r = r * dim;
-					for (int s = 0; s < dim; s++) {
-						int rs = r + s * dim;
-						if (ij > rs) {
-							// bottom left, same as upper right
-							continue;
-						}
-
-						if constexpr (dim == 2) {
-							hessian(ij, rs) = M(0, 0) * U(i, 0) * V(j, 0) * U(r, 0) * V(s, 0) + M(0, 3) * U(i, 0) * V(j, 0) * U(r, 1) * V(s, 1) + M(1, 1) * U(i, 0) * V(j, 1) * U(r, 0) * V(s, 1) + M(1, 2) * U(i, 0) * V(j, 1) * U(r, 1) * V(s, 0) + M(2, 1) * U(i, 1) * V(j, 0) * U(r, 0) * V(s, 1) + M(2, 2) * U(i, 1) * V(j, 0) * U(r, 1) * V(s, 0) + M(3, 0) * U(i, 1) * V(j, 1) * U(r, 0) * V(s, 0) + M(3, 3) * U(i, 1) * V(j, 1) * U(r, 1) * V(s, 1);
-						}
-						else {
-							hessian(ij, rs) = M(0, 0) * U(i, 0) * V(j, 0) * U(r, 0) * V(s, 0) + M(0, 4) * U(i, 0) * V(j, 0) * U(r, 1) * V(s, 1) + M(0, 8) * U(i, 0) * V(j, 0) * U(r, 2) * V(s, 2) + M(4, 0) * U(i, 1) * V(j, 1) * U(r, 0) * V(s, 0) + M(4, 4) * U(i, 1) * V(j, 1) * U(r, 1) * V(s, 1) + M(4, 8) * U(i, 1) * V(j, 1) * U(r, 2) * V(s, 2) + M(8, 0) * U(i, 2) * V(j, 2) * U(r, 0) * V(s, 0) + M(8, 4) * U(i, 2) * V(j, 2) * U(r, 1) * V(s, 1) + M(8, 8) * U(i, 2) * V(j, 2) * U(r, 2) * V(s, 2) + M(1, 1) * U(i, 0) * V(j, 1) * U(r, 0) * V(s, 1) + M(1, 3) * U(i, 0) * V(j, 1) * U(r, 1) * V(s, 0) + M(3, 1) * U(i, 1) * V(j, 0) * U(r, 0) * V(s, 1) + M(3, 3) * U(i, 1) * V(j, 0) * U(r, 1) * V(s, 0) + M(5, 5) * U(i, 1) * V(j, 2) * U(r, 1) * V(s, 2) + M(5, 7) * U(i, 1) * V(j, 2) * U(r, 2) * V(s, 1) + M(7, 5) * U(i, 2) * V(j, 1) * U(r, 1) * V(s, 2) + M(7, 7) * U(i, 2) * V(j, 1) * U(r, 2) * V(s, 1) + M(2, 2) * U(i, 0) * V(j, 2) * U(r, 0) * V(s, 2) + M(2, 6) * U(i, 0) * V(j, 2) * U(r, 2) * V(s, 0) + M(6, 2) * U(i, 2) * V(j, 0) * U(r, 0) * V(s, 2) + M(6, 6) * U(i, 2) * V(j, 0) * U(r, 2) * V(s, 0);
-						}
-
-						if (ij < rs)
-							hessian(rs, ij) = hessian(ij, rs);
-					}
-				}
-			}
-		}
 
-		return hessian;
+		return isotropic_hessian_from_singular_values<dim>(U, V, sigmas, dE_div_dsigma, d2E_div_dsigma2, BLeftCoef, project_to_psd);
 	}
 } // namespace polyfem::assembler
@@ -4,6 +4,7 @@
 #include <polyfem/assembler/MatParams.hpp>
 #include <polyfem/utils/AutodiffTypes.hpp>
 #include <polyfem/utils/ElasticityUtils.hpp>
+#include <polyfem/utils/TensorBatch.hpp>
 
 // non linear NeoHookean material model
 namespace polyfem::assembler
@@ -21,6 +22,8 @@ namespace polyfem::assembler
 		double compute_energy(const NonLinearAssemblerData &data) const override;
 		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
 		Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const override;
+		// projects the rotated singular value blocks of ∂²Ψ/∂F² in closed form
+		Eigen::MatrixXd assemble_projected_hessian(const NonLinearAssemblerData &data) const override;
 
 		void compute_stress_grad_multiply_mat(const OptAssemblerData &data,
 											  const Eigen::MatrixXd &mat,
@@ -60,13 +63,30 @@ namespace polyfem::assembler
 	private:
 		LameParameters params_;
 
-		// utility function that computes energy, the template is used for double, DScalar1, and DScalar2 in energy, gradient and hessian
-		template <int dim>
+		template <int n_basis, int dim>
 		double compute_energy_aux(const NonLinearAssemblerData &data) const;
+		Eigen::MatrixXd compute_hessian(const NonLinearAssemblerData &data, const bool project_to_psd) const;
 		template <int n_basis, int dim>
-		void compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, Eigen::MatrixXd &H) const;
+		void compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, const bool project_to_psd, Eigen::MatrixXd &H) const;
 		template <int n_basis, int dim>
 		void compute_energy_aux_gradient_fast(const NonLinearAssemblerData &data, Eigen::VectorXd &G_flattened) const;
+		template <int dim>
+		void assign_stress_tensor_aux(const OutputData &data,
+									  const int all_size,
+									  const ElasticityTensorType &type,
+									  Eigen::MatrixXd &all,
+									  const std::function<Eigen::MatrixXd(const Eigen::MatrixXd &)> &fun) const;
+
+		// basis gradients, deformation gradients, and Lamé parameters at all quadrature points
+		template <int n_basis, int dim>
+		void quadrature_batch(const NonLinearAssemblerData &data,
+							  utils::BasisGradBatch<n_basis, dim> &G,
+							  utils::TensorBatch<dim> &F,
+							  Eigen::ArrayXd &lambda,
+							  Eigen::ArrayXd &mu) const;
+		// first Piola-Kirchhoff stresses at all points, from a batched SVD of F
+		template <int dim>
+		static utils::TensorBatch<dim> compute_stress_batch(const utils::TensorBatch<dim> &F, const Eigen::ArrayXd &lambda, const Eigen::ArrayXd &mu);
 	
 		template <int dim>
 		static double compute_energy_from_singular_values(const Eigen::Vector<double, dim> &sigmas, const double lambda, const double mu);
@@ -75,11 +95,11 @@ namespace polyfem::assembler
 		template <int dim>
 		static Eigen::Matrix<double, dim, dim> compute_stiffness_from_singular_values(const Eigen::Vector<double, dim> &sigmas, const double lambda, const double mu);
 
-		template <int dim>
-		static double compute_energy_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu);
 		template <int dim>
 		static Eigen::Matrix<double, dim, dim> compute_stress_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu);
 		template <int dim>
-		static Eigen::Matrix<double, dim*dim, dim*dim> compute_stiffness_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu);
+		static Eigen::Matrix<double, dim*dim, dim*dim> compute_stiffness_from_def_grad(const Eigen::Matrix<double, dim, dim> &F, const double lambda, const double mu, const bool project_to_psd = false);
+		template <int dim>
+		static Eigen::Matrix<double, dim*dim, dim*dim> compute_stiffness_from_svd(const Eigen::Matrix<double, dim, dim> &U, const Eigen::Vector<double, dim> &sigmas, const Eigen::Matrix<double, dim, dim> &V, const double lambda, const double mu, const bool project_to_psd);
 	};
 } // namespace polyfem::assembler
@@ -23,6 +23,8 @@ namespace polyfem::assembler
 		// energy, gradient, and hessian used in newton method
 		double compute_energy(const NonLinearAssemblerData &data) const override;
 		Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const override;
+		// projects ∂²Ψ/∂F² at every quadrature point
+		Eigen::MatrixXd assemble_projected_hessian(const NonLinearAssemblerData &data) const override;
 		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
 
 		void assign_stress_tensor(const OutputData &data,
@@ -56,32 +58,36 @@ namespace polyfem::assembler
 		bool allow_inversion() const override { return true; }
 
 	private:
-		// utility function that computes energy, the template is used for double, DScalar1, and DScalar2 in energy, gradient and hessian
+		// energy density at the quadrature point p for the displacement gradient def_grad, the template is used for double, DScalar1, and DScalar2
+		template <typename T>
+		T energy_density(const NonLinearAssemblerData &data, const int p, DefGradMatrix<T> def_grad) const
+		{
+			// Id + grad d
+			for (int d = 0; d < size(); ++d)
+				def_grad(d, d) += T(1);
+
+			return derived().elastic_energy(data.vals.val.row(p), data.t, data.vals.element_id, def_grad);
+		}
+
+		// utility function that computes energy
 		template <typename T>
 		T compute_energy_aux(const NonLinearAssemblerData &data) const
 		{
 			typedef Eigen::Matrix<T, Eigen::Dynamic, 1> AutoDiffVect;
-			typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> AutoDiffGradMat;
 
 			AutoDiffVect local_disp;
 			get_local_disp(data, size(), local_disp);
 
-			AutoDiffGradMat def_grad(size(), size());
+			DefGradMatrix<T> disp_grad(size(), size());
 
 			T energy = T(0.0);
 
 			const int n_pts = data.da.size();
 			for (long p = 0; p < n_pts; ++p)
 			{
-				compute_disp_grad_at_quad(data, local_disp, p, size(), def_grad);
-
-				// Id + grad d
-				for (int d = 0; d < size(); ++d)
-					def_grad(d, d) += T(1);
-
-				const T val = derived().elastic_energy(data.vals.val.row(p), data.t, data.vals.element_id, def_grad);
+				compute_disp_grad_at_quad(data, local_disp, p, size(), disp_grad);
 
-				energy += val * data.da(p);
+				energy += energy_density(data, p, disp_grad) * data.da(p);
 			}
 			return energy;
 		}
@@ -2,6 +2,7 @@
 
 #include <polyfem/autogen/auto_elasticity_rhs.hpp>
 
+#include <polyfem/assembler/ElementKernelDispatch.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
 // #include <finitediff.hpp>
 #include <polyfem/utils/Logger.hpp>
@@ -64,73 +65,182 @@ namespace polyfem
 
 		double LinearElasticity::compute_energy(const NonLinearAssemblerData &data) const
 		{
-			return compute_energy_aux<double>(data);
+			return dispatch_element_kernel(size(), data.vals.basis_values.size(), [&](auto n_basis, auto dim) {
+				return compute_energy_aux<n_basis.value, dim.value>(data);
+			});
 		}
 
 		Eigen::VectorXd LinearElasticity::assemble_gradient(const NonLinearAssemblerData &data) const
 		{
-			const int n_bases = data.vals.basis_values.size();
-			return polyfem::gradient_from_energy(
-				size(), n_bases, data,
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 6, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 8, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 12, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 18, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 24, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 30, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 60, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 81, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, BIG_N, 1>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::VectorXd>>(data); });
+			return dispatch_element_kernel(size(), data.vals.basis_values.size(), [&](auto n_basis, auto dim) {
+				Eigen::VectorXd gradient;
+				compute_energy_aux_gradient_fast<n_basis.value, dim.value>(data, gradient);
+				return gradient;
+			});
 		}
 
 		Eigen::MatrixXd LinearElasticity::assemble_hessian(const NonLinearAssemblerData &data) const
 		{
-			const int n_bases = data.vals.basis_values.size();
-			return polyfem::hessian_from_energy(
-				size(), n_bases, data,
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 6, 1>, Eigen::Matrix<double, 6, 6>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 8, 1>, Eigen::Matrix<double, 8, 8>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 12, 1>, Eigen::Matrix<double, 12, 12>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 18, 1>, Eigen::Matrix<double, 18, 18>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 24, 1>, Eigen::Matrix<double, 24, 24>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 30, 1>, Eigen::Matrix<double, 30, 30>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 60, 1>, Eigen::Matrix<double, 60, 60>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 81, 1>, Eigen::Matrix<double, 81, 81>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>>(data); },
-				[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>>(data); });
+			Eigen::MatrixXd hessian;
+			assemble_element(data.vals, data.t, data.da, hessian);
+			return hessian;
 		}
 
-		// Compute \int mu eps : eps + lambda/2 tr(eps)^2 = \int mu tr(eps^2) + lambda/2 tr(eps)^2
-		template <typename T>
-		T LinearElasticity::compute_energy_aux(const NonLinearAssemblerData &data) const
+		bool LinearElasticity::assemble_element(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &local) const
 		{
-			typedef Eigen::Matrix<T, Eigen::Dynamic, 1> AutoDiffVect;
-			typedef Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> AutoDiffGradMat;
+			const int el_id = vals.element_id;
+			const Eigen::VectorXd signature = element_signature(vals, t, da);
 
-			AutoDiffVect local_disp;
-			get_local_disp(data, size(), local_disp);
+			if (stiffness_store_.find(el_id, vals.basis_values.size() * size(), signature, local))
+				return true;
 
-			AutoDiffGradMat disp_grad(size(), size());
+			local = dispatch_element_kernel(size(), vals.basis_values.size(), [&](auto n_basis, auto dim) {
+				Eigen::MatrixXd H;
+				compute_energy_hessian_aux_fast<n_basis.value, dim.value>(vals, t, da, H);
+				return H;
+			});
+			stiffness_store_.store(el_id, signature, local);
 
-			T energy = T(0.0);
+			return true;
+		}
 
-			const int n_pts = data.da.size();
+		Eigen::VectorXd LinearElasticity::element_signature(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da) const
+		{
+			const int n_pts = da.size();
+			const int n_bases = vals.basis_values.size();
+
+			Eigen::ArrayXd lambda, mu;
+			lame_params_batch(vals, t, lambda, mu);
+
+			// the basis gradients are needed since the points and weights do not determine the shape of the element,
+			// e.g., a P1 triangle sheared around its centroid keeps its single quadrature point and its area
+			Eigen::VectorXd signature(n_pts * (size() + 3 + n_bases * size()));
+			signature.head(n_pts * size()) = vals.val.reshaped();
+			signature.segment(n_pts * size(), n_pts) = da;
+			signature.segment(n_pts * (size() + 1), n_pts) = lambda.matrix();
+			signature.segment(n_pts * (size() + 2), n_pts) = mu.matrix();
+			for (int b = 0; b < n_bases; ++b)
+				signature.segment(n_pts * (size() + 3 + b * size()), n_pts * size()) = vals.basis_values[b].grad_t_m.reshaped();
+
+			return signature;
+		}
+
+		void LinearElasticity::lame_params_batch(const ElementAssemblyValues &vals, const double t, Eigen::ArrayXd &lambda, Eigen::ArrayXd &mu) const
+		{
+			const int n_pts = vals.val.rows();
+			lambda.resize(n_pts);
+			mu.resize(n_pts);
 			for (long p = 0; p < n_pts; ++p)
+				params_.lambda_mu(vals.quadrature.points.row(p), vals.val.row(p), t, vals.element_id, lambda(p), mu(p));
+		}
+
+		template <int n_basis, int dim>
+		void LinearElasticity::quadrature_batch(
+			const NonLinearAssemblerData &data,
+			utils::BasisGradBatch<n_basis, dim> &G,
+			utils::TensorBatch<dim> &grad_u,
+			Eigen::ArrayXd &lambda,
+			Eigen::ArrayXd &mu) const
+		{
+			assert(data.x.cols() == 1);
+
+			const int n_pts = data.da.size();
+
+			Eigen::Matrix<double, n_basis, dim> local_disp(data.vals.basis_values.size(), size());
+			local_disp.setZero();
+			for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
 			{
-				compute_disp_grad_at_quad(data, local_disp, p, size(), disp_grad);
+				const auto &bs = data.vals.basis_values[i];
+				for (size_t ii = 0; ii < bs.global.size(); ++ii)
+					local_disp.row(i) += bs.global[ii].val * data.x.block<dim, 1>(bs.global[ii].index * size(), 0).transpose();
+			}
 
-				const AutoDiffGradMat strain = (disp_grad + disp_grad.transpose()) / T(2);
+			utils::basis_grad_batch<n_basis, dim>(data.vals, G);
+			utils::def_grad_batch<n_basis, dim>(G, local_disp, grad_u);
+			for (int d = 0; d < dim; ++d)
+				grad_u.col(d * (dim + 1)) -= 1;
 
-				double lambda, mu;
-				params_.lambda_mu(data.vals.quadrature.points.row(p), data.vals.val.row(p), data.t, data.vals.element_id, lambda, mu);
+			lame_params_batch(data.vals, data.t, lambda, mu);
+		}
 
-				const T val = mu * (strain.transpose() * strain).trace() + lambda / 2 * strain.trace() * strain.trace();
+		// Compute \int mu eps : eps + lambda/2 tr(eps)^2 = \int mu tr(eps^2) + lambda/2 tr(eps)^2
+		template <int n_basis, int dim>
+		double LinearElasticity::compute_energy_aux(const NonLinearAssemblerData &data) const
+		{
+			utils::BasisGradBatch<n_basis, dim> G;
+			utils::TensorBatch<dim> grad_u;
+			Eigen::ArrayXd lambda, mu;
+			quadrature_batch<n_basis, dim>(data, G, grad_u, lambda, mu);
+
+			Eigen::ArrayXd strain_norm = Eigen::ArrayXd::Zero(grad_u.rows());
+			Eigen::ArrayXd strain_trace = Eigen::ArrayXd::Zero(grad_u.rows());
+			for (int j = 0; j < dim; ++j)
+			{
+				strain_trace += grad_u.col(j * (dim + 1));
+				for (int i = 0; i < dim; ++i)
+					strain_norm += (grad_u.col(i + j * dim) + grad_u.col(j + i * dim)).square() / 4;
+			}
 
-				energy += val * data.da(p);
+			const Eigen::ArrayXd val = mu * strain_norm + lambda / 2 * strain_trace.square();
+
+			return (val * data.da.array()).sum();
+		}
+
+		template <int n_basis, int dim>
+		void LinearElasticity::compute_energy_aux_gradient_fast(const NonLinearAssemblerData &data, Eigen::VectorXd &G_flattened) const
+		{
+			utils::BasisGradBatch<n_basis, dim> G;
+			utils::TensorBatch<dim> grad_u;
+			Eigen::ArrayXd lambda, mu;
+			quadrature_batch<n_basis, dim>(data, G, grad_u, lambda, mu);
+
+			Eigen::ArrayXd strain_trace = Eigen::ArrayXd::Zero(grad_u.rows());
+			for (int d = 0; d < dim; ++d)
+				strain_trace += grad_u.col(d * (dim + 1));
+
+			// sigma = 2 mu eps + lambda tr(eps) Id
+			utils::TensorBatch<dim> stress(grad_u.rows(), dim * dim);
+			for (int j = 0; j < dim; ++j)
+			{
+				for (int i = 0; i < dim; ++i)
+				{
+					stress.col(i + j * dim) = mu * (grad_u.col(i + j * dim) + grad_u.col(j + i * dim));
+					if (i == j)
+						stress.col(i + j * dim) += lambda * strain_trace;
+				}
 			}
-			return energy;
+
+			utils::gradient_from_stress_batch<n_basis, dim>(G, stress, data.da, G_flattened);
+		}
+
+		template <int n_basis, int dim>
+		void LinearElasticity::compute_energy_hessian_aux_fast(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &H) const
+		{
+			constexpr int n = dim * dim;
+
+			// the hessian does not depend on the displacement
+			utils::BasisGradBatch<n_basis, dim> G;
+			utils::basis_grad_batch<n_basis, dim>(vals, G);
+			Eigen::ArrayXd lambda, mu;
+			lame_params_batch(vals, t, lambda, mu);
+
+			// C_ijkl = mu (delta_ik delta_jl + delta_il delta_jk) + lambda delta_ij delta_kl
+			utils::TensorBatch4<dim> stiffness = utils::TensorBatch4<dim>::Zero(da.size(), n * n);
+			for (int l = 0; l < dim; ++l)
+				for (int k = 0; k < dim; ++k)
+					for (int j = 0; j < dim; ++j)
+						for (int i = 0; i < dim; ++i)
+						{
+							auto col = stiffness.col((i + j * dim) + (k + l * dim) * n);
+							if (i == k && j == l)
+								col += mu;
+							if (i == l && j == k)
+								col += mu;
+							if (i == j && k == l)
+								col += lambda;
+						}
+
+			utils::hessian_from_stiffness_batch<n_basis, dim>(G, stiffness, da, H);
 		}
 
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 3, 1>
@@ -4,6 +4,7 @@
 #include <polyfem/assembler/MatParams.hpp>
 #include <polyfem/utils/AutodiffTypes.hpp>
 #include <polyfem/utils/ElasticityUtils.hpp>
+#include <polyfem/utils/TensorBatch.hpp>
 
 // local assembler for linear elasticity
 namespace polyfem::assembler
@@ -21,10 +22,13 @@ namespace polyfem::assembler
 		// da contains both the quadrature weight and the change of metric in the integral
 		Eigen::Matrix<double, Eigen::Dynamic, 1, 0, 9, 1>
 		assemble(const LinearAssemblerData &data) const override;
+		// whole element stiffness from the packed store, shared by the linear assembly and the hessian
+		bool assemble_element(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &local) const override;
 
 		// compute elastic energy
 		double compute_energy(const NonLinearAssemblerData &data) const override;
 		// neccessary for mixing linear model with non-linear collision response
+		// the element hessians are kept in a packed store and rebuilt only if the geometry or the Lamé parameters of the element changed
 		Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const override;
 		// compute gradient of elastic energy, as assembler
 		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
@@ -63,6 +67,7 @@ namespace polyfem::assembler
 		const LameParameters &lame_params() const { return params_; }
 		void set_params(const LameParameters &params) { params_ = params; }
 
+		// the stored element hessians are checked against the new parameters, only the elements whose parameters changed are rebuilt
 		void update_lame_params(const Eigen::MatrixXd &lambdas, const Eigen::MatrixXd &mus) override
 		{
 			params_.lambda_mat_ = lambdas;
@@ -70,6 +75,9 @@ namespace polyfem::assembler
 		}
 
 		virtual bool is_linear() const override { return true; }
+		bool has_time_dependent_params() const override { return params_.is_time_dependent(); }
+
+		const ElementStiffnessStore &element_stiffness_store() const { return stiffness_store_; }
 
 		std::string name() const override { return "LinearElasticity"; }
 		bool allow_inversion() const override { return true; }
@@ -85,10 +93,29 @@ namespace polyfem::assembler
 		// class that stores and compute lame parameters per point
 		LameParameters params_;
 
-		// aux function that computes energy
-		// double compute_energy is the same with T=double
-		// assemble_gradient is the same with T=DScalar1 and return .getGradient()
-		template <typename T>
-		T compute_energy_aux(const NonLinearAssemblerData &data) const;
+		// element hessians BᵀCB
+		mutable ElementStiffnessStore stiffness_store_;
+
+		// quadrature points, weights, basis gradients, and Lamé parameters of the element, the element hessian depends only on these
+		Eigen::VectorXd element_signature(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da) const;
+
+		// Lamé parameters at all quadrature points of the element
+		void lame_params_batch(const ElementAssemblyValues &vals, const double t, Eigen::ArrayXd &lambda, Eigen::ArrayXd &mu) const;
+
+		// fixed-size energy, gradient, and hessian kernels, n_basis is Eigen::Dynamic for the other elements
+		template <int n_basis, int dim>
+		double compute_energy_aux(const NonLinearAssemblerData &data) const;
+		template <int n_basis, int dim>
+		void compute_energy_aux_gradient_fast(const NonLinearAssemblerData &data, Eigen::VectorXd &G_flattened) const;
+		template <int n_basis, int dim>
+		void compute_energy_hessian_aux_fast(const ElementAssemblyValues &vals, const double t, const QuadratureVector &da, Eigen::MatrixXd &H) const;
+
+		// basis gradients, displacement gradients, and Lamé parameters at all quadrature points in structure-of-arrays layout
+		template <int n_basis, int dim>
+		void quadrature_batch(const NonLinearAssemblerData &data,
+							  utils::BasisGradBatch<n_basis, dim> &G,
+							  utils::TensorBatch<dim> &grad_u,
+							  Eigen::ArrayXd &lambda,
+							  Eigen::ArrayXd &mu) const;
 	};
 } // namespace polyfem::assembler
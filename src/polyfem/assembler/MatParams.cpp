@@ -321,6 +321,17 @@ namespace polyfem::assembler
 		is_lambda_mu_ = true;
 	}
 
+	bool LameParameters::is_time_dependent() const
+	{
+		for (const auto &v : lambda_or_E_)
+			if (v.is_time_dependent())
+				return true;
+		for (const auto &v : mu_or_nu_)
+			if (v.is_time_dependent())
+				return true;
+		return false;
+	}
+
 	void LameParameters::lambda_mu(double px, double py, double pz, double x, double y, double z, double t, int el_id, double &lambda, double &mu) const
 	{
 		assert(lambda_or_E_.size() == 1 || el_id < lambda_or_E_.size());
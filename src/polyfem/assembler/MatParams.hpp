@@ -83,6 +83,9 @@ namespace polyfem::assembler
 				el_id, lambda, mu);
 		}
 
+		// true if lambda and mu (or E and nu) are expressions of t
+		bool is_time_dependent() const;
+
 		Eigen::MatrixXd lambda_mat_, mu_mat_;
 
 	private:
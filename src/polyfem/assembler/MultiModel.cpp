@@ -49,6 +49,15 @@ namespace polyfem::assembler
 		return assembler->assemble_hessian(data);
 	}
 
+	Eigen::MatrixXd
+	MultiModel::assemble_projected_hessian(const NonLinearAssemblerData &data) const
+	{
+		const int el_id = data.vals.element_id;
+		const std::string model = multi_material_models_[el_id];
+		const auto assembler = all_elastic_materials_.get_assembler(model);
+		return assembler->assemble_projected_hessian(data);
+	}
+
 	double MultiModel::compute_energy(const NonLinearAssemblerData &data) const
 	{
 		const int el_id = data.vals.element_id;
@@ -16,6 +16,7 @@ namespace polyfem::assembler
 		double compute_energy(const NonLinearAssemblerData &data) const override;
 		// neccessary for mixing linear model with non-linear collision response
 		Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const override;
+		Eigen::MatrixXd assemble_projected_hessian(const NonLinearAssemblerData &data) const override;
 		// compute gradient of elastic energy, as assembler
 		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
 
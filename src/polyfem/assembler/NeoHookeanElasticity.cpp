@@ -1,6 +1,8 @@
 #include "NeoHookeanElasticity.hpp"
 
+#include <polyfem/assembler/ElementKernelDispatch.hpp>
 #include <polyfem/utils/Jacobian.hpp>
+#include <polyfem/utils/SVDBatch.hpp>
 #include <polyfem/autogen/auto_elasticity_rhs.hpp>
 
 #include <type_traits>
@@ -49,71 +51,11 @@ namespace polyfem::assembler
 	Eigen::VectorXd
 	NeoHookeanElasticity::assemble_gradient(const NonLinearAssemblerData &data) const
 	{
-		Eigen::Matrix<double, Eigen::Dynamic, 1> gradient;
-
-		if (size() == 2)
-		{
-			switch (data.vals.basis_values.size())
-			{
-			case 3:
-			{
-				gradient.resize(6);
-				compute_energy_aux_gradient_fast<3, 2>(data, gradient);
-				break;
-			}
-			case 6:
-			{
-				gradient.resize(12);
-				compute_energy_aux_gradient_fast<6, 2>(data, gradient);
-				break;
-			}
-			case 10:
-			{
-				gradient.resize(20);
-				compute_energy_aux_gradient_fast<10, 2>(data, gradient);
-				break;
-			}
-			default:
-			{
-				gradient.resize(data.vals.basis_values.size() * 2);
-				compute_energy_aux_gradient_fast<Eigen::Dynamic, 2>(data, gradient);
-				break;
-			}
-			}
-		}
-		else // if (size() == 3)
-		{
-			assert(size() == 3);
-			switch (data.vals.basis_values.size())
-			{
-			case 4:
-			{
-				gradient.resize(12);
-				compute_energy_aux_gradient_fast<4, 3>(data, gradient);
-				break;
-			}
-			case 10:
-			{
-				gradient.resize(30);
-				compute_energy_aux_gradient_fast<10, 3>(data, gradient);
-				break;
-			}
-			case 20:
-			{
-				gradient.resize(60);
-				compute_energy_aux_gradient_fast<20, 3>(data, gradient);
-				break;
-			}
-			default:
-			{
-				gradient.resize(data.vals.basis_values.size() * 3);
-				compute_energy_aux_gradient_fast<Eigen::Dynamic, 3>(data, gradient);
-				break;
-			}
-			}
-		}
-
-		return gradient;
+		return dispatch_element_kernel(size(), data.vals.basis_values.size(), [&](auto n_basis, auto dim) {
+			Eigen::Matrix<double, Eigen::Dynamic, 1> gradient(data.vals.basis_values.size() * dim.value);
+			compute_energy_aux_gradient_fast<n_basis.value, dim.value>(data, gradient);
+			return gradient;
+		});
 	}
 
 	void NeoHookeanElasticity::compute_stiffness_value(const double t,
@@ -176,79 +118,24 @@ namespace polyfem::assembler
 	Eigen::MatrixXd
 	NeoHookeanElasticity::assemble_hessian(const NonLinearAssemblerData &data) const
 	{
-		Eigen::MatrixXd hessian;
+		return compute_hessian(data, false);
+	}
 
-		if (size() == 2)
-		{
-			switch (data.vals.basis_values.size())
-			{
-			case 3:
-			{
-				hessian.resize(6, 6);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<3, 2>(data, hessian);
-				break;
-			}
-			case 6:
-			{
-				hessian.resize(12, 12);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<6, 2>(data, hessian);
-				break;
-			}
-			case 10:
-			{
-				hessian.resize(20, 20);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<10, 2>(data, hessian);
-				break;
-			}
-			default:
-			{
-				hessian.resize(data.vals.basis_values.size() * 2, data.vals.basis_values.size() * 2);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<Eigen::Dynamic, 2>(data, hessian);
-				break;
-			}
-			}
-		}
-		else // if (size() == 3)
-		{
-			assert(size() == 3);
-			switch (data.vals.basis_values.size())
-			{
-			case 4:
-			{
-				hessian.resize(12, 12);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<4, 3>(data, hessian);
-				break;
-			}
-			case 10:
-			{
-				hessian.resize(30, 30);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<10, 3>(data, hessian);
-				break;
-			}
-			case 20:
-			{
-				hessian.resize(60, 60);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<20, 3>(data, hessian);
-				break;
-			}
-			default:
-			{
-				hessian.resize(data.vals.basis_values.size() * 3, data.vals.basis_values.size() * 3);
-				hessian.setZero();
-				compute_energy_hessian_aux_fast<Eigen::Dynamic, 3>(data, hessian);
-				break;
-			}
-			}
-		}
+	Eigen::MatrixXd
+	NeoHookeanElasticity::assemble_projected_hessian(const NonLinearAssemblerData &data) const
+	{
+		return compute_hessian(data, true);
+	}
 
-		return hessian;
+	Eigen::MatrixXd
+	NeoHookeanElasticity::compute_hessian(const NonLinearAssemblerData &data, const bool project_to_psd) const
+	{
+		return dispatch_element_kernel(size(), data.vals.basis_values.size(), [&](auto n_basis, auto dim) {
+			const int n = data.vals.basis_values.size() * dim.value;
+			Eigen::MatrixXd hessian = Eigen::MatrixXd::Zero(n, n);
+			compute_energy_hessian_aux_fast<n_basis.value, dim.value>(data, project_to_psd, hessian);
+			return hessian;
+		});
 	}
 
 	void NeoHookeanElasticity::assign_stress_tensor(const OutputData &data,
@@ -302,35 +189,49 @@ namespace polyfem::assembler
 
 	double NeoHookeanElasticity::compute_energy(const NonLinearAssemblerData &data) const
 	{
-		if (size() == 2)
+		return dispatch_element_kernel(size(), data.vals.basis_values.size(), [&](auto n_basis, auto dim) {
+			return compute_energy_aux<double, n_basis.value, dim.value>(data);
+		});
+	}
+
+	template <int n_basis, int dim>
+	void NeoHookeanElasticity::quadrature_batch(
+		const NonLinearAssemblerData &data,
+		utils::BasisGradBatch<n_basis, dim> &G,
+		utils::TensorBatch<dim> &F,
+		Eigen::ArrayXd &J,
+		Eigen::ArrayXd &lambda,
+		Eigen::ArrayXd &mu) const
+	{
+		assert(data.x.cols() == 1);
+
+		const int n_pts = data.da.size();
+
+		Eigen::Matrix<double, n_basis, dim> local_disp(data.vals.basis_values.size(), size());
+		local_disp.setZero();
+		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
 		{
-			switch (data.vals.basis_values.size())
-			{
-			case 3:
-				return compute_energy_aux<double, 3, 2>(data);
-			case 6:
-				return compute_energy_aux<double, 6, 2>(data);
-			case 10:
-				return compute_energy_aux<double, 10, 2>(data);
-			default:
-				return compute_energy_aux<double, Eigen::Dynamic, 2>(data);
-			}
+			const auto &bs = data.vals.basis_values[i];
+			for (size_t ii = 0; ii < bs.global.size(); ++ii)
+				local_disp.row(i) += bs.global[ii].val * data.x.block<dim, 1>(bs.global[ii].index * size(), 0).transpose();
 		}
-		else // if (size() == 3)
+
+		utils::basis_grad_batch<n_basis, dim>(data.vals, G);
+		utils::def_grad_batch<n_basis, dim>(G, local_disp, F);
+
+		if (use_robust_jacobian)
 		{
-			assert(size() == 3);
-			switch (data.vals.basis_values.size())
-			{
-			case 4:
-				return compute_energy_aux<double, 4, 3>(data);
-			case 10:
-				return compute_energy_aux<double, 10, 3>(data);
-			case 20:
-				return compute_energy_aux<double, 20, 3>(data);
-			default:
-				return compute_energy_aux<double, Eigen::Dynamic, 3>(data);
-			}
+			J = data.vals.eval_deformed_jacobian_determinant(data.x);
+			for (long p = 0; p < n_pts; ++p)
+				J(p) *= data.vals.jac_it[p].determinant();
 		}
+		else
+			J = utils::determinant_batch<dim>(F);
+
+		lambda.resize(n_pts);
+		mu.resize(n_pts);
+		for (long p = 0; p < n_pts; ++p)
+			params_.lambda_mu(data.vals.quadrature.points.row(p), data.vals.val.row(p), data.t, data.vals.element_id, lambda(p), mu(p));
 	}
 
 	// Compute ∫ ½μ (tr(FᵀF) - 3 - 2ln(J)) + ½λ ln²(J) du
@@ -339,52 +240,15 @@ namespace polyfem::assembler
 	{
 		if constexpr (std::is_same_v<T, double>)
 		{
-			Eigen::Matrix<T, n_basis, dim> local_disp(data.vals.basis_values.size(), size());
-			local_disp.setZero();
-			for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-			{
-				const auto &bs = data.vals.basis_values[i];
-				for (size_t ii = 0; ii < bs.global.size(); ++ii)
-				{
-					for (int d = 0; d < dim; ++d)
-					{
-						local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-					}
-				}
-			}
-
-			Eigen::VectorXd jacs;
-			if (use_robust_jacobian)
-				jacs = data.vals.eval_deformed_jacobian_determinant(data.x);
-			
-			Eigen::Matrix<T, dim, dim> def_grad(size(), size());
-
-			T energy = T(0.0);
-
-			const int n_pts = data.da.size();
-			for (long p = 0; p < n_pts; ++p)
-			{
-				Eigen::Matrix<T, n_basis, dim> grad(data.vals.basis_values.size(), size());
+			utils::BasisGradBatch<n_basis, dim> G;
+			utils::TensorBatch<dim> F;
+			Eigen::ArrayXd J, lambda, mu;
+			quadrature_batch<n_basis, dim>(data, G, F, J, lambda, mu);
 
-				for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-				{
-					grad.row(i) = data.vals.basis_values[i].grad.row(p);
-				}
+			const Eigen::ArrayXd log_det_j = J.log();
+			const Eigen::ArrayXd val = mu / 2 * (F.square().rowwise().sum() - size() - 2 * log_det_j) + lambda / 2 * log_det_j.square();
 
-				const Eigen::Matrix<T, dim, dim> jac_it = data.vals.jac_it[p];
-				// Id + grad d
-				def_grad = (local_disp.transpose() * grad) * jac_it + Eigen::Matrix<T, dim, dim>::Identity(size(), size());
-				
-				double lambda, mu;
-				params_.lambda_mu(data.vals.quadrature.points.row(p), data.vals.val.row(p), data.t, data.vals.element_id, lambda, mu);
-				
-				const T J = use_robust_jacobian ? jacs(p) * jac_it.determinant() : def_grad.determinant();
-				const T log_det_j = log(J);
-				const T val = mu / 2 * (def_grad.squaredNorm() - size() - 2 * log_det_j) + 
-								lambda / 2 * log_det_j * log_det_j;
-				energy += val * data.da(p);
-			}
-			return energy;
+			return (val * data.da.array()).sum();
 		}
 		else
 		{
@@ -419,242 +283,75 @@ namespace polyfem::assembler
 		}
 	}
 
-	template <int dim>
-	Eigen::Matrix<double, dim, dim> hat(const Eigen::Matrix<double, dim, 1> &x)
-	{
-
-		Eigen::Matrix<double, dim, dim> prod;
-		prod.setZero();
-
-		prod(0, 1) = -x(2);
-		prod(0, 2) = x(1);
-		prod(1, 0) = x(2);
-		prod(1, 2) = -x(0);
-		prod(2, 0) = -x(1);
-		prod(2, 1) = x(0);
-
-		return prod;
-	}
-
-	template <int dim>
-	Eigen::Matrix<double, dim, 1> cross(const Eigen::Matrix<double, dim, 1> &x, const Eigen::Matrix<double, dim, 1> &y)
-	{
-
-		Eigen::Matrix<double, dim, 1> z;
-		z.setZero();
-
-		z(0) = x(1) * y(2) - x(2) * y(1);
-		z(1) = x(2) * y(0) - x(0) * y(2);
-		z(2) = x(0) * y(1) - x(1) * y(0);
-
-		return z;
-	}
-
 	template <int n_basis, int dim>
 	void NeoHookeanElasticity::compute_energy_aux_gradient_fast(const NonLinearAssemblerData &data, Eigen::Matrix<double, Eigen::Dynamic, 1> &G_flattened) const
 	{
-		assert(data.x.cols() == 1);
-
-		const int n_pts = data.da.size();
-
-		Eigen::Matrix<double, n_basis, dim> local_disp(data.vals.basis_values.size(), size());
-		local_disp.setZero();
-		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-		{
-			const auto &bs = data.vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				for (int d = 0; d < dim; ++d)
-				{
-					local_disp(i, d) += bs.global[ii].val * data.x(bs.global[ii].index * size() + d);
-				}
-			}
-		}
-
-		Eigen::VectorXd jacs;
-		if (use_robust_jacobian)
-			jacs = data.vals.eval_deformed_jacobian_determinant(data.x);
-
-		Eigen::Matrix<double, dim, dim> def_grad(size(), size());
-
-		Eigen::Matrix<double, n_basis, dim> G(data.vals.basis_values.size(), size());
-		G.setZero();
-
-		for (long p = 0; p < n_pts; ++p)
-		{
-			Eigen::Matrix<double, n_basis, dim> grad(data.vals.basis_values.size(), size());
-
-			for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-			{
-				grad.row(i) = data.vals.basis_values[i].grad.row(p);
-			}
-
-			Eigen::Matrix<double, dim, dim> jac_it = data.vals.jac_it[p];
-			Eigen::Matrix<double, n_basis, dim> delF_delU = grad * jac_it;
+		utils::BasisGradBatch<n_basis, dim> G;
+		utils::TensorBatch<dim> F;
+		Eigen::ArrayXd J, lambda, mu;
+		quadrature_batch<n_basis, dim>(data, G, F, J, lambda, mu);
 
-			// Id + grad d
-			def_grad = local_disp.transpose() * delF_delU + Eigen::Matrix<double, dim, dim>::Identity(size(), size());
+		const Eigen::ArrayXd log_det_j = J.log();
+		const utils::TensorBatch<dim> delJ_delF = utils::cofactor_batch<dim>(F);
 
-			const double J = use_robust_jacobian ? jacs(p) * jac_it.determinant() : def_grad.determinant();
-			const double log_det_j = log(J);
+		// P = μF + (λln(J) - μ)/J ∂J/∂F
+		const utils::TensorBatch<dim> P = F.colwise() * mu + delJ_delF.colwise() * ((lambda * log_det_j - mu) / J);
 
-			Eigen::Matrix<double, dim, dim> delJ_delF(size(), size());
-			delJ_delF.setZero();
-
-			if (dim == 2)
-			{
-
-				delJ_delF(0, 0) = def_grad(1, 1);
-				delJ_delF(0, 1) = -def_grad(1, 0);
-				delJ_delF(1, 0) = -def_grad(0, 1);
-				delJ_delF(1, 1) = def_grad(0, 0);
-			}
-
-			else if (dim == 3)
-			{
-
-				Eigen::Matrix<double, dim, 1> u(def_grad.rows());
-				Eigen::Matrix<double, dim, 1> v(def_grad.rows());
-				Eigen::Matrix<double, dim, 1> w(def_grad.rows());
-
-				u = def_grad.col(0);
-				v = def_grad.col(1);
-				w = def_grad.col(2);
-
-				delJ_delF.col(0) = cross<dim>(v, w);
-				delJ_delF.col(1) = cross<dim>(w, u);
-				delJ_delF.col(2) = cross<dim>(u, v);
-			}
-
-			double lambda, mu;
-			params_.lambda_mu(data.vals.quadrature.points.row(p), data.vals.val.row(p), data.t, data.vals.element_id, lambda, mu);
-
-			Eigen::Matrix<double, dim, dim> gradient_temp = mu * def_grad - mu * (1 / J) * delJ_delF + lambda * log_det_j * (1 / J) * delJ_delF;
-			Eigen::Matrix<double, n_basis, dim> gradient = delF_delU * gradient_temp.transpose();
-
-			double val = mu / 2 * ((def_grad.transpose() * def_grad).trace() - size() - 2 * log_det_j) + lambda / 2 * log_det_j * log_det_j;
-
-			G.noalias() += gradient * data.da(p);
-		}
-
-		Eigen::Matrix<double, dim, n_basis> G_T = G.transpose();
-
-		constexpr int N = (n_basis == Eigen::Dynamic) ? Eigen::Dynamic : n_basis * dim;
-		Eigen::Matrix<double, N, 1> temp(Eigen::Map<Eigen::Matrix<double, N, 1>>(G_T.data(), G_T.size()));
-		G_flattened = temp;
+		utils::gradient_from_stress_batch<n_basis, dim>(G, P, data.da, G_flattened);
 	}
 
 	template <int n_basis, int dim>
-	void NeoHookeanElasticity::compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, Eigen::MatrixXd &H) const
+	void NeoHookeanElasticity::compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, const bool project_to_psd, Eigen::MatrixXd &H) const
 	{
-		assert(data.x.cols() == 1);
+		constexpr int n = dim * dim;
 
-		constexpr int N = (n_basis == Eigen::Dynamic) ? Eigen::Dynamic : n_basis * dim;
-		const int n_pts = data.da.size();
+		utils::BasisGradBatch<n_basis, dim> G;
+		utils::TensorBatch<dim> F;
+		Eigen::ArrayXd J, lambda, mu;
+		quadrature_batch<n_basis, dim>(data, G, F, J, lambda, mu);
 
-		Eigen::Matrix<double, n_basis, dim> local_disp(data.vals.basis_values.size(), size());
-		local_disp.setZero();
-		for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
-		{
-			const auto &bs = data.vals.basis_values[i];
-			for (size_t ii = 0; ii < bs.global.size(); ++ii)
-			{
-				local_disp.row(i) += bs.global[ii].val * data.x.block<dim, 1>(bs.global[ii].index * size(), 0).transpose();
-			}
-		}
+		const Eigen::ArrayXd log_det_j = J.log();
 
-		Eigen::VectorXd jacs;
-		if (use_robust_jacobian)
-			jacs = data.vals.eval_deformed_jacobian_determinant(data.x);
-
-		Eigen::Matrix<double, dim, dim> def_grad(size(), size());
-
-		for (long p = 0; p < n_pts; ++p)
+		utils::TensorBatch4<dim> hessian_temp(F.rows(), n * n);
+		if (project_to_psd)
 		{
-			Eigen::Matrix<double, n_basis, dim> grad(data.vals.basis_values.size(), size());
+			utils::TensorBatch<dim> U, V;
+			utils::SingularValueBatch<dim> sigma_batch;
+			utils::svd_batch<dim>(F, U, sigma_batch, V);
 
-			for (size_t i = 0; i < data.vals.basis_values.size(); ++i)
+			// Ψ(σ) = ½μ (Σσᵢ² - dim) - μln(J) + ½λ ln²(J), J = Πσᵢ
+			for (long p = 0; p < F.rows(); ++p)
 			{
-				grad.row(i) = data.vals.basis_values[i].grad.row(p);
-			}
-
-			Eigen::Matrix<double, dim, dim> jac_it = data.vals.jac_it[p];
-			const Eigen::Matrix<double, n_basis, dim> delF_delU = grad * jac_it;
+				const Eigen::Matrix<double, dim, 1> sigmas = sigma_batch.row(p).transpose();
+				const double c = lambda(p) * log_det_j(p) - mu(p);
 
-			// Id + grad d
-			def_grad = local_disp.transpose() * delF_delU + Eigen::Matrix<double, dim, dim>::Identity(size(), size());
+				const Eigen::Matrix<double, dim, 1> dE_div_dsigma = mu(p) * sigmas.array() + c / sigmas.array();
+				Eigen::Matrix<double, dim, dim> d2E_div_dsigma2 = lambda(p) / (sigmas * sigmas.transpose()).array();
+				d2E_div_dsigma2.diagonal().array() = mu(p) + (mu(p) + lambda(p) * (1 - log_det_j(p))) / sigmas.array().square();
 
-			const double J = use_robust_jacobian ? jacs(p) * jac_it.determinant() : def_grad.determinant();
-			double log_det_j = log(J);
+				Eigen::Matrix<double, dim * (dim - 1) / 2, 1> left_coef;
+				for (int i = 0; i < left_coef.size(); ++i)
+					left_coef(i) = (mu(p) - c / (sigmas(i) * sigmas((i + 1) % dim))) / 2;
 
-			Eigen::Matrix<double, dim, dim> delJ_delF(size(), size());
-			delJ_delF.setZero();
-			Eigen::Matrix<double, dim * dim, dim * dim> del2J_delF2(size() * size(), size() * size());
-			del2J_delF2.setZero();
-
-			if (dim == 2)
-			{
-				delJ_delF(0, 0) = def_grad(1, 1);
-				delJ_delF(0, 1) = -def_grad(1, 0);
-				delJ_delF(1, 0) = -def_grad(0, 1);
-				delJ_delF(1, 1) = def_grad(0, 0);
-
-				del2J_delF2(0, 3) = 1;
-				del2J_delF2(1, 2) = -1;
-				del2J_delF2(2, 1) = -1;
-				del2J_delF2(3, 0) = 1;
-			}
-			else if (size() == 3)
-			{
-				Eigen::Matrix<double, dim, 1> u(def_grad.rows());
-				Eigen::Matrix<double, dim, 1> v(def_grad.rows());
-				Eigen::Matrix<double, dim, 1> w(def_grad.rows());
-
-				u = def_grad.col(0);
-				v = def_grad.col(1);
-				w = def_grad.col(2);
-
-				delJ_delF.col(0) = cross<dim>(v, w);
-				delJ_delF.col(1) = cross<dim>(w, u);
-				delJ_delF.col(2) = cross<dim>(u, v);
-
-				del2J_delF2.template block<dim, dim>(0, 6) = hat<dim>(v);
-				del2J_delF2.template block<dim, dim>(6, 0) = -hat<dim>(v);
-				del2J_delF2.template block<dim, dim>(0, 3) = -hat<dim>(w);
-				del2J_delF2.template block<dim, dim>(3, 0) = hat<dim>(w);
-				del2J_delF2.template block<dim, dim>(3, 6) = -hat<dim>(u);
-				del2J_delF2.template block<dim, dim>(6, 3) = hat<dim>(u);
+				hessian_temp.row(p) = isotropic_hessian_from_singular_values<dim>(U.row(p).reshaped(dim, dim), V.row(p).reshaped(dim, dim), sigmas, dE_div_dsigma, d2E_div_dsigma2, left_coef, true).reshaped().transpose();
 			}
+		}
+		else
+		{
+			const utils::TensorBatch<dim> delJ_delF = utils::cofactor_batch<dim>(F);
 
-			double lambda, mu;
-			params_.lambda_mu(data.vals.quadrature.points.row(p), data.vals.val.row(p), data.t, data.vals.element_id, lambda, mu);
-
-			Eigen::Matrix<double, dim * dim, dim * dim> id = Eigen::Matrix<double, dim * dim, dim * dim>::Identity(size() * size(), size() * size());
-
-			Eigen::Matrix<double, dim * dim, 1> g_j = Eigen::Map<const Eigen::Matrix<double, dim * dim, 1>>(delJ_delF.data(), delJ_delF.size());
-
-			Eigen::Matrix<double, dim * dim, dim * dim> hessian_temp = (mu * id) + (((mu + lambda * (1 - log_det_j)) / (J * J)) * (g_j * g_j.transpose())) + (((lambda * log_det_j - mu) / (J)) * del2J_delF2);
-
-			Eigen::Matrix<double, dim * dim, N> delF_delU_tensor = Eigen::Matrix<double, dim * dim, N>::Zero(jac_it.size(), grad.size());
-
-			for (size_t i = 0; i < local_disp.rows(); ++i)
+			// ∂²Ψ/∂F² = μI + (μ + λ(1 - ln(J)))/J² ∂J/∂F ⊗ ∂J/∂F + (λln(J) - μ)/J ∂²J/∂F²
+			const Eigen::ArrayXd c1 = (mu + lambda * (1 - log_det_j)) / J.square();
+			for (int b = 0; b < n; ++b)
 			{
-				for (size_t j = 0; j < local_disp.cols(); ++j)
-				{
-					Eigen::Matrix<double, dim, dim> temp(size(), size());
-					temp.setZero();
-					temp.row(j) = delF_delU.row(i);
-					Eigen::Matrix<double, dim * dim, 1> temp_flattened(Eigen::Map<Eigen::Matrix<double, dim * dim, 1>>(temp.data(), temp.size()));
-					delF_delU_tensor.col(i * size() + j) = temp_flattened;
-				}
+				for (int a = 0; a < n; ++a)
+					hessian_temp.col(a + b * n) = c1 * delJ_delF.col(a) * delJ_delF.col(b);
+				hessian_temp.col(b + b * n) += mu;
 			}
-
-			Eigen::Matrix<double, N, N> hessian = delF_delU_tensor.transpose() * hessian_temp * delF_delU_tensor;
-
-			double val = mu / 2 * ((def_grad.transpose() * def_grad).trace() - size() - 2 * log_det_j) + lambda / 2 * log_det_j * log_det_j;
-
-			H += hessian * data.da(p);
+			utils::add_det_hessian_batch<dim>((lambda * log_det_j - mu) / J, F, hessian_temp);
 		}
+
+		utils::hessian_from_stiffness_batch<n_basis, dim>(G, hessian_temp, data.da, H);
 	}
 
 	void NeoHookeanElasticity::compute_stress_grad_multiply_mat(
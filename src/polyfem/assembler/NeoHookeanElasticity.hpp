@@ -4,6 +4,7 @@
 #include <polyfem/assembler/MatParams.hpp>
 #include <polyfem/utils/AutodiffTypes.hpp>
 #include <polyfem/utils/ElasticityUtils.hpp>
+#include <polyfem/utils/TensorBatch.hpp>
 
 // non linear NeoHookean material model
 namespace polyfem::assembler
@@ -21,6 +22,8 @@ namespace polyfem::assembler
 		double compute_energy(const NonLinearAssemblerData &data) const override;
 		Eigen::VectorXd assemble_gradient(const NonLinearAssemblerData &data) const override;
 		Eigen::MatrixXd assemble_hessian(const NonLinearAssemblerData &data) const override;
+		// projects ∂²Ψ/∂F² at every quadrature point in closed form from the singular values of F
+		Eigen::MatrixXd assemble_projected_hessian(const NonLinearAssemblerData &data) const override;
 
 		// rhs for fabbricated solution, compute with automatic sympy code
 		VectorNd compute_rhs(const AutodiffHessianPt &pt) const override;
@@ -77,9 +80,19 @@ namespace polyfem::assembler
 		// utility function that computes energy, the template is used for double, DScalar1, and DScalar2 in energy, gradient and hessian
 		template <typename T, int n_basis, int dim>
 		T compute_energy_aux(const NonLinearAssemblerData &data) const;
+		Eigen::MatrixXd compute_hessian(const NonLinearAssemblerData &data, const bool project_to_psd) const;
 		template <int n_basis, int dim>
-		void compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, Eigen::MatrixXd &H) const;
+		void compute_energy_hessian_aux_fast(const NonLinearAssemblerData &data, const bool project_to_psd, Eigen::MatrixXd &H) const;
 		template <int n_basis, int dim>
 		void compute_energy_aux_gradient_fast(const NonLinearAssemblerData &data, Eigen::VectorXd &G_flattened) const;
+
+		// basis gradients, deformation gradients, J, and Lamé parameters at all quadrature points in structure-of-arrays layout
+		template <int n_basis, int dim>
+		void quadrature_batch(const NonLinearAssemblerData &data,
+							  utils::BasisGradBatch<n_basis, dim> &G,
+							  utils::TensorBatch<dim> &F,
+							  Eigen::ArrayXd &J,
+							  Eigen::ArrayXd &lambda,
+							  Eigen::ArrayXd &mu) const;
 	};
 } // namespace polyfem::assembler
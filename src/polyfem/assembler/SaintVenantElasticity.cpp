@@ -88,43 +88,17 @@ namespace polyfem::assembler
 	Eigen::VectorXd
 	SaintVenantElasticity::assemble_gradient(const NonLinearAssemblerData &data) const
 	{
-		// igl::Timer time; time.start();
-
-		const int n_bases = data.vals.basis_values.size();
-
-		return polyfem::gradient_from_energy(
-			size(), n_bases, data,
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 6, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 8, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 12, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 18, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 24, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 30, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 60, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, 81, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, BIG_N, 1>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar1<double, Eigen::VectorXd>>(data); });
+		return polyfem::gradient_from_disp_grad_energy(
+			size(), data,
+			[&](const int p, const auto &disp_grad) { return energy_density(disp_grad); });
 	}
 
 	Eigen::MatrixXd
 	SaintVenantElasticity::assemble_hessian(const NonLinearAssemblerData &data) const
 	{
-		// igl::Timer time; time.start();
-
-		const int n_bases = data.vals.basis_values.size();
-		return polyfem::hessian_from_energy(
-			size(), n_bases, data,
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 6, 1>, Eigen::Matrix<double, 6, 6>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 8, 1>, Eigen::Matrix<double, 8, 8>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 12, 1>, Eigen::Matrix<double, 12, 12>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 18, 1>, Eigen::Matrix<double, 18, 18>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 24, 1>, Eigen::Matrix<double, 24, 24>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 30, 1>, Eigen::Matrix<double, 30, 30>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 60, 1>, Eigen::Matrix<double, 60, 60>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, 81, 1>, Eigen::Matrix<double, 81, 81>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::Matrix<double, Eigen::Dynamic, 1, 0, SMALL_N, 1>, Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, SMALL_N, SMALL_N>>>(data); },
-			[&](const NonLinearAssemblerData &data) { return compute_energy_aux<DScalar2<double, Eigen::VectorXd, Eigen::MatrixXd>>(data); });
+		return polyfem::hessian_from_disp_grad_energy(
+			size(), data,
+			[&](const int p, const auto &disp_grad) { return energy_density(disp_grad); });
 	}
 
 	void SaintVenantElasticity::assign_stress_tensor(
@@ -204,6 +178,43 @@ namespace polyfem::assembler
 		return compute_energy_aux<double>(data);
 	}
 
+	// Compute ½ \sigma : E
+	template <typename AutoDiffGradMat>
+	typename AutoDiffGradMat::Scalar SaintVenantElasticity::energy_density(const AutoDiffGradMat &disp_grad) const
+	{
+		typedef typename AutoDiffGradMat::Scalar T;
+
+		AutoDiffGradMat strain = strain_from_disp_grad(disp_grad);
+		AutoDiffGradMat stress_tensor(size(), size());
+
+		if (size() == 2)
+		{
+			std::array<T, 3> eps;
+			eps[0] = strain(0, 0);
+			eps[1] = strain(1, 1);
+			eps[2] = 2 * strain(0, 1);
+
+			stress_tensor << stress(eps, 0), stress(eps, 2),
+				stress(eps, 2), stress(eps, 1);
+		}
+		else
+		{
+			std::array<T, 6> eps;
+			eps[0] = strain(0, 0);
+			eps[1] = strain(1, 1);
+			eps[2] = strain(2, 2);
+			eps[3] = 2 * strain(1, 2);
+			eps[4] = 2 * strain(0, 2);
+			eps[5] = 2 * strain(0, 1);
+
+			stress_tensor << stress(eps, 0), stress(eps, 5), stress(eps, 4),
+				stress(eps, 5), stress(eps, 1), stress(eps, 3),
+				stress(eps, 4), stress(eps, 3), stress(eps, 2);
+		}
+
+		return (stress_tensor * strain).trace() * 0.5;
+	}
+
 	// Compute \int \sigma : E
 	template <typename T>
 	T SaintVenantElasticity::compute_energy_aux(const NonLinearAssemblerData &data) const
@@ -223,38 +234,10 @@ namespace polyfem::assembler
 		{
 			compute_disp_grad_at_quad(data, local_disp, p, size(), disp_grad);
 
-			AutoDiffGradMat strain = strain_from_disp_grad(disp_grad);
-			AutoDiffGradMat stress_tensor(size(), size());
-
-			if (size() == 2)
-			{
-				std::array<T, 3> eps;
-				eps[0] = strain(0, 0);
-				eps[1] = strain(1, 1);
-				eps[2] = 2 * strain(0, 1);
-
-				stress_tensor << stress(eps, 0), stress(eps, 2),
-					stress(eps, 2), stress(eps, 1);
-			}
-			else
-			{
-				std::array<T, 6> eps;
-				eps[0] = strain(0, 0);
-				eps[1] = strain(1, 1);
-				eps[2] = strain(2, 2);
-				eps[3] = 2 * strain(1, 2);
-				eps[4] = 2 * strain(0, 2);
-				eps[5] = 2 * strain(0, 1);
-
-				stress_tensor << stress(eps, 0), stress(eps, 5), stress(eps, 4),
-					stress(eps, 5), stress(eps, 1), stress(eps, 3),
-					stress(eps, 4), stress(eps, 3), stress(eps, 2);
-			}
-
-			energy += (stress_tensor * strain).trace() * data.da(p);
+			energy += energy_density(disp_grad) * data.da(p);
 		}
 
-		return energy * 0.5;
+		return energy;
 	}
 
 	std::map<std::string, Assembler::ParamFunc> SaintVenantElasticity::parameters() const
@@ -46,6 +46,9 @@ namespace polyfem::assembler
 		template <typename T, unsigned long N>
 		T stress(const std::array<T, N> &strain, const int j) const;
 
+		template <typename AutoDiffGradMat>
+		typename AutoDiffGradMat::Scalar energy_density(const AutoDiffGradMat &disp_grad) const;
+
 		template <typename T>
 		T compute_energy_aux(const NonLinearAssemblerData &data) const;
 	};
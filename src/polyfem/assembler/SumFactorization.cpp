@@ -0,0 +1,520 @@
+#include "SumFactorization.hpp"
+
+#include <polyfem/assembler/Laplacian.hpp>
+#include <polyfem/assembler/LinearElasticity.hpp>
+#include <polyfem/assembler/Mass.hpp>
+#include <polyfem/autogen/auto_q_bases.hpp>
+#include <polyfem/quadrature/LineQuadrature.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <array>
+#include <cmath>
+
+namespace polyfem::assembler
+{
+	using namespace basis;
+	using namespace quadrature;
+	using namespace utils;
+
+	namespace
+	{
+		/// Temporaries of the contractions of one element
+		struct Workspace
+		{
+			Eigen::VectorXd b2, d2, bb21, db21, bd21;
+			Eigen::VectorXd bb0, db0, bd0, b01, d01;
+		};
+
+		class LocalThreadVecStorage
+		{
+		public:
+			Eigen::VectorXd vec;
+			Workspace work;
+			std::array<Eigen::VectorXd, 3> u, r, val;
+			std::array<std::array<Eigen::VectorXd, 3>, 3> grad;
+
+			LocalThreadVecStorage(const int size)
+			{
+				vec.setZero(size);
+			}
+		};
+
+		/// Values and derivatives at the points t of the 1D Lagrange bases on the equispaced nodes of [0, 1]
+		void lagrange_1d(const int q, const Eigen::VectorXd &t, Eigen::MatrixXd &B, Eigen::MatrixXd &D)
+		{
+			B.setOnes(t.size(), q + 1);
+			D.setZero(t.size(), q + 1);
+
+			for (int a = 0; a <= q; ++a)
+			{
+				const double xa = double(a) / q;
+				for (int b = 0; b <= q; ++b)
+				{
+					if (b == a)
+						continue;
+					const double xb = double(b) / q;
+
+					Eigen::ArrayXd dfactor = Eigen::ArrayXd::Constant(t.size(), 1 / (xa - xb));
+					for (int c = 0; c <= q; ++c)
+					{
+						if (c != a && c != b)
+							dfactor *= (t.array() - double(c) / q) / (xa - double(c) / q);
+					}
+					D.col(a).array() += dfactor;
+					B.col(a).array() *= (t.array() - xb) / (xa - xb);
+				}
+			}
+		}
+
+		/// out (+)= A applied along the direction d of the tensor in of size dims, stored with the first index fastest
+		void contract(const Eigen::MatrixXd &A, const int d, const std::array<int, 3> &dims, const Eigen::VectorXd &in, Eigen::VectorXd &out, const bool add = false)
+		{
+			using Map = Eigen::Map<Eigen::MatrixXd>;
+			using ConstMap = Eigen::Map<const Eigen::MatrixXd>;
+
+			assert(A.cols() == dims[d]);
+			assert(in.size() == dims[0] * dims[1] * dims[2]);
+
+			const int out_size = in.size() / dims[d] * A.rows();
+			if (!add)
+				out.setZero(out_size);
+			assert(out.size() == out_size);
+
+			if (d == 0)
+			{
+				Map(out.data(), A.rows(), dims[1] * dims[2]).noalias() += A * ConstMap(in.data(), dims[0], dims[1] * dims[2]);
+			}
+			else if (d == 1)
+			{
+				for (int k = 0; k < dims[2]; ++k)
+					Map(out.data() + k * dims[0] * A.rows(), dims[0], A.rows()).noalias() += ConstMap(in.data() + k * dims[0] * dims[1], dims[0], dims[1]) * A.transpose();
+			}
+			else
+			{
+				Map(out.data(), dims[0] * dims[1], A.rows()).noalias() += ConstMap(in.data(), dims[0] * dims[1], dims[2]) * A.transpose();
+			}
+		}
+
+		/// Values and/or reference gradients at the tensor quadrature points of the nodal coefficients u
+		void interpolate(const Eigen::MatrixXd &B, const Eigen::MatrixXd &D, const Eigen::VectorXd &u, Workspace &w, Eigen::VectorXd *val, std::array<Eigen::VectorXd, 3> *grad)
+		{
+			const int n = B.cols(), m = B.rows();
+
+			contract(B, 2, {{n, n, n}}, u, w.b2);
+			contract(B, 1, {{n, n, m}}, w.b2, w.bb21);
+			if (val)
+				contract(B, 0, {{n, m, m}}, w.bb21, *val);
+
+			if (grad)
+			{
+				contract(D, 2, {{n, n, n}}, u, w.d2);
+				contract(D, 1, {{n, n, m}}, w.b2, w.db21);
+				contract(B, 1, {{n, n, m}}, w.d2, w.bd21);
+
+				contract(D, 0, {{n, m, m}}, w.bb21, (*grad)[0]);
+				contract(B, 0, {{n, m, m}}, w.db21, (*grad)[1]);
+				contract(B, 0, {{n, m, m}}, w.bd21, (*grad)[2]);
+			}
+		}
+
+		/// Transpose of interpolate: r = ∫ val φ + grad · ∇̂φ for all the nodal bases φ
+		void integrate(const Eigen::MatrixXd &Bt, const Eigen::MatrixXd &Dt, const Eigen::VectorXd *val, const std::array<Eigen::VectorXd, 3> *grad, Workspace &w, Eigen::VectorXd &r)
+		{
+			const int n = Bt.rows(), m = Bt.cols();
+			assert(val || grad);
+
+			if (val)
+				contract(Bt, 0, {{m, m, m}}, *val, w.bb0);
+			if (grad)
+			{
+				contract(Dt, 0, {{m, m, m}}, (*grad)[0], w.bb0, val != nullptr);
+				contract(Bt, 0, {{m, m, m}}, (*grad)[1], w.db0);
+				contract(Bt, 0, {{m, m, m}}, (*grad)[2], w.bd0);
+			}
+
+			contract(Bt, 1, {{n, m, m}}, w.bb0, w.b01);
+			if (grad)
+			{
+				contract(Dt, 1, {{n, m, m}}, w.db0, w.b01, true);
+				contract(Bt, 1, {{n, m, m}}, w.bd0, w.d01);
+			}
+
+			contract(Bt, 2, {{n, n, m}}, w.b01, r);
+			if (grad)
+				contract(Dt, 2, {{n, n, m}}, w.d01, r, true);
+		}
+
+		/// r = Σₚ weights(p) T0(i, a) T1(j, b) T2(k, c) for all the nodes (a, b, c), over the points p = (i, j, k),
+		/// the 1D tables are given transposed (n_nodes x n_points)
+		void integrate_tensor(const Eigen::MatrixXd &T0t, const Eigen::MatrixXd &T1t, const Eigen::MatrixXd &T2t, const Eigen::VectorXd &weights, Workspace &w, Eigen::VectorXd &r)
+		{
+			const int n = T0t.rows(), m = T0t.cols();
+
+			contract(T0t, 0, {{m, m, m}}, weights, w.bb0);
+			contract(T1t, 1, {{n, m, m}}, w.bb0, w.b01);
+			contract(T2t, 2, {{n, n, m}}, w.b01, r);
+		}
+
+		/// Order of the Q bases of the element, -1 if the element is not a hexahedron with (q + 1)³ bases
+		int element_order(const mesh::Mesh &mesh, const std::vector<ElementBases> &bases, const int e)
+		{
+			if (!mesh.is_cube(e))
+				return -1;
+
+			const int n_local_bases = bases[e].bases.size();
+			const int q = int(std::round(std::cbrt(double(n_local_bases)))) - 1;
+			if (q < 1 || q > autogen::MAX_Q_BASES || (q + 1) * (q + 1) * (q + 1) != n_local_bases)
+				return -1;
+			return q;
+		}
+	} // namespace
+
+	bool SumFactorizedOperator::lexicographic_order(const ElementBases &bs, const int q, std::vector<int> &lex_to_local)
+	{
+		const int n = q + 1;
+
+		Eigen::MatrixXd nodes;
+		autogen::q_nodes_3d(q, nodes);
+		if (nodes.rows() != int(bs.bases.size()))
+			return false;
+
+		lex_to_local.assign(n * n * n, -1);
+		for (int j = 0; j < nodes.rows(); ++j)
+		{
+			int lex = 0;
+			for (int d = 2; d >= 0; --d)
+			{
+				const int a = int(std::round(nodes(j, d) * q));
+				if (a < 0 || a > q || std::abs(nodes(j, d) * q - a) > 1e-10)
+					return false;
+				lex = lex * n + a;
+			}
+			if (lex_to_local[lex] >= 0)
+				return false;
+			lex_to_local[lex] = j;
+		}
+
+		// the bases must be the tensor products of the 1D Lagrange bases, which excludes e.g. the spline bases
+		Eigen::MatrixXd samples(3, 3);
+		samples << 0.21, 0.37, 0.73,
+			0.83, 0.12, 0.45,
+			0.58, 0.91, 0.06;
+
+		std::array<Eigen::MatrixXd, 3> B1, D1;
+		for (int d = 0; d < 3; ++d)
+			lagrange_1d(q, samples.col(d), B1[d], D1[d]);
+
+		std::vector<AssemblyValues> vals;
+		bs.evaluate_bases(samples, vals);
+		for (int c = 0; c < n; ++c)
+		{
+			for (int b = 0; b < n; ++b)
+			{
+				for (int a = 0; a < n; ++a)
+				{
+					const Eigen::VectorXd expected = B1[0].col(a).cwiseProduct(B1[1].col(b)).cwiseProduct(B1[2].col(c));
+					if ((vals[lex_to_local[a + n * (b + n * c)]].val - expected).cwiseAbs().maxCoeff() > 1e-10)
+						return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool SumFactorizedOperator::is_supported(const mesh::Mesh &mesh, const std::vector<ElementBases> &bases)
+	{
+		if (!mesh.is_volume() || bases.empty())
+			return false;
+
+		const int q = element_order(mesh, bases, 0);
+		if (q < 0)
+			return false;
+
+		std::vector<int> lex_to_local;
+		for (int e = 0; e < int(bases.size()); ++e)
+		{
+			if (element_order(mesh, bases, e) != q || !lexicographic_order(bases[e], q, lex_to_local))
+				return false;
+		}
+
+		return true;
+	}
+
+	SumFactorizedOperator::SumFactorizedOperator(
+		const Assembler &assembler,
+		const mesh::Mesh &mesh,
+		const int n_bases,
+		const std::vector<ElementBases> &bases,
+		const std::vector<ElementBases> &gbases,
+		const int quadrature_order,
+		const double t)
+		: n_bases_(n_bases), bases_(bases)
+	{
+		const Mass *mass = dynamic_cast<const Mass *>(&assembler);
+		const LinearElasticity *linear_elasticity = dynamic_cast<const LinearElasticity *>(&assembler);
+
+		if (dynamic_cast<const Laplacian *>(&assembler))
+			kind_ = Kind::Laplacian;
+		else if (mass)
+			kind_ = Kind::Mass;
+		else if (linear_elasticity)
+			kind_ = Kind::LinearElasticity;
+		else
+			log_and_throw_error("Sum factorization is not implemented for {}", assembler.name());
+
+		size_ = kind_ == Kind::Laplacian ? 1 : assembler.size();
+		if (kind_ == Kind::LinearElasticity && size_ != 3)
+			log_and_throw_error("Sum factorization of {} requires size 3, got {}", assembler.name(), size_);
+
+		if (!is_supported(mesh, bases))
+			log_and_throw_error("Sum factorization requires a hexahedral mesh with Q bases of a single order");
+
+		const int q = element_order(mesh, bases, 0);
+		lexicographic_order(bases[0], q, lex_to_local_);
+		n_nodes_ = q + 1;
+
+		Quadrature line_quadrature;
+		LineQuadrature().get_quadrature(quadrature_order, line_quadrature);
+		const Eigen::VectorXd t1 = line_quadrature.points.col(0);
+		const Eigen::VectorXd &w1 = line_quadrature.weights;
+		n_points_ = t1.size();
+
+		lagrange_1d(q, t1, B_, D_);
+		Bt_ = B_.transpose();
+		Dt_ = D_.transpose();
+
+		// tensor quadrature with the first direction fastest, same ordering as HexQuadrature
+		const int n_pts = n_points_ * n_points_ * n_points_;
+		Eigen::MatrixXd points(n_pts, 3);
+		Eigen::VectorXd weights(n_pts);
+		for (int k = 0; k < n_points_; ++k)
+		{
+			for (int j = 0; j < n_points_; ++j)
+			{
+				for (int i = 0; i < n_points_; ++i)
+				{
+					const int p = i + n_points_ * (j + n_points_ * k);
+					points.row(p) << t1(i), t1(j), t1(k);
+					weights(p) = w1(i) * w1(j) * w1(k);
+				}
+			}
+		}
+
+		const int n_factors = kind_ == Kind::Laplacian ? 6 : (kind_ == Kind::Mass ? 1 : 11);
+		const int n_elements = bases.size();
+		point_factors_.resize(n_elements * n_pts, n_factors);
+
+		maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+			std::vector<Eigen::MatrixXd> grads;
+			Eigen::MatrixXd mapped;
+
+			for (int e = start; e < end; ++e)
+			{
+				gbases[e].eval_geom_mapping_grads(points, grads);
+				if (kind_ != Kind::Laplacian)
+					gbases[e].eval_geom_mapping(points, mapped);
+
+				for (int p = 0; p < n_pts; ++p)
+				{
+					auto factors = point_factors_.row(e * n_pts + p);
+
+					const Eigen::Matrix3d &tmp = grads[p];
+					const double da = tmp.determinant() * weights(p);
+					const Eigen::Matrix3d K = tmp.inverse().transpose();
+
+					if (kind_ == Kind::Laplacian)
+					{
+						const Eigen::Matrix3d W = da * K * K.transpose();
+						factors << W(0, 0), W(0, 1), W(0, 2), W(1, 1), W(1, 2), W(2, 2);
+					}
+					else if (kind_ == Kind::Mass)
+					{
+						factors(0) = mass->density()(points.row(p), mapped.row(p), t, e) * da;
+					}
+					else
+					{
+						double lambda, mu;
+						linear_elasticity->lame_params().lambda_mu(points.row(p), mapped.row(p), t, e, lambda, mu);
+						factors.head<9>() = K.reshaped().transpose();
+						factors(9) = lambda * da;
+						factors(10) = mu * da;
+					}
+				}
+			}
+		});
+	}
+
+	void SumFactorizedOperator::apply(const Eigen::VectorXd &x, Eigen::VectorXd &y) const
+	{
+		assert(x.size() == size());
+
+		const int n_elements = bases_.size();
+		const int n_pts = n_points_ * n_points_ * n_points_;
+		const int n_loc = lex_to_local_.size();
+
+		auto storage = create_thread_storage(LocalThreadVecStorage(size()));
+
+		maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+			LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+			Workspace &w = local_storage.work;
+			auto &u = local_storage.u;
+			auto &r = local_storage.r;
+			auto &val = local_storage.val;
+			auto &grad = local_storage.grad;
+
+			for (int e = start; e < end; ++e)
+			{
+				const auto &bs = bases_[e].bases;
+				const auto factors = point_factors_.middleRows(e * n_pts, n_pts);
+				const auto f = [&factors](const int i) { return factors.col(i).array(); };
+
+				for (int c = 0; c < size_; ++c)
+					u[c].setZero(n_loc);
+				for (int l = 0; l < n_loc; ++l)
+					for (const auto &g : bs[lex_to_local_[l]].global())
+						for (int c = 0; c < size_; ++c)
+							u[c](l) += g.val * x(g.index * size_ + c);
+
+				if (kind_ == Kind::Laplacian)
+				{
+					interpolate(B_, D_, u[0], w, nullptr, &grad[0]);
+
+					const Eigen::ArrayXd g0 = grad[0][0], g1 = grad[0][1], g2 = grad[0][2];
+					grad[0][0] = f(0) * g0 + f(1) * g1 + f(2) * g2;
+					grad[0][1] = f(1) * g0 + f(3) * g1 + f(4) * g2;
+					grad[0][2] = f(2) * g0 + f(4) * g1 + f(5) * g2;
+
+					integrate(Bt_, Dt_, nullptr, &grad[0], w, r[0]);
+				}
+				else if (kind_ == Kind::Mass)
+				{
+					for (int c = 0; c < size_; ++c)
+					{
+						interpolate(B_, D_, u[c], w, &val[c], nullptr);
+						val[c].array() *= f(0);
+						integrate(Bt_, Dt_, &val[c], nullptr, w, r[c]);
+					}
+				}
+				else
+				{
+					for (int c = 0; c < 3; ++c)
+						interpolate(B_, D_, u[c], w, nullptr, &grad[c]);
+
+					// K(i, j) = J⁻¹(i, j), ∇u(c, j) = Σᵢ ∂̂ᵢu_c K(i, j)
+					const auto K = [&f](const int i, const int j) { return f(i + 3 * j); };
+					std::array<Eigen::ArrayXd, 9> grad_u;
+					for (int c = 0; c < 3; ++c)
+						for (int j = 0; j < 3; ++j)
+							grad_u[c + 3 * j] = grad[c][0].array() * K(0, j) + grad[c][1].array() * K(1, j) + grad[c][2].array() * K(2, j);
+
+					// σ da = μ da (∇u + ∇uᵀ) + λ da tr(∇u) I
+					const Eigen::ArrayXd lambda_tr = f(9) * (grad_u[0] + grad_u[4] + grad_u[8]);
+					std::array<Eigen::ArrayXd, 9> stress;
+					for (int j = 0; j < 3; ++j)
+					{
+						for (int c = 0; c < 3; ++c)
+						{
+							stress[c + 3 * j] = f(10) * (grad_u[c + 3 * j] + grad_u[j + 3 * c]);
+							if (c == j)
+								stress[c + 3 * j] += lambda_tr;
+						}
+					}
+
+					// ∫ σ : ∇φ, with ∇φ = ∇̂φ K
+					for (int c = 0; c < 3; ++c)
+					{
+						for (int i = 0; i < 3; ++i)
+							grad[c][i] = (K(i, 0) * stress[c] + K(i, 1) * stress[c + 3] + K(i, 2) * stress[c + 6]).matrix();
+						integrate(Bt_, Dt_, nullptr, &grad[c], w, r[c]);
+					}
+				}
+
+				for (int l = 0; l < n_loc; ++l)
+					for (const auto &g : bs[lex_to_local_[l]].global())
+						for (int c = 0; c < size_; ++c)
+							local_storage.vec(g.index * size_ + c) += g.val * r[c](l);
+			}
+		});
+
+		y.setZero(size());
+		for (const LocalThreadVecStorage &local_storage : storage)
+			y += local_storage.vec;
+	}
+
+	void SumFactorizedOperator::diagonal(Eigen::VectorXd &diag) const
+	{
+		const int n_elements = bases_.size();
+		const int n_pts = n_points_ * n_points_ * n_points_;
+		const int n_loc = lex_to_local_.size();
+
+		// K(l, l) = Σᵢⱼ ∫ Mᵢⱼ ∂̂ᵢφₗ ∂̂ⱼφₗ, the products of two 1D tables are again separable
+		const Eigen::MatrixXd BBt = B_.cwiseProduct(B_).transpose();
+		const Eigen::MatrixXd BDt = B_.cwiseProduct(D_).transpose();
+		const Eigen::MatrixXd DDt = D_.cwiseProduct(D_).transpose();
+		const auto table = [&](const int i, const int j, const int d) -> const Eigen::MatrixXd & {
+			const int n_derivatives = (i == d) + (j == d);
+			return n_derivatives == 0 ? BBt : (n_derivatives == 1 ? BDt : DDt);
+		};
+
+		auto storage = create_thread_storage(LocalThreadVecStorage(size()));
+
+		maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+			LocalThreadVecStorage &local_storage = get_local_thread_storage(storage, thread_id);
+			Workspace &w = local_storage.work;
+			auto &r = local_storage.r;
+			Eigen::VectorXd weights, tmp;
+
+			for (int e = start; e < end; ++e)
+			{
+				const auto &bs = bases_[e].bases;
+				const auto factors = point_factors_.middleRows(e * n_pts, n_pts);
+				const auto f = [&factors](const int i) { return factors.col(i).array(); };
+				const auto K = [&f](const int i, const int j) { return f(i + 3 * j); };
+
+				for (int c = 0; c < size_; ++c)
+				{
+					if (kind_ == Kind::Mass)
+					{
+						integrate_tensor(BBt, BBt, BBt, factors.col(0), w, r[c]);
+						continue;
+					}
+
+					r[c].setZero(n_loc);
+					for (int i = 0; i < 3; ++i)
+					{
+						for (int j = i; j < 3; ++j)
+						{
+							if (kind_ == Kind::Laplacian)
+							{
+								// upper triangle of da J⁻¹J⁻ᵀ
+								const int index = i == 0 ? j : (i == 1 ? 2 + j : 5);
+								weights = factors.col(index);
+							}
+							else
+							{
+								// μ da ∇φ·∇φ + (λ + μ) da (∂_c φ)², with ∂ⱼφ = Σᵢ ∂̂ᵢφ K(i, j)
+								weights = (f(10) * (K(i, 0) * K(j, 0) + K(i, 1) * K(j, 1) + K(i, 2) * K(j, 2))
+										   + (f(9) + f(10)) * K(i, c) * K(j, c))
+											  .matrix();
+							}
+
+							integrate_tensor(table(i, j, 0), table(i, j, 1), table(i, j, 2), weights, w, tmp);
+							r[c] += (i == j ? 1 : 2) * tmp;
+						}
+					}
+				}
+
+				for (int l = 0; l < n_loc; ++l)
+					for (const auto &g : bs[lex_to_local_[l]].global())
+						for (int c = 0; c < size_; ++c)
+							local_storage.vec(g.index * size_ + c) += g.val * g.val * r[c](l);
+			}
+		});
+
+		diag.setZero(size());
+		for (const LocalThreadVecStorage &local_storage : storage)
+			diag += local_storage.vec;
+	}
+} // namespace polyfem::assembler
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <polyfem/assembler/Assembler.hpp>
+#include <polyfem/basis/ElementBases.hpp>
+#include <polyfem/mesh/Mesh.hpp>
+
+#include <Eigen/Dense>
+
+#include <vector>
+
+namespace polyfem::assembler
+{
+	/// Matrix-free application of the Laplacian, Mass, and LinearElasticity operators on hexahedral
+	/// meshes with tensor-product Lagrange (Q) bases. Values and gradients at the tensor quadrature
+	/// points are interpolated, and integrated back, by one-dimensional contractions (sum factorization),
+	/// which costs O(p⁴) per element instead of the O(p⁹) of assembling the element matrix.
+	class SumFactorizedOperator
+	{
+	public:
+		/// Precomputes the 1D tables and the per-point geometric and material factors, quadrature_order is the
+		/// order of the 1D Gauss rule (as for HexQuadrature). Throws if the mesh is not supported.
+		SumFactorizedOperator(
+			const Assembler &assembler,
+			const mesh::Mesh &mesh,
+			const int n_bases,
+			const std::vector<basis::ElementBases> &bases,
+			const std::vector<basis::ElementBases> &gbases,
+			const int quadrature_order,
+			const double t = 0);
+
+		/// true if all elements are hexahedra with Lagrange Q bases of the same order
+		static bool is_supported(const mesh::Mesh &mesh, const std::vector<basis::ElementBases> &bases);
+
+		/// y = K x, where K is the matrix assembled by the assembler with the same quadrature
+		void apply(const Eigen::VectorXd &x, Eigen::VectorXd &y) const;
+
+		/// diagonal of K, with the same sum factorization as apply, e.g. for a Jacobi preconditioner.
+		/// Exact when every local basis maps to a single global node, the cross terms of constrained nodes are dropped.
+		void diagonal(Eigen::VectorXd &diag) const;
+
+		/// number of rows (and columns) of K
+		int size() const { return n_bases_ * size_; }
+
+	private:
+		enum class Kind
+		{
+			Laplacian,
+			Mass,
+			LinearElasticity
+		};
+
+		/// Maps the lexicographic index a + (q + 1) * (b + (q + 1) * c) of the node (a, b, c) / q to the local basis,
+		/// returns false if the bases of the element are not the Q bases of order q
+		static bool lexicographic_order(const basis::ElementBases &bs, const int q, std::vector<int> &lex_to_local);
+
+		Kind kind_;
+		int size_;
+		int n_bases_;
+		const std::vector<basis::ElementBases> &bases_;
+
+		/// number of 1D nodes (q + 1) and of 1D quadrature points
+		int n_nodes_;
+		int n_points_;
+		std::vector<int> lex_to_local_;
+
+		/// values and derivatives of the 1D Lagrange bases at the 1D quadrature points (n_points x n_nodes) and their transposes
+		Eigen::MatrixXd B_, D_, Bt_, Dt_;
+
+		/// per point factors, n_points³ consecutive rows per element:
+		/// Laplacian the upper triangle of da J⁻¹J⁻ᵀ, Mass ρ da, LinearElasticity J⁻¹ (column-major), λ da, and μ da
+		Eigen::MatrixXd point_factors_;
+	};
+} // namespace polyfem::assembler
@@ -35,6 +35,25 @@ void p_0_nodes_2d(Eigen::MatrixXd &res) {
 }
 
 
+void p_0_tabulate_basis_value_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 1);
+val.col(0).setOnes();
+}
+void p_0_tabulate_grad_basis_value_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 2);
+val.col(0).setZero();
+val.col(1).setZero();
+}
+
+
 void p_1_basis_value_2d(const int local_index, const Eigen::MatrixXd &uv, Eigen::MatrixXd &result_0){
 
 auto x=uv.col(0).array();
@@ -69,6 +88,31 @@ void p_1_nodes_2d(Eigen::MatrixXd &res) {
 }
 
 
+void p_1_tabulate_basis_value_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 3);
+val.col(0) = (-x - y + 1).matrix();
+val.col(1) = (x).matrix();
+val.col(2) = (y).matrix();
+}
+void p_1_tabulate_grad_basis_value_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 6);
+val.col(0).setConstant(-1);
+val.col(1).setConstant(-1);
+val.col(2).setOnes();
+val.col(3).setZero();
+val.col(4).setZero();
+val.col(5).setOnes();
+}
+
+
 void p_2_basis_value_2d(const int local_index, const Eigen::MatrixXd &uv, Eigen::MatrixXd &result_0){
 
 auto x=uv.col(0).array();
@@ -112,6 +156,47 @@ void p_2_nodes_2d(Eigen::MatrixXd &res) {
 }
 
 
+void p_2_tabulate_basis_value_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 6);
+const Eigen::ArrayXd helper_0 = x + y - 1;
+const Eigen::ArrayXd helper_1 = 2*y;
+const Eigen::ArrayXd helper_2 = 2*x - 1;
+const Eigen::ArrayXd helper_3 = 4*x;
+val.col(0) = (helper_0*(helper_1 + helper_2)).matrix();
+val.col(1) = (helper_2*x).matrix();
+val.col(2) = (y*(helper_1 - 1)).matrix();
+val.col(3) = (-helper_0*helper_3).matrix();
+val.col(4) = (helper_3*y).matrix();
+val.col(5) = (-4*helper_0*y).matrix();
+}
+void p_2_tabulate_grad_basis_value_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 12);
+const Eigen::ArrayXd helper_0 = 4*x;
+const Eigen::ArrayXd helper_1 = 4*y;
+const Eigen::ArrayXd helper_2 = helper_0 + helper_1 - 3;
+val.col(0) = (helper_2).matrix();
+val.col(1) = (helper_2).matrix();
+val.col(2) = (helper_0 - 1).matrix();
+val.col(3).setZero();
+val.col(4).setZero();
+val.col(5) = (helper_1 - 1).matrix();
+val.col(6) = (4*(-2*x - y + 1)).matrix();
+val.col(7) = (-helper_0).matrix();
+val.col(8) = (helper_1).matrix();
+val.col(9) = (helper_0).matrix();
+val.col(10) = (-helper_1).matrix();
+val.col(11) = (4*(-x - 2*y + 1)).matrix();
+}
+
+
 void p_3_basis_value_2d(const int local_index, const Eigen::MatrixXd &uv, Eigen::MatrixXd &result_0){
 
 auto x=uv.col(0).array();
@@ -169,6 +254,81 @@ void p_3_nodes_2d(Eigen::MatrixXd &res) {
 }
 
 
+void p_3_tabulate_basis_value_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 10);
+const Eigen::ArrayXd helper_0 = pow(x, 2);
+const Eigen::ArrayXd helper_1 = pow(y, 2);
+const Eigen::ArrayXd helper_2 = (9.0/2.0)*x;
+const Eigen::ArrayXd helper_3 = x + y - 1;
+const Eigen::ArrayXd helper_4 = 3*x;
+const Eigen::ArrayXd helper_5 = 3*y;
+const Eigen::ArrayXd helper_6 = helper_3*(helper_4 + helper_5 - 2);
+const Eigen::ArrayXd helper_7 = helper_4*y + 1;
+const Eigen::ArrayXd helper_8 = x*y;
+const Eigen::ArrayXd helper_9 = (9.0/2.0)*helper_8;
+const Eigen::ArrayXd helper_10 = (9.0/2.0)*y;
+val.col(0) = (-27.0/2.0*helper_0*y + 9*helper_0 - 27.0/2.0*helper_1*x + 9*helper_1 - 9.0/2.0*pow(x, 3) + 18*x*y - 11.0/2.0*x - 9.0/2.0*pow(y, 3) - 11.0/2.0*y + 1).matrix();
+val.col(1) = ((1.0/2.0)*x*(9*helper_0 - 9*x + 2)).matrix();
+val.col(2) = ((1.0/2.0)*y*(9*helper_1 - 9*y + 2)).matrix();
+val.col(3) = (helper_2*helper_6).matrix();
+val.col(4) = (-helper_2*(3*helper_0 + helper_7 - 4*x - y)).matrix();
+val.col(5) = (helper_9*(helper_4 - 1)).matrix();
+val.col(6) = (helper_9*(helper_5 - 1)).matrix();
+val.col(7) = (-helper_10*(3*helper_1 + helper_7 - x - 4*y)).matrix();
+val.col(8) = (helper_10*helper_6).matrix();
+val.col(9) = (-27*helper_3*helper_8).matrix();
+}
+void p_3_tabulate_grad_basis_value_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 20);
+const Eigen::ArrayXd helper_0 = 27*y;
+const Eigen::ArrayXd helper_1 = pow(x, 2);
+const Eigen::ArrayXd helper_2 = (27.0/2.0)*helper_1;
+const Eigen::ArrayXd helper_3 = pow(y, 2);
+const Eigen::ArrayXd helper_4 = (27.0/2.0)*helper_3;
+const Eigen::ArrayXd helper_5 = -helper_0*x - helper_2 - helper_4 + 18*x + 18*y - 11.0/2.0;
+const Eigen::ArrayXd helper_6 = (9.0/2.0)*helper_1;
+const Eigen::ArrayXd helper_7 = 6*x;
+const Eigen::ArrayXd helper_8 = helper_7*y + 1;
+const Eigen::ArrayXd helper_9 = 6*y;
+const Eigen::ArrayXd helper_10 = helper_7 + helper_9 - 5;
+const Eigen::ArrayXd helper_11 = (9.0/2.0)*x;
+const Eigen::ArrayXd helper_12 = 3*x;
+const Eigen::ArrayXd helper_13 = helper_12*y + 1.0/2.0;
+const Eigen::ArrayXd helper_14 = helper_11*(helper_12 - 1);
+const Eigen::ArrayXd helper_15 = (9.0/2.0)*y;
+const Eigen::ArrayXd helper_16 = helper_15*(3*y - 1);
+const Eigen::ArrayXd helper_17 = (9.0/2.0)*helper_3;
+val.col(0) = (helper_5).matrix();
+val.col(1) = (helper_5).matrix();
+val.col(2) = (helper_2 - 9*x + 1).matrix();
+val.col(3).setZero();
+val.col(4).setZero();
+val.col(5) = (helper_4 - 9*y + 1).matrix();
+val.col(6) = ((27.0/2.0)*helper_3 + 9*helper_6 + 9*helper_8 - 45*x - 45.0/2.0*y).matrix();
+val.col(7) = (helper_10*helper_11).matrix();
+val.col(8) = (-9*helper_13 - 9*helper_6 + 36*x + (9.0/2.0)*y).matrix();
+val.col(9) = (-helper_14).matrix();
+val.col(10) = (helper_15*(helper_7 - 1)).matrix();
+val.col(11) = (helper_14).matrix();
+val.col(12) = (helper_16).matrix();
+val.col(13) = (helper_11*(helper_9 - 1)).matrix();
+val.col(14) = (-helper_16).matrix();
+val.col(15) = (-9*helper_13 - 9*helper_17 + (9.0/2.0)*x + 36*y).matrix();
+val.col(16) = (helper_10*helper_15).matrix();
+val.col(17) = ((27.0/2.0)*helper_1 + 9*helper_17 + 9*helper_8 - 45.0/2.0*x - 45*y).matrix();
+val.col(18) = (-helper_0*(2*x + y - 1)).matrix();
+val.col(19) = (-27*x*(x + 2*y - 1)).matrix();
+}
+
+
 void p_4_basis_value_2d(const int local_index, const Eigen::MatrixXd &uv, Eigen::MatrixXd &result_0){
 
 auto x=uv.col(0).array();
@@ -270,6 +430,140 @@ void p_4_nodes_2d(Eigen::MatrixXd &res) {
 }
 
 
+void p_4_tabulate_basis_value_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 15);
+const Eigen::ArrayXd helper_0 = x*y;
+const Eigen::ArrayXd helper_1 = pow(x, 2);
+const Eigen::ArrayXd helper_2 = pow(x, 3);
+const Eigen::ArrayXd helper_3 = pow(y, 2);
+const Eigen::ArrayXd helper_4 = pow(y, 3);
+const Eigen::ArrayXd helper_5 = helper_3*x;
+const Eigen::ArrayXd helper_6 = helper_1*y;
+const Eigen::ArrayXd helper_7 = 8*helper_2;
+const Eigen::ArrayXd helper_8 = 8*helper_4;
+const Eigen::ArrayXd helper_9 = -36*helper_0 - 3;
+const Eigen::ArrayXd helper_10 = -18*helper_1 - 18*helper_3 + 24*helper_5 + 24*helper_6 + helper_7 + helper_8 + helper_9 + 13*x + 13*y;
+const Eigen::ArrayXd helper_11 = (16.0/3.0)*x;
+const Eigen::ArrayXd helper_12 = 7*y;
+const Eigen::ArrayXd helper_13 = 32*helper_1;
+const Eigen::ArrayXd helper_14 = 4*x;
+const Eigen::ArrayXd helper_15 = 7*x;
+const Eigen::ArrayXd helper_16 = 6*x;
+const Eigen::ArrayXd helper_17 = -helper_16*y;
+const Eigen::ArrayXd helper_18 = 8*helper_1;
+const Eigen::ArrayXd helper_19 = y - 1;
+const Eigen::ArrayXd helper_20 = (16.0/3.0)*helper_0;
+const Eigen::ArrayXd helper_21 = 4*y;
+const Eigen::ArrayXd helper_22 = 8*helper_3;
+const Eigen::ArrayXd helper_23 = (16.0/3.0)*y;
+const Eigen::ArrayXd helper_24 = 32*helper_3;
+const Eigen::ArrayXd helper_25 = 32*helper_0*(helper_19 + x);
+val.col(0) = ((140.0/3.0)*helper_0 + 64*helper_1*helper_3 + (70.0/3.0)*helper_1 + (128.0/3.0)*helper_2*y - 80.0/3.0*helper_2 + (70.0/3.0)*helper_3 + (128.0/3.0)*helper_4*x - 80.0/3.0*helper_4 - 80*helper_5 - 80*helper_6 + (32.0/3.0)*pow(x, 4) - 25.0/3.0*x + (32.0/3.0)*pow(y, 4) - 25.0/3.0*y + 1).matrix();
+val.col(1) = ((1.0/3.0)*x*(-48*helper_1 + 32*helper_2 + 22*x - 3)).matrix();
+val.col(2) = ((1.0/3.0)*y*(-48*helper_3 + 32*helper_4 + 22*y - 3)).matrix();
+val.col(3) = (-helper_10*helper_11).matrix();
+val.col(4) = (helper_14*(helper_12 + helper_13*y - helper_13 + 16*helper_2 - 4*helper_3 + 16*helper_5 + helper_9 + 19*x)).matrix();
+val.col(5) = (-helper_11*(-14*helper_1 + helper_15 + helper_17 + helper_18*y + helper_19 + helper_7)).matrix();
+val.col(6) = (helper_20*(-helper_16 + helper_18 + 1)).matrix();
+val.col(7) = (helper_14*y*(16*helper_0 - helper_14 - helper_21 + 1)).matrix();
+val.col(8) = (helper_20*(helper_22 - 6*y + 1)).matrix();
+val.col(9) = (-helper_23*(helper_12 + helper_17 + helper_22*x - 14*helper_3 + helper_8 + x - 1)).matrix();
+val.col(10) = (helper_21*(-4*helper_1 + helper_15 + helper_24*x - helper_24 + 16*helper_4 + 16*helper_6 + helper_9 + 19*y)).matrix();
+val.col(11) = (-helper_10*helper_23).matrix();
+val.col(12) = (helper_25*(helper_14 + helper_21 - 3)).matrix();
+val.col(13) = (-helper_25*(helper_21 - 1)).matrix();
+val.col(14) = (-helper_25*(helper_14 - 1)).matrix();
+}
+void p_4_tabulate_grad_basis_value_2d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+
+val.resize(uv.rows(), 30);
+const Eigen::ArrayXd helper_0 = x*y;
+const Eigen::ArrayXd helper_1 = pow(x, 2);
+const Eigen::ArrayXd helper_2 = pow(x, 3);
+const Eigen::ArrayXd helper_3 = (128.0/3.0)*helper_2;
+const Eigen::ArrayXd helper_4 = pow(y, 2);
+const Eigen::ArrayXd helper_5 = pow(y, 3);
+const Eigen::ArrayXd helper_6 = (128.0/3.0)*helper_5;
+const Eigen::ArrayXd helper_7 = helper_4*x;
+const Eigen::ArrayXd helper_8 = helper_1*y;
+const Eigen::ArrayXd helper_9 = -160*helper_0 - 80*helper_1 + helper_3 - 80*helper_4 + helper_6 + 128*helper_7 + 128*helper_8 + (140.0/3.0)*x + (140.0/3.0)*y - 25.0/3.0;
+const Eigen::ArrayXd helper_10 = (32.0/3.0)*helper_2;
+const Eigen::ArrayXd helper_11 = 24*helper_1;
+const Eigen::ArrayXd helper_12 = -24*x*y - 1;
+const Eigen::ArrayXd helper_13 = -36*x;
+const Eigen::ArrayXd helper_14 = -36*y;
+const Eigen::ArrayXd helper_15 = 24*helper_4;
+const Eigen::ArrayXd helper_16 = 48*helper_0 + helper_11 + helper_13 + helper_14 + helper_15 + 13;
+const Eigen::ArrayXd helper_17 = (16.0/3.0)*x;
+const Eigen::ArrayXd helper_18 = 96*helper_1;
+const Eigen::ArrayXd helper_19 = 4*helper_4;
+const Eigen::ArrayXd helper_20 = 7*y;
+const Eigen::ArrayXd helper_21 = 32*helper_4;
+const Eigen::ArrayXd helper_22 = -72*helper_0 - 3;
+const Eigen::ArrayXd helper_23 = 8*y;
+const Eigen::ArrayXd helper_24 = -helper_23;
+const Eigen::ArrayXd helper_25 = 32*helper_1;
+const Eigen::ArrayXd helper_26 = 32*helper_0;
+const Eigen::ArrayXd helper_27 = helper_26 + 7;
+const Eigen::ArrayXd helper_28 = 4*x;
+const Eigen::ArrayXd helper_29 = -4*x*y - 1.0/3.0;
+const Eigen::ArrayXd helper_30 = helper_17*(8*helper_1 - 6*x + 1);
+const Eigen::ArrayXd helper_31 = (16.0/3.0)*y;
+const Eigen::ArrayXd helper_32 = 8*x;
+const Eigen::ArrayXd helper_33 = -helper_32;
+const Eigen::ArrayXd helper_34 = 4*y;
+const Eigen::ArrayXd helper_35 = helper_26 + 1;
+const Eigen::ArrayXd helper_36 = helper_31*(8*helper_4 - 6*y + 1);
+const Eigen::ArrayXd helper_37 = (32.0/3.0)*helper_5;
+const Eigen::ArrayXd helper_38 = 96*helper_4;
+const Eigen::ArrayXd helper_39 = 4*helper_1;
+const Eigen::ArrayXd helper_40 = 7*x;
+const Eigen::ArrayXd helper_41 = 12*helper_1;
+const Eigen::ArrayXd helper_42 = 16*helper_0 + 3;
+const Eigen::ArrayXd helper_43 = 32*y;
+const Eigen::ArrayXd helper_44 = 12*helper_4;
+const Eigen::ArrayXd helper_45 = 32*x;
+const Eigen::ArrayXd helper_46 = helper_23*x + 1;
+val.col(0) = (helper_9).matrix();
+val.col(1) = (helper_9).matrix();
+val.col(2) = (-48*helper_1 + helper_3 + (44.0/3.0)*x - 1).matrix();
+val.col(3).setZero();
+val.col(4).setZero();
+val.col(5) = (-48*helper_4 + helper_6 + (44.0/3.0)*y - 1).matrix();
+val.col(6) = (288*helper_1 - 16*helper_10 - 16*helper_11*y - 16*helper_12 + 96*helper_4 - 128.0/3.0*helper_5 - 256*helper_7 - 416.0/3.0*x - 208.0/3.0*y).matrix();
+val.col(7) = (-helper_16*helper_17).matrix();
+val.col(8) = (4*helper_18*y - 4*helper_18 - 4*helper_19 + 256*helper_2 + 4*helper_20 + 4*helper_21*x + 4*helper_22 + 152*x).matrix();
+val.col(9) = (helper_28*(helper_13 + helper_24 + helper_25 + helper_27)).matrix();
+val.col(10) = (-16*helper_1*helper_23 + 224*helper_1 - 16*helper_10 - 16*helper_29 - 224.0/3.0*x - 16.0/3.0*y).matrix();
+val.col(11) = (-helper_30).matrix();
+val.col(12) = (helper_31*(helper_11 - 12*x + 1)).matrix();
+val.col(13) = (helper_30).matrix();
+val.col(14) = (helper_34*(helper_33 - helper_34 + helper_35)).matrix();
+val.col(15) = (helper_28*(helper_24 - helper_28 + helper_35)).matrix();
+val.col(16) = (helper_36).matrix();
+val.col(17) = (helper_17*(helper_15 - 12*y + 1)).matrix();
+val.col(18) = (-helper_36).matrix();
+val.col(19) = (-16*helper_29 - 16*helper_32*helper_4 - 16*helper_37 + 224*helper_4 - 16.0/3.0*x - 224.0/3.0*y).matrix();
+val.col(20) = (helper_34*(helper_14 + helper_21 + helper_27 + helper_33)).matrix();
+val.col(21) = (4*helper_22 + 4*helper_25*y + 4*helper_38*x - 4*helper_38 - 4*helper_39 + 4*helper_40 + 256*helper_5 + 152*y).matrix();
+val.col(22) = (-helper_16*helper_31).matrix();
+val.col(23) = (96*helper_1 - 16*helper_12 - 16*helper_15*x - 128.0/3.0*helper_2 - 16*helper_37 + 288*helper_4 - 256*helper_8 - 208.0/3.0*x - 416.0/3.0*y).matrix();
+val.col(24) = (helper_43*(helper_19 - helper_20 + helper_41 + helper_42 - 14*x)).matrix();
+val.col(25) = (helper_45*(helper_39 - helper_40 + helper_42 + helper_44 - 14*y)).matrix();
+val.col(26) = (-helper_43*(helper_19 + helper_46 - 2*x - 5*y)).matrix();
+val.col(27) = (-helper_45*(helper_44 + helper_46 - x - 10*y)).matrix();
+val.col(28) = (-helper_43*(helper_41 + helper_46 - 10*x - y)).matrix();
+val.col(29) = (-helper_45*(helper_39 + helper_46 - 5*x - 2*y)).matrix();
+}
+
+
 }
 
 void p_nodes_2d(const int p, Eigen::MatrixXd &val){
@@ -307,6 +601,48 @@ switch(p){
 	default: p_n_basis_grad_value_2d(p, local_index, uv, val);
 }}
 
+void p_tabulate_basis_value_2d(const bool bernstein, const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+if(bernstein || p > 4) {
+const int n_bases = (p + 1) * (p + 2) / 2;
+val.resize(uv.rows(), n_bases);
+Eigen::MatrixXd tmp;
+for(int i = 0; i < n_bases; ++i) {
+p_basis_value_2d(bernstein, p, i, uv, tmp);
+val.col(i) = tmp;
+}
+return;
+}
+
+switch(p){
+	case 0: p_0_tabulate_basis_value_2d(uv, val); break;
+	case 1: p_1_tabulate_basis_value_2d(uv, val); break;
+	case 2: p_2_tabulate_basis_value_2d(uv, val); break;
+	case 3: p_3_tabulate_basis_value_2d(uv, val); break;
+	case 4: p_4_tabulate_basis_value_2d(uv, val); break;
+	default: assert(false);
+}}
+
+void p_tabulate_grad_basis_value_2d(const bool bernstein, const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+if(bernstein || p > 4) {
+const int n_bases = (p + 1) * (p + 2) / 2;
+val.resize(uv.rows(), n_bases * 2);
+Eigen::MatrixXd tmp;
+for(int i = 0; i < n_bases; ++i) {
+p_grad_basis_value_2d(bernstein, p, i, uv, tmp);
+val.middleCols(i * 2, 2) = tmp;
+}
+return;
+}
+
+switch(p){
+	case 0: p_0_tabulate_grad_basis_value_2d(uv, val); break;
+	case 1: p_1_tabulate_grad_basis_value_2d(uv, val); break;
+	case 2: p_2_tabulate_grad_basis_value_2d(uv, val); break;
+	case 3: p_3_tabulate_grad_basis_value_2d(uv, val); break;
+	case 4: p_4_tabulate_grad_basis_value_2d(uv, val); break;
+	default: assert(false);
+}}
+
 namespace {
 void p_0_basis_value_3d(const int local_index, const Eigen::MatrixXd &uv, Eigen::MatrixXd &result_0){
 
@@ -339,6 +675,28 @@ void p_0_nodes_3d(Eigen::MatrixXd &res) {
 }
 
 
+void p_0_tabulate_basis_value_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 1);
+val.col(0).setOnes();
+}
+void p_0_tabulate_grad_basis_value_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 3);
+val.col(0).setZero();
+val.col(1).setZero();
+val.col(2).setZero();
+}
+
+
 void p_1_basis_value_3d(const int local_index, const Eigen::MatrixXd &uv, Eigen::MatrixXd &result_0){
 
 auto x=uv.col(0).array();
@@ -378,6 +736,40 @@ void p_1_nodes_3d(Eigen::MatrixXd &res) {
 }
 
 
+void p_1_tabulate_basis_value_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 4);
+val.col(0) = (-x - y - z + 1).matrix();
+val.col(1) = (x).matrix();
+val.col(2) = (y).matrix();
+val.col(3) = (z).matrix();
+}
+void p_1_tabulate_grad_basis_value_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 12);
+val.col(0).setConstant(-1);
+val.col(1).setConstant(-1);
+val.col(2).setConstant(-1);
+val.col(3).setOnes();
+val.col(4).setZero();
+val.col(5).setZero();
+val.col(6).setZero();
+val.col(7).setOnes();
+val.col(8).setZero();
+val.col(9).setZero();
+val.col(10).setZero();
+val.col(11).setOnes();
+}
+
+
 void p_2_basis_value_3d(const int local_index, const Eigen::MatrixXd &uv, Eigen::MatrixXd &result_0){
 
 auto x=uv.col(0).array();
@@ -435,6 +827,78 @@ void p_2_nodes_3d(Eigen::MatrixXd &res) {
 }
 
 
+void p_2_tabulate_basis_value_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 10);
+const Eigen::ArrayXd helper_0 = x + y + z - 1;
+const Eigen::ArrayXd helper_1 = 2*y;
+const Eigen::ArrayXd helper_2 = 2*z;
+const Eigen::ArrayXd helper_3 = 2*x - 1;
+const Eigen::ArrayXd helper_4 = 4*x;
+const Eigen::ArrayXd helper_5 = 4*helper_0;
+val.col(0) = (helper_0*(helper_1 + helper_2 + helper_3)).matrix();
+val.col(1) = (helper_3*x).matrix();
+val.col(2) = (y*(helper_1 - 1)).matrix();
+val.col(3) = (z*(helper_2 - 1)).matrix();
+val.col(4) = (-helper_0*helper_4).matrix();
+val.col(5) = (helper_4*y).matrix();
+val.col(6) = (-helper_5*y).matrix();
+val.col(7) = (-helper_5*z).matrix();
+val.col(8) = (helper_4*z).matrix();
+val.col(9) = (4*y*z).matrix();
+}
+void p_2_tabulate_grad_basis_value_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 30);
+const Eigen::ArrayXd helper_0 = 4*x;
+const Eigen::ArrayXd helper_1 = 4*y;
+const Eigen::ArrayXd helper_2 = 4*z;
+const Eigen::ArrayXd helper_3 = helper_0 + helper_1 + helper_2 - 3;
+const Eigen::ArrayXd helper_4 = z - 1;
+const Eigen::ArrayXd helper_5 = -helper_0;
+const Eigen::ArrayXd helper_6 = -helper_1;
+const Eigen::ArrayXd helper_7 = -helper_2;
+val.col(0) = (helper_3).matrix();
+val.col(1) = (helper_3).matrix();
+val.col(2) = (helper_3).matrix();
+val.col(3) = (helper_0 - 1).matrix();
+val.col(4).setZero();
+val.col(5).setZero();
+val.col(6).setZero();
+val.col(7) = (helper_1 - 1).matrix();
+val.col(8).setZero();
+val.col(9).setZero();
+val.col(10).setZero();
+val.col(11) = (helper_2 - 1).matrix();
+val.col(12) = (-4*helper_4 - 8*x - 4*y).matrix();
+val.col(13) = (helper_5).matrix();
+val.col(14) = (helper_5).matrix();
+val.col(15) = (helper_1).matrix();
+val.col(16) = (helper_0).matrix();
+val.col(17).setZero();
+val.col(18) = (helper_6).matrix();
+val.col(19) = (-4*helper_4 - 4*x - 8*y).matrix();
+val.col(20) = (helper_6).matrix();
+val.col(21) = (helper_7).matrix();
+val.col(22) = (helper_7).matrix();
+val.col(23) = (4*(-x - y - 2*z + 1)).matrix();
+val.col(24) = (helper_2).matrix();
+val.col(25).setZero();
+val.col(26) = (helper_0).matrix();
+val.col(27).setZero();
+val.col(28) = (helper_2).matrix();
+val.col(29) = (helper_1).matrix();
+}
+
+
 void p_3_basis_value_3d(const int local_index, const Eigen::MatrixXd &uv, Eigen::MatrixXd &result_0){
 
 auto x=uv.col(0).array();
@@ -540,6 +1004,181 @@ void p_3_nodes_3d(Eigen::MatrixXd &res) {
 }
 
 
+void p_3_tabulate_basis_value_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 20);
+const Eigen::ArrayXd helper_0 = pow(x, 2);
+const Eigen::ArrayXd helper_1 = pow(y, 2);
+const Eigen::ArrayXd helper_2 = pow(z, 2);
+const Eigen::ArrayXd helper_3 = y*z;
+const Eigen::ArrayXd helper_4 = 27*x;
+const Eigen::ArrayXd helper_5 = helper_3*helper_4;
+const Eigen::ArrayXd helper_6 = (27.0/2.0)*x;
+const Eigen::ArrayXd helper_7 = (27.0/2.0)*y;
+const Eigen::ArrayXd helper_8 = (27.0/2.0)*z;
+const Eigen::ArrayXd helper_9 = (9.0/2.0)*x;
+const Eigen::ArrayXd helper_10 = x + y + z - 1;
+const Eigen::ArrayXd helper_11 = 3*x;
+const Eigen::ArrayXd helper_12 = 3*y;
+const Eigen::ArrayXd helper_13 = 3*z;
+const Eigen::ArrayXd helper_14 = helper_10*(helper_11 + helper_12 + helper_13 - 2);
+const Eigen::ArrayXd helper_15 = helper_11*y - z + 1;
+const Eigen::ArrayXd helper_16 = helper_11*z - y;
+const Eigen::ArrayXd helper_17 = helper_11 - 1;
+const Eigen::ArrayXd helper_18 = helper_9*y;
+const Eigen::ArrayXd helper_19 = helper_12 - 1;
+const Eigen::ArrayXd helper_20 = helper_12*z - x;
+const Eigen::ArrayXd helper_21 = (9.0/2.0)*y;
+const Eigen::ArrayXd helper_22 = (9.0/2.0)*z;
+const Eigen::ArrayXd helper_23 = helper_9*z;
+const Eigen::ArrayXd helper_24 = helper_13 - 1;
+const Eigen::ArrayXd helper_25 = (9.0/2.0)*helper_3;
+const Eigen::ArrayXd helper_26 = helper_10*helper_4;
+val.col(0) = (-helper_0*helper_7 - helper_0*helper_8 + 9*helper_0 - helper_1*helper_6 - helper_1*helper_8 + 9*helper_1 - helper_2*helper_6 - helper_2*helper_7 + 9*helper_2 - helper_5 - 9.0/2.0*pow(x, 3) + 18*x*y + 18*x*z - 11.0/2.0*x - 9.0/2.0*pow(y, 3) + 18*y*z - 11.0/2.0*y - 9.0/2.0*pow(z, 3) - 11.0/2.0*z + 1).matrix();
+val.col(1) = ((1.0/2.0)*x*(9*helper_0 - 9*x + 2)).matrix();
+val.col(2) = ((1.0/2.0)*y*(9*helper_1 - 9*y + 2)).matrix();
+val.col(3) = ((1.0/2.0)*z*(9*helper_2 - 9*z + 2)).matrix();
+val.col(4) = (helper_14*helper_9).matrix();
+val.col(5) = (-helper_9*(3*helper_0 + helper_15 + helper_16 - 4*x)).matrix();
+val.col(6) = (helper_17*helper_18).matrix();
+val.col(7) = (helper_18*helper_19).matrix();
+val.col(8) = (-helper_21*(3*helper_1 + helper_15 + helper_20 - 4*y)).matrix();
+val.col(9) = (helper_14*helper_21).matrix();
+val.col(10) = (helper_14*helper_22).matrix();
+val.col(11) = (-helper_22*(helper_16 + 3*helper_2 + helper_20 - 4*z + 1)).matrix();
+val.col(12) = (helper_17*helper_23).matrix();
+val.col(13) = (helper_23*helper_24).matrix();
+val.col(14) = (helper_19*helper_25).matrix();
+val.col(15) = (helper_24*helper_25).matrix();
+val.col(16) = (-helper_26*y).matrix();
+val.col(17) = (-helper_26*z).matrix();
+val.col(18) = (helper_5).matrix();
+val.col(19) = (-27*helper_10*helper_3).matrix();
+}
+void p_3_tabulate_grad_basis_value_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 60);
+const Eigen::ArrayXd helper_0 = 27*x;
+const Eigen::ArrayXd helper_1 = helper_0*y;
+const Eigen::ArrayXd helper_2 = helper_0*z;
+const Eigen::ArrayXd helper_3 = 27*y;
+const Eigen::ArrayXd helper_4 = helper_3*z;
+const Eigen::ArrayXd helper_5 = pow(x, 2);
+const Eigen::ArrayXd helper_6 = (27.0/2.0)*helper_5;
+const Eigen::ArrayXd helper_7 = pow(y, 2);
+const Eigen::ArrayXd helper_8 = (27.0/2.0)*helper_7;
+const Eigen::ArrayXd helper_9 = pow(z, 2);
+const Eigen::ArrayXd helper_10 = (27.0/2.0)*helper_9;
+const Eigen::ArrayXd helper_11 = -helper_1 - helper_10 - helper_2 - helper_4 - helper_6 - helper_8 + 18*x + 18*y + 18*z - 11.0/2.0;
+const Eigen::ArrayXd helper_12 = (9.0/2.0)*helper_5;
+const Eigen::ArrayXd helper_13 = 3*y;
+const Eigen::ArrayXd helper_14 = helper_13*z;
+const Eigen::ArrayXd helper_15 = 6*x;
+const Eigen::ArrayXd helper_16 = helper_15*y + (3.0/2.0)*helper_9 - 5.0/2.0*z + 1;
+const Eigen::ArrayXd helper_17 = helper_15*z + (3.0/2.0)*helper_7 - 5.0/2.0*y;
+const Eigen::ArrayXd helper_18 = 6*y;
+const Eigen::ArrayXd helper_19 = 6*z;
+const Eigen::ArrayXd helper_20 = helper_15 + helper_18 + helper_19 - 5;
+const Eigen::ArrayXd helper_21 = (9.0/2.0)*x;
+const Eigen::ArrayXd helper_22 = helper_20*helper_21;
+const Eigen::ArrayXd helper_23 = 3*x;
+const Eigen::ArrayXd helper_24 = helper_23*y;
+const Eigen::ArrayXd helper_25 = helper_24 - 1.0/2.0*z + 1.0/2.0;
+const Eigen::ArrayXd helper_26 = helper_23*z;
+const Eigen::ArrayXd helper_27 = helper_26 - 1.0/2.0*y;
+const Eigen::ArrayXd helper_28 = helper_21*(helper_23 - 1);
+const Eigen::ArrayXd helper_29 = -helper_28;
+const Eigen::ArrayXd helper_30 = helper_15 - 1;
+const Eigen::ArrayXd helper_31 = (9.0/2.0)*y;
+const Eigen::ArrayXd helper_32 = helper_31*(helper_13 - 1);
+const Eigen::ArrayXd helper_33 = helper_18 - 1;
+const Eigen::ArrayXd helper_34 = -helper_32;
+const Eigen::ArrayXd helper_35 = (9.0/2.0)*helper_7;
+const Eigen::ArrayXd helper_36 = helper_14 - 1.0/2.0*x;
+const Eigen::ArrayXd helper_37 = helper_20*helper_31;
+const Eigen::ArrayXd helper_38 = helper_18*z + (3.0/2.0)*helper_5 - 5.0/2.0*x;
+const Eigen::ArrayXd helper_39 = (9.0/2.0)*z;
+const Eigen::ArrayXd helper_40 = helper_20*helper_39;
+const Eigen::ArrayXd helper_41 = (9.0/2.0)*helper_9;
+const Eigen::ArrayXd helper_42 = helper_39*(3*z - 1);
+const Eigen::ArrayXd helper_43 = -helper_42;
+const Eigen::ArrayXd helper_44 = helper_19 - 1;
+const Eigen::ArrayXd helper_45 = z - 1;
+const Eigen::ArrayXd helper_46 = helper_45 + 2*x + y;
+const Eigen::ArrayXd helper_47 = helper_45 + x + 2*y;
+const Eigen::ArrayXd helper_48 = 27*z;
+const Eigen::ArrayXd helper_49 = x + y + 2*z - 1;
+val.col(0) = (helper_11).matrix();
+val.col(1) = (helper_11).matrix();
+val.col(2) = (helper_11).matrix();
+val.col(3) = (helper_6 - 9*x + 1).matrix();
+val.col(4).setZero();
+val.col(5).setZero();
+val.col(6).setZero();
+val.col(7) = (helper_8 - 9*y + 1).matrix();
+val.col(8).setZero();
+val.col(9).setZero();
+val.col(10).setZero();
+val.col(11) = (helper_10 - 9*z + 1).matrix();
+val.col(12) = (9*helper_12 + 9*helper_14 + 9*helper_16 + 9*helper_17 - 45*x).matrix();
+val.col(13) = (helper_22).matrix();
+val.col(14) = (helper_22).matrix();
+val.col(15) = (-9*helper_12 - 9*helper_25 - 9*helper_27 + 36*x).matrix();
+val.col(16) = (helper_29).matrix();
+val.col(17) = (helper_29).matrix();
+val.col(18) = (helper_30*helper_31).matrix();
+val.col(19) = (helper_28).matrix();
+val.col(20).setZero();
+val.col(21) = (helper_32).matrix();
+val.col(22) = (helper_21*helper_33).matrix();
+val.col(23).setZero();
+val.col(24) = (helper_34).matrix();
+val.col(25) = (-9*helper_25 - 9*helper_35 - 9*helper_36 + 36*y).matrix();
+val.col(26) = (helper_34).matrix();
+val.col(27) = (helper_37).matrix();
+val.col(28) = (9*helper_16 + 9*helper_26 + 9*helper_35 + 9*helper_38 - 45*y).matrix();
+val.col(29) = (helper_37).matrix();
+val.col(30) = (helper_40).matrix();
+val.col(31) = (helper_40).matrix();
+val.col(32) = (9*helper_17 + 9*helper_24 + 9*helper_38 + 9*helper_41 - 45*z + 9).matrix();
+val.col(33) = (helper_43).matrix();
+val.col(34) = (helper_43).matrix();
+val.col(35) = (-9*helper_27 - 9*helper_36 - 9*helper_41 + 36*z - 9.0/2.0).matrix();
+val.col(36) = (helper_30*helper_39).matrix();
+val.col(37).setZero();
+val.col(38) = (helper_28).matrix();
+val.col(39) = (helper_42).matrix();
+val.col(40).setZero();
+val.col(41) = (helper_21*helper_44).matrix();
+val.col(42).setZero();
+val.col(43) = (helper_33*helper_39).matrix();
+val.col(44) = (helper_32).matrix();
+val.col(45).setZero();
+val.col(46) = (helper_42).matrix();
+val.col(47) = (helper_31*helper_44).matrix();
+val.col(48) = (-helper_3*helper_46).matrix();
+val.col(49) = (-helper_0*helper_47).matrix();
+val.col(50) = (-helper_1).matrix();
+val.col(51) = (-helper_46*helper_48).matrix();
+val.col(52) = (-helper_2).matrix();
+val.col(53) = (-helper_0*helper_49).matrix();
+val.col(54) = (helper_4).matrix();
+val.col(55) = (helper_2).matrix();
+val.col(56) = (helper_1).matrix();
+val.col(57) = (-helper_4).matrix();
+val.col(58) = (-helper_47*helper_48).matrix();
+val.col(59) = (-helper_3*helper_49).matrix();
+}
+
+
 void p_4_basis_value_3d(const int local_index, const Eigen::MatrixXd &uv, Eigen::MatrixXd &result_0){
 
 auto x=uv.col(0).array();
@@ -825,6 +1464,382 @@ void p_4_nodes_3d(Eigen::MatrixXd &res) {
 }
 
 
+void p_4_tabulate_basis_value_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 35);
+const Eigen::ArrayXd helper_0 = y + z - 1;
+const Eigen::ArrayXd helper_1 = helper_0 + x;
+const Eigen::ArrayXd helper_2 = pow(x, 3);
+const Eigen::ArrayXd helper_3 = pow(y, 3);
+const Eigen::ArrayXd helper_4 = pow(z, 3);
+const Eigen::ArrayXd helper_5 = y*z;
+const Eigen::ArrayXd helper_6 = helper_5*x;
+const Eigen::ArrayXd helper_7 = pow(y, 2);
+const Eigen::ArrayXd helper_8 = 9*x;
+const Eigen::ArrayXd helper_9 = pow(z, 2);
+const Eigen::ArrayXd helper_10 = pow(x, 2);
+const Eigen::ArrayXd helper_11 = 9*y;
+const Eigen::ArrayXd helper_12 = 9*z;
+const Eigen::ArrayXd helper_13 = 26*helper_1;
+const Eigen::ArrayXd helper_14 = helper_13*x;
+const Eigen::ArrayXd helper_15 = pow(helper_1, 2);
+const Eigen::ArrayXd helper_16 = 13*x;
+const Eigen::ArrayXd helper_17 = 13*helper_1;
+const Eigen::ArrayXd helper_18 = 13*y;
+const Eigen::ArrayXd helper_19 = 13*z;
+const Eigen::ArrayXd helper_20 = 36*x;
+const Eigen::ArrayXd helper_21 = 8*helper_2;
+const Eigen::ArrayXd helper_22 = 8*helper_3;
+const Eigen::ArrayXd helper_23 = 8*helper_4;
+const Eigen::ArrayXd helper_24 = 24*x;
+const Eigen::ArrayXd helper_25 = 24*y;
+const Eigen::ArrayXd helper_26 = 24*z;
+const Eigen::ArrayXd helper_27 = helper_10*helper_25 + helper_10*helper_26 - 18*helper_10 + helper_16 + helper_18 + helper_19 - helper_20*y - helper_20*z + helper_21 + helper_22 + helper_23 + helper_24*helper_7 + helper_24*helper_9 + helper_25*helper_9 + helper_26*helper_7 - 36*helper_5 + 48*helper_6 - 18*helper_7 - 18*helper_9 - 3;
+const Eigen::ArrayXd helper_28 = (16.0/3.0)*x;
+const Eigen::ArrayXd helper_29 = 3*helper_15;
+const Eigen::ArrayXd helper_30 = 2*helper_1;
+const Eigen::ArrayXd helper_31 = helper_30*y;
+const Eigen::ArrayXd helper_32 = helper_30*z;
+const Eigen::ArrayXd helper_33 = 2*x;
+const Eigen::ArrayXd helper_34 = helper_33*y;
+const Eigen::ArrayXd helper_35 = 10*helper_1;
+const Eigen::ArrayXd helper_36 = -2*helper_5;
+const Eigen::ArrayXd helper_37 = helper_33*z;
+const Eigen::ArrayXd helper_38 = helper_36 + helper_37;
+const Eigen::ArrayXd helper_39 = 4*x;
+const Eigen::ArrayXd helper_40 = 6*x;
+const Eigen::ArrayXd helper_41 = -helper_40*y;
+const Eigen::ArrayXd helper_42 = -helper_40*z;
+const Eigen::ArrayXd helper_43 = 8*helper_10;
+const Eigen::ArrayXd helper_44 = -helper_40 + helper_43 + 1;
+const Eigen::ArrayXd helper_45 = helper_28*y;
+const Eigen::ArrayXd helper_46 = 4*y;
+const Eigen::ArrayXd helper_47 = -helper_46;
+const Eigen::ArrayXd helper_48 = 16*x;
+const Eigen::ArrayXd helper_49 = 1 - helper_39;
+const Eigen::ArrayXd helper_50 = 6*y;
+const Eigen::ArrayXd helper_51 = 8*helper_7;
+const Eigen::ArrayXd helper_52 = -helper_50 + helper_51 + 1;
+const Eigen::ArrayXd helper_53 = -helper_50*z + x - 1;
+const Eigen::ArrayXd helper_54 = (16.0/3.0)*y;
+const Eigen::ArrayXd helper_55 = helper_10 - helper_29 + helper_30*x;
+const Eigen::ArrayXd helper_56 = (16.0/3.0)*z;
+const Eigen::ArrayXd helper_57 = 4*z;
+const Eigen::ArrayXd helper_58 = 8*helper_9;
+const Eigen::ArrayXd helper_59 = helper_28*z;
+const Eigen::ArrayXd helper_60 = -helper_57;
+const Eigen::ArrayXd helper_61 = helper_58 - 6*z + 1;
+const Eigen::ArrayXd helper_62 = (16.0/3.0)*helper_5;
+const Eigen::ArrayXd helper_63 = helper_39 + helper_46 + helper_57 - 3;
+const Eigen::ArrayXd helper_64 = 32*helper_1;
+const Eigen::ArrayXd helper_65 = helper_64*x;
+const Eigen::ArrayXd helper_66 = helper_65*y;
+const Eigen::ArrayXd helper_67 = helper_46 - 1;
+const Eigen::ArrayXd helper_68 = helper_39 - 1;
+const Eigen::ArrayXd helper_69 = helper_65*z;
+const Eigen::ArrayXd helper_70 = helper_57 - 1;
+const Eigen::ArrayXd helper_71 = 32*helper_6;
+const Eigen::ArrayXd helper_72 = helper_5*helper_64;
+val.col(0) = ((1.0/3.0)*helper_1*(3*pow(helper_1, 3) + helper_10*helper_11 + helper_10*helper_12 + helper_10*helper_17 + helper_11*helper_9 + helper_12*helper_7 + helper_13*helper_5 + helper_14*y + helper_14*z + helper_15*helper_16 + helper_15*helper_18 + helper_15*helper_19 + helper_17*helper_7 + helper_17*helper_9 + 3*helper_2 + 3*helper_3 + 3*helper_4 + 18*helper_6 + helper_7*helper_8 + helper_8*helper_9)).matrix();
+val.col(1) = ((1.0/3.0)*x*(-48*helper_10 + 32*helper_2 + 22*x - 3)).matrix();
+val.col(2) = ((1.0/3.0)*y*(32*helper_3 - 48*helper_7 + 22*y - 3)).matrix();
+val.col(3) = ((1.0/3.0)*z*(32*helper_4 - 48*helper_9 + 22*z - 3)).matrix();
+val.col(4) = (-helper_27*helper_28).matrix();
+val.col(5) = (helper_1*helper_39*(3*helper_10 + helper_29 - helper_31 - helper_32 + helper_34 + helper_35*x + helper_38 - helper_7 - helper_9)).matrix();
+val.col(6) = (-helper_28*(helper_0 - 14*helper_10 + helper_21 + helper_41 + helper_42 + helper_43*y + helper_43*z + 7*x)).matrix();
+val.col(7) = (helper_44*helper_45).matrix();
+val.col(8) = (helper_39*y*(helper_47 + helper_48*y + helper_49)).matrix();
+val.col(9) = (helper_45*helper_52).matrix();
+val.col(10) = (-helper_54*(helper_22 + helper_41 + helper_51*x + helper_51*z + helper_53 - 14*helper_7 + 7*y + z)).matrix();
+val.col(11) = (-helper_1*helper_46*(helper_32 - helper_34 - helper_35*y + helper_38 + helper_55 - 3*helper_7 + helper_9)).matrix();
+val.col(12) = (-helper_27*helper_54).matrix();
+val.col(13) = (-helper_27*helper_56).matrix();
+val.col(14) = (-helper_1*helper_57*(helper_31 + helper_34 - helper_35*z + helper_36 - helper_37 + helper_55 + helper_7 - 3*helper_9)).matrix();
+val.col(15) = (-helper_56*(helper_23 + helper_42 + helper_53 + helper_58*x + helper_58*y - 14*helper_9 + y + 7*z)).matrix();
+val.col(16) = (helper_44*helper_59).matrix();
+val.col(17) = (helper_39*z*(helper_48*z + helper_49 + helper_60)).matrix();
+val.col(18) = (helper_59*helper_61).matrix();
+val.col(19) = (helper_52*helper_62).matrix();
+val.col(20) = (helper_46*z*(helper_47 + 16*helper_5 + helper_60 + 1)).matrix();
+val.col(21) = (helper_61*helper_62).matrix();
+val.col(22) = (helper_63*helper_66).matrix();
+val.col(23) = (-helper_66*helper_67).matrix();
+val.col(24) = (-helper_66*helper_68).matrix();
+val.col(25) = (helper_63*helper_69).matrix();
+val.col(26) = (-helper_69*helper_70).matrix();
+val.col(27) = (-helper_68*helper_69).matrix();
+val.col(28) = (helper_68*helper_71).matrix();
+val.col(29) = (helper_70*helper_71).matrix();
+val.col(30) = (helper_67*helper_71).matrix();
+val.col(31) = (-helper_67*helper_72).matrix();
+val.col(32) = (-helper_70*helper_72).matrix();
+val.col(33) = (helper_63*helper_72).matrix();
+val.col(34) = (-256*helper_1*helper_6).matrix();
+}
+void p_4_tabulate_grad_basis_value_3d(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+
+auto x=uv.col(0).array();
+auto y=uv.col(1).array();
+auto z=uv.col(2).array();
+
+val.resize(uv.rows(), 105);
+const Eigen::ArrayXd helper_0 = 160*x;
+const Eigen::ArrayXd helper_1 = y*z;
+const Eigen::ArrayXd helper_2 = pow(x, 2);
+const Eigen::ArrayXd helper_3 = pow(x, 3);
+const Eigen::ArrayXd helper_4 = (128.0/3.0)*helper_3;
+const Eigen::ArrayXd helper_5 = pow(y, 2);
+const Eigen::ArrayXd helper_6 = pow(y, 3);
+const Eigen::ArrayXd helper_7 = (128.0/3.0)*helper_6;
+const Eigen::ArrayXd helper_8 = pow(z, 2);
+const Eigen::ArrayXd helper_9 = pow(z, 3);
+const Eigen::ArrayXd helper_10 = (128.0/3.0)*helper_9;
+const Eigen::ArrayXd helper_11 = helper_1*x;
+const Eigen::ArrayXd helper_12 = 128*x;
+const Eigen::ArrayXd helper_13 = 128*y;
+const Eigen::ArrayXd helper_14 = 128*z;
+const Eigen::ArrayXd helper_15 = -helper_0*y - helper_0*z - 160*helper_1 + helper_10 + 256*helper_11 + helper_12*helper_5 + helper_12*helper_8 + helper_13*helper_2 + helper_13*helper_8 + helper_14*helper_2 + helper_14*helper_5 - 80*helper_2 + helper_4 - 80*helper_5 + helper_7 - 80*helper_8 + (140.0/3.0)*x + (140.0/3.0)*y + (140.0/3.0)*z - 25.0/3.0;
+const Eigen::ArrayXd helper_16 = (32.0/3.0)*helper_3;
+const Eigen::ArrayXd helper_17 = 8*z;
+const Eigen::ArrayXd helper_18 = helper_17*helper_5;
+const Eigen::ArrayXd helper_19 = 8*y;
+const Eigen::ArrayXd helper_20 = helper_19*helper_8;
+const Eigen::ArrayXd helper_21 = 16*x;
+const Eigen::ArrayXd helper_22 = 24*helper_2;
+const Eigen::ArrayXd helper_23 = 32*x;
+const Eigen::ArrayXd helper_24 = helper_1*helper_23;
+const Eigen::ArrayXd helper_25 = helper_24 - 6*helper_8 + (8.0/3.0)*helper_9 - 24*x*y + (13.0/3.0)*z - 1;
+const Eigen::ArrayXd helper_26 = -6*helper_5 + (8.0/3.0)*helper_6 - 24*x*z + (13.0/3.0)*y;
+const Eigen::ArrayXd helper_27 = -36*x;
+const Eigen::ArrayXd helper_28 = -36*y;
+const Eigen::ArrayXd helper_29 = -36*z;
+const Eigen::ArrayXd helper_30 = 48*x;
+const Eigen::ArrayXd helper_31 = 24*helper_5;
+const Eigen::ArrayXd helper_32 = 24*helper_8;
+const Eigen::ArrayXd helper_33 = 48*helper_1 + helper_22 + helper_27 + helper_28 + helper_29 + helper_30*y + helper_30*z + helper_31 + helper_32 + 13;
+const Eigen::ArrayXd helper_34 = (16.0/3.0)*x;
+const Eigen::ArrayXd helper_35 = -helper_33*helper_34;
+const Eigen::ArrayXd helper_36 = 96*helper_2;
+const Eigen::ArrayXd helper_37 = helper_19*z;
+const Eigen::ArrayXd helper_38 = 32*helper_5;
+const Eigen::ArrayXd helper_39 = 32*helper_8;
+const Eigen::ArrayXd helper_40 = 4*helper_8;
+const Eigen::ArrayXd helper_41 = 7*z;
+const Eigen::ArrayXd helper_42 = 72*x;
+const Eigen::ArrayXd helper_43 = 64*helper_11;
+const Eigen::ArrayXd helper_44 = -helper_40 + helper_41 - helper_42*y + helper_43 - 3;
+const Eigen::ArrayXd helper_45 = 4*helper_5;
+const Eigen::ArrayXd helper_46 = 7*y;
+const Eigen::ArrayXd helper_47 = -helper_42*z - helper_45 + helper_46;
+const Eigen::ArrayXd helper_48 = 32*helper_2;
+const Eigen::ArrayXd helper_49 = helper_23*y;
+const Eigen::ArrayXd helper_50 = -helper_17;
+const Eigen::ArrayXd helper_51 = helper_49 + helper_50 + 7;
+const Eigen::ArrayXd helper_52 = -helper_19;
+const Eigen::ArrayXd helper_53 = helper_23*z;
+const Eigen::ArrayXd helper_54 = helper_52 + helper_53;
+const Eigen::ArrayXd helper_55 = 4*x;
+const Eigen::ArrayXd helper_56 = helper_55*(helper_27 + helper_48 + helper_51 + helper_54);
+const Eigen::ArrayXd helper_57 = helper_19*helper_2;
+const Eigen::ArrayXd helper_58 = helper_17*helper_2;
+const Eigen::ArrayXd helper_59 = -4*x*y + (1.0/3.0)*z - 1.0/3.0;
+const Eigen::ArrayXd helper_60 = -4*x*z + (1.0/3.0)*y;
+const Eigen::ArrayXd helper_61 = helper_34*(8*helper_2 - 6*x + 1);
+const Eigen::ArrayXd helper_62 = -helper_61;
+const Eigen::ArrayXd helper_63 = helper_22 - 12*x + 1;
+const Eigen::ArrayXd helper_64 = (16.0/3.0)*y;
+const Eigen::ArrayXd helper_65 = 8*x;
+const Eigen::ArrayXd helper_66 = -helper_65;
+const Eigen::ArrayXd helper_67 = 4*y;
+const Eigen::ArrayXd helper_68 = -helper_67;
+const Eigen::ArrayXd helper_69 = helper_49 + 1;
+const Eigen::ArrayXd helper_70 = -helper_55;
+const Eigen::ArrayXd helper_71 = helper_64*(8*helper_5 - 6*y + 1);
+const Eigen::ArrayXd helper_72 = helper_31 - 12*y + 1;
+const Eigen::ArrayXd helper_73 = -helper_71;
+const Eigen::ArrayXd helper_74 = (32.0/3.0)*helper_6;
+const Eigen::ArrayXd helper_75 = helper_5*helper_65;
+const Eigen::ArrayXd helper_76 = (1.0/3.0)*x - 4*y*z;
+const Eigen::ArrayXd helper_77 = 32*helper_1;
+const Eigen::ArrayXd helper_78 = helper_66 + helper_77;
+const Eigen::ArrayXd helper_79 = helper_67*(helper_28 + helper_38 + helper_51 + helper_78);
+const Eigen::ArrayXd helper_80 = 96*helper_5;
+const Eigen::ArrayXd helper_81 = helper_17*x;
+const Eigen::ArrayXd helper_82 = 4*helper_2;
+const Eigen::ArrayXd helper_83 = 7*x;
+const Eigen::ArrayXd helper_84 = -72*helper_1 - helper_82 + helper_83;
+const Eigen::ArrayXd helper_85 = -helper_33*helper_64;
+const Eigen::ArrayXd helper_86 = helper_65*helper_8;
+const Eigen::ArrayXd helper_87 = 16*y;
+const Eigen::ArrayXd helper_88 = -6*helper_2 + (8.0/3.0)*helper_3 + (13.0/3.0)*x - 24*y*z;
+const Eigen::ArrayXd helper_89 = (16.0/3.0)*z;
+const Eigen::ArrayXd helper_90 = -helper_33*helper_89;
+const Eigen::ArrayXd helper_91 = (32.0/3.0)*helper_9;
+const Eigen::ArrayXd helper_92 = 16*z;
+const Eigen::ArrayXd helper_93 = 4*z;
+const Eigen::ArrayXd helper_94 = helper_93*(helper_29 + helper_39 + helper_54 + helper_78 + 7);
+const Eigen::ArrayXd helper_95 = 96*helper_8;
+const Eigen::ArrayXd helper_96 = helper_19*x;
+const Eigen::ArrayXd helper_97 = helper_89*(8*helper_8 - 6*z + 1);
+const Eigen::ArrayXd helper_98 = -helper_97;
+const Eigen::ArrayXd helper_99 = -helper_93;
+const Eigen::ArrayXd helper_100 = helper_53 + 1;
+const Eigen::ArrayXd helper_101 = helper_32 - 12*z + 1;
+const Eigen::ArrayXd helper_102 = helper_77 + 1;
+const Eigen::ArrayXd helper_103 = 12*helper_2;
+const Eigen::ArrayXd helper_104 = helper_21*z - helper_46 + 3;
+const Eigen::ArrayXd helper_105 = helper_21*y + helper_40 - helper_41;
+const Eigen::ArrayXd helper_106 = helper_103 + helper_104 + helper_105 + helper_37 + helper_45 - 14*x;
+const Eigen::ArrayXd helper_107 = 32*y;
+const Eigen::ArrayXd helper_108 = 12*helper_5;
+const Eigen::ArrayXd helper_109 = 16*helper_1 + helper_82 - helper_83;
+const Eigen::ArrayXd helper_110 = helper_105 + helper_108 + helper_109 + helper_81 - 14*y + 3;
+const Eigen::ArrayXd helper_111 = helper_17 + helper_19 + helper_65 - 7;
+const Eigen::ArrayXd helper_112 = -5*y;
+const Eigen::ArrayXd helper_113 = helper_45 + helper_96;
+const Eigen::ArrayXd helper_114 = 1 - z;
+const Eigen::ArrayXd helper_115 = 2*x;
+const Eigen::ArrayXd helper_116 = -helper_115 + helper_67*z;
+const Eigen::ArrayXd helper_117 = helper_114 + helper_96;
+const Eigen::ArrayXd helper_118 = helper_37 - x;
+const Eigen::ArrayXd helper_119 = helper_108 + helper_117 + helper_118 - 10*y;
+const Eigen::ArrayXd helper_120 = helper_67 - 1;
+const Eigen::ArrayXd helper_121 = helper_120*helper_49;
+const Eigen::ArrayXd helper_122 = helper_81 - y;
+const Eigen::ArrayXd helper_123 = helper_103 + helper_117 + helper_122 - 10*x;
+const Eigen::ArrayXd helper_124 = helper_82 - 5*x;
+const Eigen::ArrayXd helper_125 = 2*y;
+const Eigen::ArrayXd helper_126 = -helper_125 + helper_55*z;
+const Eigen::ArrayXd helper_127 = helper_55 - 1;
+const Eigen::ArrayXd helper_128 = helper_127*helper_49;
+const Eigen::ArrayXd helper_129 = 32*z;
+const Eigen::ArrayXd helper_130 = 12*helper_8;
+const Eigen::ArrayXd helper_131 = helper_104 + helper_109 + helper_113 + helper_130 - 14*z;
+const Eigen::ArrayXd helper_132 = helper_122 + 1;
+const Eigen::ArrayXd helper_133 = helper_40 - 5*z;
+const Eigen::ArrayXd helper_134 = helper_93 - 1;
+const Eigen::ArrayXd helper_135 = helper_134*helper_53;
+const Eigen::ArrayXd helper_136 = helper_118 + helper_130 + helper_132 - 10*z;
+const Eigen::ArrayXd helper_137 = helper_127*helper_53;
+const Eigen::ArrayXd helper_138 = 2*z;
+const Eigen::ArrayXd helper_139 = -helper_138 + helper_67*x;
+const Eigen::ArrayXd helper_140 = helper_134*helper_77;
+const Eigen::ArrayXd helper_141 = helper_120*helper_77;
+const Eigen::ArrayXd helper_142 = helper_118 + 1;
+const Eigen::ArrayXd helper_143 = z - 1;
+const Eigen::ArrayXd helper_144 = 256*x;
+val.col(0) = (helper_15).matrix();
+val.col(1) = (helper_15).matrix();
+val.col(2) = (helper_15).matrix();
+val.col(3) = (-48*helper_2 + helper_4 + (44.0/3.0)*x - 1).matrix();
+val.col(4).setZero();
+val.col(5).setZero();
+val.col(6).setZero();
+val.col(7) = (-48*helper_5 + helper_7 + (44.0/3.0)*y - 1).matrix();
+val.col(8).setZero();
+val.col(9).setZero();
+val.col(10).setZero();
+val.col(11) = (helper_10 - 48*helper_8 + (44.0/3.0)*z - 1).matrix();
+val.col(12) = (-16*helper_16 - 16*helper_18 + 288*helper_2 - 16*helper_20 - 16*helper_21*helper_5 - 16*helper_21*helper_8 - 16*helper_22*y - 16*helper_22*z - 16*helper_25 - 16*helper_26 - 416.0/3.0*x + 192*y*z).matrix();
+val.col(13) = (helper_35).matrix();
+val.col(14) = (helper_35).matrix();
+val.col(15) = (256*helper_3 + 4*helper_36*y + 4*helper_36*z - 4*helper_36 - 4*helper_37 + 4*helper_38*x + 4*helper_39*x + 4*helper_44 + 4*helper_47 + 152*x).matrix();
+val.col(16) = (helper_56).matrix();
+val.col(17) = (helper_56).matrix();
+val.col(18) = (-16*helper_16 + 224*helper_2 - 16*helper_57 - 16*helper_58 - 16*helper_59 - 16*helper_60 - 224.0/3.0*x).matrix();
+val.col(19) = (helper_62).matrix();
+val.col(20) = (helper_62).matrix();
+val.col(21) = (helper_63*helper_64).matrix();
+val.col(22) = (helper_61).matrix();
+val.col(23).setZero();
+val.col(24) = (helper_67*(helper_66 + helper_68 + helper_69)).matrix();
+val.col(25) = (helper_55*(helper_52 + helper_69 + helper_70)).matrix();
+val.col(26).setZero();
+val.col(27) = (helper_71).matrix();
+val.col(28) = (helper_34*helper_72).matrix();
+val.col(29).setZero();
+val.col(30) = (helper_73).matrix();
+val.col(31) = (-16*helper_18 + 224*helper_5 - 16*helper_59 - 16*helper_74 - 16*helper_75 - 16*helper_76 - 224.0/3.0*y).matrix();
+val.col(32) = (helper_73).matrix();
+val.col(33) = (helper_79).matrix();
+val.col(34) = (4*helper_39*y + 4*helper_44 + 4*helper_48*y + 256*helper_6 + 4*helper_80*x + 4*helper_80*z - 4*helper_80 - 4*helper_81 + 4*helper_84 + 152*y).matrix();
+val.col(35) = (helper_79).matrix();
+val.col(36) = (helper_85).matrix();
+val.col(37) = (-16*helper_2*helper_87 - 16*helper_25 - 16*helper_31*x - 16*helper_31*z + 288*helper_5 - 16*helper_58 - 16*helper_74 - 16*helper_8*helper_87 - 16*helper_86 - 16*helper_88 + 192*x*z - 416.0/3.0*y).matrix();
+val.col(38) = (helper_85).matrix();
+val.col(39) = (helper_90).matrix();
+val.col(40) = (helper_90).matrix();
+val.col(41) = (-16*helper_2*helper_92 - 16*helper_24 - 16*helper_26 - 16*helper_32*x - 16*helper_32*y - 16*helper_5*helper_92 - 16*helper_57 - 16*helper_75 + 288*helper_8 - 16*helper_88 - 16*helper_91 + 192*x*y - 416.0/3.0*z + 16).matrix();
+val.col(42) = (helper_94).matrix();
+val.col(43) = (helper_94).matrix();
+val.col(44) = (4*helper_38*z + 4*helper_43 + 4*helper_47 + 4*helper_48*z + 4*helper_84 + 256*helper_9 + 4*helper_95*x + 4*helper_95*y - 4*helper_95 - 4*helper_96 + 152*z - 12).matrix();
+val.col(45) = (helper_98).matrix();
+val.col(46) = (helper_98).matrix();
+val.col(47) = (-16*helper_20 - 16*helper_60 - 16*helper_76 + 224*helper_8 - 16*helper_86 - 16*helper_91 - 224.0/3.0*z + 16.0/3.0).matrix();
+val.col(48) = (helper_63*helper_89).matrix();
+val.col(49).setZero();
+val.col(50) = (helper_61).matrix();
+val.col(51) = (helper_93*(helper_100 + helper_66 + helper_99)).matrix();
+val.col(52).setZero();
+val.col(53) = (helper_55*(helper_100 + helper_50 + helper_70)).matrix();
+val.col(54) = (helper_97).matrix();
+val.col(55).setZero();
+val.col(56) = (helper_101*helper_34).matrix();
+val.col(57).setZero();
+val.col(58) = (helper_72*helper_89).matrix();
+val.col(59) = (helper_71).matrix();
+val.col(60).setZero();
+val.col(61) = (helper_93*(helper_102 + helper_52 + helper_99)).matrix();
+val.col(62) = (helper_67*(helper_102 + helper_50 + helper_68)).matrix();
+val.col(63).setZero();
+val.col(64) = (helper_97).matrix();
+val.col(65) = (helper_101*helper_64).matrix();
+val.col(66) = (helper_106*helper_107).matrix();
+val.col(67) = (helper_110*helper_23).matrix();
+val.col(68) = (helper_111*helper_49).matrix();
+val.col(69) = (-helper_107*(helper_112 + helper_113 + helper_114 + helper_116)).matrix();
+val.col(70) = (-helper_119*helper_23).matrix();
+val.col(71) = (-helper_121).matrix();
+val.col(72) = (-helper_107*helper_123).matrix();
+val.col(73) = (-helper_23*(helper_117 + helper_124 + helper_126)).matrix();
+val.col(74) = (-helper_128).matrix();
+val.col(75) = (helper_106*helper_129).matrix();
+val.col(76) = (helper_111*helper_53).matrix();
+val.col(77) = (helper_131*helper_23).matrix();
+val.col(78) = (-helper_129*(helper_116 + helper_132 + helper_133)).matrix();
+val.col(79) = (-helper_135).matrix();
+val.col(80) = (-helper_136*helper_23).matrix();
+val.col(81) = (-helper_123*helper_129).matrix();
+val.col(82) = (-helper_137).matrix();
+val.col(83) = (-helper_23*(helper_124 + helper_132 + helper_139)).matrix();
+val.col(84) = (helper_77*(helper_65 - 1)).matrix();
+val.col(85) = (helper_137).matrix();
+val.col(86) = (helper_128).matrix();
+val.col(87) = (helper_140).matrix();
+val.col(88) = (helper_135).matrix();
+val.col(89) = (helper_49*(helper_17 - 1)).matrix();
+val.col(90) = (helper_141).matrix();
+val.col(91) = (helper_53*(helper_19 - 1)).matrix();
+val.col(92) = (helper_121).matrix();
+val.col(93) = (-helper_141).matrix();
+val.col(94) = (-helper_119*helper_129).matrix();
+val.col(95) = (-helper_107*(helper_112 + helper_139 + helper_142 + helper_45)).matrix();
+val.col(96) = (-helper_140).matrix();
+val.col(97) = (-helper_129*(helper_126 + helper_133 + helper_142)).matrix();
+val.col(98) = (-helper_107*helper_136).matrix();
+val.col(99) = (helper_111*helper_77).matrix();
+val.col(100) = (helper_110*helper_129).matrix();
+val.col(101) = (helper_107*helper_131).matrix();
+val.col(102) = (-256*helper_1*(helper_115 + helper_143 + y)).matrix();
+val.col(103) = (-helper_144*z*(helper_125 + helper_143 + x)).matrix();
+val.col(104) = (-helper_144*y*(helper_138 + x + y - 1)).matrix();
+}
+
+
 }
 
 void p_nodes_3d(const int p, Eigen::MatrixXd &val){
@@ -862,6 +1877,48 @@ switch(p){
 	default: p_n_basis_grad_value_3d(p, local_index, uv, val);
 }}
 
+void p_tabulate_basis_value_3d(const bool bernstein, const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+if(bernstein || p > 4) {
+const int n_bases = (p + 1) * (p + 2) * (p + 3) / 6;
+val.resize(uv.rows(), n_bases);
+Eigen::MatrixXd tmp;
+for(int i = 0; i < n_bases; ++i) {
+p_basis_value_3d(bernstein, p, i, uv, tmp);
+val.col(i) = tmp;
+}
+return;
+}
+
+switch(p){
+	case 0: p_0_tabulate_basis_value_3d(uv, val); break;
+	case 1: p_1_tabulate_basis_value_3d(uv, val); break;
+	case 2: p_2_tabulate_basis_value_3d(uv, val); break;
+	case 3: p_3_tabulate_basis_value_3d(uv, val); break;
+	case 4: p_4_tabulate_basis_value_3d(uv, val); break;
+	default: assert(false);
+}}
+
+void p_tabulate_grad_basis_value_3d(const bool bernstein, const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val){
+if(bernstein || p > 4) {
+const int n_bases = (p + 1) * (p + 2) * (p + 3) / 6;
+val.resize(uv.rows(), n_bases * 3);
+Eigen::MatrixXd tmp;
+for(int i = 0; i < n_bases; ++i) {
+p_grad_basis_value_3d(bernstein, p, i, uv, tmp);
+val.middleCols(i * 3, 3) = tmp;
+}
+return;
+}
+
+switch(p){
+	case 0: p_0_tabulate_grad_basis_value_3d(uv, val); break;
+	case 1: p_1_tabulate_grad_basis_value_3d(uv, val); break;
+	case 2: p_2_tabulate_grad_basis_value_3d(uv, val); break;
+	case 3: p_3_tabulate_grad_basis_value_3d(uv, val); break;
+	case 4: p_4_tabulate_grad_basis_value_3d(uv, val); break;
+	default: assert(false);
+}}
+
 namespace {
 
 }}}
@@ -11,6 +11,12 @@ void p_basis_value_2d(const bool bernstein, const int p, const int local_index,
 
 void p_grad_basis_value_2d(const bool bernstein, const int p, const int local_index, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
 
+// all the bases of order p at once, val(k, i) is the value of the i-th basis at uv.row(k)
+void p_tabulate_basis_value_2d(const bool bernstein, const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+
+// all the basis gradients of order p at once, val(k, i * dim + d) is the d-th component of the gradient of the i-th basis at uv.row(k)
+void p_tabulate_grad_basis_value_2d(const bool bernstein, const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+
 
 void p_nodes_3d(const int p, Eigen::MatrixXd &val);
 
@@ -18,6 +24,12 @@ void p_basis_value_3d(const bool bernstein, const int p, const int local_index,
 
 void p_grad_basis_value_3d(const bool bernstein, const int p, const int local_index, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
 
+// all the bases of order p at once, val(k, i) is the value of the i-th basis at uv.row(k)
+void p_tabulate_basis_value_3d(const bool bernstein, const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+
+// all the basis gradients of order p at once, val(k, i * dim + d) is the d-th component of the gradient of the i-th basis at uv.row(k)
+void p_tabulate_grad_basis_value_3d(const bool bernstein, const int p, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val);
+
 
 
 static const int MAX_P_BASES = 4;
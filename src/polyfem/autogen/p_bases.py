@@ -219,6 +219,39 @@ if __name__ == "__main__":
         hpp = hpp + unique_fun + ";\n\n"
         hpp = hpp + dunique_fun + ";\n\n"
 
+        if not args.bernstein:
+            n_bases = "(p + 1) * (p + 2) / 2" if dim == 2 else "(p + 1) * (p + 2) * (p + 3) / 6"
+            tabulate_fun = f"void {bletter}_tabulate_basis_value_{suffix}" + \
+                f"(const bool bernstein, const int {bletter}, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)"
+            dtabulate_fun = f"void {bletter}_tabulate_grad_basis_value_{suffix}" + \
+                f"(const bool bernstein, const int {bletter}, const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)"
+
+            hpp = hpp + "// all the bases of order p at once, val(k, i) is the value of the i-th basis at uv.row(k)\n"
+            hpp = hpp + tabulate_fun + ";\n\n"
+            hpp = hpp + "// all the basis gradients of order p at once, val(k, i * dim + d) is the d-th component of the gradient of the i-th basis at uv.row(k)\n"
+            hpp = hpp + dtabulate_fun + ";\n\n"
+
+            tabulate_fun = tabulate_fun + "{\n" + \
+                f"if(bernstein || p > {max(orders)}) {{\n" + \
+                f"const int n_bases = {n_bases};\n" + \
+                "val.resize(uv.rows(), n_bases);\n" + \
+                "Eigen::MatrixXd tmp;\n" + \
+                "for(int i = 0; i < n_bases; ++i) {\n" + \
+                f"p_basis_value_{suffix}(bernstein, p, i, uv, tmp);\n" + \
+                "val.col(i) = tmp;\n" + \
+                "}\nreturn;\n}\n\n" + \
+                "switch(p){\n"
+            dtabulate_fun = dtabulate_fun + "{\n" + \
+                f"if(bernstein || p > {max(orders)}) {{\n" + \
+                f"const int n_bases = {n_bases};\n" + \
+                f"val.resize(uv.rows(), n_bases * {dim});\n" + \
+                "Eigen::MatrixXd tmp;\n" + \
+                "for(int i = 0; i < n_bases; ++i) {\n" + \
+                f"p_grad_basis_value_{suffix}(bernstein, p, i, uv, tmp);\n" + \
+                f"val.middleCols(i * {dim}, {dim}) = tmp;\n" + \
+                "}\nreturn;\n}\n\n" + \
+                "switch(p){\n"
+
         unique_nodes = unique_nodes + f"{{\nswitch({bletter})" + "{\n"
 
         unique_fun = unique_fun + "{\n"
@@ -468,6 +501,31 @@ if __name__ == "__main__":
             if not args.bernstein:
                 cpp = cpp + nodes + "\n\n\n"
 
+            if not args.bernstein:
+                coords = [x, y, z][:dim]
+                values = [simplify(fe.N[indices[i]]) for i in range(0, fe.nbf())]
+                grads = [simplify(diff(fe.N[indices[i]], c)) if order > 0 else 0
+                         for i in range(0, fe.nbf()) for c in coords]
+
+                tabulate_base = base.split("switch(local_index)")[0].replace("result_0.resize(x.size(),1);\n", "")
+
+                tfunc = f"void {bletter}_{order}_tabulate_basis_value_{suffix}" + \
+                    "(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)"
+                dtfunc = f"void {bletter}_{order}_tabulate_grad_basis_value_{suffix}" + \
+                    "(const Eigen::MatrixXd &uv, Eigen::MatrixXd &val)"
+
+                cpp = cpp + tfunc + "{\n\n" + tabulate_base + \
+                    f"val.resize(uv.rows(), {fe.nbf()});\n" + \
+                    pretty_print.C99_print_columns(values) + "\n}\n"
+                cpp = cpp + dtfunc + "{\n\n" + tabulate_base + \
+                    f"val.resize(uv.rows(), {fe.nbf() * dim});\n" + \
+                    pretty_print.C99_print_columns(grads) + "\n}\n\n\n"
+
+                tabulate_fun = tabulate_fun + \
+                    f"\tcase {order}: {bletter}_{order}_tabulate_basis_value_{suffix}(uv, val); break;\n"
+                dtabulate_fun = dtabulate_fun + \
+                    f"\tcase {order}: {bletter}_{order}_tabulate_grad_basis_value_{suffix}(uv, val); break;\n"
+
         if args.bernstein:
             unique_nodes = ""
         else:
@@ -481,7 +539,12 @@ if __name__ == "__main__":
             dunique_fun = dunique_fun + "\tdefault: "+default_dbase+"\n}}"
 
         cpp = cpp + "}\n\n" + unique_nodes + "\n" + unique_fun + \
-            "\n\n" + dunique_fun + "\n" + "\nnamespace " + "{\n"
+            "\n\n" + dunique_fun + "\n"
+        if not args.bernstein:
+            tabulate_fun = tabulate_fun + "\tdefault: assert(false);\n}}"
+            dtabulate_fun = dtabulate_fun + "\tdefault: assert(false);\n}}"
+            cpp = cpp + "\n" + tabulate_fun + "\n\n" + dtabulate_fun + "\n"
+        cpp = cpp + "\nnamespace " + "{\n"
         hpp = hpp + "\n"
 
     hpp = hpp + \
@@ -20,6 +20,27 @@ def C99_print(expr):
         lines.append(ccode(result, "result_%d" % i))
     return '\n'.join(lines)
 
+# Pretty print a list of expressions evaluated on arrays of points, one column of
+# result_name per expression. The common subexpressions are shared by all columns.
+def C99_print_columns(exprs, result_name="val"):
+    CSE_results = cse([sympify(e) for e in exprs], numbered_symbols("helper_"), optimizations='basic')
+    lines = []
+    for helper in CSE_results[0]:
+        helper_type = 'const Eigen::ArrayXd ' if helper[1].free_symbols else 'const double '
+        lines.append(helper_type + ccode(helper[1], helper[0]))
+
+    for i, result in enumerate(CSE_results[1]):
+        if result.is_Number:
+            if result == 0:
+                lines.append(f"{result_name}.col({i}).setZero();")
+            elif result == 1:
+                lines.append(f"{result_name}.col({i}).setOnes();")
+            else:
+                lines.append(f"{result_name}.col({i}).setConstant({ccode(result)});")
+        else:
+            lines.append(f"{result_name}.col({i}) = ({ccode(result)}).matrix();")
+    return '\n'.join(lines)
+
 # Pretty print a matrix or tensor expression.
 def C99_print_tensor(expr, result_name="result"):
     # If a tensor expression, the result is reshaped into a 2d matrix for printing.
@@ -0,0 +1,268 @@
+#include "DofReordering.hpp"
+
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/RadixSort.hpp>
+#include <polyfem/utils/Logger.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+namespace polyfem
+{
+	using namespace utils;
+
+	namespace basis
+	{
+		namespace
+		{
+			/// Graph of the bases sharing an element, in CSR format
+			struct DofGraph
+			{
+				std::vector<int> offsets;
+				std::vector<int> neighbors;
+
+				int degree(const int i) const { return offsets[i + 1] - offsets[i]; }
+			};
+
+			DofGraph build_dof_graph(const int n_bases, const std::vector<ElementBases> &bases)
+			{
+				const int n_elements = bases.size();
+
+				std::vector<std::vector<int>> element_dofs(n_elements);
+				maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+					for (int e = start; e < end; ++e)
+					{
+						auto &dofs = element_dofs[e];
+						for (const auto &b : bases[e].bases)
+							for (const auto &lg : b.global())
+								dofs.push_back(lg.index);
+						std::sort(dofs.begin(), dofs.end());
+						dofs.erase(std::unique(dofs.begin(), dofs.end()), dofs.end());
+					}
+				});
+
+				std::vector<size_t> pair_offsets(n_elements + 1, 0);
+				for (int e = 0; e < n_elements; ++e)
+					pair_offsets[e + 1] = pair_offsets[e] + element_dofs[e].size() * (element_dofs[e].size() - 1);
+
+				std::vector<uint64_t> pairs(pair_offsets.back());
+				maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+					for (int e = start; e < end; ++e)
+					{
+						size_t k = pair_offsets[e];
+						for (const int i : element_dofs[e])
+							for (const int j : element_dofs[e])
+								if (i != j)
+									pairs[k++] = (uint64_t(i) << 32) | uint64_t(j);
+					}
+				});
+
+				radix_sort(pairs);
+				pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+				DofGraph graph;
+				graph.offsets.assign(n_bases + 1, 0);
+				graph.neighbors.resize(pairs.size());
+				for (size_t k = 0; k < pairs.size(); ++k)
+				{
+					++graph.offsets[(pairs[k] >> 32) + 1];
+					graph.neighbors[k] = int(pairs[k] & 0xFFFFFFFF);
+				}
+				for (int i = 0; i < n_bases; ++i)
+					graph.offsets[i + 1] += graph.offsets[i];
+
+				return graph;
+			}
+
+			/// Breadth-first traversal of the component of root, returns the nodes of the last level and the eccentricity of root
+			int bfs_levels(const DofGraph &graph, const int root, std::vector<int> &level, std::vector<int> &component, std::vector<int> &last_level)
+			{
+				component.clear();
+				component.push_back(root);
+				level[root] = 0;
+				int eccentricity = 0;
+				for (size_t k = 0; k < component.size(); ++k)
+				{
+					const int i = component[k];
+					eccentricity = std::max(eccentricity, level[i]);
+					for (int n = graph.offsets[i]; n < graph.offsets[i + 1]; ++n)
+					{
+						const int j = graph.neighbors[n];
+						if (level[j] < 0)
+						{
+							level[j] = level[i] + 1;
+							component.push_back(j);
+						}
+					}
+				}
+
+				last_level.clear();
+				for (const int i : component)
+				{
+					if (level[i] == eccentricity)
+						last_level.push_back(i);
+					level[i] = -1;
+				}
+
+				return eccentricity;
+			}
+
+			/// George-Liu heuristic to find a node of (nearly) maximal eccentricity in the component of root
+			int pseudo_peripheral_node(const DofGraph &graph, int root, std::vector<int> &level, std::vector<int> &component)
+			{
+				std::vector<int> last_level;
+				int eccentricity = bfs_levels(graph, root, level, component, last_level);
+
+				while (true)
+				{
+					const int candidate = *std::min_element(last_level.begin(), last_level.end(), [&](int a, int b) {
+						return graph.degree(a) < graph.degree(b) || (graph.degree(a) == graph.degree(b) && a < b);
+					});
+
+					std::vector<int> candidate_component;
+					const int candidate_eccentricity = bfs_levels(graph, candidate, level, candidate_component, last_level);
+					if (candidate_eccentricity <= eccentricity)
+						break;
+
+					root = candidate;
+					eccentricity = candidate_eccentricity;
+				}
+
+				return root;
+			}
+
+			uint64_t interleave_bits(const std::array<uint32_t, 3> &coords, const int dim, const int bits)
+			{
+				uint64_t key = 0;
+				for (int b = bits - 1; b >= 0; --b)
+					for (int d = 0; d < dim; ++d)
+						key = (key << 1) | ((coords[d] >> b) & 1);
+				return key;
+			}
+		} // namespace
+
+		std::vector<int> reverse_cuthill_mckee_ordering(const int n_bases, const std::vector<ElementBases> &bases)
+		{
+			const DofGraph graph = build_dof_graph(n_bases, bases);
+
+			std::vector<int> order;
+			order.reserve(n_bases);
+			std::vector<bool> visited(n_bases, false);
+			std::vector<int> level(n_bases, -1);
+			std::vector<int> component, next;
+
+			for (int seed = 0; seed < n_bases; ++seed)
+			{
+				if (visited[seed])
+					continue;
+
+				const int root = pseudo_peripheral_node(graph, seed, level, component);
+
+				size_t head = order.size();
+				order.push_back(root);
+				visited[root] = true;
+				while (head < order.size())
+				{
+					const int i = order[head++];
+
+					next.clear();
+					for (int n = graph.offsets[i]; n < graph.offsets[i + 1]; ++n)
+					{
+						const int j = graph.neighbors[n];
+						if (!visited[j])
+						{
+							visited[j] = true;
+							next.push_back(j);
+						}
+					}
+					std::stable_sort(next.begin(), next.end(), [&](int a, int b) { return graph.degree(a) < graph.degree(b); });
+					order.insert(order.end(), next.begin(), next.end());
+				}
+			}
+			assert(order.size() == n_bases);
+
+			std::vector<int> old_to_new(n_bases);
+			for (int k = 0; k < n_bases; ++k)
+				old_to_new[order[k]] = n_bases - 1 - k;
+
+			return old_to_new;
+		}
+
+		std::vector<int> morton_ordering(const int n_bases, const std::vector<ElementBases> &bases)
+		{
+			int dim = 0;
+			for (const auto &bs : bases)
+			{
+				if (!bs.bases.empty() && !bs.bases.front().global().empty())
+				{
+					dim = bs.bases.front().global().front().node.size();
+					break;
+				}
+			}
+			assert(dim == 0 || dim == 2 || dim == 3);
+
+			Eigen::MatrixXd positions = Eigen::MatrixXd::Zero(n_bases, std::max(dim, 1));
+			for (const auto &bs : bases)
+				for (const auto &b : bs.bases)
+					for (const auto &lg : b.global())
+						positions.row(lg.index) = lg.node;
+
+			const int bits = dim == 3 ? 21 : 32;
+			const double max_coord = double((uint64_t(1) << bits) - 1);
+			const Eigen::RowVectorXd min_corner = positions.colwise().minCoeff();
+			const Eigen::RowVectorXd extent = positions.colwise().maxCoeff() - min_corner;
+
+			std::vector<uint64_t> keys(n_bases);
+			std::vector<uint32_t> ids(n_bases);
+			maybe_parallel_for(n_bases, [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; ++i)
+				{
+					std::array<uint32_t, 3> coords = {{0, 0, 0}};
+					for (int d = 0; d < dim; ++d)
+					{
+						if (extent(d) > 0)
+							coords[d] = uint32_t((positions(i, d) - min_corner(d)) / extent(d) * max_coord);
+					}
+					keys[i] = interleave_bits(coords, dim, bits);
+					ids[i] = i;
+				}
+			});
+
+			radix_sort(keys, ids);
+
+			std::vector<int> old_to_new(n_bases);
+			for (int k = 0; k < n_bases; ++k)
+				old_to_new[ids[k]] = k;
+
+			return old_to_new;
+		}
+
+		std::vector<int> compute_dof_ordering(const std::string &method, const int n_bases, const std::vector<ElementBases> &bases)
+		{
+			if (method == "rcm")
+				return reverse_cuthill_mckee_ordering(n_bases, bases);
+			else if (method == "morton")
+				return morton_ordering(n_bases, bases);
+
+			log_and_throw_error("Unknown DOF reordering {}", method);
+		}
+
+		void apply_dof_ordering(const std::vector<int> &old_to_new, std::vector<ElementBases> &bases)
+		{
+			maybe_parallel_for(bases.size(), [&](int start, int end, int thread_id) {
+				for (int e = start; e < end; ++e)
+				{
+					for (auto &b : bases[e].bases)
+					{
+						for (auto &lg : b.global())
+						{
+							assert(lg.index >= 0 && lg.index < old_to_new.size());
+							lg.index = old_to_new[lg.index];
+						}
+					}
+				}
+			});
+		}
+	} // namespace basis
+} // namespace polyfem
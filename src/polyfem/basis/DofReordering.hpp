@@ -0,0 +1,53 @@
+#pragma once
+
+#include <polyfem/basis/ElementBases.hpp>
+
+#include <string>
+#include <vector>
+
+namespace polyfem
+{
+	namespace basis
+	{
+		///
+		/// @brief      Computes a bandwidth-reducing numbering of the bases with the reverse
+		///             Cuthill-McKee algorithm on the graph of bases sharing an element.
+		///
+		/// @param[in]  n_bases  The number of bases
+		/// @param[in]  bases    The bases of every element
+		///
+		/// @return     new index of every basis (old_to_new)
+		///
+		std::vector<int> reverse_cuthill_mckee_ordering(const int n_bases, const std::vector<ElementBases> &bases);
+
+		///
+		/// @brief      Computes a numbering of the bases following the Morton (Z-order) curve
+		///             of their node positions.
+		///
+		/// @param[in]  n_bases  The number of bases
+		/// @param[in]  bases    The bases of every element
+		///
+		/// @return     new index of every basis (old_to_new)
+		///
+		std::vector<int> morton_ordering(const int n_bases, const std::vector<ElementBases> &bases);
+
+		///
+		/// @brief      Computes a numbering of the bases with the given method.
+		///
+		/// @param[in]  method   Either "rcm" or "morton"
+		/// @param[in]  n_bases  The number of bases
+		/// @param[in]  bases    The bases of every element
+		///
+		/// @return     new index of every basis (old_to_new)
+		///
+		std::vector<int> compute_dof_ordering(const std::string &method, const int n_bases, const std::vector<ElementBases> &bases);
+
+		///
+		/// @brief      Renumbers the global indices of all bases.
+		///
+		/// @param[in]  old_to_new  New index of every basis, must be a permutation
+		/// @param[in,out] bases    The bases of every element
+		///
+		void apply_dof_ordering(const std::vector<int> &old_to_new, std::vector<ElementBases> &bases);
+	} // namespace basis
+} // namespace polyfem
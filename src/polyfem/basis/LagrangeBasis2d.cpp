@@ -180,7 +180,9 @@ namespace
 		return l2g;
 	}
 
-	void tri_local_to_global(const bool is_geom_bases, const int p, const Mesh2D &mesh, int f, const Eigen::VectorXi &discr_order, const Eigen::VectorXi &edge_orders, std::vector<int> &res, MeshNodes &nodes, std::vector<std::vector<int>> &edge_virtual_nodes)
+	// Nodes is MeshNodes or one of the two-phase replacements MeshNodesRecorder and MeshNodesLookup
+	template <typename Nodes>
+	void tri_local_to_global(const bool is_geom_bases, const int p, const Mesh2D &mesh, int f, const Eigen::VectorXi &discr_order, const Eigen::VectorXi &edge_orders, std::vector<int> &res, Nodes &nodes, std::vector<std::vector<int>> &edge_virtual_nodes)
 	{
 		int edge_offset = mesh.n_vertices();
 		int face_offset = edge_offset + mesh.n_edges();
@@ -309,7 +311,8 @@ namespace
 		// return res;
 	}
 
-	void quad_local_to_global(const bool serendipity, const int q, const Mesh2D &mesh, int f, const Eigen::VectorXi &discr_order, std::vector<int> &res, MeshNodes &nodes)
+	template <typename Nodes>
+	void quad_local_to_global(const bool serendipity, const int q, const Mesh2D &mesh, int f, const Eigen::VectorXi &discr_order, std::vector<int> &res, Nodes &nodes)
 	{
 		int edge_offset = mesh.n_vertices();
 		int face_offset = edge_offset + mesh.n_edges();
@@ -426,64 +429,102 @@ namespace
 			edge_virtual_nodes.resize(ncmesh.n_edges());
 		}
 
-		for (int f = 0; f < mesh.n_faces(); ++f)
-		{
+		const auto element_local_to_global = [&](const int f, std::vector<int> &res, auto &element_nodes) {
 			const int discr_order = discr_orders(f);
 			if (mesh.is_cube(f))
-			{
-				quad_local_to_global(serendipity, discr_order, mesh, f, discr_orders, element_nodes_id[f], nodes);
-
-				LocalBoundary lb(f, BoundaryType::QUAD_LINE);
-
-				auto v = quad_vertices_local_to_global(mesh, f);
-				Eigen::Matrix<int, 4, 2> ev;
-				ev.row(0) << v[0], v[1];
-				ev.row(1) << v[1], v[2];
-				ev.row(2) << v[2], v[3];
-				ev.row(3) << v[3], v[0];
+				quad_local_to_global(serendipity, discr_order, mesh, f, discr_orders, res, element_nodes);
+			else if (mesh.is_simplex(f))
+				tri_local_to_global(is_geom_bases, discr_order, mesh, f, discr_orders, edge_orders, res, element_nodes, edge_virtual_nodes);
+		};
 
-				for (int i = 0; i < int(ev.rows()); ++i)
+		// Non-conforming meshes create virtual nodes and geometric bases do not share nodes, they use the lazy numbering
+		if (mesh.is_conforming() && !is_geom_bases)
+		{
+			// Two-phase numbering: record the requests of every element, create all nodes, then retrieve the ids
+			std::vector<std::vector<NodeRequest>> requests(mesh.n_faces());
+			maybe_parallel_for(mesh.n_faces(), [&](int start, int end, int thread_id) {
+				std::vector<int> placeholders;
+				for (int f = start; f < end; ++f)
 				{
-					const auto index = find_edge(mesh, f, ev(i, 0), ev(i, 1));
-					const int edge = index.edge;
-
-					if (mesh.is_boundary_edge(edge) || mesh.get_boundary_id(edge) > 0)
-					{
-						lb.add_boundary_primitive(edge, i);
-					}
+					MeshNodesRecorder recorder(nodes, requests[f]);
+					placeholders.clear();
+					element_local_to_global(f, placeholders, recorder);
 				}
+			});
 
-				if (!lb.empty())
-					local_boundary.emplace_back(lb);
-			}
-			else if (mesh.is_simplex(f))
+			nodes.assign_requested_nodes(requests);
+
+			maybe_parallel_for(mesh.n_faces(), [&](int start, int end, int thread_id) {
+				MeshNodesLookup lookup(nodes);
+				for (int f = start; f < end; ++f)
+					element_local_to_global(f, element_nodes_id[f], lookup);
+			});
+		}
+		else
+		{
+			for (int f = 0; f < mesh.n_faces(); ++f)
+				element_local_to_global(f, element_nodes_id[f], nodes);
+		}
+
+		std::vector<std::vector<LocalBoundary>> face_local_boundary(mesh.n_faces());
+		maybe_parallel_for(mesh.n_faces(), [&](int start, int end, int thread_id) {
+			for (int f = start; f < end; ++f)
 			{
-				tri_local_to_global(is_geom_bases, discr_order, mesh, f, discr_orders, edge_orders, element_nodes_id[f], nodes, edge_virtual_nodes);
+				if (mesh.is_cube(f))
+				{
+					LocalBoundary lb(f, BoundaryType::QUAD_LINE);
 
-				auto v = tri_vertices_local_to_global(mesh, f);
+					auto v = quad_vertices_local_to_global(mesh, f);
+					Eigen::Matrix<int, 4, 2> ev;
+					ev.row(0) << v[0], v[1];
+					ev.row(1) << v[1], v[2];
+					ev.row(2) << v[2], v[3];
+					ev.row(3) << v[3], v[0];
 
-				Eigen::Matrix<int, 3, 2> ev;
-				ev.row(0) << v[0], v[1];
-				ev.row(1) << v[1], v[2];
-				ev.row(2) << v[2], v[0];
+					for (int i = 0; i < int(ev.rows()); ++i)
+					{
+						const auto index = find_edge(mesh, f, ev(i, 0), ev(i, 1));
+						const int edge = index.edge;
 
-				LocalBoundary lb(f, BoundaryType::TRI_LINE);
+						if (mesh.is_boundary_edge(edge) || mesh.get_boundary_id(edge) > 0)
+						{
+							lb.add_boundary_primitive(edge, i);
+						}
+					}
 
-				for (int i = 0; i < int(ev.rows()); ++i)
+					if (!lb.empty())
+						face_local_boundary[f].emplace_back(lb);
+				}
+				else if (mesh.is_simplex(f))
 				{
-					const auto index = find_edge(mesh, f, ev(i, 0), ev(i, 1));
-					const int edge = index.edge;
+					auto v = tri_vertices_local_to_global(mesh, f);
+
+					Eigen::Matrix<int, 3, 2> ev;
+					ev.row(0) << v[0], v[1];
+					ev.row(1) << v[1], v[2];
+					ev.row(2) << v[2], v[0];
 
-					if (mesh.is_boundary_edge(edge) || mesh.get_boundary_id(edge) > 0)
+					LocalBoundary lb(f, BoundaryType::TRI_LINE);
+
+					for (int i = 0; i < int(ev.rows()); ++i)
 					{
-						lb.add_boundary_primitive(edge, i);
+						const auto index = find_edge(mesh, f, ev(i, 0), ev(i, 1));
+						const int edge = index.edge;
+
+						if (mesh.is_boundary_edge(edge) || mesh.get_boundary_id(edge) > 0)
+						{
+							lb.add_boundary_primitive(edge, i);
+						}
 					}
-				}
 
-				if (!lb.empty())
-					local_boundary.emplace_back(lb);
+					if (!lb.empty())
+						face_local_boundary[f].emplace_back(lb);
+				}
 			}
-		}
+		});
+		for (const auto &lbs : face_local_boundary)
+			for (const auto &lb : lbs)
+				local_boundary.emplace_back(lb);
 
 		if (!has_polys)
 			return;
@@ -735,193 +776,217 @@ int LagrangeBasis2d::build_bases(
 	std::vector<int> interface_elements;
 	interface_elements.reserve(mesh.n_faces());
 
-	for (int e = 0; e < mesh.n_faces(); ++e)
-	{
-		ElementBases &b = bases[e];
-		const int discr_order = discr_orders(e);
-		const int n_el_bases = element_nodes_id[e].size();
-		b.bases.resize(n_el_bases);
+	std::vector<char> is_interface_element(mesh.n_faces(), false);
+	maybe_parallel_for(mesh.n_faces(), [&](int start, int end, int thread_id) {
+		for (int e = start; e < end; ++e)
+		{
+			ElementBases &b = bases[e];
+			const int discr_order = discr_orders(e);
+			const int n_el_bases = element_nodes_id[e].size();
+			b.bases.resize(n_el_bases);
 
-		bool skip_interface_element = false;
+			bool skip_interface_element = false;
 
-		for (int j = 0; j < n_el_bases; ++j)
-		{
-			// mark interface between elements of different order
-			const int global_index = element_nodes_id[e][j];
-			if (global_index < 0)
+			for (int j = 0; j < n_el_bases; ++j)
 			{
-				skip_interface_element = true;
-				break;
+				// mark interface between elements of different order
+				const int global_index = element_nodes_id[e][j];
+				if (global_index < 0)
+				{
+					skip_interface_element = true;
+					break;
+				}
 			}
-		}
-
-		if (skip_interface_element)
-		{
-			interface_elements.push_back(e);
-		}
 
-		if (mesh.is_cube(e))
-		{
-			const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 2);
-			const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 2);
-			b.set_quadrature([real_order](Quadrature &quad) {
-				QuadQuadrature quad_quadrature;
-				quad_quadrature.get_quadrature(real_order, quad);
-			});
-			b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
-				QuadQuadrature quad_quadrature;
-				quad_quadrature.get_quadrature(real_mass_order, quad);
-			});
-			// quad_quadrature.get_quadrature(real_order, b.quadrature);
+			is_interface_element[e] = skip_interface_element;
 
-			b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
-				const auto &mesh2d = dynamic_cast<const Mesh2D &>(mesh);
-				auto index = mesh2d.get_index_from_face(e);
+			if (mesh.is_cube(e))
+			{
+				const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 2);
+				const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 2);
+				b.set_quadrature([real_order](Quadrature &quad) {
+					QuadQuadrature quad_quadrature;
+					quad_quadrature.get_quadrature(real_order, quad);
+				});
+				b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
+					QuadQuadrature quad_quadrature;
+					quad_quadrature.get_quadrature(real_mass_order, quad);
+				});
+				// quad_quadrature.get_quadrature(real_order, b.quadrature);
+
+				b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
+					const auto &mesh2d = dynamic_cast<const Mesh2D &>(mesh);
+					auto index = mesh2d.get_index_from_face(e);
+
+					for (int le = 0; le < mesh2d.n_face_vertices(e); ++le)
+					{
+						if (index.edge == primitive_id)
+							break;
+						index = mesh2d.next_around_face(index);
+					}
+					assert(index.edge == primitive_id);
+					return quad_edge_local_nodes(discr_order, mesh2d, index);
+				});
 
-				for (int le = 0; le < mesh2d.n_face_vertices(e); ++le)
+				for (int j = 0; j < n_el_bases; ++j)
 				{
-					if (index.edge == primitive_id)
-						break;
-					index = mesh2d.next_around_face(index);
-				}
-				assert(index.edge == primitive_id);
-				return quad_edge_local_nodes(discr_order, mesh2d, index);
-			});
-
-			for (int j = 0; j < n_el_bases; ++j)
-			{
-				const int global_index = element_nodes_id[e][j];
+					const int global_index = element_nodes_id[e][j];
 
-				// if(!skip_interface_element)
-				b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
+					// if(!skip_interface_element)
+					b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
 
-				const int dtmp = serendipity ? -2 : discr_order;
+					const int dtmp = serendipity ? -2 : discr_order;
 
-				b.bases[j].set_basis([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_2d(dtmp, j, uv, val); });
-				b.bases[j].set_grad([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_2d(dtmp, j, uv, val); });
+					b.bases[j].set_basis([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_2d(dtmp, j, uv, val); });
+					b.bases[j].set_grad([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_2d(dtmp, j, uv, val); });
+				}
 			}
-		}
-		else if (mesh.is_simplex(e))
-		{
-			const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 2);
-			const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 2);
-			b.set_quadrature([real_order, use_corner_quadrature](Quadrature &quad) {
-				TriQuadrature tri_quadrature(use_corner_quadrature);
-				tri_quadrature.get_quadrature(real_order, quad);
-			});
-			b.set_mass_quadrature([real_mass_order, use_corner_quadrature](Quadrature &quad) {
-				TriQuadrature tri_quadrature(use_corner_quadrature);
-				tri_quadrature.get_quadrature(real_mass_order, quad);
-			});
+			else if (mesh.is_simplex(e))
+			{
+				const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 2);
+				const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 2);
+				b.set_quadrature([real_order, use_corner_quadrature](Quadrature &quad) {
+					TriQuadrature tri_quadrature(use_corner_quadrature);
+					tri_quadrature.get_quadrature(real_order, quad);
+				});
+				b.set_mass_quadrature([real_mass_order, use_corner_quadrature](Quadrature &quad) {
+					TriQuadrature tri_quadrature(use_corner_quadrature);
+					tri_quadrature.get_quadrature(real_mass_order, quad);
+				});
+
+				b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
+					const auto &mesh2d = dynamic_cast<const Mesh2D &>(mesh);
+					auto index = mesh2d.get_index_from_face(e);
+
+					for (int le = 0; le < mesh2d.n_face_vertices(e); ++le)
+					{
+						if (index.edge == primitive_id)
+							break;
+						index = mesh2d.next_around_face(index);
+					}
+					assert(index.edge == primitive_id);
+					return tri_edge_local_nodes(discr_order, mesh2d, index);
+				});
 
-			b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
-				const auto &mesh2d = dynamic_cast<const Mesh2D &>(mesh);
-				auto index = mesh2d.get_index_from_face(e);
+				const bool rational = is_geom_bases && mesh.is_rational() && !mesh.cell_weights(e).empty();
 
-				for (int le = 0; le < mesh2d.n_face_vertices(e); ++le)
+				for (int j = 0; j < n_el_bases; ++j)
 				{
-					if (index.edge == primitive_id)
-						break;
-					index = mesh2d.next_around_face(index);
-				}
-				assert(index.edge == primitive_id);
-				return tri_edge_local_nodes(discr_order, mesh2d, index);
-			});
-
-			const bool rational = is_geom_bases && mesh.is_rational() && !mesh.cell_weights(e).empty();
+					const int global_index = element_nodes_id[e][j];
 
-			for (int j = 0; j < n_el_bases; ++j)
-			{
-				const int global_index = element_nodes_id[e][j];
+					if (!skip_interface_element)
+					{
+						b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
+					}
 
-				if (!skip_interface_element)
-				{
-					b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
-				}
+					if (rational)
+					{
+						const auto &w = mesh.cell_weights(e);
+						assert(discr_order == 2);
+						assert(w.size() == 6);
 
-				if (rational)
-				{
-					const auto &w = mesh.cell_weights(e);
-					assert(discr_order == 2);
-					assert(w.size() == 6);
-
-					b.bases[j].set_basis([bernstein, discr_order, j, w](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) {
-						autogen::p_basis_value_2d(bernstein, discr_order, j, uv, val);
-						Eigen::MatrixXd denom = val;
-						denom.setZero();
-						Eigen::MatrixXd tmp;
+						b.bases[j].set_basis([bernstein, discr_order, j, w](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) {
+							autogen::p_basis_value_2d(bernstein, discr_order, j, uv, val);
+							Eigen::MatrixXd denom = val;
+							denom.setZero();
+							Eigen::MatrixXd tmp;
 
-						for (int k = 0; k < 6; ++k)
-						{
-							autogen::p_basis_value_2d(bernstein, discr_order, k, uv, tmp);
-							denom += w[k] * tmp;
-						}
+							for (int k = 0; k < 6; ++k)
+							{
+								autogen::p_basis_value_2d(bernstein, discr_order, k, uv, tmp);
+								denom += w[k] * tmp;
+							}
 
-						val = (w[j] * val.array() / denom.array()).eval();
-					});
+							val = (w[j] * val.array() / denom.array()).eval();
+						});
 
-					b.bases[j].set_grad([bernstein, discr_order, j, w](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) {
-						Eigen::MatrixXd b;
-						autogen::p_basis_value_2d(bernstein, discr_order, j, uv, b);
-						autogen::p_grad_basis_value_2d(bernstein, discr_order, j, uv, val);
-						Eigen::MatrixXd denom = b;
-						denom.setZero();
-						Eigen::MatrixXd denom_prime = val;
-						denom_prime.setZero();
-						Eigen::MatrixXd tmp;
+						b.bases[j].set_grad([bernstein, discr_order, j, w](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) {
+							Eigen::MatrixXd b;
+							autogen::p_basis_value_2d(bernstein, discr_order, j, uv, b);
+							autogen::p_grad_basis_value_2d(bernstein, discr_order, j, uv, val);
+							Eigen::MatrixXd denom = b;
+							denom.setZero();
+							Eigen::MatrixXd denom_prime = val;
+							denom_prime.setZero();
+							Eigen::MatrixXd tmp;
 
-						for (int k = 0; k < 6; ++k)
-						{
-							autogen::p_basis_value_2d(bernstein, discr_order, k, uv, tmp);
-							denom += w[k] * tmp;
+							for (int k = 0; k < 6; ++k)
+							{
+								autogen::p_basis_value_2d(bernstein, discr_order, k, uv, tmp);
+								denom += w[k] * tmp;
 
-							autogen::p_grad_basis_value_2d(bernstein, discr_order, k, uv, tmp);
-							denom_prime += w[k] * tmp;
-						}
+								autogen::p_grad_basis_value_2d(bernstein, discr_order, k, uv, tmp);
+								denom_prime += w[k] * tmp;
+							}
 
-						val.col(0) = ((w[j] * val.col(0).array() * denom.array() - w[j] * b.array() * denom_prime.col(0).array()) / (denom.array() * denom.array())).eval();
-						val.col(1) = ((w[j] * val.col(1).array() * denom.array() - w[j] * b.array() * denom_prime.col(1).array()) / (denom.array() * denom.array())).eval();
-					});
+							val.col(0) = ((w[j] * val.col(0).array() * denom.array() - w[j] * b.array() * denom_prime.col(0).array()) / (denom.array() * denom.array())).eval();
+							val.col(1) = ((w[j] * val.col(1).array() * denom.array() - w[j] * b.array() * denom_prime.col(1).array()) / (denom.array() * denom.array())).eval();
+						});
+					}
+					else
+					{
+						// pick out basis functions using autogenerated code
+						b.bases[j].set_basis([bernstein, discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_basis_value_2d(bernstein, discr_order, j, uv, val); });
+						b.bases[j].set_grad([bernstein, discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_grad_basis_value_2d(bernstein, discr_order, j, uv, val); });
+					}
 				}
-				else
+
+				if (!rational)
 				{
-					// pick out basis functions using autogenerated code
-					b.bases[j].set_basis([bernstein, discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_basis_value_2d(bernstein, discr_order, j, uv, val); });
-					b.bases[j].set_grad([bernstein, discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_grad_basis_value_2d(bernstein, discr_order, j, uv, val); });
+					// evaluate all the bases of the element in one pass
+					b.set_bases_func([bernstein, discr_order](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
+						Eigen::MatrixXd tmp;
+						autogen::p_tabulate_basis_value_2d(bernstein, discr_order, uv, tmp);
+						val.resize(tmp.cols());
+						for (size_t i = 0; i < val.size(); ++i)
+							val[i].val = tmp.col(i);
+					});
+					b.set_grads_func([bernstein, discr_order](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
+						Eigen::MatrixXd tmp;
+						autogen::p_tabulate_grad_basis_value_2d(bernstein, discr_order, uv, tmp);
+						val.resize(tmp.cols() / 2);
+						for (size_t i = 0; i < val.size(); ++i)
+							val[i].grad = tmp.middleCols(i * 2, 2);
+					});
 				}
 			}
-		}
-		else
-		{
-			// Polygon bases are built later on
-		}
-
-#ifndef NDEBUG
-		if (mesh.is_conforming())
-		{
-			Eigen::MatrixXd uv(4, 2);
-			uv << 0.1, 0.1, 0.3, 0.3, 0.9, 0.01, 0.01, 0.9;
-			Eigen::MatrixXd dx(4, 1);
-			dx.setConstant(1e-6);
-			Eigen::MatrixXd uvdx = uv;
-			uvdx.col(0) += dx;
-			Eigen::MatrixXd uvdy = uv;
-			uvdy.col(1) += dx;
-			Eigen::MatrixXd grad, val, vdx, vdy;
+			else
+			{
+				// Polygon bases are built later on
+			}
 
-			for (int j = 0; j < n_el_bases; ++j)
+	#ifndef NDEBUG
+			if (mesh.is_conforming())
 			{
-				b.bases[j].eval_grad(uv, grad);
+				Eigen::MatrixXd uv(4, 2);
+				uv << 0.1, 0.1, 0.3, 0.3, 0.9, 0.01, 0.01, 0.9;
+				Eigen::MatrixXd dx(4, 1);
+				dx.setConstant(1e-6);
+				Eigen::MatrixXd uvdx = uv;
+				uvdx.col(0) += dx;
+				Eigen::MatrixXd uvdy = uv;
+				uvdy.col(1) += dx;
+				Eigen::MatrixXd grad, val, vdx, vdy;
+
+				for (int j = 0; j < n_el_bases; ++j)
+				{
+					b.bases[j].eval_grad(uv, grad);
 
-				b.bases[j].eval_basis(uv, val);
-				b.bases[j].eval_basis(uvdx, vdx);
-				b.bases[j].eval_basis(uvdy, vdy);
+					b.bases[j].eval_basis(uv, val);
+					b.bases[j].eval_basis(uvdx, vdx);
+					b.bases[j].eval_basis(uvdy, vdy);
 
-				assert((grad.col(0) - (vdx - val) / 1e-6).norm() < 1e-4);
-				assert((grad.col(1) - (vdy - val) / 1e-6).norm() < 1e-4);
+					assert((grad.col(0) - (vdx - val) / 1e-6).norm() < 1e-4);
+					assert((grad.col(1) - (vdy - val) / 1e-6).norm() < 1e-4);
+				}
 			}
+	#endif
 		}
-#endif
+	});
+	for (int e = 0; e < mesh.n_faces(); ++e)
+	{
+		if (is_interface_element[e])
+			interface_elements.push_back(e);
 	}
 
 	if (!is_geom_bases)
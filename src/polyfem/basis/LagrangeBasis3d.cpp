@@ -200,7 +200,9 @@ namespace
 		return elem;
 	}
 
-	void tet_local_to_global(const bool is_geom_bases, const int p, const Mesh3D &mesh, int c, const Eigen::VectorXi &discr_order, const Eigen::VectorXi &edge_orders, const Eigen::VectorXi &face_orders, std::vector<int> &res, polyfem::mesh::MeshNodes &nodes, std::vector<std::vector<int>> &edge_virtual_nodes, std::vector<std::vector<int>> &face_virtual_nodes)
+	// Nodes is MeshNodes or one of the two-phase replacements MeshNodesRecorder and MeshNodesLookup
+	template <typename Nodes>
+	void tet_local_to_global(const bool is_geom_bases, const int p, const Mesh3D &mesh, int c, const Eigen::VectorXi &discr_order, const Eigen::VectorXi &edge_orders, const Eigen::VectorXi &face_orders, std::vector<int> &res, Nodes &nodes, std::vector<std::vector<int>> &edge_virtual_nodes, std::vector<std::vector<int>> &face_virtual_nodes)
 	{
 		const int n_edge_nodes = p > 1 ? ((p - 1) * 6) : 0;
 		const int nn = p > 2 ? (p - 2) : 0;
@@ -396,7 +398,8 @@ namespace
 		assert(res.size() == size_t(4 + n_edge_nodes + n_face_nodes + n_cell_nodes));
 	}
 
-	void hex_local_to_global(const bool serendipity, const int q, const Mesh3D &mesh, int c, const Eigen::VectorXi &discr_order, std::vector<int> &res, MeshNodes &nodes)
+	template <typename Nodes>
+	void hex_local_to_global(const bool serendipity, const int q, const Mesh3D &mesh, int c, const Eigen::VectorXi &discr_order, std::vector<int> &res, Nodes &nodes)
 	{
 		assert(mesh.is_cube(c));
 
@@ -530,6 +533,7 @@ namespace
 	///
 	/// @param[in]  mesh               The input mesh
 	/// @param[in]  discr_order        The discretization order
+	/// @param[in]  lazy_node_numbering Number the nodes serially instead of the two-phase numbering
 	/// @param[in]  nodes              Lazy evaluator for node ids
 	/// @param[out] element_nodes_id   List of node indices per element
 	/// @param[out] local_boundary     Which facet of the element are on the boundary
@@ -543,6 +547,7 @@ namespace
 		const bool serendipity,
 		const bool has_polys,
 		const bool is_geom_bases,
+		const bool lazy_node_numbering,
 		MeshNodes &nodes,
 		std::vector<std::vector<int>> &edge_virtual_nodes,
 		std::vector<std::vector<int>> &face_virtual_nodes,
@@ -562,64 +567,100 @@ namespace
 			face_virtual_nodes.resize(ncmesh.n_faces());
 		}
 
-		for (int c = 0; c < mesh.n_cells(); ++c)
-		{
+		const auto element_local_to_global = [&](const int c, std::vector<int> &res, auto &element_nodes) {
 			const int discr_order = discr_orders(c);
-
 			if (mesh.is_cube(c))
-			{
-				hex_local_to_global(serendipity, discr_order, mesh, c, discr_orders, element_nodes_id[c], nodes);
-
-				auto v = hex_vertices_local_to_global(mesh, c);
-				Eigen::Matrix<int, 6, 4> fv;
-				fv.row(0) << v[0], v[3], v[4], v[7];
-				fv.row(1) << v[1], v[2], v[5], v[6];
-				fv.row(2) << v[0], v[1], v[5], v[4];
-				fv.row(3) << v[3], v[2], v[6], v[7];
-				fv.row(4) << v[0], v[1], v[2], v[3];
-				fv.row(5) << v[4], v[5], v[6], v[7];
-
-				LocalBoundary lb(c, BoundaryType::QUAD);
-				for (int i = 0; i < fv.rows(); ++i)
-				{
-					const int f = find_quad_face(mesh, c, fv(i, 0), fv(i, 1), fv(i, 2), fv(i, 3)).face;
+				hex_local_to_global(serendipity, discr_order, mesh, c, discr_orders, res, element_nodes);
+			else if (mesh.is_simplex(c))
+				tet_local_to_global(is_geom_bases, discr_order, mesh, c, discr_orders, edge_orders, face_orders, res, element_nodes, edge_virtual_nodes, face_virtual_nodes);
+		};
 
-					if (mesh.is_boundary_face(f) || mesh.get_boundary_id(f) > 0)
-					{
-						lb.add_boundary_primitive(f, i);
-					}
+		// Non-conforming meshes create virtual nodes and geometric bases do not share nodes, they use the lazy numbering
+		if (mesh.is_conforming() && !is_geom_bases && !lazy_node_numbering)
+		{
+			// Two-phase numbering: record the requests of every element, create all nodes, then retrieve the ids
+			std::vector<std::vector<NodeRequest>> requests(mesh.n_cells());
+			polyfem::utils::maybe_parallel_for(mesh.n_cells(), [&](int start, int end, int thread_id) {
+				std::vector<int> placeholders;
+				for (int c = start; c < end; ++c)
+				{
+					MeshNodesRecorder recorder(nodes, requests[c]);
+					placeholders.clear();
+					element_local_to_global(c, placeholders, recorder);
 				}
+			});
 
-				if (!lb.empty())
-					local_boundary.emplace_back(lb);
-			}
-			else if (mesh.is_simplex(c))
+			nodes.assign_requested_nodes(requests);
+
+			polyfem::utils::maybe_parallel_for(mesh.n_cells(), [&](int start, int end, int thread_id) {
+				MeshNodesLookup lookup(nodes);
+				for (int c = start; c < end; ++c)
+					element_local_to_global(c, element_nodes_id[c], lookup);
+			});
+		}
+		else
+		{
+			for (int c = 0; c < mesh.n_cells(); ++c)
+				element_local_to_global(c, element_nodes_id[c], nodes);
+		}
+
+		std::vector<std::vector<LocalBoundary>> cell_local_boundary(mesh.n_cells());
+		polyfem::utils::maybe_parallel_for(mesh.n_cells(), [&](int start, int end, int thread_id) {
+			for (int c = start; c < end; ++c)
 			{
-				// element_nodes_id[c] = polyfem::LagrangeBasis3d::tet_local_to_global(discr_order, mesh, c, discr_orders, nodes);
-				tet_local_to_global(is_geom_bases, discr_order, mesh, c, discr_orders, edge_orders, face_orders, element_nodes_id[c], nodes, edge_virtual_nodes, face_virtual_nodes);
-
-				auto v = tet_vertices_local_to_global(mesh, c);
-				Eigen::Matrix<int, 4, 3> fv;
-				fv.row(0) << v[0], v[1], v[2];
-				fv.row(1) << v[0], v[1], v[3];
-				fv.row(2) << v[1], v[2], v[3];
-				fv.row(3) << v[2], v[0], v[3];
-
-				LocalBoundary lb(c, BoundaryType::TRI);
-				for (long i = 0; i < fv.rows(); ++i)
+				if (mesh.is_cube(c))
 				{
-					const int f = mesh.get_index_from_element_face(c, fv(i, 0), fv(i, 1), fv(i, 2)).face;
-
-					if (mesh.is_boundary_face(f))
+					auto v = hex_vertices_local_to_global(mesh, c);
+					Eigen::Matrix<int, 6, 4> fv;
+					fv.row(0) << v[0], v[3], v[4], v[7];
+					fv.row(1) << v[1], v[2], v[5], v[6];
+					fv.row(2) << v[0], v[1], v[5], v[4];
+					fv.row(3) << v[3], v[2], v[6], v[7];
+					fv.row(4) << v[0], v[1], v[2], v[3];
+					fv.row(5) << v[4], v[5], v[6], v[7];
+
+					LocalBoundary lb(c, BoundaryType::QUAD);
+					for (int i = 0; i < fv.rows(); ++i)
 					{
-						lb.add_boundary_primitive(f, i);
+						const int f = find_quad_face(mesh, c, fv(i, 0), fv(i, 1), fv(i, 2), fv(i, 3)).face;
+
+						if (mesh.is_boundary_face(f) || mesh.get_boundary_id(f) > 0)
+						{
+							lb.add_boundary_primitive(f, i);
+						}
 					}
+
+					if (!lb.empty())
+						cell_local_boundary[c].emplace_back(lb);
 				}
+				else if (mesh.is_simplex(c))
+				{
+					auto v = tet_vertices_local_to_global(mesh, c);
+					Eigen::Matrix<int, 4, 3> fv;
+					fv.row(0) << v[0], v[1], v[2];
+					fv.row(1) << v[0], v[1], v[3];
+					fv.row(2) << v[1], v[2], v[3];
+					fv.row(3) << v[2], v[0], v[3];
+
+					LocalBoundary lb(c, BoundaryType::TRI);
+					for (long i = 0; i < fv.rows(); ++i)
+					{
+						const int f = mesh.get_index_from_element_face(c, fv(i, 0), fv(i, 1), fv(i, 2)).face;
+
+						if (mesh.is_boundary_face(f))
+						{
+							lb.add_boundary_primitive(f, i);
+						}
+					}
 
-				if (!lb.empty())
-					local_boundary.emplace_back(lb);
+					if (!lb.empty())
+						cell_local_boundary[c].emplace_back(lb);
+				}
 			}
-		}
+		});
+		for (const auto &lbs : cell_local_boundary)
+			for (const auto &lb : lbs)
+				local_boundary.emplace_back(lb);
 
 		if (!has_polys)
 			return;
@@ -1383,12 +1424,13 @@ int LagrangeBasis3d::build_bases(
 	std::vector<ElementBases> &bases,
 	std::vector<LocalBoundary> &local_boundary,
 	std::map<int, InterfaceData> &poly_face_to_data,
-	std::shared_ptr<MeshNodes> &mesh_nodes)
+	std::shared_ptr<MeshNodes> &mesh_nodes,
+	const bool lazy_node_numbering)
 {
 	Eigen::VectorXi discr_orders(mesh.n_cells());
 	discr_orders.setConstant(discr_order);
 
-	return build_bases(mesh, assembler, quadrature_order, mass_quadrature_order, discr_orders, bernstein, serendipity, has_polys, is_geom_bases, use_corner_quadrature, bases, local_boundary, poly_face_to_data, mesh_nodes);
+	return build_bases(mesh, assembler, quadrature_order, mass_quadrature_order, discr_orders, bernstein, serendipity, has_polys, is_geom_bases, use_corner_quadrature, bases, local_boundary, poly_face_to_data, mesh_nodes, lazy_node_numbering);
 }
 
 int LagrangeBasis3d::build_bases(
@@ -1405,7 +1447,8 @@ int LagrangeBasis3d::build_bases(
 	std::vector<ElementBases> &bases,
 	std::vector<LocalBoundary> &local_boundary,
 	std::map<int, InterfaceData> &poly_face_to_data,
-	std::shared_ptr<MeshNodes> &mesh_nodes)
+	std::shared_ptr<MeshNodes> &mesh_nodes,
+	const bool lazy_node_numbering)
 {
 	assert(mesh.is_volume());
 	assert(discr_orders.size() == mesh.n_cells());
@@ -1433,7 +1476,7 @@ int LagrangeBasis3d::build_bases(
 	mesh_nodes = std::make_shared<MeshNodes>(mesh, has_polys, !is_geom_bases, nn, n_face_nodes * (is_geom_bases ? 2 : 1), max_p == 0 ? 1 : n_cells_nodes);
 	MeshNodes &nodes = *mesh_nodes;
 	std::vector<std::vector<int>> element_nodes_id, edge_virtual_nodes, face_virtual_nodes;
-	compute_nodes(mesh, discr_orders, edge_orders, face_orders, serendipity, has_polys, is_geom_bases, nodes, edge_virtual_nodes, face_virtual_nodes, element_nodes_id, local_boundary, poly_face_to_data);
+	compute_nodes(mesh, discr_orders, edge_orders, face_orders, serendipity, has_polys, is_geom_bases, lazy_node_numbering, nodes, edge_virtual_nodes, face_virtual_nodes, element_nodes_id, local_boundary, poly_face_to_data);
 	// boundary_nodes = nodes.boundary_nodes();
 
 	// std::cout<<"get_index_from_element_face_time " << Navigation3D::get_index_from_element_face_time <<std::endl;
@@ -1446,117 +1489,138 @@ int LagrangeBasis3d::build_bases(
 	std::vector<int> interface_elements;
 	interface_elements.reserve(mesh.n_faces());
 
-	for (int e = 0; e < mesh.n_cells(); ++e)
-	{
-		ElementBases &b = bases[e];
-		const int discr_order = discr_orders(e);
-		const int n_el_bases = (int)element_nodes_id[e].size();
-		b.bases.resize(n_el_bases);
+	std::vector<char> is_interface_element(mesh.n_cells(), false);
+	polyfem::utils::maybe_parallel_for(mesh.n_cells(), [&](int start, int end, int thread_id) {
+		for (int e = start; e < end; ++e)
+		{
+			ElementBases &b = bases[e];
+			const int discr_order = discr_orders(e);
+			const int n_el_bases = (int)element_nodes_id[e].size();
+			b.bases.resize(n_el_bases);
 
-		bool skip_interface_element = false;
+			bool skip_interface_element = false;
 
-		for (int j = 0; j < n_el_bases; ++j)
-		{
-			const int global_index = element_nodes_id[e][j];
-			if (global_index < 0)
+			for (int j = 0; j < n_el_bases; ++j)
 			{
-				skip_interface_element = true;
-				break;
+				const int global_index = element_nodes_id[e][j];
+				if (global_index < 0)
+				{
+					skip_interface_element = true;
+					break;
+				}
 			}
-		}
 
-		if (skip_interface_element)
-		{
-			interface_elements.push_back(e);
-		}
+			is_interface_element[e] = skip_interface_element;
 
-		if (mesh.is_cube(e))
-		{
-			const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
-			const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
-			b.set_quadrature([real_order](Quadrature &quad) {
-				HexQuadrature hex_quadrature;
-				hex_quadrature.get_quadrature(real_order, quad);
-			});
-			b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
-				HexQuadrature hex_quadrature;
-				hex_quadrature.get_quadrature(real_mass_order, quad);
-			});
+			if (mesh.is_cube(e))
+			{
+				const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
+				const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
+				b.set_quadrature([real_order](Quadrature &quad) {
+					HexQuadrature hex_quadrature;
+					hex_quadrature.get_quadrature(real_order, quad);
+				});
+				b.set_mass_quadrature([real_mass_order](Quadrature &quad) {
+					HexQuadrature hex_quadrature;
+					hex_quadrature.get_quadrature(real_mass_order, quad);
+				});
 
-			b.set_local_node_from_primitive_func([serendipity, discr_order, e](const int primitive_id, const Mesh &mesh) {
-				const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
-				Navigation3D::Index index;
+				b.set_local_node_from_primitive_func([serendipity, discr_order, e](const int primitive_id, const Mesh &mesh) {
+					const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
+					Navigation3D::Index index;
 
-				for (int lf = 0; lf < 6; ++lf)
-				{
-					index = mesh3d.get_index_from_element(e, lf, 0);
-					if (index.face == primitive_id)
-						break;
-				}
-				assert(index.face == primitive_id);
-				return hex_face_local_nodes(serendipity, discr_order, mesh3d, index);
-			});
+					for (int lf = 0; lf < 6; ++lf)
+					{
+						index = mesh3d.get_index_from_element(e, lf, 0);
+						if (index.face == primitive_id)
+							break;
+					}
+					assert(index.face == primitive_id);
+					return hex_face_local_nodes(serendipity, discr_order, mesh3d, index);
+				});
 
-			for (int j = 0; j < n_el_bases; ++j)
-			{
-				const int global_index = element_nodes_id[e][j];
+				for (int j = 0; j < n_el_bases; ++j)
+				{
+					const int global_index = element_nodes_id[e][j];
 
-				b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
+					b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
 
-				const int dtmp = serendipity ? -2 : discr_order;
+					const int dtmp = serendipity ? -2 : discr_order;
 
-				b.bases[j].set_basis([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_3d(dtmp, j, uv, val); });
-				b.bases[j].set_grad([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_3d(dtmp, j, uv, val); });
+					b.bases[j].set_basis([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_basis_value_3d(dtmp, j, uv, val); });
+					b.bases[j].set_grad([dtmp, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::q_grad_basis_value_3d(dtmp, j, uv, val); });
+				}
 			}
-		}
-		else if (mesh.is_simplex(e))
-		{
-			const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 3);
-			const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 3);
+			else if (mesh.is_simplex(e))
+			{
+				const int real_order = quadrature_order > 0 ? quadrature_order : AssemblerUtils::quadrature_order(assembler, discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 3);
+				const int real_mass_order = mass_quadrature_order > 0 ? mass_quadrature_order : AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::SIMPLEX_LAGRANGE, 3);
 
-			b.set_quadrature([real_order, use_corner_quadrature](Quadrature &quad) {
-				TetQuadrature tet_quadrature(use_corner_quadrature);
-				tet_quadrature.get_quadrature(real_order, quad);
-			});
-			b.set_mass_quadrature([real_mass_order, use_corner_quadrature](Quadrature &quad) {
-				TetQuadrature tet_quadrature(use_corner_quadrature);
-				tet_quadrature.get_quadrature(real_mass_order, quad);
-			});
+				b.set_quadrature([real_order, use_corner_quadrature](Quadrature &quad) {
+					TetQuadrature tet_quadrature(use_corner_quadrature);
+					tet_quadrature.get_quadrature(real_order, quad);
+				});
+				b.set_mass_quadrature([real_mass_order, use_corner_quadrature](Quadrature &quad) {
+					TetQuadrature tet_quadrature(use_corner_quadrature);
+					tet_quadrature.get_quadrature(real_mass_order, quad);
+				});
 
-			b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
-				const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
-				Navigation3D::Index index;
+				b.set_local_node_from_primitive_func([discr_order, e](const int primitive_id, const Mesh &mesh) {
+					const auto &mesh3d = dynamic_cast<const Mesh3D &>(mesh);
+					Navigation3D::Index index;
 
-				for (int lf = 0; lf < mesh3d.n_cell_faces(e); ++lf)
-				{
-					index = mesh3d.get_index_from_element(e, lf, 0);
-					if (index.face == primitive_id)
-						break;
-				}
-				assert(index.face == primitive_id);
-				return tet_face_local_nodes(discr_order, mesh3d, index);
-			});
+					for (int lf = 0; lf < mesh3d.n_cell_faces(e); ++lf)
+					{
+						index = mesh3d.get_index_from_element(e, lf, 0);
+						if (index.face == primitive_id)
+							break;
+					}
+					assert(index.face == primitive_id);
+					return tet_face_local_nodes(discr_order, mesh3d, index);
+				});
 
-			const bool rational = is_geom_bases && mesh.is_rational() && !mesh.cell_weights(e).empty();
-			assert(!rational);
+				const bool rational = is_geom_bases && mesh.is_rational() && !mesh.cell_weights(e).empty();
+				assert(!rational);
 
-			for (int j = 0; j < n_el_bases; ++j)
-			{
-				const int global_index = element_nodes_id[e][j];
-				if (!skip_interface_element)
+				for (int j = 0; j < n_el_bases; ++j)
 				{
-					b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
+					const int global_index = element_nodes_id[e][j];
+					if (!skip_interface_element)
+					{
+						b.bases[j].init(discr_order, global_index, j, nodes.node_position(global_index));
+					}
+
+					b.bases[j].set_basis([bernstein, discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_basis_value_3d(bernstein, discr_order, j, uv, val); });
+					b.bases[j].set_grad([bernstein, discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_grad_basis_value_3d(bernstein, discr_order, j, uv, val); });
 				}
 
-				b.bases[j].set_basis([bernstein, discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_basis_value_3d(bernstein, discr_order, j, uv, val); });
-				b.bases[j].set_grad([bernstein, discr_order, j](const Eigen::MatrixXd &uv, Eigen::MatrixXd &val) { autogen::p_grad_basis_value_3d(bernstein, discr_order, j, uv, val); });
+				// evaluate all the bases of the element in one pass
+				b.set_bases_func([bernstein, discr_order](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
+					Eigen::MatrixXd tmp;
+					autogen::p_tabulate_basis_value_3d(bernstein, discr_order, uv, tmp);
+					val.resize(tmp.cols());
+					for (size_t i = 0; i < val.size(); ++i)
+						val[i].val = tmp.col(i);
+				});
+				b.set_grads_func([bernstein, discr_order](const Eigen::MatrixXd &uv, std::vector<AssemblyValues> &val) {
+					Eigen::MatrixXd tmp;
+					autogen::p_tabulate_grad_basis_value_3d(bernstein, discr_order, uv, tmp);
+					val.resize(tmp.cols() / 3);
+					for (size_t i = 0; i < val.size(); ++i)
+						val[i].grad = tmp.middleCols(i * 3, 3);
+				});
+			}
+			else
+			{
+				// Polyhedra bases are built later on
+				// assert(false);
 			}
 		}
-		else
-		{
-			// Polyhedra bases are built later on
-			// assert(false);
-		}
+	});
+	for (int e = 0; e < mesh.n_cells(); ++e)
+	{
+		if (is_interface_element[e])
+			interface_elements.push_back(e);
 	}
 
 	if (!is_geom_bases)
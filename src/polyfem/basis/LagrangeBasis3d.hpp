@@ -37,6 +37,8 @@ namespace polyfem
 			///                                the canonical elements lie on the boundary of the mesh
 			/// @param[out] poly_edge_to_data  Data for edges at the interface with a polygon (used to
 			///                                build the harmonics inside polygons)
+			/// @param[in]  lazy_node_numbering Number the nodes serially while visiting the elements instead of
+			///                                the two-phase parallel numbering (same result)
 			///
 			/// @return     The number of basis functions created.
 			///
@@ -54,7 +56,8 @@ namespace polyfem
 				std::vector<ElementBases> &bases,
 				std::vector<mesh::LocalBoundary> &local_boundary,
 				std::map<int, InterfaceData> &poly_face_to_data,
-				std::shared_ptr<mesh::MeshNodes> &mesh_nodes);
+				std::shared_ptr<mesh::MeshNodes> &mesh_nodes,
+				const bool lazy_node_numbering = false);
 
 			///
 			/// @brief      Builds FE basis functions over the entire mesh (P1, P2 over tets, Q1,
@@ -75,6 +78,8 @@ namespace polyfem
 			///                                the canonical elements lie on the boundary of the mesh
 			/// @param[out] poly_edge_to_data  Data for edges at the interface with a polygon (used to
 			///                                build the harmonics inside polygons)
+			/// @param[in]  lazy_node_numbering Number the nodes serially while visiting the elements instead of
+			///                                the two-phase parallel numbering (same result)
 			///
 			/// @return     The number of basis functions created.
 			///
@@ -92,7 +97,8 @@ namespace polyfem
 				std::vector<ElementBases> &bases,
 				std::vector<mesh::LocalBoundary> &local_boundary,
 				std::map<int, InterfaceData> &poly_face_to_data,
-				std::shared_ptr<mesh::MeshNodes> &mesh_nodes);
+				std::shared_ptr<mesh::MeshNodes> &mesh_nodes,
+				const bool lazy_node_numbering = false);
 
 			// return the local faces nodes for a tet or a hex of order p, index points to a face
 			static Eigen::VectorXi tet_face_local_nodes(const int p, const mesh::Mesh3D &mesh, mesh::Navigation3D::Index index);
@@ -2,6 +2,7 @@
 
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/StringUtils.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
 
 #include <mshio/mshio.h>
 
@@ -26,6 +27,19 @@ namespace polyfem::io
 		}
 	}
 
+	namespace
+	{
+		bool is_supported_element(const int type)
+		{
+			const bool is_tri = type == 2 || type == 9 || type == 21 || type == 23 || type == 25;
+			const bool is_quad = type == 3 || type == 10;
+			const bool is_tet = type == 4 || type == 11 || type == 29 || type == 30 || type == 31;
+			const bool is_hex = type == 5 || type == 12;
+
+			return is_tri || is_quad || is_tet || is_hex;
+		}
+	} // namespace
+
 	bool MshReader::load(const std::string &path, Eigen::MatrixXd &vertices, Eigen::MatrixXi &cells, std::vector<std::vector<int>> &elements, std::vector<std::vector<double>> &weights, std::vector<int> &body_ids)
 	{
 		std::vector<std::string> node_data_name;
@@ -35,6 +49,31 @@ namespace polyfem::io
 	}
 
 	bool MshReader::load(const std::string &path, Eigen::MatrixXd &vertices, Eigen::MatrixXi &cells, std::vector<std::vector<int>> &elements, std::vector<std::vector<double>> &weights, std::vector<int> &body_ids, std::vector<std::string> &node_data_name, std::vector<std::vector<double>> &node_data)
+	{
+		std::vector<int> element_nodes, element_offsets;
+		if (!load(path, vertices, cells, element_nodes, element_offsets, body_ids, node_data_name, node_data))
+			return false;
+
+		unflatten_elements(element_nodes, element_offsets, elements);
+		weights.clear();
+		weights.resize(elements.size());
+
+		return true;
+	}
+
+	void MshReader::unflatten_elements(const std::vector<int> &element_nodes, const std::vector<int> &element_offsets, std::vector<std::vector<int>> &elements)
+	{
+		assert(!element_offsets.empty());
+		const int n_elements = element_offsets.size() - 1;
+		elements.resize(n_elements);
+
+		utils::maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
+			for (int e = start; e < end; ++e)
+				elements[e].assign(element_nodes.begin() + element_offsets[e], element_nodes.begin() + element_offsets[e + 1]);
+		});
+	}
+
+	bool MshReader::load(const std::string &path, Eigen::MatrixXd &vertices, Eigen::MatrixXi &cells, std::vector<int> &element_nodes, std::vector<int> &element_offsets, std::vector<int> &body_ids, std::vector<std::string> &node_data_name, std::vector<std::vector<double>> &node_data)
 	{
 		if (!std::filesystem::exists(path))
 		{
@@ -58,8 +97,8 @@ namespace polyfem::io
 			return false;
 		}
 
-		const auto &nodes = spec.nodes;
-		const auto &els = spec.elements;
+		auto &nodes = spec.nodes;
+		auto &els = spec.elements;
 		const int n_vertices = nodes.num_nodes;
 		const int max_tag = nodes.max_node_tag;
 		int dim = -1;
@@ -76,25 +115,33 @@ namespace polyfem::io
 		if (n_vertices != max_tag)
 			logger().warn("MSH file contains more node tags than nodes, condensing nodes which will break input node ordering.");
 
-		int index = 0;
-		for (const auto &n : nodes.entity_blocks)
+		// Each node block is copied in parallel, the output position of a
+		// condensed node is given by the number of nodes in the previous blocks.
+		int block_start = 0;
+		for (auto &n : nodes.entity_blocks)
 		{
-			for (int i = 0; i < n.num_nodes_in_block * 3; i += 3)
-			{
-				const int node_id = n_vertices != max_tag ? (index++) : (n.tags[i / 3] - 1);
+			utils::maybe_parallel_for(n.num_nodes_in_block, [&](int start, int end, int thread_id) {
+				for (int k = start; k < end; ++k)
+				{
+					const int node_id = n_vertices != max_tag ? (block_start + k) : (n.tags[k] - 1);
 
-				if (dim == 2)
-					vertices.row(node_id) << n.data[i], n.data[i + 1];
-				if (dim == 3)
-					vertices.row(node_id) << n.data[i], n.data[i + 1], n.data[i + 2];
+					for (int d = 0; d < dim; ++d)
+						vertices(node_id, d) = n.data[3 * k + d];
 
-				assert(n.tags[i / 3] < tag_to_index.size());
-				tag_to_index[n.tags[i / 3]] = node_id;
-			}
+					assert(n.tags[k] < tag_to_index.size());
+					tag_to_index[n.tags[k]] = node_id;
+				}
+			});
+			block_start += n.num_nodes_in_block;
+
+			// Release the block as soon as it has been consumed to keep the peak memory low
+			std::vector<size_t>().swap(n.tags);
+			std::vector<double>().swap(n.data);
 		}
 
 		int cells_cols = -1;
 		int num_els = 0;
+		size_t num_nodes = 0;
 		for (const auto &e : els.entity_blocks)
 		{
 			if (e.entity_dim != dim)
@@ -105,26 +152,27 @@ namespace polyfem::io
 			{
 				assert(cells_cols == -1 || cells_cols == 3);
 				cells_cols = 3;
-				num_els += e.num_elements_in_block;
 			}
 			else if (type == 3 || type == 10) // quad
 			{
 				assert(cells_cols == -1 || cells_cols == 4);
 				cells_cols = 4;
-				num_els += e.num_elements_in_block;
 			}
 			else if (type == 4 || type == 11 || type == 29 || type == 30 || type == 31) // tet
 			{
 				assert(cells_cols == -1 || cells_cols == 4);
 				cells_cols = 4;
-				num_els += e.num_elements_in_block;
 			}
 			else if (type == 5 || type == 12) // hex
 			{
 				assert(cells_cols == -1 || cells_cols == 8);
 				cells_cols = 8;
-				num_els += e.num_elements_in_block;
 			}
+			else
+				continue;
+
+			num_els += e.num_elements_in_block;
+			num_nodes += e.num_elements_in_block * mshio::nodes_per_element(type);
 		}
 		assert(cells_cols > 0);
 
@@ -136,42 +184,51 @@ namespace polyfem::io
 
 		cells.resize(num_els, cells_cols);
 		body_ids.resize(num_els);
-		elements.resize(num_els);
-		weights.resize(num_els);
-		int cell_index = 0;
-		for (const auto &e : els.entity_blocks)
+		element_nodes.resize(num_nodes);
+		element_offsets.resize(num_els + 1);
+		element_offsets[0] = 0;
+
+		// Elements in a block all have the same number of nodes, so the output
+		// location of every element is known upfront and blocks can be filled in parallel.
+		int cell_start = 0;
+		size_t node_start = 0;
+		for (auto &e : els.entity_blocks)
 		{
-			if (e.entity_dim != dim)
+			if (e.entity_dim != dim || !is_supported_element(e.element_type))
 				continue;
-			const int type = e.element_type;
-			if (type == 2 || type == 9 || type == 21 || type == 23 || type == 25 || type == 3 || type == 10 || type == 4 || type == 11 || type == 29 || type == 30 || type == 31 || type == 5 || type == 12)
-			{
-				const size_t n_nodes = mshio::nodes_per_element(type);
-				for (int i = 0; i < e.data.size(); i += (n_nodes + 1))
+
+			const int n_nodes = mshio::nodes_per_element(e.element_type);
+			const auto &it = entity_tag_to_physical_tag.find(e.entity_tag);
+			const int body_id = it != entity_tag_to_physical_tag.end() ? it->second : 0;
+
+			utils::maybe_parallel_for(e.num_elements_in_block, [&](int start, int end, int thread_id) {
+				for (int k = start; k < end; ++k)
 				{
-					int index = 0;
-					for (int j = i + 1; j <= i + cells_cols; ++j)
-					{
-						const int v_index = tag_to_index[e.data[j]];
-						assert(v_index < n_vertices);
-						cells(cell_index, index++) = v_index;
-					}
+					const int cell_index = cell_start + k;
+					const size_t *data = e.data.data() + k * (n_nodes + 1) + 1;
+					int *out = element_nodes.data() + node_start + k * n_nodes;
 
-					for (int j = i + 1; j < i + 1 + n_nodes; ++j)
+					for (int j = 0; j < n_nodes; ++j)
 					{
-						const int v_index = tag_to_index[e.data[j]];
-						assert(v_index < n_vertices);
-						elements[cell_index].push_back(v_index);
+						const int v_index = tag_to_index[data[j]];
+						assert(v_index >= 0 && v_index < n_vertices);
+						out[j] = v_index;
+						if (j < cells_cols)
+							cells(cell_index, j) = v_index;
 					}
 
-					const auto &it = entity_tag_to_physical_tag.find(e.entity_tag);
-					body_ids[cell_index] =
-						it != entity_tag_to_physical_tag.end() ? it->second : 0;
-
-					++cell_index;
+					element_offsets[cell_index + 1] = node_start + (k + 1) * n_nodes;
+					body_ids[cell_index] = body_id;
 				}
-			}
+			});
+
+			cell_start += e.num_elements_in_block;
+			node_start += e.num_elements_in_block * n_nodes;
+
+			std::vector<size_t>().swap(e.data);
 		}
+		assert(cell_start == num_els);
+		assert(node_start == num_nodes);
 
 		node_data.resize(spec.node_data.size());
 		int i = 0;
@@ -26,5 +26,39 @@ namespace polyfem::io
 			std::vector<int> &body_ids,
 			std::vector<std::string> &node_data_name,
 			std::vector<std::vector<double>> &node_data);
+
+		/// @brief Load a MSH file into flat (CSR-like) element storage.
+		///
+		/// The nodes of element i are element_nodes[element_offsets[i]] ... element_nodes[element_offsets[i + 1] - 1].
+		/// Blocks are copied in parallel and no per-element allocation is performed.
+		///
+		/// @param[in] path path to the MSH file
+		/// @param[out] vertices all nodes of the mesh
+		/// @param[out] cells linear connectivity (corners only)
+		/// @param[out] element_nodes concatenated list of all the nodes of every element (including high-order nodes)
+		/// @param[out] element_offsets offsets into element_nodes, of size #cells + 1
+		/// @param[out] body_ids physical tag of each element
+		/// @param[out] node_data_name names of the node data fields
+		/// @param[out] node_data values of the node data fields
+		/// @return if success
+		static bool load(
+			const std::string &path,
+			Eigen::MatrixXd &vertices,
+			Eigen::MatrixXi &cells,
+			std::vector<int> &element_nodes,
+			std::vector<int> &element_offsets,
+			std::vector<int> &body_ids,
+			std::vector<std::string> &node_data_name,
+			std::vector<std::vector<double>> &node_data);
+
+		/// @brief Convert flat element storage to a list of nodes per element.
+		///
+		/// @param[in] element_nodes concatenated list of nodes
+		/// @param[in] element_offsets offsets into element_nodes
+		/// @param[out] elements list of nodes per element
+		static void unflatten_elements(
+			const std::vector<int> &element_nodes,
+			const std::vector<int> &element_offsets,
+			std::vector<std::vector<int>> &elements);
 	};
 } // namespace polyfem::io
@@ -2,6 +2,7 @@
 
 #include <polyfem/mesh/Mesh.hpp>
 #include <polyfem/mesh/MeshUtils.hpp>
+#include <polyfem/mesh/mesh3D/CMesh3D.hpp>
 #include <polyfem/io/MshReader.hpp>
 #include <polyfem/utils/StringUtils.hpp>
 
@@ -222,6 +223,16 @@ namespace polyfem::mesh
 
 		// --------------------------------------------------------------------
 
+		if (j_mesh["advanced"]["compressed_storage"].get<bool>())
+		{
+			if (CMesh3D *cmesh = dynamic_cast<CMesh3D *>(mesh.get()))
+				cmesh->set_compressed_storage(true);
+			else
+				logger().warn("Option \"compressed_storage\" is only supported for conforming 3D meshes, ignoring it");
+		}
+
+		// --------------------------------------------------------------------
+
 		return mesh;
 	}
 
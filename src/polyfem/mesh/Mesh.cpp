@@ -194,11 +194,12 @@ namespace polyfem::mesh
 		{
 			Eigen::MatrixXd vertices;
 			Eigen::MatrixXi cells;
-			std::vector<std::vector<int>> elements;
-			std::vector<std::vector<double>> weights;
+			std::vector<int> element_nodes, element_offsets;
 			std::vector<int> body_ids;
+			std::vector<std::string> node_data_name;
+			std::vector<std::vector<double>> node_data;
 
-			if (!MshReader::load(path, vertices, cells, elements, weights, body_ids))
+			if (!MshReader::load(path, vertices, cells, element_nodes, element_offsets, body_ids, node_data_name, node_data))
 			{
 				logger().error("Failed to load MSH mesh: {}", path);
 				return nullptr;
@@ -207,23 +208,17 @@ namespace polyfem::mesh
 			const int dim = vertices.cols();
 			std::unique_ptr<Mesh> mesh = create(vertices, cells, non_conforming);
 
-			// Only tris and tets
-			if ((dim == 2 && cells.cols() == 3) || (dim == 3 && cells.cols() == 4))
+			// Only tris and tets, linear meshes have no extra nodes and are fully described by cells
+			const bool has_high_order_nodes = element_nodes.size() > size_t(cells.size());
+			if (has_high_order_nodes && ((dim == 2 && cells.cols() == 3) || (dim == 3 && cells.cols() == 4)))
 			{
+				std::vector<std::vector<int>> elements;
+				MshReader::unflatten_elements(element_nodes, element_offsets, elements);
 				mesh->attach_higher_order_nodes(vertices, elements);
-				mesh->set_cell_weights(weights);
+				mesh->set_cell_weights(std::vector<std::vector<double>>(elements.size()));
 				// TODO: not clear?
 			}
 
-			for (const auto &w : weights)
-			{
-				if (!w.empty())
-				{
-					mesh->set_is_rational(true);
-					break;
-				}
-			}
-
 			mesh->set_body_ids(body_ids);
 
 			return mesh;
@@ -4,6 +4,8 @@
 #include <polyfem/mesh/mesh2D/NCMesh2D.hpp>
 #include <polyfem/mesh/mesh3D/CMesh3D.hpp>
 #include <polyfem/mesh/mesh3D/NCMesh3D.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/RadixSort.hpp>
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace polyfem::mesh
@@ -231,24 +233,7 @@ namespace polyfem::mesh
 		}
 		else
 		{
-			const auto [v, _] = mesh2d->edge_node(index, n_new_nodes, 1);
-
-			if ((node_position(start_node_id) - v).norm() < 1e-10)
-			{
-				for (int i = 0; i < n_new_nodes; ++i)
-				{
-					const int primitive_id = start + i;
-					res.push_back(primitive_to_node_[primitive_id]);
-				}
-			}
-			else
-			{
-				for (int i = n_new_nodes - 1; i >= 0; --i)
-				{
-					const int primitive_id = start + i;
-					res.push_back(primitive_to_node_[primitive_id]);
-				}
-			}
+			res = existing_edge_node_ids(index, n_new_nodes, start);
 		}
 
 		assert(res.size() == size_t(n_new_nodes));
@@ -287,23 +272,7 @@ namespace polyfem::mesh
 		}
 		else
 		{
-			const auto [v, _] = mesh3d->edge_node(index, n_new_nodes, 1);
-			if ((node_position(start_node_id) - v).norm() < 1e-10)
-			{
-				for (int i = 0; i < n_new_nodes; ++i)
-				{
-					const int primitive_id = start + i;
-					res.push_back(primitive_to_node_[primitive_id]);
-				}
-			}
-			else
-			{
-				for (int i = n_new_nodes - 1; i >= 0; --i)
-				{
-					const int primitive_id = start + i;
-					res.push_back(primitive_to_node_[primitive_id]);
-				}
-			}
+			res = existing_edge_node_ids(index, n_new_nodes, start);
 		}
 
 		assert(res.size() == size_t(n_new_nodes));
@@ -420,36 +389,7 @@ namespace polyfem::mesh
 		}
 		else
 		{
-			if (n_new_nodes == 1)
-			{
-				res.push_back(start_node_id);
-			}
-			else
-			{
-				const int total_nodes = mesh3d->is_simplex(index.element) ? (n_new_nodes * (n_new_nodes + 1) / 2) : (n_new_nodes * n_new_nodes);
-				for (int i = 1; i <= n_new_nodes; ++i)
-				{
-					const int end = mesh3d->is_simplex(index.element) ? (n_new_nodes - i + 1) : n_new_nodes;
-					for (int j = 1; j <= end; ++j)
-					{
-						const auto [p, _] = mesh3d->face_node(index, n_new_nodes, i, j);
-
-						bool found = false;
-						for (int k = start; k < start + total_nodes; ++k)
-						{
-							const double dist = (nodes_.row(k) - p).norm();
-							if (dist < 1e-10)
-							{
-								res.push_back(primitive_to_node_[k]);
-								found = true;
-								break;
-							}
-						}
-
-						assert(found);
-					}
-				}
-			}
+			res = existing_face_node_ids(index, n_new_nodes, start);
 		}
 
 #ifndef NDEBUG
@@ -548,6 +488,89 @@ namespace polyfem::mesh
 		return res;
 	}
 
+	std::vector<int> MeshNodes::existing_edge_node_ids(const Navigation::Index &index, const int n_new_nodes, const int start) const
+	{
+		const Mesh2D *mesh2d = dynamic_cast<const Mesh2D *>(&mesh_);
+
+		std::vector<int> res;
+		res.reserve(n_new_nodes);
+
+		const auto [v, _] = mesh2d->edge_node(index, n_new_nodes, 1);
+		if ((node_position(primitive_to_node_[start]) - v).norm() < 1e-10)
+		{
+			for (int i = 0; i < n_new_nodes; ++i)
+				res.push_back(primitive_to_node_[start + i]);
+		}
+		else
+		{
+			for (int i = n_new_nodes - 1; i >= 0; --i)
+				res.push_back(primitive_to_node_[start + i]);
+		}
+
+		return res;
+	}
+
+	std::vector<int> MeshNodes::existing_edge_node_ids(const Navigation3D::Index &index, const int n_new_nodes, const int start) const
+	{
+		const Mesh3D *mesh3d = dynamic_cast<const Mesh3D *>(&mesh_);
+
+		std::vector<int> res;
+		res.reserve(n_new_nodes);
+
+		const auto [v, _] = mesh3d->edge_node(index, n_new_nodes, 1);
+		if ((node_position(primitive_to_node_[start]) - v).norm() < 1e-10)
+		{
+			for (int i = 0; i < n_new_nodes; ++i)
+				res.push_back(primitive_to_node_[start + i]);
+		}
+		else
+		{
+			for (int i = n_new_nodes - 1; i >= 0; --i)
+				res.push_back(primitive_to_node_[start + i]);
+		}
+
+		return res;
+	}
+
+	std::vector<int> MeshNodes::existing_face_node_ids(const Navigation3D::Index &index, const int n_new_nodes, const int start) const
+	{
+		const Mesh3D *mesh3d = dynamic_cast<const Mesh3D *>(&mesh_);
+
+		std::vector<int> res;
+		if (n_new_nodes == 1)
+		{
+			res.push_back(primitive_to_node_[start]);
+			return res;
+		}
+
+		const int total_nodes = mesh3d->is_simplex(index.element) ? (n_new_nodes * (n_new_nodes + 1) / 2) : (n_new_nodes * n_new_nodes);
+		res.reserve(total_nodes);
+		for (int i = 1; i <= n_new_nodes; ++i)
+		{
+			const int end = mesh3d->is_simplex(index.element) ? (n_new_nodes - i + 1) : n_new_nodes;
+			for (int j = 1; j <= end; ++j)
+			{
+				const auto [p, _] = mesh3d->face_node(index, n_new_nodes, i, j);
+
+				bool found = false;
+				for (int k = start; k < start + total_nodes; ++k)
+				{
+					const double dist = (nodes_.row(k) - p).norm();
+					if (dist < 1e-10)
+					{
+						res.push_back(primitive_to_node_[k]);
+						found = true;
+						break;
+					}
+				}
+
+				assert(found);
+			}
+		}
+
+		return res;
+	}
+
 	int MeshNodes::node_id_from_vertex(int v)
 	{
 		return node_id_from_primitive(v);
@@ -623,4 +646,374 @@ namespace polyfem::mesh
 		return count;
 	}
 
+	////////////////////////////////////////////////////////////////////////////////
+
+	int MeshNodes::n_request_nodes(const NodeRequest &request) const
+	{
+		const int n = request.n_new_nodes;
+		switch (request.type)
+		{
+		case NodeRequest::Type::PRIMITIVE:
+			return 1;
+		case NodeRequest::Type::EDGE_2D:
+		case NodeRequest::Type::EDGE_3D:
+			return n;
+		case NodeRequest::Type::FACE_2D:
+			return mesh_.is_simplex(request.index_2d.face) ? (n * (n + 1) / 2) : (n * n);
+		case NodeRequest::Type::FACE_3D:
+			return mesh_.is_simplex(request.index_3d.element) ? (n * (n + 1) / 2) : (n * n);
+		case NodeRequest::Type::CELL_3D:
+		{
+			if (!mesh_.is_simplex(request.index_3d.element))
+				return n * n * n;
+			int n_cell_nodes = 0;
+			for (int pp = 0; pp <= n; ++pp)
+				n_cell_nodes += (pp * (pp + 1) / 2);
+			return n_cell_nodes;
+		}
+		}
+
+		assert(false);
+		return 0;
+	}
+
+	void MeshNodes::create_request_nodes(const NodeRequest &request, const int first_node_id)
+	{
+		int node_id = first_node_id;
+		const auto add_node = [&](const int primitive_id, const int gid, const RowVectorNd &node, const int input_node_id) {
+			primitive_to_node_[primitive_id] = node_id;
+
+			in_ordered_vertices_[node_id] = input_node_id;
+			node_to_primitive_[node_id] = primitive_id;
+			node_to_primitive_gid_[node_id] = gid;
+
+			nodes_.row(primitive_id) = node;
+			++node_id;
+		};
+
+		const int start = request.primitive;
+		const int n = request.n_new_nodes;
+
+		switch (request.type)
+		{
+		case NodeRequest::Type::PRIMITIVE:
+		{
+			RowVectorNd node;
+			if (start < edge_offset_)
+				node = mesh_.point(start);
+			else if (start < face_offset_)
+				node = mesh_.edge_barycenter(start - edge_offset_);
+			else if (start < cell_offset_)
+				node = mesh_.face_barycenter(start - face_offset_);
+			else
+				node = mesh_.cell_barycenter(start - cell_offset_);
+			add_node(start, start, node, start);
+			break;
+		}
+		case NodeRequest::Type::EDGE_2D:
+		{
+			const Mesh2D *mesh2d = dynamic_cast<const Mesh2D *>(&mesh_);
+			for (int i = 1; i <= n; ++i)
+			{
+				const auto [node, input_node_id] = mesh2d->edge_node(request.index_2d, n, i);
+				add_node(start + i - 1, request.index_2d.edge, node, input_node_id);
+			}
+			break;
+		}
+		case NodeRequest::Type::FACE_2D:
+		{
+			const Mesh2D *mesh2d = dynamic_cast<const Mesh2D *>(&mesh_);
+			int loc_index = 0;
+			for (int i = 1; i <= n; ++i)
+			{
+				const int end = mesh2d->is_simplex(request.index_2d.face) ? (n - i + 1) : n;
+				for (int j = 1; j <= end; ++j)
+				{
+					const auto [node, input_node_id] = mesh2d->face_node(request.index_2d, n, i, j);
+					add_node(start + loc_index, request.index_2d.face, node, input_node_id);
+					++loc_index;
+				}
+			}
+			break;
+		}
+		case NodeRequest::Type::EDGE_3D:
+		{
+			const Mesh3D *mesh3d = dynamic_cast<const Mesh3D *>(&mesh_);
+			for (int i = 1; i <= n; ++i)
+			{
+				const auto [node, input_node_id] = mesh3d->edge_node(request.index_3d, n, i);
+				add_node(start + i - 1, request.index_3d.edge, node, input_node_id);
+			}
+			break;
+		}
+		case NodeRequest::Type::FACE_3D:
+		{
+			const Mesh3D *mesh3d = dynamic_cast<const Mesh3D *>(&mesh_);
+			int loc_index = 0;
+			for (int i = 1; i <= n; ++i)
+			{
+				const int end = mesh3d->is_simplex(request.index_3d.element) ? (n - i + 1) : n;
+				for (int j = 1; j <= end; ++j)
+				{
+					const auto [node, input_node_id] = mesh3d->face_node(request.index_3d, n, i, j);
+					add_node(start + loc_index, request.index_3d.face, node, input_node_id);
+					++loc_index;
+				}
+			}
+			break;
+		}
+		case NodeRequest::Type::CELL_3D:
+		{
+			const Mesh3D *mesh3d = dynamic_cast<const Mesh3D *>(&mesh_);
+			const bool is_simplex = mesh3d->is_simplex(request.index_3d.element);
+			int loc_index = 0;
+			for (int i = 1; i <= n; ++i)
+			{
+				const int endj = is_simplex ? (n - i + 1) : n;
+				for (int j = 1; j <= endj; ++j)
+				{
+					const int endk = is_simplex ? (n - i - j + 2) : n;
+					for (int k = 1; k <= endk; ++k)
+					{
+						const auto [node, input_node_id] = mesh3d->cell_node(request.index_3d, n, i, j, k);
+						add_node(start + loc_index, request.index_3d.element, node, input_node_id);
+						++loc_index;
+					}
+				}
+			}
+			break;
+		}
+		}
+
+		assert(node_id - first_node_id == n_request_nodes(request));
+	}
+
+	void MeshNodes::assign_requested_nodes(const std::vector<std::vector<NodeRequest>> &element_requests)
+	{
+		assert(connect_nodes_);
+
+		// Flatten the requests, r is the position in the serial order
+		std::vector<int> offsets(element_requests.size() + 1, 0);
+		for (size_t e = 0; e < element_requests.size(); ++e)
+			offsets[e + 1] = offsets[e] + element_requests[e].size();
+		const int n_requests = offsets.back();
+
+		std::vector<const NodeRequest *> requests(n_requests);
+		std::vector<uint64_t> keys(n_requests);
+		utils::maybe_parallel_for(element_requests.size(), [&](int start, int end, int thread_id) {
+			for (int e = start; e < end; ++e)
+			{
+				for (int k = 0; k < element_requests[e].size(); ++k)
+				{
+					const int r = offsets[e] + k;
+					requests[r] = &element_requests[e][k];
+					keys[r] = (uint64_t(requests[r]->primitive) << 32) | uint32_t(r);
+				}
+			}
+		});
+
+		// The first request of a primitive creates its nodes
+		utils::radix_sort(keys);
+		std::vector<int> n_created(n_requests, 0);
+		utils::maybe_parallel_for(n_requests, [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				const int primitive = keys[i] >> 32;
+				if ((i > 0 && (keys[i - 1] >> 32) == primitive) || primitive_to_node_[primitive] >= 0)
+					continue;
+				const int r = uint32_t(keys[i]);
+				n_created[r] = n_request_nodes(*requests[r]);
+			}
+		});
+
+		std::vector<int> first_node_id(n_requests);
+		int n_total = n_nodes();
+		for (int r = 0; r < n_requests; ++r)
+		{
+			first_node_id[r] = n_total;
+			n_total += n_created[r];
+		}
+
+		in_ordered_vertices_.resize(n_total);
+		node_to_primitive_.resize(n_total);
+		node_to_primitive_gid_.resize(n_total);
+
+		utils::maybe_parallel_for(n_requests, [&](int start, int end, int thread_id) {
+			for (int r = start; r < end; ++r)
+			{
+				if (n_created[r] > 0)
+					create_request_nodes(*requests[r], first_node_id[r]);
+			}
+		});
+	}
+
+	void MeshNodes::permute_nodes(const std::vector<int> &old_to_new)
+	{
+		assert(old_to_new.size() == size_t(n_nodes()));
+
+		for (int &node_id : primitive_to_node_)
+		{
+			if (node_id >= 0)
+				node_id = old_to_new[node_id];
+		}
+
+		const auto permute = [&](std::vector<int> &node_data) {
+			std::vector<int> tmp(node_data.size());
+			for (size_t i = 0; i < node_data.size(); ++i)
+				tmp[old_to_new[i]] = node_data[i];
+			node_data.swap(tmp);
+		};
+		permute(node_to_primitive_);
+		permute(node_to_primitive_gid_);
+		permute(in_ordered_vertices_);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+
+	int MeshNodesRecorder::node_id_from_primitive(int primitive_id)
+	{
+		NodeRequest request;
+		request.type = NodeRequest::Type::PRIMITIVE;
+		request.primitive = primitive_id;
+		request.n_new_nodes = 1;
+		requests_.push_back(request);
+		return 0;
+	}
+
+	std::vector<int> MeshNodesRecorder::node_ids_from_edge(const Navigation::Index &index, const int n_new_nodes)
+	{
+		if (n_new_nodes <= 0)
+			return {};
+
+		NodeRequest request;
+		request.type = NodeRequest::Type::EDGE_2D;
+		request.primitive = nodes_.edge_offset_ + index.edge * nodes_.max_nodes_per_edge_;
+		request.n_new_nodes = n_new_nodes;
+		request.index_2d = index;
+		return record(request);
+	}
+
+	std::vector<int> MeshNodesRecorder::node_ids_from_face(const Navigation::Index &index, const int n_new_nodes)
+	{
+		if (n_new_nodes <= 0)
+			return {};
+
+		NodeRequest request;
+		request.type = NodeRequest::Type::FACE_2D;
+		request.primitive = nodes_.face_offset_ + index.face * nodes_.max_nodes_per_face_;
+		request.n_new_nodes = n_new_nodes;
+		request.index_2d = index;
+		return record(request);
+	}
+
+	std::vector<int> MeshNodesRecorder::node_ids_from_edge(const Navigation3D::Index &index, const int n_new_nodes)
+	{
+		if (n_new_nodes <= 0)
+			return {};
+
+		NodeRequest request;
+		request.type = NodeRequest::Type::EDGE_3D;
+		request.primitive = nodes_.edge_offset_ + index.edge * nodes_.max_nodes_per_edge_;
+		request.n_new_nodes = n_new_nodes;
+		request.index_3d = index;
+		return record(request);
+	}
+
+	std::vector<int> MeshNodesRecorder::node_ids_from_face(const Navigation3D::Index &index, const int n_new_nodes)
+	{
+		if (n_new_nodes <= 0)
+			return {};
+
+		NodeRequest request;
+		request.type = NodeRequest::Type::FACE_3D;
+		request.primitive = nodes_.face_offset_ + index.face * nodes_.max_nodes_per_face_;
+		request.n_new_nodes = n_new_nodes;
+		request.index_3d = index;
+		return record(request);
+	}
+
+	std::vector<int> MeshNodesRecorder::node_ids_from_cell(const Navigation3D::Index &index, const int n_new_nodes)
+	{
+		if (n_new_nodes <= 0)
+			return {};
+
+		NodeRequest request;
+		request.type = NodeRequest::Type::CELL_3D;
+		request.primitive = nodes_.cell_offset_ + index.element * nodes_.max_nodes_per_cell_;
+		request.n_new_nodes = n_new_nodes;
+		request.index_3d = index;
+		return record(request);
+	}
+
+	std::vector<int> MeshNodesRecorder::record(const NodeRequest &request)
+	{
+		requests_.push_back(request);
+		return std::vector<int>(nodes_.n_request_nodes(request), 0);
+	}
+
+	////////////////////////////////////////////////////////////////////////////////
+
+	int MeshNodesLookup::node_id_from_primitive(int primitive_id)
+	{
+		const int node_id = nodes_.primitive_to_node_[primitive_id];
+		assert(node_id >= 0);
+		return node_id;
+	}
+
+	std::vector<int> MeshNodesLookup::node_ids_from_edge(const Navigation::Index &index, const int n_new_nodes)
+	{
+		if (n_new_nodes <= 0)
+			return {};
+
+		return nodes_.existing_edge_node_ids(index, n_new_nodes, nodes_.edge_offset_ + index.edge * nodes_.max_nodes_per_edge_);
+	}
+
+	std::vector<int> MeshNodesLookup::node_ids_from_face(const Navigation::Index &index, const int n_new_nodes)
+	{
+		if (n_new_nodes <= 0)
+			return {};
+
+		const int n = nodes_.mesh_.is_simplex(index.face) ? (n_new_nodes * (n_new_nodes + 1) / 2) : (n_new_nodes * n_new_nodes);
+		return consecutive_node_ids(nodes_.face_offset_ + index.face * nodes_.max_nodes_per_face_, n);
+	}
+
+	std::vector<int> MeshNodesLookup::node_ids_from_edge(const Navigation3D::Index &index, const int n_new_nodes)
+	{
+		if (n_new_nodes <= 0)
+			return {};
+
+		return nodes_.existing_edge_node_ids(index, n_new_nodes, nodes_.edge_offset_ + index.edge * nodes_.max_nodes_per_edge_);
+	}
+
+	std::vector<int> MeshNodesLookup::node_ids_from_face(const Navigation3D::Index &index, const int n_new_nodes)
+	{
+		if (n_new_nodes <= 0)
+			return {};
+
+		return nodes_.existing_face_node_ids(index, n_new_nodes, nodes_.face_offset_ + index.face * nodes_.max_nodes_per_face_);
+	}
+
+	std::vector<int> MeshNodesLookup::node_ids_from_cell(const Navigation3D::Index &index, const int n_new_nodes)
+	{
+		if (n_new_nodes <= 0)
+			return {};
+
+		NodeRequest request;
+		request.type = NodeRequest::Type::CELL_3D;
+		request.n_new_nodes = n_new_nodes;
+		request.index_3d = index;
+		return consecutive_node_ids(nodes_.cell_offset_ + index.element * nodes_.max_nodes_per_cell_, nodes_.n_request_nodes(request));
+	}
+
+	std::vector<int> MeshNodesLookup::consecutive_node_ids(const int start, const int n) const
+	{
+		std::vector<int> res(n);
+		for (int i = 0; i < n; ++i)
+		{
+			res[i] = nodes_.primitive_to_node_[start + i];
+			assert(res[i] >= 0);
+		}
+		return res;
+	}
+
 } // namespace polyfem::mesh
\ No newline at end of file
@@ -12,10 +12,32 @@ namespace polyfem
 {
 	namespace mesh
 	{
+		/// @brief Nodes of a primitive requested by an element, recorded by MeshNodesRecorder
+		struct NodeRequest
+		{
+			enum class Type
+			{
+				PRIMITIVE, // node_id_from_primitive
+				EDGE_2D,
+				FACE_2D,
+				EDGE_3D,
+				FACE_3D,
+				CELL_3D
+			};
+
+			Type type;
+			int primitive;   // packed id of the first node of the primitive
+			int n_new_nodes; // argument of node_ids_from_*
+			Navigation::Index index_2d;
+			Navigation3D::Index index_3d;
+		};
 
 		// Wrapper for lazy assignment of node ids
 		class MeshNodes
 		{
+			friend class MeshNodesRecorder;
+			friend class MeshNodesLookup;
+
 		public:
 			MeshNodes(const Mesh &mesh, const bool has_poly, const bool connect_nodes, const int max_nodes_per_edge, const int max_nodes_per_face, const int max_nodes_per_cell = 0);
 
@@ -65,6 +87,8 @@ namespace polyfem
 
 			// Node position from node id
 			RowVectorNd node_position(int node_id) const { return nodes_.row(node_to_primitive_[node_id]); }
+			// Moves an existing node, the topology is unchanged
+			void set_node_position(int node_id, const RowVectorNd &p) { nodes_.row(node_to_primitive_[node_id]) = p; }
 
 			// Whether a node is on the mesh boundary or not
 			bool is_boundary(int node_id) const { return is_boundary_[node_to_primitive_[node_id]]; }
@@ -80,9 +104,29 @@ namespace polyfem
 			// Retrieve a list of nodes which are marked as boundary
 			std::vector<int> boundary_nodes() const;
 
+			/// @brief Assigns the nodes of all recorded requests in parallel. The numbering is the same as
+			/// the one of the lazy retrieval when the elements are processed one after the other.
+			/// Only supported for connected nodes.
+			/// @param[in] element_requests requests of every element, in the order they were issued
+			void assign_requested_nodes(const std::vector<std::vector<NodeRequest>> &element_requests);
+
+			/// @brief Renumbers the assigned nodes, e.g., after reordering the dofs of the bases
+			/// @param[in] old_to_new new id of every node, must be a permutation of [0, n_nodes())
+			void permute_nodes(const std::vector<int> &old_to_new);
+
 		private:
 			int count_nonnegative_nodes(int start_i, int end_i) const;
 
+			// Number of nodes created by a request
+			int n_request_nodes(const NodeRequest &request) const;
+			// Creates the nodes of a request, numbered from first_node_id, without resizing the node lists
+			void create_request_nodes(const NodeRequest &request, const int first_node_id);
+
+			// Ids of already created edge/face nodes, ordered according to index
+			std::vector<int> existing_edge_node_ids(const Navigation::Index &index, const int n_new_nodes, const int start) const;
+			std::vector<int> existing_edge_node_ids(const Navigation3D::Index &index, const int n_new_nodes, const int start) const;
+			std::vector<int> existing_face_node_ids(const Navigation3D::Index &index, const int n_new_nodes, const int start) const;
+
 			const Mesh &mesh_;
 			const bool connect_nodes_;
 			// Offset to pack primitives ids into a single vector
@@ -107,5 +151,60 @@ namespace polyfem
 			// Store the input nodes ids
 			std::vector<int> in_ordered_vertices_;
 		};
+
+		/// @brief Drop-in replacement of MeshNodes for the first phase of the two-phase numbering:
+		/// records the requests of one element instead of creating nodes. The returned ids are placeholders.
+		/// Different recorders can be used concurrently.
+		class MeshNodesRecorder
+		{
+		public:
+			MeshNodesRecorder(const MeshNodes &nodes, std::vector<NodeRequest> &requests) : nodes_(nodes), requests_(requests) {}
+
+			int node_id_from_vertex(int v) { return node_id_from_primitive(nodes_.primitive_from_vertex(v)); }
+			int node_id_from_edge(int e) { return node_id_from_primitive(nodes_.edge_offset_ + e * nodes_.max_nodes_per_edge_); }
+			int node_id_from_face(int f) { return node_id_from_primitive(nodes_.face_offset_ + f * nodes_.max_nodes_per_face_); }
+			int node_id_from_cell(int c) { return node_id_from_primitive(nodes_.cell_offset_ + c * nodes_.max_nodes_per_cell_); }
+			int node_id_from_primitive(int primitive_id);
+
+			std::vector<int> node_ids_from_edge(const Navigation::Index &index, const int n_new_nodes);
+			std::vector<int> node_ids_from_face(const Navigation::Index &index, const int n_new_nodes);
+
+			std::vector<int> node_ids_from_edge(const Navigation3D::Index &index, const int n_new_nodes);
+			std::vector<int> node_ids_from_face(const Navigation3D::Index &index, const int n_new_nodes);
+			std::vector<int> node_ids_from_cell(const Navigation3D::Index &index, const int n_new_nodes);
+
+		private:
+			std::vector<int> record(const NodeRequest &request);
+
+			const MeshNodes &nodes_;
+			std::vector<NodeRequest> &requests_;
+		};
+
+		/// @brief Drop-in replacement of MeshNodes for the second phase of the two-phase numbering:
+		/// retrieves the ids of nodes created by MeshNodes::assign_requested_nodes without modifying them.
+		/// Can be used concurrently.
+		class MeshNodesLookup
+		{
+		public:
+			MeshNodesLookup(const MeshNodes &nodes) : nodes_(nodes) {}
+
+			int node_id_from_vertex(int v) { return node_id_from_primitive(nodes_.primitive_from_vertex(v)); }
+			int node_id_from_edge(int e) { return node_id_from_primitive(nodes_.edge_offset_ + e * nodes_.max_nodes_per_edge_); }
+			int node_id_from_face(int f) { return node_id_from_primitive(nodes_.face_offset_ + f * nodes_.max_nodes_per_face_); }
+			int node_id_from_cell(int c) { return node_id_from_primitive(nodes_.cell_offset_ + c * nodes_.max_nodes_per_cell_); }
+			int node_id_from_primitive(int primitive_id);
+
+			std::vector<int> node_ids_from_edge(const Navigation::Index &index, const int n_new_nodes);
+			std::vector<int> node_ids_from_face(const Navigation::Index &index, const int n_new_nodes);
+
+			std::vector<int> node_ids_from_edge(const Navigation3D::Index &index, const int n_new_nodes);
+			std::vector<int> node_ids_from_face(const Navigation3D::Index &index, const int n_new_nodes);
+			std::vector<int> node_ids_from_cell(const Navigation3D::Index &index, const int n_new_nodes);
+
+		private:
+			std::vector<int> consecutive_node_ids(const int start, const int n) const;
+
+			const MeshNodes &nodes_;
+		};
 	} // namespace mesh
 } // namespace polyfem
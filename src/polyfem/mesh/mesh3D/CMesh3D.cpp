@@ -25,6 +25,7 @@ namespace polyfem
 
 			// TODO refine high order mesh!
 			orders_.resize(0, 0);
+			MeshProcessing3D::decompress_connectivity(mesh_);
 			if (mesh_.type == MeshType::TET)
 			{
 				MeshProcessing3D::refine_red_refinement_tet(mesh_, n_refinement);
@@ -55,23 +56,23 @@ namespace polyfem
 
 			for (int e = 0; e < (int)mesh_.edges.size(); ++e)
 			{
-				assert(mesh_.edges[e].vs.size() == 2);
+				assert(mesh_.edge_vs(e).size() == 2);
 				for (int lv = 0; lv < 2; ++lv)
 				{
-					in_ordered_edges_(e, lv) = mesh_.edges[e].vs[lv];
+					in_ordered_edges_(e, lv) = mesh_.edge_vs(e)[lv];
 				}
 			}
 			assert(in_ordered_edges_.size() > 0);
 
-			in_ordered_faces_.resize(mesh_.faces.size(), mesh_.faces[0].vs.size());
+			in_ordered_faces_.resize(mesh_.faces.size(), mesh_.face_vs(0).size());
 
 			for (int f = 0; f < (int)mesh_.faces.size(); ++f)
 			{
-				assert(in_ordered_faces_.cols() == mesh_.faces[f].vs.size());
+				assert(in_ordered_faces_.cols() == mesh_.face_vs(f).size());
 
 				for (int lv = 0; lv < in_ordered_faces_.cols(); ++lv)
 				{
-					in_ordered_faces_(f, lv) = mesh_.faces[f].vs[lv];
+					in_ordered_faces_(f, lv) = mesh_.face_vs(f)[lv];
 				}
 			}
 			assert(in_ordered_faces_.size() > 0);
@@ -82,6 +83,7 @@ namespace polyfem
 			edge_nodes_.clear();
 			face_nodes_.clear();
 			cell_nodes_.clear();
+			mesh_.compressed = Mesh3DConnectivity();
 
 			if (!StringUtils::endswith(path, ".HYBRID"))
 			{
@@ -206,6 +208,7 @@ namespace polyfem
 			edge_nodes_.clear();
 			face_nodes_.clear();
 			cell_nodes_.clear();
+			mesh_.compressed = Mesh3DConnectivity();
 
 			assert(M.vertices.dimension() == 3);
 
@@ -430,23 +433,24 @@ namespace polyfem
 			for (int i = 0; i < mesh_.points.cols(); i++)
 				f << mesh_.points(0, i) << " " << mesh_.points(1, i) << " " << mesh_.points(2, i) << std::endl;
 
-			for (auto f_ : mesh_.faces)
+			for (uint32_t i = 0; i < mesh_.faces.size(); i++)
 			{
-				f << f_.vs.size() << " ";
-				for (auto vid : f_.vs)
+				f << mesh_.face_vs(i).size() << " ";
+				for (auto vid : mesh_.face_vs(i))
 					f << vid << " ";
 				f << std::endl;
 			}
 
 			for (uint32_t i = 0; i < mesh_.elements.size(); i++)
 			{
-				f << mesh_.elements[i].fs.size() << " ";
-				for (auto fid : mesh_.elements[i].fs)
+				const IndexRange fs = mesh_.element_fs(i);
+				f << fs.size() << " ";
+				for (auto fid : fs)
 					f << fid << " ";
 				f << std::endl;
-				f << mesh_.elements[i].fs_flag.size() << " ";
-				for (auto f_flag : mesh_.elements[i].fs_flag)
-					f << f_flag << " ";
+				f << fs.size() << " ";
+				for (int lf = 0; lf < fs.size(); ++lf)
+					f << mesh_.element_fs_flag(i, lf) << " ";
 				f << std::endl;
 			}
 
@@ -1188,7 +1192,7 @@ namespace polyfem
 
 		bool CMesh3D::is_boundary_element(const int element_global_id) const
 		{
-			const auto &fs = mesh_.elements[element_global_id].fs;
+			const IndexRange fs = mesh_.element_fs(element_global_id);
 
 			for (auto f_id : fs)
 			{
@@ -1196,7 +1200,7 @@ namespace polyfem
 					return true;
 			}
 
-			const auto &vs = mesh_.elements[element_global_id].vs;
+			const IndexRange vs = mesh_.element_vs(element_global_id);
 
 			for (auto v_id : vs)
 			{
@@ -1272,22 +1276,22 @@ namespace polyfem
 
 			// boundary flags
 			std::vector<bool> bv_flag(mesh_.vertices.size(), false), be_flag(mesh_.edges.size(), false), bf_flag(mesh_.faces.size(), false);
-			for (auto f : mesh_.faces)
+			for (const auto &f : mesh_.faces)
 				if (f.boundary)
 					bf_flag[f.id] = true;
 				else
 				{
-					for (auto nhid : f.neighbor_hs)
+					for (auto nhid : mesh_.face_neighbor_hs(f.id))
 						if (!mesh_.elements[nhid].hex)
 							bf_flag[f.id] = true;
 				}
 			for (uint32_t i = 0; i < mesh_.faces.size(); ++i)
 				if (bf_flag[i])
-					for (uint32_t j = 0; j < mesh_.faces[i].vs.size(); ++j)
+					for (uint32_t j = 0; j < mesh_.face_vs(i).size(); ++j)
 					{
-						uint32_t eid = mesh_.faces[i].es[j];
+						uint32_t eid = mesh_.face_es(i)[j];
 						be_flag[eid] = true;
-						bv_flag[mesh_.faces[i].vs[j]] = true;
+						bv_flag[mesh_.face_vs(i)[j]] = true;
 					}
 
 			for (auto &ele : mesh_.elements)
@@ -1296,9 +1300,9 @@ namespace polyfem
 				{
 					bool attaching_non_hex = false, on_boundary = false;
 					;
-					for (auto vid : ele.vs)
+					for (auto vid : mesh_.element_vs(ele.id))
 					{
-						for (auto eleid : mesh_.vertices[vid].neighbor_hs)
+						for (auto eleid : mesh_.vertex_neighbor_hs(vid))
 							if (!mesh_.elements[eleid].hex)
 							{
 								attaching_non_hex = true;
@@ -1324,13 +1328,13 @@ namespace polyfem
 						// has no boundary edge--> singular
 						bool boundary_edge = false, boundary_edge_singular = false, interior_edge_singular = false;
 						int n_interior_edge_singular = 0;
-						for (auto eid : ele.es)
+						for (auto eid : mesh_.element_es(ele.id))
 						{
 							int en = 0;
 							if (be_flag[eid])
 							{
 								boundary_edge = true;
-								for (auto nhid : mesh_.edges[eid].neighbor_hs)
+								for (auto nhid : mesh_.edge_neighbor_hs(eid))
 									if (mesh_.elements[nhid].hex)
 										en++;
 								if (en > 2)
@@ -1338,7 +1342,7 @@ namespace polyfem
 							}
 							else
 							{
-								for (auto nhid : mesh_.edges[eid].neighbor_hs)
+								for (auto nhid : mesh_.edge_neighbor_hs(eid))
 									if (mesh_.elements[nhid].hex)
 										en++;
 								if (en != 4)
@@ -1353,13 +1357,13 @@ namespace polyfem
 
 						bool has_singular_v = false, has_iregular_v = false;
 						int n_in_irregular_v = 0;
-						for (auto vid : ele.vs)
+						for (auto vid : mesh_.element_vs(ele.id))
 						{
 							int vn = 0;
 							if (bv_flag[vid])
 							{
 								int nh = 0;
-								for (auto nhid : mesh_.vertices[vid].neighbor_hs)
+								for (auto nhid : mesh_.vertex_neighbor_hs(vid))
 									if (mesh_.elements[nhid].hex)
 										nh++;
 								if (nh > 4)
@@ -1368,12 +1372,12 @@ namespace polyfem
 							}
 							else
 							{
-								if (mesh_.vertices[vid].neighbor_hs.size() != 8)
+								if (mesh_.vertex_neighbor_hs(vid).size() != 8)
 									n_in_irregular_v++;
 								int n_irregular_e = 0;
-								for (auto eid : mesh_.vertices[vid].neighbor_es)
+								for (auto eid : mesh_.vertex_neighbor_es(vid))
 								{
-									if (mesh_.edges[eid].neighbor_hs.size() != 4)
+									if (mesh_.edge_neighbor_hs(eid).size() != 4)
 										n_irregular_e++;
 								}
 								if (n_irregular_e != 0 && n_irregular_e != 2)
@@ -1384,8 +1388,8 @@ namespace polyfem
 							}
 						}
 						int n_irregular_e = 0;
-						for (auto eid : ele.es)
-							if (!be_flag[eid] && mesh_.edges[eid].neighbor_hs.size() != 4)
+						for (auto eid : mesh_.element_es(ele.id))
+							if (!be_flag[eid] && mesh_.edge_neighbor_hs(eid).size() != 4)
 								n_irregular_e++;
 						if (has_singular_v)
 							continue;
@@ -1405,8 +1409,8 @@ namespace polyfem
 
 					// type 1
 					bool has_irregular_v = false;
-					for (auto vid : ele.vs)
-						if (mesh_.vertices[vid].neighbor_hs.size() != 8)
+					for (auto vid : mesh_.element_vs(ele.id))
+						if (mesh_.vertex_neighbor_hs(vid).size() != 8)
 						{
 							has_irregular_v = true;
 							break;
@@ -1419,14 +1423,14 @@ namespace polyfem
 					// type 2
 					bool has_singular_v = false;
 					int n_irregular_v = 0;
-					for (auto vid : ele.vs)
+					for (auto vid : mesh_.element_vs(ele.id))
 					{
-						if (mesh_.vertices[vid].neighbor_hs.size() != 8)
+						if (mesh_.vertex_neighbor_hs(vid).size() != 8)
 							n_irregular_v++;
 						int n_irregular_e = 0;
-						for (auto eid : mesh_.vertices[vid].neighbor_es)
+						for (auto eid : mesh_.vertex_neighbor_es(vid))
 						{
-							if (mesh_.edges[eid].neighbor_hs.size() != 4)
+							if (mesh_.edge_neighbor_hs(eid).size() != 4)
 								n_irregular_e++;
 						}
 						if (n_irregular_e != 0 && n_irregular_e != 2)
@@ -1446,7 +1450,7 @@ namespace polyfem
 				else
 				{
 					ele_tag[ele.id] = ElementType::INTERIOR_POLYTOPE;
-					for (auto fid : ele.fs)
+					for (auto fid : mesh_.element_fs(ele.id))
 						if (mesh_.faces[fid].boundary)
 						{
 							ele_tag[ele.id] = ElementType::BOUNDARY_POLYTOPE;
@@ -1458,7 +1462,7 @@ namespace polyfem
 			// TODO correct?
 			for (auto &ele : mesh_.elements)
 			{
-				if (ele.vs.size() == 4)
+				if (mesh_.element_vs(ele.id).size() == 4)
 					ele_tag[ele.id] = ElementType::SIMPLEX;
 			}
 		}
@@ -1468,7 +1472,7 @@ namespace polyfem
 			const int n_vertices = n_face_vertices(gid);
 			assert(n_vertices == 4);
 
-			const auto &vertices = mesh_.faces[gid].vs;
+			const IndexRange vertices = mesh_.face_vs(gid);
 
 			const auto v1 = point(vertices[0]);
 			const auto v2 = point(vertices[1]);
@@ -1486,8 +1490,8 @@ namespace polyfem
 
 		RowVectorNd CMesh3D::edge_barycenter(const int e) const
 		{
-			const int v0 = mesh_.edges[e].vs[0];
-			const int v1 = mesh_.edges[e].vs[1];
+			const int v0 = mesh_.edge_vs(e)[0];
+			const int v1 = mesh_.edge_vs(e)[1];
 			return 0.5 * (point(v0) + point(v1));
 		}
 
@@ -1497,7 +1501,7 @@ namespace polyfem
 			RowVectorNd bary(3);
 			bary.setZero();
 
-			const auto &vertices = mesh_.faces[f].vs;
+			const IndexRange vertices = mesh_.face_vs(f);
 			for (int lv = 0; lv < n_vertices; ++lv)
 			{
 				bary += point(vertices[lv]);
@@ -1511,7 +1515,7 @@ namespace polyfem
 			RowVectorNd bary(3);
 			bary.setZero();
 
-			const auto &vertices = mesh_.elements[c].vs;
+			const IndexRange vertices = mesh_.element_vs(c);
 			for (int lv = 0; lv < n_vertices; ++lv)
 			{
 				bary += point(vertices[lv]);
@@ -1602,12 +1606,29 @@ namespace polyfem
 			Mesh::append(mesh);
 
 			const CMesh3D &mesh3d = dynamic_cast<const CMesh3D &>(mesh);
-			mesh_.append(mesh3d.mesh_);
+			MeshProcessing3D::decompress_connectivity(mesh_);
+			if (mesh3d.mesh_.is_compressed())
+			{
+				Mesh3DStorage other = mesh3d.mesh_;
+				MeshProcessing3D::decompress_connectivity(other);
+				mesh_.append(other);
+			}
+			else
+				mesh_.append(mesh3d.mesh_);
 
 			Navigation3D::prepare_mesh(mesh_);
 			compute_elements_tag();
 		}
 
+		void CMesh3D::set_compressed_storage(const bool compressed)
+		{
+			mesh_.use_compressed_storage = compressed;
+			if (compressed)
+				MeshProcessing3D::compress_connectivity(mesh_);
+			else
+				MeshProcessing3D::decompress_connectivity(mesh_);
+		}
+
 		std::unique_ptr<Mesh> CMesh3D::copy() const
 		{
 			return std::make_unique<CMesh3D>(*this);
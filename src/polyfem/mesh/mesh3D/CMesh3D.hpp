@@ -34,15 +34,15 @@ namespace polyfem
 			int n_edges() const override { return int(mesh_.edges.size()); }
 			int n_vertices() const override { return int(mesh_.points.cols()); }
 
-			inline int n_face_vertices(const int f_id) const override { return mesh_.faces[f_id].vs.size(); }
-			inline int n_cell_vertices(const int c_id) const override { return mesh_.elements[c_id].vs.size(); }
-			inline int n_cell_edges(const int c_id) const override { return mesh_.elements[c_id].es.size(); }
-			inline int n_cell_faces(const int c_id) const override { return mesh_.elements[c_id].fs.size(); }
-			inline int cell_vertex(const int c_id, const int lv_id) const override { return mesh_.elements[c_id].vs[lv_id]; }
-			inline int cell_face(const int c_id, const int lf_id) const override { return mesh_.elements[c_id].fs[lf_id]; }
-			inline int cell_edge(const int c_id, const int le_id) const override { return mesh_.elements[c_id].es[le_id]; }
-			inline int face_vertex(const int f_id, const int lv_id) const override { return mesh_.faces[f_id].vs[lv_id]; }
-			inline int edge_vertex(const int e_id, const int lv_id) const override { return mesh_.edges[e_id].vs[lv_id]; }
+			inline int n_face_vertices(const int f_id) const override { return mesh_.face_vs(f_id).size(); }
+			inline int n_cell_vertices(const int c_id) const override { return mesh_.element_vs(c_id).size(); }
+			inline int n_cell_edges(const int c_id) const override { return mesh_.element_es(c_id).size(); }
+			inline int n_cell_faces(const int c_id) const override { return mesh_.element_fs(c_id).size(); }
+			inline int cell_vertex(const int c_id, const int lv_id) const override { return mesh_.element_vs(c_id)[lv_id]; }
+			inline int cell_face(const int c_id, const int lf_id) const override { return mesh_.element_fs(c_id)[lf_id]; }
+			inline int cell_edge(const int c_id, const int le_id) const override { return mesh_.element_es(c_id)[le_id]; }
+			inline int face_vertex(const int f_id, const int lv_id) const override { return mesh_.face_vs(f_id)[lv_id]; }
+			inline int edge_vertex(const int e_id, const int lv_id) const override { return mesh_.edge_vs(e_id)[lv_id]; }
 
 			void elements_boxes(std::vector<std::array<Eigen::Vector3d, 2>> &boxes) const override;
 			void barycentric_coords(const RowVectorNd &p, const int el_id, Eigen::MatrixXd &coord) const override;
@@ -80,8 +80,8 @@ namespace polyfem
 			Navigation3D::Index get_index_from_element_edge(int hi, int v0, int v1) const override { return Navigation3D::get_index_from_element_edge(mesh_, hi, v0, v1); }
 			Navigation3D::Index get_index_from_element_face(int hi, int v0, int v1, int v2) const override { return Navigation3D::get_index_from_element_tri(mesh_, hi, v0, v1, v2); }
 
-			inline std::vector<uint32_t> vertex_neighs(const int v_gid) const override { return mesh_.vertices[v_gid].neighbor_hs; }
-			inline std::vector<uint32_t> edge_neighs(const int e_gid) const override { return mesh_.edges[e_gid].neighbor_hs; }
+			inline std::vector<uint32_t> vertex_neighs(const int v_gid) const override { return mesh_.vertex_neighbor_hs(v_gid).to_vector(); }
+			inline std::vector<uint32_t> edge_neighs(const int e_gid) const override { return mesh_.edge_neighbor_hs(e_gid).to_vector(); }
 
 			// Navigation in a surface mesh
 			Navigation3D::Index switch_vertex(Navigation3D::Index idx) const override { return Navigation3D::switch_vertex(mesh_, idx); }
@@ -95,17 +95,27 @@ namespace polyfem
 
 			void get_vertex_elements_neighs(const int v_id, std::vector<int> &ids) const override
 			{
-				ids.clear();
-				ids.insert(ids.begin(), mesh_.vertices[v_id].neighbor_hs.begin(), mesh_.vertices[v_id].neighbor_hs.end());
+				const IndexRange hs = mesh_.vertex_neighbor_hs(v_id);
+				ids.assign(hs.begin(), hs.end());
 			}
 			void get_edge_elements_neighs(const int e_id, std::vector<int> &ids) const override
 			{
-				ids.clear();
-				ids.insert(ids.begin(), mesh_.edges[e_id].neighbor_hs.begin(), mesh_.edges[e_id].neighbor_hs.end());
+				const IndexRange hs = mesh_.edge_neighbor_hs(e_id);
+				ids.assign(hs.begin(), hs.end());
 			}
 
 			void compute_boundary_ids(const std::function<int(const size_t, const std::vector<int> &, const RowVectorNd &, bool)> &marker) override;
 
+			/// @brief Switch between the list-based and the compressed (CSR) connectivity storage.
+			/// The compressed storage uses a few flat arrays instead of one allocation per adjacency list,
+			/// it is kept across refinements and appends. The connectivity is still built with lists and
+			/// copied afterwards, so only the memory held after construction is reduced.
+			///
+			/// @param[in] compressed use the compressed storage
+			void set_compressed_storage(const bool compressed);
+			/// @brief check if the connectivity is stored in compressed form
+			bool is_storage_compressed() const { return mesh_.is_compressed(); }
+
 			void compute_body_ids(const std::function<int(const size_t, const std::vector<int> &, const RowVectorNd &)> &marker) override;
 
 			// void triangulate_faces(Eigen::MatrixXi &tris, Eigen::MatrixXd &pts, std::vector<int> &ranges) const override;
@@ -3,6 +3,7 @@
 #include <vector>
 #include <Eigen/Dense>
 #include <cassert>
+#include <cstdint>
 
 namespace polyfem
 {
@@ -51,6 +52,64 @@ namespace polyfem
 			std::vector<double> v_in_Kernel;
 		};
 
+		/// @brief Non-owning view on a contiguous list of indices
+		struct IndexRange
+		{
+			const uint32_t *first = nullptr;
+			const uint32_t *last = nullptr;
+
+			IndexRange() = default;
+			IndexRange(const uint32_t *first, const uint32_t *last) : first(first), last(last) {}
+			IndexRange(const std::vector<uint32_t> &v) : first(v.data()), last(v.data() + v.size()) {}
+
+			const uint32_t *begin() const { return first; }
+			const uint32_t *end() const { return last; }
+			size_t size() const { return last - first; }
+			bool empty() const { return first == last; }
+			uint32_t operator[](const size_t i) const
+			{
+				assert(i < size());
+				return first[i];
+			}
+
+			std::vector<uint32_t> to_vector() const { return std::vector<uint32_t>(first, last); }
+		};
+
+		/// @brief Compressed (offsets + indices) representation of a one-to-many relation
+		struct CSRRelation
+		{
+			/// the list of entity i is indices[offsets[i]] ... indices[offsets[i + 1] - 1], offsets has size n + 1
+			std::vector<uint32_t> offsets;
+			std::vector<uint32_t> indices;
+
+			bool empty() const { return offsets.empty(); }
+			size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; }
+			IndexRange operator[](const size_t i) const
+			{
+				assert(i + 1 < offsets.size());
+				return IndexRange(indices.data() + offsets[i], indices.data() + offsets[i + 1]);
+			}
+
+			void clear()
+			{
+				std::vector<uint32_t>().swap(offsets);
+				std::vector<uint32_t>().swap(indices);
+			}
+		};
+
+		/// @brief Compressed connectivity of a Mesh3DStorage, one CSR relation per adjacency list of the entities.
+		/// H: elements, F: faces, E: edges, V: vertices, e.g., HF is the list of faces of every element.
+		struct Mesh3DConnectivity
+		{
+			CSRRelation HV, HE, HF;
+			std::vector<uint8_t> HF_flag; // same layout as HF.indices
+			CSRRelation FV, FE, FH;
+			CSRRelation EV, EF, EH;
+			CSRRelation VV, VE, VF, VH;
+
+			bool empty() const { return HV.empty(); }
+		};
+
 		enum class MeshType
 		{
 			TRI = 0,
@@ -75,8 +134,36 @@ namespace polyfem
 			Eigen::MatrixXi FV, FE, FH, FHi; // FV (3, nf), FE(3, nf), FH (2, nf), FHi(2, nf)
 			Eigen::MatrixXi HV, HF;          // HV(4, nh), HE(6, nh), HF(4, nh)
 
+			/// if true, Navigation3D::prepare_mesh moves all adjacency lists into the compressed connectivity
+			bool use_compressed_storage = false;
+			/// compressed connectivity, when not empty the adjacency lists in vertices, edges, faces, and elements are released
+			Mesh3DConnectivity compressed;
+
+			inline bool is_compressed() const { return !compressed.empty(); }
+
+			// adjacency accessors, valid both for the compressed and the list-based storage
+			inline IndexRange element_vs(const int h) const { return is_compressed() ? compressed.HV[h] : IndexRange(elements[h].vs); }
+			inline IndexRange element_es(const int h) const { return is_compressed() ? compressed.HE[h] : IndexRange(elements[h].es); }
+			inline IndexRange element_fs(const int h) const { return is_compressed() ? compressed.HF[h] : IndexRange(elements[h].fs); }
+			inline bool element_fs_flag(const int h, const int lf) const { return is_compressed() ? compressed.HF_flag[compressed.HF.offsets[h] + lf] : elements[h].fs_flag[lf]; }
+
+			inline IndexRange face_vs(const int f) const { return is_compressed() ? compressed.FV[f] : IndexRange(faces[f].vs); }
+			inline IndexRange face_es(const int f) const { return is_compressed() ? compressed.FE[f] : IndexRange(faces[f].es); }
+			inline IndexRange face_neighbor_hs(const int f) const { return is_compressed() ? compressed.FH[f] : IndexRange(faces[f].neighbor_hs); }
+
+			inline IndexRange edge_vs(const int e) const { return is_compressed() ? compressed.EV[e] : IndexRange(edges[e].vs); }
+			inline IndexRange edge_neighbor_fs(const int e) const { return is_compressed() ? compressed.EF[e] : IndexRange(edges[e].neighbor_fs); }
+			inline IndexRange edge_neighbor_hs(const int e) const { return is_compressed() ? compressed.EH[e] : IndexRange(edges[e].neighbor_hs); }
+
+			inline IndexRange vertex_neighbor_vs(const int v) const { return is_compressed() ? compressed.VV[v] : IndexRange(vertices[v].neighbor_vs); }
+			inline IndexRange vertex_neighbor_es(const int v) const { return is_compressed() ? compressed.VE[v] : IndexRange(vertices[v].neighbor_es); }
+			inline IndexRange vertex_neighbor_fs(const int v) const { return is_compressed() ? compressed.VF[v] : IndexRange(vertices[v].neighbor_fs); }
+			inline IndexRange vertex_neighbor_hs(const int v) const { return is_compressed() ? compressed.VH[v] : IndexRange(vertices[v].neighbor_hs); }
+
 			void append(const Mesh3DStorage &other)
 			{
+				assert(!is_compressed() && !other.is_compressed());
+
 				if (other.type != type)
 					type = MeshType::HYB;
 
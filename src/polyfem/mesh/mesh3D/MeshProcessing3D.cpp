@@ -1,5 +1,7 @@
 #include "MeshProcessing3D.hpp"
 #include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/RadixSort.hpp>
 
 #include <Eigen/Dense>
 
@@ -15,6 +17,44 @@ using namespace polyfem;
 using namespace std;
 using namespace Eigen;
 
+namespace
+{
+	/// @brief Builds the inverse of a one-to-many relation in parallel: target_list(targets[t]) is set to the
+	/// indices s of all sources with t in source_list(sources[s]), in increasing order (same as serial push_backs)
+	template <typename Source, typename Target, typename SourceList, typename TargetList>
+	void invert_relation(const std::vector<Source> &sources, SourceList source_list, std::vector<Target> &targets, TargetList target_list)
+	{
+		const size_t n_sources = sources.size();
+		std::vector<size_t> offsets(n_sources + 1, 0);
+		for (size_t s = 0; s < n_sources; ++s)
+			offsets[s + 1] = offsets[s] + source_list(sources[s]).size();
+
+		// (target, source) pairs packed in a single key
+		std::vector<uint64_t> keys(offsets.back());
+		utils::maybe_parallel_for(n_sources, [&](int start, int end, int thread_id) {
+			for (int s = start; s < end; ++s)
+			{
+				const auto &l = source_list(sources[s]);
+				for (size_t k = 0; k < l.size(); ++k)
+					keys[offsets[s] + k] = (uint64_t(l[k]) << 32) | uint32_t(s);
+			}
+		});
+		utils::radix_sort(keys);
+
+		utils::maybe_parallel_for(targets.size(), [&](int start, int end, int thread_id) {
+			auto first = std::lower_bound(keys.begin(), keys.end(), uint64_t(start) << 32);
+			for (int t = start; t < end; ++t)
+			{
+				const auto last = std::lower_bound(first, keys.end(), uint64_t(t + 1) << 32);
+				auto &l = target_list(targets[t]);
+				l.resize(last - first);
+				for (size_t k = 0; first != last; ++first, ++k)
+					l[k] = uint32_t(*first);
+			}
+		});
+	}
+} // namespace
+
 void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
 {
 	hmi.edges.clear();
@@ -148,43 +188,65 @@ void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
 	else if (hmi.type == MeshType::HYB || hmi.type == MeshType::TET)
 	{
 		vector<bool> bf_flag(hmi.faces.size(), false);
-		for (auto h : hmi.elements)
+		for (const auto &h : hmi.elements)
 			for (auto f : h.fs)
 				bf_flag[f] = !bf_flag[f];
 		for (auto &f : hmi.faces)
 			f.boundary = bf_flag[f.id];
 
-		std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>> temp;
+		// half-edges keyed by their sorted end points, the payload is the half-edge id
+		std::vector<uint32_t> he_offsets(hmi.faces.size() + 1, 0);
 		for (uint32_t i = 0; i < hmi.faces.size(); ++i)
-		{
-			int fl = hmi.faces[i].vs.size();
-			for (uint32_t j = 0; j < hmi.faces[i].vs.size(); ++j)
+			he_offsets[i + 1] = he_offsets[i] + hmi.faces[i].vs.size();
+
+		const uint32_t n_he = he_offsets.back();
+		std::vector<uint64_t> he_keys(n_he);
+		std::vector<uint32_t> he_ids(n_he), he_faces(n_he);
+		utils::maybe_parallel_for(hmi.faces.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
 			{
-				uint32_t v0 = hmi.faces[i].vs[j], v1 = hmi.faces[i].vs[(j + 1) % fl];
-				if (v0 > v1)
-					std::swap(v0, v1);
-				temp.push_back(std::make_tuple(v0, v1, i, j));
+				const auto &fvs = hmi.faces[i].vs;
+				const int fl = fvs.size();
+				for (int j = 0; j < fl; ++j)
+				{
+					uint32_t v0 = fvs[j], v1 = fvs[(j + 1) % fl];
+					if (v0 > v1)
+						std::swap(v0, v1);
+					he_keys[he_offsets[i] + j] = (uint64_t(v0) << 32) | v1;
+					he_ids[he_offsets[i] + j] = he_offsets[i] + j;
+					he_faces[he_offsets[i] + j] = i;
+				}
+				hmi.faces[i].es.resize(fl);
 			}
-			hmi.faces[i].es.resize(fl);
-		}
-		std::sort(temp.begin(), temp.end());
-		hmi.edges.reserve(temp.size() / 2);
+		});
+		// stable, so ties are in (face, local edge) order as with the tuple sort
+		utils::radix_sort(he_keys, he_ids);
+
+		std::vector<uint32_t> he_edge(n_he);
 		uint32_t E_num = 0;
-		Edge e;
-		e.boundary = false;
-		e.vs.resize(2);
-		for (uint32_t i = 0; i < temp.size(); ++i)
+		for (uint32_t i = 0; i < n_he; ++i)
 		{
-			if (i == 0 || (i != 0 && (std::get<0>(temp[i]) != std::get<0>(temp[i - 1]) || std::get<1>(temp[i]) != std::get<1>(temp[i - 1]))))
-			{
-				e.id = E_num;
+			if (i == 0 || he_keys[i] != he_keys[i - 1])
 				E_num++;
-				e.vs[0] = std::get<0>(temp[i]);
-				e.vs[1] = std::get<1>(temp[i]);
-				hmi.edges.push_back(e);
-			}
-			hmi.faces[std::get<2>(temp[i])].es[std::get<3>(temp[i])] = E_num - 1;
+			he_edge[i] = E_num - 1;
 		}
+
+		hmi.edges.resize(E_num);
+		utils::maybe_parallel_for(n_he, [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				const uint32_t eid = he_edge[i];
+				if (i == 0 || he_keys[i] != he_keys[i - 1])
+				{
+					Edge &e = hmi.edges[eid];
+					e.id = eid;
+					e.vs = {uint32_t(he_keys[i] >> 32), uint32_t(he_keys[i])};
+					e.boundary = false;
+				}
+				const uint32_t fid = he_faces[he_ids[i]];
+				hmi.faces[fid].es[he_ids[i] - he_offsets[fid]] = eid;
+			}
+		});
 		// boundary
 		for (auto &v : hmi.vertices)
 			v.boundary = false;
@@ -198,247 +260,247 @@ void MeshProcessing3D::build_connectivity(Mesh3DStorage &hmi)
 				}
 	}
 	// f_nhs;
-	for (auto &f : hmi.faces)
-		f.neighbor_hs.clear();
-	for (uint32_t i = 0; i < hmi.elements.size(); i++)
-	{
-		for (uint32_t j = 0; j < hmi.elements[i].fs.size(); j++)
-		{
-			hmi.faces[hmi.elements[i].fs[j]].neighbor_hs.push_back(i);
-		}
-	}
+	invert_relation(
+		hmi.elements, [](const Element &h) -> const auto & { return h.fs; },
+		hmi.faces, [](Face &f) -> auto & { return f.neighbor_hs; });
 	// e_nfs, v_nfs
-	for (auto &e : hmi.edges)
-		e.neighbor_fs.clear();
-	for (auto &v : hmi.vertices)
-		v.neighbor_fs.clear();
-	for (uint32_t i = 0; i < hmi.faces.size(); i++)
-	{
-		for (uint32_t j = 0; j < hmi.faces[i].es.size(); j++)
-			hmi.edges[hmi.faces[i].es[j]].neighbor_fs.push_back(i);
-		for (uint32_t j = 0; j < hmi.faces[i].vs.size(); j++)
-			hmi.vertices[hmi.faces[i].vs[j]].neighbor_fs.push_back(i);
-	}
+	invert_relation(
+		hmi.faces, [](const Face &f) -> const auto & { return f.es; },
+		hmi.edges, [](Edge &e) -> auto & { return e.neighbor_fs; });
+	invert_relation(
+		hmi.faces, [](const Face &f) -> const auto & { return f.vs; },
+		hmi.vertices, [](Vertex &v) -> auto & { return v.neighbor_fs; });
 	// v_nes, v_nvs
-	for (auto &v : hmi.vertices)
-	{
-		v.neighbor_es.clear();
-		v.neighbor_vs.clear();
-	}
-	for (uint32_t i = 0; i < hmi.edges.size(); i++)
-	{
-		uint32_t v0 = hmi.edges[i].vs[0], v1 = hmi.edges[i].vs[1];
-		hmi.vertices[v0].neighbor_es.push_back(i);
-		hmi.vertices[v1].neighbor_es.push_back(i);
-		hmi.vertices[v0].neighbor_vs.push_back(v1);
-		hmi.vertices[v1].neighbor_vs.push_back(v0);
-	}
+	invert_relation(
+		hmi.edges, [](const Edge &e) -> const auto & { return e.vs; },
+		hmi.vertices, [](Vertex &v) -> auto & { return v.neighbor_es; });
+	utils::maybe_parallel_for(hmi.vertices.size(), [&](int start, int end, int thread_id) {
+		for (int i = start; i < end; ++i)
+		{
+			auto &v = hmi.vertices[i];
+			v.neighbor_vs.resize(v.neighbor_es.size());
+			for (uint32_t j = 0; j < v.neighbor_es.size(); ++j)
+			{
+				const auto &evs = hmi.edges[v.neighbor_es[j]].vs;
+				v.neighbor_vs[j] = evs[0] == i ? evs[1] : evs[0];
+			}
+		}
+	});
 	// e_nhs
-	for (auto &e : hmi.edges)
-		e.neighbor_hs.clear();
-	for (auto &ele : hmi.elements)
-		ele.es.clear();
-	for (uint32_t i = 0; i < hmi.edges.size(); i++)
-	{
-		std::vector<uint32_t> nhs;
-		for (uint32_t j = 0; j < hmi.edges[i].neighbor_fs.size(); j++)
+	utils::maybe_parallel_for(hmi.edges.size(), [&](int start, int end, int thread_id) {
+		for (int i = start; i < end; ++i)
 		{
-			uint32_t nfid = hmi.edges[i].neighbor_fs[j];
-			nhs.insert(nhs.end(), hmi.faces[nfid].neighbor_hs.begin(), hmi.faces[nfid].neighbor_hs.end());
+			std::vector<uint32_t> &nhs = hmi.edges[i].neighbor_hs;
+			nhs.clear();
+			for (uint32_t j = 0; j < hmi.edges[i].neighbor_fs.size(); j++)
+			{
+				uint32_t nfid = hmi.edges[i].neighbor_fs[j];
+				nhs.insert(nhs.end(), hmi.faces[nfid].neighbor_hs.begin(), hmi.faces[nfid].neighbor_hs.end());
+			}
+			std::sort(nhs.begin(), nhs.end());
+			nhs.erase(std::unique(nhs.begin(), nhs.end()), nhs.end());
 		}
-		std::sort(nhs.begin(), nhs.end());
-		nhs.erase(std::unique(nhs.begin(), nhs.end()), nhs.end());
-		hmi.edges[i].neighbor_hs = nhs;
-		for (auto nhid : nhs)
-			hmi.elements[nhid].es.push_back(i);
-	}
+	});
+	invert_relation(
+		hmi.edges, [](const Edge &e) -> const auto & { return e.neighbor_hs; },
+		hmi.elements, [](Element &h) -> auto & { return h.es; });
 	// v_nhs; ordering fs for hex
 	if (hmi.type != MeshType::HYB && hmi.type != MeshType::TET)
 		return;
 
-	for (auto &v : hmi.vertices)
-		v.neighbor_hs.clear();
-	for (uint32_t i = 0; i < hmi.elements.size(); i++)
-	{
-		vector<uint32_t> vs;
-		for (auto fid : hmi.elements[i].fs)
-			vs.insert(vs.end(), hmi.faces[fid].vs.begin(), hmi.faces[fid].vs.end());
-		sort(vs.begin(), vs.end());
-		vs.erase(unique(vs.begin(), vs.end()), vs.end());
-
-		bool degree3 = true;
-		for (auto vid : vs)
+	utils::maybe_parallel_for(hmi.elements.size(), [&](int start, int end, int thread_id) {
+		for (int i = start; i < end; i++)
 		{
-			int nv = 0;
-			for (auto nvid : hmi.vertices[vid].neighbor_vs)
-				if (find(vs.begin(), vs.end(), nvid) != vs.end())
-					nv++;
-			if (nv != 3)
+			vector<uint32_t> vs;
+			for (auto fid : hmi.elements[i].fs)
+				vs.insert(vs.end(), hmi.faces[fid].vs.begin(), hmi.faces[fid].vs.end());
+			sort(vs.begin(), vs.end());
+			vs.erase(unique(vs.begin(), vs.end()), vs.end());
+
+			bool degree3 = true;
+			for (auto vid : vs)
 			{
-				degree3 = false;
-				break;
+				int nv = 0;
+				for (auto nvid : hmi.vertices[vid].neighbor_vs)
+					if (find(vs.begin(), vs.end(), nvid) != vs.end())
+						nv++;
+				if (nv != 3)
+				{
+					degree3 = false;
+					break;
+				}
 			}
-		}
 
-		if (hmi.elements[i].hex && (vs.size() != 8 || !degree3))
-			hmi.elements[i].hex = false;
+			if (hmi.elements[i].hex && (vs.size() != 8 || !degree3))
+				hmi.elements[i].hex = false;
 
-		hmi.elements[i].vs.clear();
+			hmi.elements[i].vs.clear();
 
-		if (hmi.elements[i].hex)
-		{
-			int top_fid = hmi.elements[i].fs[0];
-			hmi.elements[i].vs = hmi.faces[top_fid].vs;
+			if (hmi.elements[i].hex)
+			{
+				int top_fid = hmi.elements[i].fs[0];
+				hmi.elements[i].vs = hmi.faces[top_fid].vs;
 
-			std::set<uint32_t> s_model(vs.begin(), vs.end());
-			std::set<uint32_t> s_pattern(hmi.faces[top_fid].vs.begin(), hmi.faces[top_fid].vs.end());
-			vector<uint32_t> vs_left;
-			std::set_difference(s_model.begin(), s_model.end(), s_pattern.begin(), s_pattern.end(), std::back_inserter(vs_left));
+				std::set<uint32_t> s_model(vs.begin(), vs.end());
+				std::set<uint32_t> s_pattern(hmi.faces[top_fid].vs.begin(), hmi.faces[top_fid].vs.end());
+				vector<uint32_t> vs_left;
+				std::set_difference(s_model.begin(), s_model.end(), s_pattern.begin(), s_pattern.end(), std::back_inserter(vs_left));
 
-			for (auto vid : hmi.faces[top_fid].vs)
-				for (auto nvid : hmi.vertices[vid].neighbor_vs)
-					if (find(vs_left.begin(), vs_left.end(), nvid) != vs_left.end())
-					{
-						hmi.elements[i].vs.push_back(nvid);
-						break;
-					}
+				for (auto vid : hmi.faces[top_fid].vs)
+					for (auto nvid : hmi.vertices[vid].neighbor_vs)
+						if (find(vs_left.begin(), vs_left.end(), nvid) != vs_left.end())
+						{
+							hmi.elements[i].vs.push_back(nvid);
+							break;
+						}
 
-			function<int(vector<uint32_t> &, int &)> WHICH_F = [&](vector<uint32_t> &vs0, int &f_flag) -> int {
-				int which_f = -1;
-				sort(vs0.begin(), vs0.end());
-				bool found_f = false;
-				for (uint32_t j = 0; j < hmi.elements[i].fs.size(); j++)
-				{
-					auto fid = hmi.elements[i].fs[j];
-					vector<uint32_t> vs1 = hmi.faces[fid].vs;
-					sort(vs1.begin(), vs1.end());
-					if (vs0.size() == vs1.size() && std::equal(vs0.begin(), vs0.end(), vs1.begin()))
+				function<int(vector<uint32_t> &, int &)> WHICH_F = [&](vector<uint32_t> &vs0, int &f_flag) -> int {
+					int which_f = -1;
+					sort(vs0.begin(), vs0.end());
+					bool found_f = false;
+					for (uint32_t j = 0; j < hmi.elements[i].fs.size(); j++)
 					{
-						f_flag = hmi.elements[i].fs_flag[j];
-						which_f = fid;
-						break;
+						auto fid = hmi.elements[i].fs[j];
+						vector<uint32_t> vs1 = hmi.faces[fid].vs;
+						sort(vs1.begin(), vs1.end());
+						if (vs0.size() == vs1.size() && std::equal(vs0.begin(), vs0.end(), vs1.begin()))
+						{
+							f_flag = hmi.elements[i].fs_flag[j];
+							which_f = fid;
+							break;
+						}
 					}
-				}
-				return which_f;
-			};
-
-			vector<uint32_t> fs;
-			vector<bool> fs_flag;
-			fs_flag.push_back(hmi.elements[i].fs_flag[0]);
-			fs.push_back(top_fid);
-			vector<uint32_t> vs_temp;
-
-			vs_temp.insert(vs_temp.end(), hmi.elements[i].vs.begin() + 4, hmi.elements[i].vs.end());
-			int f_flag = -1;
-			int bottom_fid = WHICH_F(vs_temp, f_flag);
-			fs_flag.push_back(f_flag);
-			fs.push_back(bottom_fid);
-
-			vs_temp.clear();
-			vs_temp.push_back(hmi.elements[i].vs[0]);
-			vs_temp.push_back(hmi.elements[i].vs[1]);
-			vs_temp.push_back(hmi.elements[i].vs[4]);
-			vs_temp.push_back(hmi.elements[i].vs[5]);
-			f_flag = -1;
-			int front_fid = WHICH_F(vs_temp, f_flag);
-			fs_flag.push_back(f_flag);
-			fs.push_back(front_fid);
-
-			vs_temp.clear();
-			vs_temp.push_back(hmi.elements[i].vs[2]);
-			vs_temp.push_back(hmi.elements[i].vs[3]);
-			vs_temp.push_back(hmi.elements[i].vs[6]);
-			vs_temp.push_back(hmi.elements[i].vs[7]);
-			f_flag = -1;
-			int back_fid = WHICH_F(vs_temp, f_flag);
-			fs_flag.push_back(f_flag);
-			fs.push_back(back_fid);
-
-			vs_temp.clear();
-			vs_temp.push_back(hmi.elements[i].vs[1]);
-			vs_temp.push_back(hmi.elements[i].vs[2]);
-			vs_temp.push_back(hmi.elements[i].vs[5]);
-			vs_temp.push_back(hmi.elements[i].vs[6]);
-			f_flag = -1;
-			int left_fid = WHICH_F(vs_temp, f_flag);
-			fs_flag.push_back(f_flag);
-			fs.push_back(left_fid);
-
-			vs_temp.clear();
-			vs_temp.push_back(hmi.elements[i].vs[3]);
-			vs_temp.push_back(hmi.elements[i].vs[0]);
-			vs_temp.push_back(hmi.elements[i].vs[7]);
-			vs_temp.push_back(hmi.elements[i].vs[4]);
-			f_flag = -1;
-			int right_fid = WHICH_F(vs_temp, f_flag);
-			fs_flag.push_back(f_flag);
-			fs.push_back(right_fid);
-
-			hmi.elements[i].fs = fs;
-			hmi.elements[i].fs_flag = fs_flag;
+					return which_f;
+				};
+
+				vector<uint32_t> fs;
+				vector<bool> fs_flag;
+				fs_flag.push_back(hmi.elements[i].fs_flag[0]);
+				fs.push_back(top_fid);
+				vector<uint32_t> vs_temp;
+
+				vs_temp.insert(vs_temp.end(), hmi.elements[i].vs.begin() + 4, hmi.elements[i].vs.end());
+				int f_flag = -1;
+				int bottom_fid = WHICH_F(vs_temp, f_flag);
+				fs_flag.push_back(f_flag);
+				fs.push_back(bottom_fid);
+
+				vs_temp.clear();
+				vs_temp.push_back(hmi.elements[i].vs[0]);
+				vs_temp.push_back(hmi.elements[i].vs[1]);
+				vs_temp.push_back(hmi.elements[i].vs[4]);
+				vs_temp.push_back(hmi.elements[i].vs[5]);
+				f_flag = -1;
+				int front_fid = WHICH_F(vs_temp, f_flag);
+				fs_flag.push_back(f_flag);
+				fs.push_back(front_fid);
+
+				vs_temp.clear();
+				vs_temp.push_back(hmi.elements[i].vs[2]);
+				vs_temp.push_back(hmi.elements[i].vs[3]);
+				vs_temp.push_back(hmi.elements[i].vs[6]);
+				vs_temp.push_back(hmi.elements[i].vs[7]);
+				f_flag = -1;
+				int back_fid = WHICH_F(vs_temp, f_flag);
+				fs_flag.push_back(f_flag);
+				fs.push_back(back_fid);
+
+				vs_temp.clear();
+				vs_temp.push_back(hmi.elements[i].vs[1]);
+				vs_temp.push_back(hmi.elements[i].vs[2]);
+				vs_temp.push_back(hmi.elements[i].vs[5]);
+				vs_temp.push_back(hmi.elements[i].vs[6]);
+				f_flag = -1;
+				int left_fid = WHICH_F(vs_temp, f_flag);
+				fs_flag.push_back(f_flag);
+				fs.push_back(left_fid);
+
+				vs_temp.clear();
+				vs_temp.push_back(hmi.elements[i].vs[3]);
+				vs_temp.push_back(hmi.elements[i].vs[0]);
+				vs_temp.push_back(hmi.elements[i].vs[7]);
+				vs_temp.push_back(hmi.elements[i].vs[4]);
+				f_flag = -1;
+				int right_fid = WHICH_F(vs_temp, f_flag);
+				fs_flag.push_back(f_flag);
+				fs.push_back(right_fid);
+
+				hmi.elements[i].fs = fs;
+				hmi.elements[i].fs_flag = fs_flag;
+			}
+			else
+				hmi.elements[i].vs = vs;
 		}
-		else
-			hmi.elements[i].vs = vs;
-		for (uint32_t j = 0; j < hmi.elements[i].vs.size(); j++)
-			hmi.vertices[hmi.elements[i].vs[j]].neighbor_hs.push_back(i);
-	}
+	});
+	invert_relation(
+		hmi.elements, [](const Element &h) -> const auto & { return h.vs; },
+		hmi.vertices, [](Vertex &v) -> auto & { return v.neighbor_hs; });
 	// matrix representation of tet mesh
 	if (hmi.type == MeshType::TET)
 	{
 		hmi.EV.resize(2, hmi.edges.size());
-		for (const auto &e : hmi.edges)
-		{
-			hmi.EV(0, e.id) = e.vs[0];
-			hmi.EV(1, e.id) = e.vs[1];
-		}
+		utils::maybe_parallel_for(hmi.edges.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				const auto &e = hmi.edges[i];
+				hmi.EV(0, e.id) = e.vs[0];
+				hmi.EV(1, e.id) = e.vs[1];
+			}
+		});
 		hmi.FV.resize(3, hmi.faces.size());
 		hmi.FE.resize(3, hmi.faces.size());
 		hmi.FH.resize(2, hmi.faces.size());
 		hmi.FHi.resize(2, hmi.faces.size());
-		for (const auto &f : hmi.faces)
-		{
-			hmi.FV(0, f.id) = f.vs[0];
-			hmi.FV(1, f.id) = f.vs[1];
-			hmi.FV(2, f.id) = f.vs[2];
-
-			hmi.FE(0, f.id) = f.es[0];
-			hmi.FE(1, f.id) = f.es[1];
-			hmi.FE(2, f.id) = f.es[2];
-
-			hmi.FH(0, f.id) = f.neighbor_hs[0];
-			for (int i = 0; i < hmi.elements[f.neighbor_hs[0]].fs.size(); i++)
-				if (f.id == hmi.elements[f.neighbor_hs[0]].fs[i])
-					hmi.FHi(0, f.id) = i;
-
-			hmi.FH(1, f.id) = -1;
-			hmi.FHi(1, f.id) = -1;
-			if (f.neighbor_hs.size() == 2)
+		utils::maybe_parallel_for(hmi.faces.size(), [&](int start, int end, int thread_id) {
+			for (int k = start; k < end; ++k)
 			{
-				hmi.FH(1, f.id) = f.neighbor_hs[1];
-				for (int i = 0; i < hmi.elements[f.neighbor_hs[1]].fs.size(); i++)
-					if (f.id == hmi.elements[f.neighbor_hs[1]].fs[i])
-						hmi.FHi(1, f.id) = i;
+				const auto &f = hmi.faces[k];
+				hmi.FV(0, f.id) = f.vs[0];
+				hmi.FV(1, f.id) = f.vs[1];
+				hmi.FV(2, f.id) = f.vs[2];
+
+				hmi.FE(0, f.id) = f.es[0];
+				hmi.FE(1, f.id) = f.es[1];
+				hmi.FE(2, f.id) = f.es[2];
+
+				hmi.FH(0, f.id) = f.neighbor_hs[0];
+				for (int i = 0; i < hmi.elements[f.neighbor_hs[0]].fs.size(); i++)
+					if (f.id == hmi.elements[f.neighbor_hs[0]].fs[i])
+						hmi.FHi(0, f.id) = i;
+
+				hmi.FH(1, f.id) = -1;
+				hmi.FHi(1, f.id) = -1;
+				if (f.neighbor_hs.size() == 2)
+				{
+					hmi.FH(1, f.id) = f.neighbor_hs[1];
+					for (int i = 0; i < hmi.elements[f.neighbor_hs[1]].fs.size(); i++)
+						if (f.id == hmi.elements[f.neighbor_hs[1]].fs[i])
+							hmi.FHi(1, f.id) = i;
+				}
 			}
-		}
+		});
 		hmi.HV.resize(4, hmi.elements.size());
 		hmi.HF.resize(4, hmi.elements.size());
-		for (const auto &h : hmi.elements)
-		{
-			hmi.HV(0, h.id) = h.vs[0];
-			hmi.HV(1, h.id) = h.vs[1];
-			hmi.HV(2, h.id) = h.vs[2];
-			hmi.HV(3, h.id) = h.vs[3];
-
-			hmi.HF(0, h.id) = h.fs[0];
-			hmi.HF(1, h.id) = h.fs[1];
-			hmi.HF(2, h.id) = h.fs[2];
-			hmi.HF(3, h.id) = h.fs[3];
-		}
+		utils::maybe_parallel_for(hmi.elements.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				const auto &h = hmi.elements[i];
+				hmi.HV(0, h.id) = h.vs[0];
+				hmi.HV(1, h.id) = h.vs[1];
+				hmi.HV(2, h.id) = h.vs[2];
+				hmi.HV(3, h.id) = h.vs[3];
+
+				hmi.HF(0, h.id) = h.fs[0];
+				hmi.HF(1, h.id) = h.fs[1];
+				hmi.HF(2, h.id) = h.fs[2];
+				hmi.HF(3, h.id) = h.fs[3];
+			}
+		});
 	}
 
 	// boundary flags for hybrid mesh
 	std::vector<bool> bv_flag(hmi.vertices.size(), false), be_flag(hmi.edges.size(), false), bf_flag(hmi.faces.size(), false);
-	for (auto f : hmi.faces)
+	for (const auto &f : hmi.faces)
 		if (f.boundary && hmi.elements[f.neighbor_hs[0]].hex)
 			bf_flag[f.id] = true;
 		else if (!f.boundary)
@@ -1735,6 +1797,11 @@ void MeshProcessing3D::ele_subdivison_levels(const Mesh3DStorage &hmi, std::vect
 // template<typename T>
 // void MeshProcessing3D::set_intersection_own(const std::vector<T> &A, const std::vector<T> &B, std::vector<T> &C, const int &num){
 void MeshProcessing3D::set_intersection_own(const std::vector<uint32_t> &A, const std::vector<uint32_t> &B, std::array<uint32_t, 2> &C, int &num)
+{
+	set_intersection_own(IndexRange(A), IndexRange(B), C, num);
+}
+
+void MeshProcessing3D::set_intersection_own(const IndexRange &A, const IndexRange &B, std::array<uint32_t, 2> &C, int &num)
 {
 	// void MeshProcessing3D::set_intersection_own( std::vector<uint32_t> &A,  std::vector<uint32_t> &B, std::vector<uint32_t> &C, int &num)
 	//  C.resize(num);
@@ -1754,3 +1821,110 @@ void MeshProcessing3D::set_intersection_own(const std::vector<uint32_t> &A, cons
 			break;
 	}
 }
+
+namespace
+{
+	template <typename T>
+	void release(std::vector<T> &v)
+	{
+		std::vector<T>().swap(v);
+	}
+
+	// copies one relation into CSR form and frees its lists right away, so that only one relation is duplicated at a time
+	template <typename Entity, typename List>
+	void compress_relation(std::vector<Entity> &entities, List list, CSRRelation &relation)
+	{
+		const int n = entities.size();
+		relation.offsets.resize(n + 1);
+		relation.offsets[0] = 0;
+		for (int i = 0; i < n; ++i)
+			relation.offsets[i + 1] = relation.offsets[i] + list(entities[i]).size();
+
+		relation.indices.resize(relation.offsets.back());
+		utils::maybe_parallel_for(n, [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				auto &l = list(entities[i]);
+				std::copy(l.begin(), l.end(), relation.indices.begin() + relation.offsets[i]);
+				release(l);
+			}
+		});
+	}
+
+	template <typename Entity, typename List>
+	void decompress_relation(std::vector<Entity> &entities, List list, const CSRRelation &relation)
+	{
+		assert(relation.size() == entities.size());
+		utils::maybe_parallel_for(entities.size(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+			{
+				const IndexRange r = relation[i];
+				list(entities[i]).assign(r.begin(), r.end());
+			}
+		});
+	}
+} // namespace
+
+void MeshProcessing3D::compress_connectivity(Mesh3DStorage &hmi)
+{
+	if (hmi.is_compressed())
+		return;
+
+	Mesh3DConnectivity &c = hmi.compressed;
+
+	compress_relation(hmi.elements, [](Element &h) -> auto & { return h.vs; }, c.HV);
+	compress_relation(hmi.elements, [](Element &h) -> auto & { return h.es; }, c.HE);
+	compress_relation(hmi.elements, [](Element &h) -> auto & { return h.fs; }, c.HF);
+	c.HF_flag.resize(c.HF.indices.size());
+	utils::maybe_parallel_for(hmi.elements.size(), [&](int start, int end, int thread_id) {
+		for (int i = start; i < end; ++i)
+		{
+			std::copy(hmi.elements[i].fs_flag.begin(), hmi.elements[i].fs_flag.end(), c.HF_flag.begin() + c.HF.offsets[i]);
+			release(hmi.elements[i].fs_flag);
+		}
+	});
+
+	compress_relation(hmi.faces, [](Face &f) -> auto & { return f.vs; }, c.FV);
+	compress_relation(hmi.faces, [](Face &f) -> auto & { return f.es; }, c.FE);
+	compress_relation(hmi.faces, [](Face &f) -> auto & { return f.neighbor_hs; }, c.FH);
+
+	compress_relation(hmi.edges, [](Edge &e) -> auto & { return e.vs; }, c.EV);
+	compress_relation(hmi.edges, [](Edge &e) -> auto & { return e.neighbor_fs; }, c.EF);
+	compress_relation(hmi.edges, [](Edge &e) -> auto & { return e.neighbor_hs; }, c.EH);
+
+	compress_relation(hmi.vertices, [](Vertex &v) -> auto & { return v.neighbor_vs; }, c.VV);
+	compress_relation(hmi.vertices, [](Vertex &v) -> auto & { return v.neighbor_es; }, c.VE);
+	compress_relation(hmi.vertices, [](Vertex &v) -> auto & { return v.neighbor_fs; }, c.VF);
+	compress_relation(hmi.vertices, [](Vertex &v) -> auto & { return v.neighbor_hs; }, c.VH);
+}
+
+void MeshProcessing3D::decompress_connectivity(Mesh3DStorage &hmi)
+{
+	if (!hmi.is_compressed())
+		return;
+
+	const Mesh3DConnectivity &c = hmi.compressed;
+
+	decompress_relation(hmi.elements, [](Element &h) -> auto & { return h.vs; }, c.HV);
+	decompress_relation(hmi.elements, [](Element &h) -> auto & { return h.es; }, c.HE);
+	decompress_relation(hmi.elements, [](Element &h) -> auto & { return h.fs; }, c.HF);
+	utils::maybe_parallel_for(hmi.elements.size(), [&](int start, int end, int thread_id) {
+		for (int i = start; i < end; ++i)
+			hmi.elements[i].fs_flag.assign(c.HF_flag.begin() + c.HF.offsets[i], c.HF_flag.begin() + c.HF.offsets[i + 1]);
+	});
+
+	decompress_relation(hmi.faces, [](Face &f) -> auto & { return f.vs; }, c.FV);
+	decompress_relation(hmi.faces, [](Face &f) -> auto & { return f.es; }, c.FE);
+	decompress_relation(hmi.faces, [](Face &f) -> auto & { return f.neighbor_hs; }, c.FH);
+
+	decompress_relation(hmi.edges, [](Edge &e) -> auto & { return e.vs; }, c.EV);
+	decompress_relation(hmi.edges, [](Edge &e) -> auto & { return e.neighbor_fs; }, c.EF);
+	decompress_relation(hmi.edges, [](Edge &e) -> auto & { return e.neighbor_hs; }, c.EH);
+
+	decompress_relation(hmi.vertices, [](Vertex &v) -> auto & { return v.neighbor_vs; }, c.VV);
+	decompress_relation(hmi.vertices, [](Vertex &v) -> auto & { return v.neighbor_es; }, c.VE);
+	decompress_relation(hmi.vertices, [](Vertex &v) -> auto & { return v.neighbor_fs; }, c.VF);
+	decompress_relation(hmi.vertices, [](Vertex &v) -> auto & { return v.neighbor_hs; }, c.VH);
+
+	hmi.compressed = Mesh3DConnectivity();
+}
@@ -46,6 +46,12 @@ namespace polyfem
 				{2, 3}};
 
 			void build_connectivity(Mesh3DStorage &hmi);
+			// move all adjacency lists into the flat compressed connectivity (built in parallel) and release the lists
+			// the lists must already exist (see build_connectivity), this lowers the memory held after construction
+			// but not the peak memory or the construction time, which includes this extra copy
+			void compress_connectivity(Mesh3DStorage &hmi);
+			// restore the adjacency lists from the compressed connectivity, needed before modifying the mesh
+			void decompress_connectivity(Mesh3DStorage &hmi);
 			void reorder_hex_mesh_propogation(Mesh3DStorage &hmi);
 			bool scaled_jacobian(Mesh3DStorage &hmi, Mesh_Quality &mq);
 			double a_jacobian(Eigen::Vector3d &v0, Eigen::Vector3d &v1, Eigen::Vector3d &v2, Eigen::Vector3d &v3);
@@ -62,6 +68,7 @@ namespace polyfem
 
 			// template<typename T>
 			void set_intersection_own(const std::vector<uint32_t> &A, const std::vector<uint32_t> &B, std::array<uint32_t, 2> &C, int &num);
+			void set_intersection_own(const IndexRange &A, const IndexRange &B, std::array<uint32_t, 2> &C, int &num);
 		} // namespace MeshProcessing3D
 	}     // namespace mesh
 } // namespace polyfem
@@ -3,15 +3,22 @@
 #include <polyfem/solver/forms/adjoint_forms/AdjointForm.hpp>
 #include <polyfem/utils/Logger.hpp>
 #include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/par_for.hpp>
 #include <polyfem/utils/Timer.hpp>
 #include <polyfem/io/OBJWriter.hpp>
 #include <polyfem/io/MshWriter.hpp>
 #include <polyfem/State.hpp>
 #include <polyfem/mesh/SlimSmooth.hpp>
 
+#include <algorithm>
+#include <functional>
 #include <list>
 #include <stack>
 
+#ifdef POLYFEM_WITH_TBB
+#include <tbb/task_arena.h>
+#endif
+
 namespace polyfem::solver
 {
 	namespace
@@ -59,6 +66,10 @@ namespace polyfem::solver
 
 			// prints a Topological Sort of the complete graph
 			vector<int> topologicalSort();
+
+			// groups the vertices by the length of the longest path reaching them,
+			// vertices in the same level do not depend on each other
+			vector<vector<int>> levels();
 		};
 
 		Graph::Graph(int V)
@@ -114,6 +125,59 @@ namespace polyfem::solver
 
 			return sorted;
 		}
+
+		vector<vector<int>> Graph::levels()
+		{
+			const vector<int> sorted = topologicalSort();
+
+			vector<int> level(V, 0);
+			int n_levels = 0;
+			for (int v : sorted)
+			{
+				for (int w : adj[v])
+					level[w] = std::max(level[w], level[v] + 1);
+				n_levels = std::max(n_levels, level[v] + 1);
+			}
+
+			vector<vector<int>> grouped(n_levels);
+			for (int v : sorted)
+				grouped[level[v]].push_back(v);
+
+			return grouped;
+		}
+
+		/// Runs func on every task, one level after the other. Tasks of the same level are independent
+		/// and run concurrently. With TBB, each one runs in a task arena limited to its share of the threads
+		/// for its nested parallel loops. With std threads there is no such split: the tasks are spread over
+		/// the threads of par_for and every nested loop starts its own get_n_threads() threads, so up to
+		/// n_tasks * get_n_threads() threads can run at once. Without a parallel backend the tasks run serially.
+		void run_levels(const vector<vector<int>> &levels, const bool parallel, const std::function<void(int)> &func)
+		{
+			for (const auto &level : levels)
+			{
+				if (!parallel || level.size() <= 1)
+				{
+					for (int i : level)
+						func(i);
+					continue;
+				}
+
+				const int n_tasks = level.size();
+				const int n_threads = utils::get_n_threads();
+				utils::maybe_parallel_for(n_tasks, [&](int start, int end, int thread_id) {
+					for (int k = start; k < end; ++k)
+					{
+#ifdef POLYFEM_WITH_TBB
+						const int share = n_threads / n_tasks + (k < n_threads % n_tasks ? 1 : 0);
+						tbb::task_arena arena(std::max(1, share));
+						arena.execute([&]() { func(level[k]); });
+#else
+						func(level[k]);
+#endif
+					}
+				});
+			}
+		}
 	} // namespace
 
 	AdjointNLProblem::AdjointNLProblem(std::shared_ptr<AdjointForm> form, const VariableToSimulationGroup &variables_to_simulation, const std::vector<std::shared_ptr<State>> &all_states, const json &args)
@@ -124,7 +188,8 @@ namespace polyfem::solver
 		  save_freq(args["output"]["save_frequency"]),
 		  enable_slim(args["solver"]["advanced"]["enable_slim"]),
 		  smooth_line_search(args["solver"]["advanced"]["smooth_line_search"]),
-		  solve_in_parallel(args["solver"]["advanced"]["solve_in_parallel"])
+		  solve_in_parallel(args["solver"]["advanced"]["solve_in_parallel"]),
+		  surrogate_snapshots(args["solver"]["advanced"]["surrogate_line_search"])
 	{
 		cur_grad.setZero(0);
 
@@ -152,8 +217,12 @@ namespace polyfem::solver
 			}
 
 			solve_in_order = G.topologicalSort();
+			solve_levels = G.levels();
 		}
 
+		for (const auto &state : all_states_)
+			state->set_max_surrogate_snapshots(surrogate_snapshots);
+
 		active_state_mask.assign(all_states_.size(), false);
 		for (int i = 0; i < all_states_.size(); i++)
 		{
@@ -183,34 +252,70 @@ namespace polyfem::solver
 
 	double AdjointNLProblem::value(const Eigen::VectorXd &x)
 	{
+		// line-search trials are evaluated on the surrogate solutions on purpose
+		if (!in_line_search)
+			ensure_actual_solutions(x);
 		return form_->value(x);
 	}
 
 	void AdjointNLProblem::gradient(const Eigen::VectorXd &x, Eigen::VectorXd &gradv)
 	{
+		// the adjoint is only consistent with actual forward solutions
+		ensure_actual_solutions(x);
+
 		if (cur_grad.size() == x.size())
 			gradv = cur_grad;
 		else
 		{
-			gradv.setZero(x.size());
+			std::vector<Eigen::VectorXd> grads;
+			gradients(x, {form_}, grads);
+			gradv = grads[0];
 
+			if (x.size() < 10)
 			{
-				POLYFEM_SCOPED_TIMER("adjoint solve");
-				for (int i = 0; i < all_states_.size(); i++)
-					all_states_[i]->solve_adjoint_cached(form_->compute_reduced_adjoint_rhs(x, *all_states_[i])); // caches inside state
+				adjoint_logger().trace("x {}", x.transpose());
+				adjoint_logger().trace("gradient {}", gradv.transpose());
 			}
 
+			cur_grad = gradv;
+		}
+	}
+
+	void AdjointNLProblem::gradients(const Eigen::VectorXd &x, const std::vector<std::shared_ptr<AdjointForm>> &forms, std::vector<Eigen::VectorXd> &grads)
+	{
+		ensure_actual_solutions(x);
+
+		// adjoints[i][k] is the adjoint of state i for forms[k]
+		std::vector<std::vector<Eigen::MatrixXd>> adjoints(all_states_.size());
+		{
+			POLYFEM_SCOPED_TIMER("adjoint solve");
+
+			// the right-hand sides go through the (shared) forms, only the solves run concurrently
+			std::vector<std::vector<Eigen::MatrixXd>> adjoint_rhs(all_states_.size());
+			for (int i = 0; i < all_states_.size(); i++)
+				for (const auto &form : forms)
+					adjoint_rhs[i].push_back(form->compute_reduced_adjoint_rhs(x, *all_states_[i]));
+
+			// an adjoint solve writes the caches of its own state (diff_cached and solve_data when evicted time steps are
+			// recomputed), nothing shared across states, so they are independent. The forms of a state share one
+			// factorization per system
+			run_levels({solve_in_order}, solve_in_parallel, [&](int i) {
+				adjoints[i] = all_states_[i]->solve_adjoints(adjoint_rhs[i]);
+			});
+		}
+
+		{
+			POLYFEM_SCOPED_TIMER("gradient assembly");
+			grads.resize(forms.size());
+			for (int k = 0; k < forms.size(); ++k)
 			{
-				POLYFEM_SCOPED_TIMER("gradient assembly");
-				form_->first_derivative(x, gradv);
-				if (x.size() < 10)
-				{
-					adjoint_logger().trace("x {}", x.transpose());
-					adjoint_logger().trace("gradient {}", gradv.transpose());
-				}
-			}
+				// the forms read the adjoints cached inside the states
+				for (int i = 0; i < all_states_.size(); i++)
+					all_states_[i]->diff_cached.cache_adjoints(adjoints[i][k]);
 
-			cur_grad = gradv;
+				grads[k].setZero(x.size());
+				forms[k]->first_derivative(x, grads[k]);
+			}
 		}
 	}
 
@@ -275,15 +380,27 @@ namespace polyfem::solver
 	void AdjointNLProblem::line_search_begin(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1)
 	{
 		form_->line_search_begin(x0, x1);
+
+		if (surrogate_snapshots > 0)
+		{
+			in_line_search = true;
+			line_search_start_energy = form_->value(x0);
+		}
 	}
 
 	void AdjointNLProblem::line_search_end()
 	{
 		form_->line_search_end();
+
+		// the last trial can be rejected by the surrogate, whether it is the accepted iterate is only known by the
+		// optimizer, so the states are solved again at the iterate passed to the next call of value, gradient, post_step, or stop
+		in_line_search = false;
 	}
 
 	void AdjointNLProblem::post_step(const polysolve::nonlinear::PostStepData &data)
 	{
+		ensure_actual_solutions(data.x);
+
 		save_to_file(save_iter++, data.x);
 
 		form_->post_step(data);
@@ -351,6 +468,17 @@ namespace polyfem::solver
 	}
 
 	void AdjointNLProblem::solution_changed(const Eigen::VectorXd &newX)
+	{
+		update_states(newX, in_line_search);
+	}
+
+	void AdjointNLProblem::ensure_actual_solutions(const Eigen::VectorXd &x)
+	{
+		if (surrogate_solution)
+			update_states(x, false);
+	}
+
+	void AdjointNLProblem::update_states(const Eigen::VectorXd &newX, const bool allow_surrogate)
 	{
 		bool need_rebuild_basis = false;
 
@@ -364,8 +492,25 @@ namespace polyfem::solver
 
 		if (need_rebuild_basis)
 		{
+			// only the vertex positions changed, the topology is the same
 			for (const auto &state : all_states_)
-				state->build_basis();
+				state->update_basis_geometry();
+		}
+
+		curr_x = newX;
+
+		// trials that do not even decrease the energy with the surrogate are rejected without a full solve
+		if (allow_surrogate && solve_pde_surrogate())
+		{
+			form_->solution_changed(newX);
+			const double surrogate_energy = form_->value(newX);
+			if (!std::isfinite(surrogate_energy) || surrogate_energy >= line_search_start_energy)
+			{
+				adjoint_logger().debug("Surrogate energy {} does not decrease from {}, skipping the forward solve", surrogate_energy, line_search_start_energy);
+				surrogate_solution = true;
+				++n_surrogate_rejections_;
+				return;
+			}
 		}
 
 		// solve PDE
@@ -373,7 +518,7 @@ namespace polyfem::solver
 
 		form_->solution_changed(newX);
 
-		curr_x = newX;
+		surrogate_solution = false;
 	}
 
 	bool AdjointNLProblem::after_line_search_custom_operation(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1)
@@ -420,42 +565,44 @@ namespace polyfem::solver
 	void AdjointNLProblem::solve_pde()
 	{
 		if (solve_in_parallel)
-		{
 			adjoint_logger().info("Run simulations in parallel...");
-
-			utils::maybe_parallel_for(all_states_.size(), [&](int start, int end, int thread_id) {
-				for (int i = start; i < end; i++)
-				{
-					auto state = all_states_[i];
-					if (active_state_mask[i] || state->diff_cached.size() == 0)
-					{
-						state->assemble_rhs();
-						state->assemble_mass_mat();
-						Eigen::MatrixXd sol, pressure; // solution is also cached in state
-						state->solve_problem(sol, pressure);
-					}
-				}
-			});
-		}
 		else
-		{
 			adjoint_logger().info("Run simulations in serial...");
 
-			Eigen::MatrixXd sol, pressure; // solution is also cached in state
-			for (int i : solve_in_order)
+		// states in the same level do not depend on each other's solution
+		run_levels(solve_in_parallel ? solve_levels : std::vector<std::vector<int>>{solve_in_order}, solve_in_parallel, [&](int i) {
+			auto state = all_states_[i];
+			if (active_state_mask[i] || state->diff_cached.size() == 0)
 			{
-				auto state = all_states_[i];
-				if (active_state_mask[i] || state->diff_cached.size() == 0)
-				{
-					state->assemble_rhs();
-					state->assemble_mass_mat();
-
-					state->solve_problem(sol, pressure);
-				}
+				state->assemble_rhs();
+				state->assemble_mass_mat();
+				Eigen::MatrixXd sol, pressure; // solution is also cached in state
+				state->solve_problem(sol, pressure);
 			}
+		});
+
+		++n_forward_solves_;
+		cur_grad.resize(0);
+	}
+
+	bool AdjointNLProblem::solve_pde_surrogate()
+	{
+		for (int i : solve_in_order)
+		{
+			auto state = all_states_[i];
+			if (!active_state_mask[i])
+				continue;
+
+			state->assemble_rhs();
+			state->assemble_mass_mat();
+			Eigen::MatrixXd sol; // solution is also cached in state
+			if (!state->solve_surrogate(sol))
+				return false;
 		}
 
+		++n_surrogate_solves_;
 		cur_grad.resize(0);
+		return true;
 	}
 
 	bool AdjointNLProblem::stop(const TVector &x)
@@ -463,6 +610,7 @@ namespace polyfem::solver
 		if (stopping_conditions_.size() == 0)
 			return false;
 
+		ensure_actual_solutions(x);
 		for (auto &obj : stopping_conditions_)
 		{
 			obj->solution_changed(x);
@@ -39,8 +39,24 @@ namespace polyfem::solver
 		void solution_changed(const Eigen::VectorXd &new_x) override;
 		bool after_line_search_custom_operation(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) override;
 		void solve_pde();
+		/// gradients of several forms of the same states at x, e.g. an objective and constraints; each state solves the
+		/// adjoints of all forms with one factorization of its adjoint system. The adjoint of the last form stays cached
+		void gradients(const Eigen::VectorXd &x, const std::vector<std::shared_ptr<AdjointForm>> &forms, std::vector<Eigen::VectorXd> &grads);
+
+		/// number of forward solves of all the active states, actual and with the surrogate
+		int n_forward_solves() const { return n_forward_solves_; }
+		int n_surrogate_solves() const { return n_surrogate_solves_; }
+		/// number of line-search trials rejected by the surrogate without an actual forward solve
+		int n_surrogate_rejections() const { return n_surrogate_rejections_; }
 
 	private:
+		// solves the active states with their reduced-order surrogate, false if one of them has none
+		bool solve_pde_surrogate();
+		// updates the parameters and solves the states, with the surrogate if allowed and it rejects the trial
+		void update_states(const Eigen::VectorXd &newX, const bool allow_surrogate);
+		// replaces the surrogate solutions held by the states with actual forward solves at x
+		void ensure_actual_solutions(const Eigen::VectorXd &x);
+
 		std::shared_ptr<AdjointForm> form_;
 		const VariableToSimulationGroup variables_to_simulation_;
 		std::vector<std::shared_ptr<State>> all_states_;
@@ -56,6 +72,16 @@ namespace polyfem::solver
 
 		const bool solve_in_parallel;
 		std::vector<int> solve_in_order;
+		std::vector<std::vector<int>> solve_levels; // solve_in_order grouped into sets of independent states
+
+		// line-search trials are first screened with a reduced-order surrogate of the forward solves
+		const int surrogate_snapshots;
+		bool in_line_search = false;
+		bool surrogate_solution = false; // the states hold surrogate solutions
+		double line_search_start_energy = 0;
+		int n_forward_solves_ = 0;
+		int n_surrogate_solves_ = 0;
+		int n_surrogate_rejections_ = 0;
 
 		int save_iter = 0;
 
@@ -661,7 +661,7 @@ namespace polyfem::solver
 	}
 
 	void AdjointTools::dJ_shape_transient_adjoint_term(
-		const State &state,
+		State &state,
 		const Eigen::MatrixXd &adjoint_nu,
 		const Eigen::MatrixXd &adjoint_p,
 		Eigen::VectorXd &one_form)
@@ -671,12 +671,14 @@ namespace polyfem::solver
 		const int time_steps = state.args["time"]["time_steps"];
 		const int bdf_order = get_bdf_order(state);
 
-		Eigen::VectorXd elasticity_term, rhs_term, pressure_term, damping_term, mass_term, contact_term, friction_term;
 		one_form.setZero(state.n_geom_bases * state.mesh->dimension());
 
-		Eigen::VectorXd cur_p, cur_nu;
-		for (int i = time_steps; i > 0; --i)
-		{
+		// the terms of different time steps are independent, only the accumulator is per thread: the forms run nested
+		// parallel loops, during which TBB can start another time step on the same thread, so the per-step vectors
+		// must not live in the thread storage
+		auto storage = utils::create_thread_storage(LocalThreadVecStorage(one_form.size()));
+
+		auto step_term = [&](const int i, const solver::DiffCache::StepQuantities *step, LocalThreadVecStorage &local_storage) {
 			const int real_order = std::min(bdf_order, i);
 			double beta = time_integrator::BDF::betas(real_order - 1);
 			double beta_dt = beta * dt;
@@ -684,11 +686,13 @@ namespace polyfem::solver
 
 			Eigen::MatrixXd velocity = state.diff_cached.v(i);
 
-			cur_p = adjoint_p.col(i);
-			cur_nu = adjoint_nu.col(i);
+			Eigen::VectorXd cur_p = adjoint_p.col(i);
+			Eigen::VectorXd cur_nu = adjoint_nu.col(i);
 			cur_p(state.boundary_nodes).setZero();
 			cur_nu(state.boundary_nodes).setZero();
 
+			Eigen::VectorXd elasticity_term, rhs_term, pressure_term, damping_term, mass_term, contact_term, friction_term;
+
 			{
 				state.solve_data.inertia_form->force_shape_derivative(state.mesh->is_volume(), state.n_geom_bases, t, state.bases, state.geom_bases(), *(state.mass_matrix_assembler), state.mass_ass_vals_cache, velocity, cur_nu, mass_term);
 				state.solve_data.elastic_form->force_shape_derivative(t, state.n_geom_bases, state.diff_cached.u(i), state.diff_cached.u(i), cur_p, elasticity_term);
@@ -703,7 +707,7 @@ namespace polyfem::solver
 
 				if (state.is_contact_enabled())
 				{
-					state.solve_data.contact_form->force_shape_derivative(state.diff_cached.collision_set(i), state.diff_cached.u(i), cur_p, contact_term);
+					state.solve_data.contact_form->force_shape_derivative(step->collision_set, state.diff_cached.u(i), cur_p, contact_term);
 					contact_term = state.basis_nodes_to_gbasis_nodes * contact_term;
 					// contact_term /= beta_dt * beta_dt;
 				}
@@ -712,7 +716,7 @@ namespace polyfem::solver
 
 				if (state.solve_data.friction_form)
 				{
-					state.solve_data.friction_form->force_shape_derivative(state.diff_cached.u(i - 1), state.diff_cached.u(i), cur_p, state.diff_cached.friction_collision_set(i), friction_term);
+					state.solve_data.friction_form->force_shape_derivative(state.diff_cached.u(i - 1), state.diff_cached.u(i), cur_p, step->friction_collision_set, friction_term);
 					friction_term = state.basis_nodes_to_gbasis_nodes * (friction_term / beta);
 					// friction_term /= beta_dt * beta_dt;
 				}
@@ -720,11 +724,36 @@ namespace polyfem::solver
 					friction_term.setZero(mass_term.size());
 			}
 
-			one_form += beta_dt * (elasticity_term + rhs_term + pressure_term + damping_term + contact_term + friction_term + mass_term);
+			local_storage.vec += beta_dt * (elasticity_term + rhs_term + pressure_term + damping_term + contact_term + friction_term + mass_term);
+		};
+
+		// the collision sets of evicted steps are loaded serially, loading can replay the step on the solver state
+		// that the forms read; blocks of pinned steps are then processed in parallel
+		const bool needs_collisions = state.is_contact_enabled() || state.solve_data.friction_form;
+		const int block_size = needs_collisions && state.diff_cached.is_checkpointing() ? state.diff_cached.max_resident_steps() : time_steps;
+		std::vector<solver::DiffCache::StepHandle> steps(time_steps + 1);
+		for (int last = time_steps; last > 0; last -= block_size)
+		{
+			const int first = std::max(1, last - block_size + 1);
+			if (needs_collisions)
+				for (int i = last; i >= first; --i)
+					steps[i] = state.diff_cached.load(i);
+
+			utils::maybe_parallel_for(last - first + 1, [&](int start, int end, int thread_id) {
+				LocalThreadVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+				for (int i_aux = start; i_aux < end; ++i_aux)
+					step_term(last - i_aux, steps[last - i_aux].get(), local_storage);
+			});
+
+			for (int i = last; i >= first; --i)
+				steps[i] = nullptr;
 		}
 
+		for (const LocalThreadVecStorage &local_storage : storage)
+			one_form += local_storage.vec;
+
 		// time step 0
-		Eigen::VectorXd sum_alpha_p;
+		Eigen::VectorXd sum_alpha_p, mass_term;
 		{
 			sum_alpha_p.setZero(adjoint_p.rows());
 			int num = std::min(bdf_order, time_steps);
@@ -790,7 +819,7 @@ namespace polyfem::solver
 	}
 
 	void AdjointTools::dJ_friction_transient_adjoint_term(
-		const State &state,
+		State &state,
 		const Eigen::MatrixXd &adjoint_nu,
 		const Eigen::MatrixXd &adjoint_p,
 		Eigen::VectorXd &one_form)
@@ -829,7 +858,7 @@ namespace polyfem::solver
 
 			Eigen::MatrixXd force = state.collision_mesh.to_full_dof(
 				-state.solve_data.friction_form->friction_potential().force(
-					state.diff_cached.friction_collision_set(t),
+					state.diff_cached.load(t)->friction_collision_set,
 					state.collision_mesh,
 					state.collision_mesh.rest_positions(),
 					/*lagged_displacements=*/surface_solution_prev,
@@ -983,30 +1012,33 @@ namespace polyfem::solver
 		const int n_pressure_dof = boundary_ids.size();
 
 		one_form.setZero(time_steps * n_pressure_dof);
-		Eigen::VectorXd cur_p, cur_nu;
-		for (int i = time_steps; i > 0; --i)
-		{
-			const int real_order = std::min(bdf_order, i);
-			double beta = time_integrator::BDF::betas(real_order - 1);
-			double beta_dt = beta * dt;
-			const double t = i * dt + t0;
 
-			cur_p = adjoint_p.col(i);
-			cur_nu = adjoint_nu.col(i);
-			cur_p(state.boundary_nodes).setZero();
-			cur_nu(state.boundary_nodes).setZero();
-
-			for (int b = 0; b < boundary_ids.size(); ++b)
+		// every time step writes its own block of one_form
+		utils::maybe_parallel_for(time_steps, [&](int start, int end, int thread_id) {
+			Eigen::VectorXd cur_p;
+			for (int i_aux = start; i_aux < end; ++i_aux)
 			{
-				double pressure_term = state.solve_data.pressure_form->force_pressure_derivative(
-					state.n_geom_bases,
-					t,
-					boundary_ids[b],
-					state.diff_cached.u(i),
-					cur_p);
-				one_form((i - 1) * n_pressure_dof + b) = -beta_dt * pressure_term;
+				const int i = time_steps - i_aux;
+				const int real_order = std::min(bdf_order, i);
+				double beta = time_integrator::BDF::betas(real_order - 1);
+				double beta_dt = beta * dt;
+				const double t = i * dt + t0;
+
+				cur_p = adjoint_p.col(i);
+				cur_p(state.boundary_nodes).setZero();
+
+				for (int b = 0; b < boundary_ids.size(); ++b)
+				{
+					double pressure_term = state.solve_data.pressure_form->force_pressure_derivative(
+						state.n_geom_bases,
+						t,
+						boundary_ids[b],
+						state.diff_cached.u(i),
+						cur_p);
+					one_form((i - 1) * n_pressure_dof + b) = -beta_dt * pressure_term;
+				}
 			}
-		}
+		});
 	}
 
 	void AdjointTools::dJ_du_step(
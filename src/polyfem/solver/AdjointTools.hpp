@@ -88,7 +88,7 @@ namespace polyfem::solver
 			Eigen::VectorXd &one_form);
 
 		void dJ_shape_transient_adjoint_term(
-			const State &state,
+			State &state,
 			const Eigen::MatrixXd &adjoint_nu,
 			const Eigen::MatrixXd &adjoint_p,
 			Eigen::VectorXd &one_form);
@@ -103,7 +103,7 @@ namespace polyfem::solver
 			const Eigen::MatrixXd &adjoint_p,
 			Eigen::VectorXd &one_form);
 		void dJ_friction_transient_adjoint_term(
-			const State &state,
+			State &state,
 			const Eigen::MatrixXd &adjoint_nu,
 			const Eigen::MatrixXd &adjoint_p,
 			Eigen::VectorXd &one_form);
@@ -0,0 +1,169 @@
+#include "DiffCache.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+namespace polyfem::solver
+{
+	void DiffCache::set_checkpointing(const int max_resident_steps, const std::string &scratch_path, RecomputeFunc recompute)
+	{
+		max_resident_steps_ = max_resident_steps < 0 ? -1 : std::max(max_resident_steps, MIN_RESIDENT_STEPS);
+		recompute_ = recompute;
+
+		if (scratch_.is_open())
+			scratch_.close();
+		std::fill(scratch_offsets_.begin(), scratch_offsets_.end(), -1);
+		std::fill(spilled_.begin(), spilled_.end(), nullptr);
+
+		if (max_resident_steps_ < 0 || scratch_path.empty())
+			return;
+
+		scratch_.open(scratch_path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!scratch_.is_open())
+			log_and_throw_error("Unable to open the adjoint scratch file {}!", scratch_path);
+	}
+
+	void DiffCache::step_cached(const int step, const StiffnessMatrix &gradu_h, const ipc::Collisions &collision_set, const ipc::FrictionCollisions &friction_collision_set)
+	{
+		assert(step < steps_.size());
+
+		auto quantities = std::make_shared<StepQuantities>();
+		quantities->gradu_h = gradu_h;
+		quantities->gradu_h.makeCompressed();
+		quantities->collision_set = collision_set;
+		quantities->friction_collision_set = friction_collision_set;
+
+		if (!steps_[step])
+			++n_resident_;
+		steps_[step] = quantities;
+		last_access_[step] = ++access_counter_;
+		scratch_offsets_[step] = -1; // the spilled copy is outdated
+		spilled_[step] = nullptr;
+
+		evict_least_recently_used(step);
+	}
+
+	const DiffCache::StepQuantities &DiffCache::resident(int step) const
+	{
+		assert(step < size());
+		if (step < 0)
+			step += steps_.size();
+
+		if (!steps_[step])
+			log_and_throw_error("Adjoint quantities of step {} were evicted, load the step first!", step);
+		return *steps_[step];
+	}
+
+	DiffCache::StepHandle DiffCache::load(int step)
+	{
+		assert(step < size());
+		if (step < 0)
+			step += steps_.size();
+
+		// the recomputation replays the step on the solver state of the simulation, one at a time
+		std::lock_guard<std::mutex> lock(load_mutex_);
+
+		if (!steps_[step])
+		{
+			std::shared_ptr<StepQuantities> quantities;
+			if (scratch_offsets_[step] >= 0)
+			{
+				quantities = std::move(spilled_[step]);
+				read_scratch(step, quantities->gradu_h);
+			}
+			else if (recompute_)
+			{
+				quantities = std::make_shared<StepQuantities>();
+				recompute_(step, quantities->gradu_h, quantities->collision_set, quantities->friction_collision_set);
+				quantities->gradu_h.makeCompressed();
+			}
+			else
+				log_and_throw_error("Adjoint quantities of step {} were evicted and cannot be recomputed!", step);
+
+			steps_[step] = quantities;
+			++n_resident_;
+		}
+		last_access_[step] = ++access_counter_;
+
+		evict_least_recently_used(step);
+
+		return steps_[step];
+	}
+
+	void DiffCache::evict_least_recently_used(const int keep)
+	{
+		if (max_resident_steps_ < 0)
+			return;
+
+		while (n_resident_ > max_resident_steps_)
+		{
+			// step 0 is never evicted
+			int victim = -1;
+			for (int step = 1; step < steps_.size(); ++step)
+			{
+				if (steps_[step] && step != keep && (victim < 0 || last_access_[step] < last_access_[victim]))
+					victim = step;
+			}
+
+			if (victim < 0)
+				break;
+			evict(victim);
+		}
+	}
+
+	void DiffCache::evict(const int step)
+	{
+		if (scratch_.is_open())
+		{
+			if (scratch_offsets_[step] < 0)
+				write_scratch(step, steps_[step]->gradu_h);
+
+			// the collision sets are small compared to the force Jacobian and stay in memory
+			auto spilled = std::make_shared<StepQuantities>();
+			spilled->collision_set = steps_[step]->collision_set;
+			spilled->friction_collision_set = steps_[step]->friction_collision_set;
+			spilled_[step] = spilled;
+		}
+
+		// the handles returned by load keep their quantities alive
+		steps_[step] = nullptr;
+		--n_resident_;
+	}
+
+	void DiffCache::write_scratch(const int step, const StiffnessMatrix &mat)
+	{
+		using StorageIndex = StiffnessMatrix::StorageIndex;
+		assert(mat.isCompressed());
+
+		scratch_.seekp(0, std::ios::end);
+		scratch_offsets_[step] = scratch_.tellp();
+
+		const int64_t header[3] = {mat.rows(), mat.cols(), mat.nonZeros()};
+		scratch_.write(reinterpret_cast<const char *>(header), sizeof(header));
+		scratch_.write(reinterpret_cast<const char *>(mat.outerIndexPtr()), sizeof(StorageIndex) * (mat.outerSize() + 1));
+		scratch_.write(reinterpret_cast<const char *>(mat.innerIndexPtr()), sizeof(StorageIndex) * mat.nonZeros());
+		scratch_.write(reinterpret_cast<const char *>(mat.valuePtr()), sizeof(double) * mat.nonZeros());
+
+		if (!scratch_)
+			log_and_throw_error("Failed to write step {} to the adjoint scratch file!", step);
+	}
+
+	void DiffCache::read_scratch(const int step, StiffnessMatrix &mat)
+	{
+		using StorageIndex = StiffnessMatrix::StorageIndex;
+
+		scratch_.seekg(scratch_offsets_[step]);
+
+		int64_t header[3];
+		scratch_.read(reinterpret_cast<char *>(header), sizeof(header));
+
+		mat.resize(header[0], header[1]);
+		mat.makeCompressed();
+		mat.resizeNonZeros(header[2]);
+		scratch_.read(reinterpret_cast<char *>(mat.outerIndexPtr()), sizeof(StorageIndex) * (mat.outerSize() + 1));
+		scratch_.read(reinterpret_cast<char *>(mat.innerIndexPtr()), sizeof(StorageIndex) * header[2]);
+		scratch_.read(reinterpret_cast<char *>(mat.valuePtr()), sizeof(double) * header[2]);
+
+		if (!scratch_)
+			log_and_throw_error("Failed to read step {} from the adjoint scratch file!", step);
+	}
+} // namespace polyfem::solver
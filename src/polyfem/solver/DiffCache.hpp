@@ -6,6 +6,13 @@
 #include <ipc/collisions/collisions.hpp>
 #include <ipc/friction/friction_collisions.hpp>
 
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 namespace polyfem::solver
 {
 	enum class CacheLevel
@@ -18,6 +25,22 @@ namespace polyfem::solver
 	class DiffCache
 	{
 	public:
+		/// @brief Force Jacobian and collision sets of a time step
+		struct StepQuantities
+		{
+			StiffnessMatrix gradu_h;
+			ipc::Collisions collision_set;
+			ipc::FrictionCollisions friction_collision_set;
+		};
+		/// @brief Shared ownership of the quantities of a step, they stay valid after the step is evicted from the cache
+		using StepHandle = std::shared_ptr<const StepQuantities>;
+
+		/// @brief Recomputes the force Jacobian and the collision sets of a time step from the cached trajectory
+		using RecomputeFunc = std::function<void(const int step, StiffnessMatrix &gradu_h, ipc::Collisions &collision_set, ipc::FrictionCollisions &friction_collision_set)>;
+
+		/// @brief Minimal number of time steps kept in memory when checkpointing
+		static constexpr int MIN_RESIDENT_STEPS = 4;
+
 		void init(const int dimension, const int ndof, const int n_time_steps = 0)
 		{
 			cur_size_ = 0;
@@ -28,15 +51,44 @@ namespace polyfem::solver
 			if (n_time_steps_ > 0)
 			{
 				bdf_order_.setZero(n_time_steps + 1);
+				barrier_stiffness_.setZero(n_time_steps + 1);
 				v_.setZero(ndof, n_time_steps + 1);
 				acc_.setZero(ndof, n_time_steps + 1);
 				// gradu_h_prev_.resize(n_time_steps + 1);
 			}
-			gradu_h_.resize(n_time_steps + 1);
-			collision_set_.resize(n_time_steps + 1);
- 			friction_collision_set_.resize(n_time_steps + 1);
+			steps_.assign(n_time_steps + 1, nullptr);
+			spilled_.assign(n_time_steps + 1, nullptr);
+
+			max_resident_steps_ = -1;
+			recompute_ = nullptr;
+			last_access_.assign(n_time_steps + 1, 0);
+			scratch_offsets_.assign(n_time_steps + 1, -1);
+			n_resident_ = 0;
+			access_counter_ = 0;
+			if (scratch_.is_open())
+				scratch_.close();
 		}
 
+		/// @brief Bounds the memory used by the per-step force Jacobians and collision sets of time-dependent problems.
+		/// The least recently used steps beyond the limit are evicted; they are either spilled to a scratch file
+		/// (force Jacobian only) or recomputed from the cached trajectory when loaded again. Step 0 is never evicted.
+		/// The solutions, velocities and accelerations of all steps stay in memory.
+		/// Must be called after init.
+		/// @param max_resident_steps number of steps kept in memory, negative to keep all of them
+		/// @param scratch_path file where evicted force Jacobians are written, empty to recompute them instead
+		/// @param recompute function recomputing the quantities of an evicted step, it temporarily changes the solver
+		/// state of the simulation, so it must not run while the forms of the simulation are evaluated
+		void set_checkpointing(const int max_resident_steps, const std::string &scratch_path, RecomputeFunc recompute);
+		/// @brief True if some steps may be evicted, they must then be loaded before their quantities are read
+		bool is_checkpointing() const { return max_resident_steps_ >= 0; }
+		/// @brief Number of steps kept in memory, negative if all of them are
+		int max_resident_steps() const { return max_resident_steps_; }
+
+		/// @brief Makes the quantities of a step resident, reading or recomputing them if it was evicted, and pins them.
+		/// The recomputation uses the solver state of the simulation: load the steps before entering a parallel region
+		/// reading that state, and keep the handles for the duration of the region.
+		StepHandle load(int step);
+
         void cache_quantities_static(
             const Eigen::MatrixXd &u,
             const StiffnessMatrix &gradu_h,
@@ -45,13 +97,10 @@ namespace polyfem::solver
             const Eigen::MatrixXd &disp_grad)
         {
             u_ = u;
-
-            gradu_h_[0] = gradu_h;
-            collision_set_[0] = contact_set;
-            friction_collision_set_[0] = friction_constraint_set;
             disp_grad_[0] = disp_grad;
 
 			cur_size_ = 1;
+			step_cached(0, gradu_h, contact_set, friction_constraint_set);
 		}
 
 		void cache_quantities_transient(
@@ -70,16 +119,14 @@ namespace polyfem::solver
 			u_.col(cur_step) = u;
 			v_.col(cur_step) = v;
 			acc_.col(cur_step) = acc;
-
-			gradu_h_[cur_step] = gradu_h;
 			// gradu_h_prev_[cur_step] = gradu_h_prev;
 
-			collision_set_[cur_step] = collision_set;
-			friction_collision_set_[cur_step] = friction_collision_set;
-
 			cur_size_++;
+			step_cached(cur_step, gradu_h, collision_set, friction_collision_set);
 		}
 
+		void cache_barrier_stiffness(const int cur_step, const double barrier_stiffness) { barrier_stiffness_(cur_step) = barrier_stiffness; }
+
         void cache_quantities_quasistatic(
             const int cur_step,
             const Eigen::MatrixXd &u,
@@ -88,11 +135,10 @@ namespace polyfem::solver
             const Eigen::MatrixXd &disp_grad)
         {
             u_.col(cur_step) = u;
-            gradu_h_[cur_step] = gradu_h;
-            collision_set_[cur_step] = contact_set;
             disp_grad_[cur_step] = disp_grad;
 
             cur_size_++;
+            step_cached(cur_step, gradu_h, contact_set, ipc::FrictionCollisions());
         }
 
 		void cache_adjoints(const Eigen::MatrixXd &adjoint_mat) { adjoint_mat_ = adjoint_mat; }
@@ -106,6 +152,13 @@ namespace polyfem::solver
 				step += bdf_order_.size();
 			return bdf_order_(step);
 		}
+		inline double barrier_stiffness(int step) const
+		{
+			assert(step < size());
+			if (step < 0)
+				step += barrier_stiffness_.size();
+			return barrier_stiffness_(step);
+		}
 
         Eigen::MatrixXd disp_grad(int step = 0) const { assert(step < size()); if (step < 0) step += disp_grad_.size(); return disp_grad_[step]; }
 		
@@ -131,31 +184,22 @@ namespace polyfem::solver
 			return acc_.col(step);
 		}
 
-		const StiffnessMatrix &gradu_h(int step) const
-		{
-			assert(step < size());
-			if (step < 0)
-				step += gradu_h_.size();
-			return gradu_h_[step];
-		}
+		/// @brief Quantities of a resident step, the references are invalidated when the step is evicted by a later load
+		const StiffnessMatrix &gradu_h(int step) const { return resident(step).gradu_h; }
 		// const StiffnessMatrix &gradu_h_prev(const int step) const { assert(step < size()); return gradu_h_prev_[step]; }
-
-		const ipc::Collisions &collision_set(int step) const
-		{
-			assert(step < size());
-			if (step < 0)
-				step += collision_set_.size();
-			return collision_set_[step];
-		}
-		const ipc::FrictionCollisions &friction_collision_set(int step) const
-		{
-			assert(step < size());
-			if (step < 0)
-				step += friction_collision_set_.size();
-			return friction_collision_set_[step];
-		}
+		const ipc::Collisions &collision_set(int step) const { return resident(step).collision_set; }
+		const ipc::FrictionCollisions &friction_collision_set(int step) const { return resident(step).friction_collision_set; }
 
 	private:
+		// Stores the quantities of a freshly cached step and evicts the least recently used steps if needed
+		void step_cached(const int step, const StiffnessMatrix &gradu_h, const ipc::Collisions &collision_set, const ipc::FrictionCollisions &friction_collision_set);
+		// Throws if the step was evicted
+		const StepQuantities &resident(int step) const;
+		void evict_least_recently_used(const int keep);
+		void evict(const int step);
+		void write_scratch(const int step, const StiffnessMatrix &mat);
+		void read_scratch(const int step, StiffnessMatrix &mat);
+
 		int n_time_steps_ = 0;
 		int cur_size_ = 0;
 
@@ -165,12 +209,21 @@ namespace polyfem::solver
 		Eigen::MatrixXd acc_; // acceleration in transient elastic simulations
 
 		Eigen::VectorXi bdf_order_; // BDF orders used at each time step in forward simulation
+		Eigen::VectorXd barrier_stiffness_; // barrier stiffness used at each time step in forward simulation
 
-		std::vector<StiffnessMatrix> gradu_h_; // gradient of force at time T wrt. u  at time T
+		std::vector<std::shared_ptr<const StepQuantities>> steps_; // nullptr if the step is evicted
 		// std::vector<StiffnessMatrix> gradu_h_prev_; // gradient of force at time T wrt. u at time (T-1) in transient simulations
 
-		std::vector<ipc::Collisions> collision_set_;
-		std::vector<ipc::FrictionCollisions> friction_collision_set_;
+		// Checkpointing of the per-step quantities
+		int max_resident_steps_ = -1;
+		RecomputeFunc recompute_;
+		std::vector<std::shared_ptr<StepQuantities>> spilled_; // collision sets of the steps whose force Jacobian is in the scratch file
+		std::vector<long> last_access_;
+		std::vector<std::streamoff> scratch_offsets_; // position of the spilled force Jacobian, -1 if not spilled
+		int n_resident_ = 0;
+		long access_counter_ = 0;
+		std::fstream scratch_;
+		std::mutex load_mutex_;
 
 		Eigen::MatrixXd adjoint_mat_;
 	};
@@ -294,6 +294,13 @@ namespace polyfem::solver
 
 	double ElasticForm::value_unweighted(const Eigen::VectorXd &x) const
 	{
+		if (assembler_.is_linear())
+		{
+			// the energy of a linear material is the quadratic form of its constant stiffness
+			assert(cached_stiffness_.rows() == x.size() && cached_stiffness_.cols() == x.size());
+			return 0.5 * x.dot(cached_stiffness_ * x);
+		}
+
 		return assembler_.assemble_energy(
 			is_volume_,
 			bases_, geom_bases_, ass_vals_cache_, t_, dt_, x, x_prev_);
@@ -309,6 +316,13 @@ namespace polyfem::solver
 
 	void ElasticForm::first_derivative_unweighted(const Eigen::VectorXd &x, Eigen::VectorXd &gradv) const
 	{
+		if (assembler_.is_linear())
+		{
+			assert(cached_stiffness_.rows() == x.size() && cached_stiffness_.cols() == x.size());
+			gradv = cached_stiffness_ * x;
+			return;
+		}
+
 		Eigen::MatrixXd grad;
 		assembler_.assemble_gradient(is_volume_, n_bases_, bases_, geom_bases_,
 									 ass_vals_cache_, t_, dt_, x, x_prev_, grad);
@@ -331,7 +345,8 @@ namespace polyfem::solver
 			// NOTE: mat_cache_ is marked as mutable so we can modify it here
 			assembler_.assemble_hessian(
 				is_volume_, n_bases_, project_to_psd_, bases_,
-				geom_bases_, ass_vals_cache_, t_, dt_, x, x_prev_, *mat_cache_, hessian);
+				geom_bases_, ass_vals_cache_, t_, dt_, x, x_prev_, *mat_cache_, hessian,
+				element_hessian_cache_.get());
 		}
 	}
 
@@ -339,6 +354,17 @@ namespace polyfem::solver
 	{
 		for (auto &t : quadrature_hierarchy_)
 			t = Tree();
+
+		if (element_hessian_cache_)
+			element_hessian_cache_->clear();
+	}
+
+	void ElasticForm::set_hessian_reuse_tolerance(const double tolerance)
+	{
+		if (tolerance < 0 || assembler_.is_linear())
+			element_hessian_cache_ = nullptr;
+		else
+			element_hessian_cache_ = std::make_unique<assembler::ElementHessianCache>(tolerance);
 	}
 
 	double ElasticForm::max_step_size(const Eigen::VectorXd &x0, const Eigen::VectorXd &x1) const
@@ -416,6 +442,18 @@ namespace polyfem::solver
 	{
 	}
 
+	void ElasticForm::update_quantities(const double t, const Eigen::VectorXd &x)
+	{
+		const bool stale_stiffness = t != t_ && assembler_.has_time_dependent_params();
+		t_ = t;
+		if (stale_stiffness)
+		{
+			cached_stiffness_.resize(0, 0);
+			compute_cached_stiffness();
+		}
+		x_prev_ = x;
+	}
+
 	void ElasticForm::compute_cached_stiffness()
 	{
 		if (assembler_.is_linear() && cached_stiffness_.size() == 0)
@@ -482,6 +520,10 @@ namespace polyfem::solver
 			utils::maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
 				LocalThreadVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
+				// the per-point matrices have the same size on all elements, they are allocated once per range
+				Eigen::MatrixXd u, grad_u, p, grad_p;
+				Eigen::MatrixXd grad_p_i, grad_u_i, f_prime_dmu, f_prime_dlambda;
+
 				for (int e = start; e < end; ++e)
 				{
 					assembler::ElementAssemblyValues &vals = local_storage.vals;
@@ -490,17 +532,14 @@ namespace polyfem::solver
 					const quadrature::Quadrature &quadrature = vals.quadrature;
 					local_storage.da = vals.det.array() * quadrature.weights.array();
 
-					Eigen::MatrixXd u, grad_u, p, grad_p;
 					io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, x, u, grad_u);
 					io::Evaluator::interpolate_at_local_vals(e, dim, dim, vals, adjoint, p, grad_p);
 
 					for (int q = 0; q < local_storage.da.size(); ++q)
 					{
-						Eigen::MatrixXd grad_p_i, grad_u_i;
 						vector2matrix(grad_p.row(q), grad_p_i);
 						vector2matrix(grad_u.row(q), grad_u_i);
 
-						Eigen::MatrixXd f_prime_dmu, f_prime_dlambda;
 						assembler_.compute_dstress_dmu_dlambda(OptAssemblerData(t, dt_, e, quadrature.points.row(q), vals.val.row(q), grad_u_i), f_prime_dmu, f_prime_dlambda);
 
 						// This needs to be a sum over material parameter basis.
@@ -581,23 +620,25 @@ namespace polyfem::solver
 			utils::maybe_parallel_for(n_elements, [&](int start, int end, int thread_id) {
 				LocalThreadVecStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
 
+				// the per-point matrices have the same size on all elements, they are allocated once per range
+				assembler::ElementAssemblyValues gvals;
+				Eigen::MatrixXd u, grad_u, p, grad_p;
+				Eigen::MatrixXd grad_u_i, grad_p_i, grad_v_i, stress_tensor, f_prime_gradu_gradv, tmp;
+
 				for (int e = start; e < end; ++e)
 				{
 					assembler::ElementAssemblyValues &vals = local_storage.vals;
 					ass_vals_cache_.compute(e, is_volume_, bases_[e], geom_bases_[e], vals);
-					assembler::ElementAssemblyValues gvals;
 					gvals.compute(e, is_volume_, vals.quadrature.points, geom_bases_[e], geom_bases_[e]);
 
 					const quadrature::Quadrature &quadrature = vals.quadrature;
 					local_storage.da = vals.det.array() * quadrature.weights.array();
 
-					Eigen::MatrixXd u, grad_u, p, grad_p;
 					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, x, u, grad_u);
 					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, adjoint, p, grad_p);
 
 					for (int q = 0; q < local_storage.da.size(); ++q)
 					{
-						Eigen::MatrixXd grad_u_i, grad_p_i, stiffness_i;
 						if (actual_dim == 1)
 						{
 							grad_u_i = grad_u.row(q);
@@ -613,14 +654,12 @@ namespace polyfem::solver
 						{
 							for (int d = 0; d < dim; d++)
 							{
-								Eigen::MatrixXd grad_v_i;
 								grad_v_i.setZero(dim, dim);
 								grad_v_i.row(d) = v.grad_t_m.row(q);
 
-								Eigen::MatrixXd stress_tensor, f_prime_gradu_gradv;
 								assembler_.compute_stress_grad_multiply_mat(OptAssemblerData(t, dt_, e, quadrature.points.row(q), vals.val.row(q), grad_u_i), grad_u_i * grad_v_i, stress_tensor, f_prime_gradu_gradv);
 
-								const Eigen::MatrixXd tmp = stress_tensor * grad_v_i.transpose() - grad_v_i.trace() * stress_tensor;
+								tmp = stress_tensor * grad_v_i.transpose() - grad_v_i.trace() * stress_tensor;
 								local_storage.vec(v.global[0].index * dim + d) -= matrix_inner_product<double>(f_prime_gradu_gradv + tmp, grad_p_i) * local_storage.da(q);
 							}
 						}
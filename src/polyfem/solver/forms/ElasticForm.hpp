@@ -70,11 +70,8 @@ namespace polyfem::solver
 		/// @brief Update time-dependent fields
 		/// @param t Current time
 		/// @param x Current solution at time t
-		void update_quantities(const double t, const Eigen::VectorXd &x) override
-		{
-			t_ = t;
-			x_prev_ = x;
-		}
+		/// @note The cached stiffness of linear materials is reassembled when t changes and the material parameters depend on t
+		void update_quantities(const double t, const Eigen::VectorXd &x) override;
 
 		/// @brief Determine the maximum step size allowable between the current and next solution
 		/// @param x0 Current solution (step size = 0)
@@ -104,6 +101,10 @@ namespace polyfem::solver
 		/// @brief Reset adaptive quadrature refinement after each complete nonlinear solve.
 		void finish() override;
 
+		/// @brief Reuse the hessian of the elements whose local DOFs moved by at most tolerance (max norm) since it was computed
+		/// @param tolerance Reuse tolerance, negative disables the reuse and zero only reuses the hessians of unchanged elements
+		void set_hessian_reuse_tolerance(const double tolerance);
+
 	private:
 		const int n_bases_;
 		std::vector<basis::ElementBases> &bases_;
@@ -117,10 +118,11 @@ namespace polyfem::solver
 		const double dt_;
 		const bool is_volume_;
 
-		StiffnessMatrix cached_stiffness_;                      ///< Cached stiffness matrix for linear elasticity
+		StiffnessMatrix cached_stiffness_;                      ///< Cached stiffness matrix of linear materials, used for the energy, gradient, and hessian
 		mutable std::unique_ptr<utils::MatrixCache> mat_cache_; ///< Matrix cache (mutable because it is modified in second_derivative_unweighted)
+		mutable std::unique_ptr<assembler::ElementHessianCache> element_hessian_cache_; ///< Element hessians to reuse, nullptr if disabled
 
-		/// @brief Compute the stiffness matrix (cached)
+		/// @brief Assemble the stiffness matrix of a linear material at t_ if it is not cached
 		void compute_cached_stiffness();
 
 		Eigen::VectorXd x_prev_;
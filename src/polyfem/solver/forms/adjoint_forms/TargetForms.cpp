@@ -27,6 +27,119 @@ namespace polyfem::solver
 				val = 0;
 			}
 		};
+
+		class LocalThreadPointStorage
+		{
+		public:
+			assembler::ElementAssemblyValues vals;
+			std::vector<Eigen::RowVectorXd> points;
+		};
+
+		/// Deformed positions of the boundary quadrature points on the selected surfaces, one per row
+		Eigen::MatrixXd deformed_boundary_points(const State &state, const std::set<int> &ids, const int dim, const int time_step)
+		{
+			const auto &bases = state.bases;
+			const auto &gbases = state.geom_bases();
+			const int actual_dim = state.problem->is_scalar() ? 1 : dim;
+
+			auto storage = utils::create_thread_storage(LocalThreadPointStorage());
+			utils::maybe_parallel_for(state.total_local_boundary.size(), [&](int start, int end, int thread_id) {
+				LocalThreadPointStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
+
+				Eigen::MatrixXd uv, points, normal;
+				Eigen::VectorXd weights;
+
+				Eigen::MatrixXd u, grad_u;
+
+				for (int lb_id = start; lb_id < end; ++lb_id)
+				{
+					const auto &lb = state.total_local_boundary[lb_id];
+					const int e = lb.element_id();
+
+					for (int i = 0; i < lb.size(); i++)
+					{
+						const int global_primitive_id = lb.global_primitive_id(i);
+						if (ids.size() != 0 && ids.find(state.mesh->get_boundary_id(global_primitive_id)) == ids.end())
+							continue;
+
+						utils::BoundarySampler::boundary_quadrature(lb, state.n_boundary_samples(), *state.mesh, i, false, uv, points, normal, weights);
+
+						assembler::ElementAssemblyValues &vals = local_storage.vals;
+						vals.compute(e, state.mesh->is_volume(), points, bases[e], gbases[e]);
+						io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, state.diff_cached.u(time_step), u, grad_u);
+
+						for (int q = 0; q < u.rows(); q++)
+							local_storage.points.push_back(vals.val.row(q) + u.row(q));
+					}
+				}
+			});
+
+			int n_points = 0;
+			for (const auto &local_storage : storage)
+				n_points += local_storage.points.size();
+
+			Eigen::MatrixXd deformed(n_points, dim);
+			int row = 0;
+			for (const auto &local_storage : storage)
+				for (const auto &p : local_storage.points)
+					deformed.row(row++) = p;
+
+			return deformed;
+		}
+
+		/// Squared distance of the deformed surface to a target surface, either exact or through the cached interpolation
+		IntegrableFunctional surface_distance_functional(const utils::SurfaceDistance &target, const std::unique_ptr<LazyCubicInterpolator> &interpolation_fn)
+		{
+			IntegrableFunctional j;
+			auto j_func = [&target, &interpolation_fn](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
+				val.setZero(u.rows(), 1);
+
+				if (!interpolation_fn)
+				{
+					Eigen::VectorXd sqr_distances;
+					Eigen::MatrixXd closest;
+					target.closest_points(u + pts, sqr_distances, closest);
+					val.col(0) = sqr_distances;
+					return;
+				}
+
+				for (int q = 0; q < u.rows(); q++)
+				{
+					double distance;
+					Eigen::MatrixXd unused_grad;
+					interpolation_fn->evaluate(u.row(q) + pts.row(q), distance, unused_grad);
+					val(q) = pow(distance, 2);
+				}
+			};
+
+			auto djdu_func = [&target, &interpolation_fn](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
+				val.setZero(u.rows(), u.cols());
+
+				if (!interpolation_fn)
+				{
+					Eigen::VectorXd sqr_distances;
+					Eigen::MatrixXd closest;
+					const Eigen::MatrixXd deformed = u + pts;
+					target.closest_points(deformed, sqr_distances, closest);
+					val = 2 * (deformed - closest);
+					return;
+				}
+
+				for (int q = 0; q < u.rows(); q++)
+				{
+					double distance;
+					Eigen::MatrixXd grad;
+					interpolation_fn->evaluate(u.row(q) + pts.row(q), distance, grad);
+					val.row(q) = 2 * distance * grad.transpose();
+				}
+			};
+
+			j.set_j(j_func);
+			j.set_dj_du(djdu_func);
+			j.set_dj_dx(djdu_func);
+
+			return j;
+		}
 	} // namespace
 
 	IntegrableFunctional TargetForm::get_integral_functional() const
@@ -188,44 +301,11 @@ namespace polyfem::solver
 
 	void SDFTargetForm::solution_changed_step(const int time_step, const Eigen::VectorXd &x)
 	{
-		const auto &bases = state_.bases;
-		const auto &gbases = state_.geom_bases();
-		const int actual_dim = state_.problem->is_scalar() ? 1 : dim;
-
-		auto storage = utils::create_thread_storage(LocalThreadScalarStorage());
-		utils::maybe_parallel_for(state_.total_local_boundary.size(), [&](int start, int end, int thread_id) {
-			LocalThreadScalarStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
-
-			Eigen::MatrixXd uv, samples, gtmp;
-			Eigen::MatrixXd points, normal;
-			Eigen::VectorXd weights;
+		if (!interpolation_fn)
+			return;
 
-			Eigen::MatrixXd u, grad_u;
-
-			for (int lb_id = start; lb_id < end; ++lb_id)
-			{
-				const auto &lb = state_.total_local_boundary[lb_id];
-				const int e = lb.element_id();
-
-				for (int i = 0; i < lb.size(); i++)
-				{
-					const int global_primitive_id = lb.global_primitive_id(i);
-					if (ids_.size() != 0 && ids_.find(state_.mesh->get_boundary_id(global_primitive_id)) == ids_.end())
-						continue;
-
-					utils::BoundarySampler::boundary_quadrature(lb, state_.n_boundary_samples(), *state_.mesh, i, false, uv, points, normal, weights);
-
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					vals.compute(e, state_.mesh->is_volume(), points, bases[e], gbases[e]);
-					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, state_.diff_cached.u(time_step), u, grad_u);
-
-					normal = normal * vals.jac_it[0]; // assuming linear geometry
-
-					for (int q = 0; q < u.rows(); q++)
-						interpolation_fn->cache_grid([this](const Eigen::MatrixXd &point, double &distance) { compute_distance(point, distance); }, vals.val.row(q) + u.row(q));
-				}
-			}
-		});
+		const Eigen::MatrixXd points = deformed_boundary_points(state_, ids_, dim, time_step);
+		interpolation_fn->cache_grid([this](const Eigen::MatrixXd &point, double &distance) { distance = target_.distance(point.col(0)); }, points);
 	}
 
 	void SDFTargetForm::set_bspline_target(const Eigen::MatrixXd &control_points, const Eigen::VectorXd &knots, const double delta)
@@ -235,25 +315,26 @@ namespace polyfem::solver
 		if ((dim != 2) || (state_.mesh->dimension() != 2))
 			log_and_throw_error("SDFTargetForm specified for 2d.");
 
-		samples = 100;
+		const int samples = 100;
 
 		nanospline::BSpline<double, 2, 3> curve;
 		curve.set_control_points(control_points);
 		curve.set_knots(knots);
 
-		t_or_uv_sampling = Eigen::VectorXd::LinSpaced(samples, 0, 1);
+		const Eigen::VectorXd t_sampling = Eigen::VectorXd::LinSpaced(samples, 0, 1);
+		Eigen::MatrixXd point_sampling;
 		point_sampling.setZero(samples, 2);
-		for (int i = 0; i < t_or_uv_sampling.size(); ++i)
-			point_sampling.row(i) = curve.evaluate(t_or_uv_sampling(i));
+		for (int i = 0; i < t_sampling.size(); ++i)
+			point_sampling.row(i) = curve.evaluate(t_sampling(i));
 
-		{
-			Eigen::MatrixXi edges(samples - 1, 2);
-			edges.col(0) = Eigen::VectorXi::LinSpaced(samples - 1, 0, samples - 2);
-			edges.col(1) = Eigen::VectorXi::LinSpaced(samples - 1, 1, samples - 1);
-			io::OBJWriter::write(fmt::format("spline_target_{:d}.obj", rand() % 100), point_sampling, edges);
-		}
+		Eigen::MatrixXi edges(samples - 1, 2);
+		edges.col(0) = Eigen::VectorXi::LinSpaced(samples - 1, 0, samples - 2);
+		edges.col(1) = Eigen::VectorXi::LinSpaced(samples - 1, 1, samples - 1);
+		io::OBJWriter::write(fmt::format("spline_target_{:d}.obj", rand() % 100), point_sampling, edges);
 
-		interpolation_fn = std::make_unique<LazyCubicInterpolator>(dim, delta_);
+		target_.init(point_sampling, edges);
+		if (delta_ > 0)
+			interpolation_fn = std::make_unique<LazyCubicInterpolator>(dim, delta_);
 	}
 
 	void SDFTargetForm::set_bspline_target(const Eigen::MatrixXd &control_points, const Eigen::VectorXd &knots_u, const Eigen::VectorXd &knots_v, const double delta)
@@ -264,7 +345,7 @@ namespace polyfem::solver
 		if ((dim != 3) || (state_.mesh->dimension() != 3))
 			log_and_throw_error("SDFTargetForm specified for 3d.");
 
-		samples = 100;
+		const int samples = 100;
 
 		nanospline::BSplinePatch<double, 3, 3, 3> patch;
 		patch.set_control_grid(control_points);
@@ -272,107 +353,40 @@ namespace polyfem::solver
 		patch.set_knots_v(knots_v);
 		patch.initialize();
 
-		t_or_uv_sampling.resize(samples * samples, 2);
+		Eigen::MatrixXd uv_sampling(samples * samples, 2);
 		for (int i = 0; i < samples; ++i)
 		{
-			t_or_uv_sampling.block(i * samples, 0, samples, 1) = Eigen::VectorXd::LinSpaced(samples, 0, 1);
-			t_or_uv_sampling.block(i * samples, 1, samples, 1) = (double)i / (samples - 1) * Eigen::VectorXd::Ones(samples);
+			uv_sampling.block(i * samples, 0, samples, 1) = Eigen::VectorXd::LinSpaced(samples, 0, 1);
+			uv_sampling.block(i * samples, 1, samples, 1) = (double)i / (samples - 1) * Eigen::VectorXd::Ones(samples);
 		}
+		Eigen::MatrixXd point_sampling;
 		point_sampling.setZero(samples * samples, 3);
-		for (int i = 0; i < t_or_uv_sampling.rows(); ++i)
-		{
-			point_sampling.row(i) = patch.evaluate(t_or_uv_sampling(i, 0), t_or_uv_sampling(i, 1));
-		}
-
-		{
-			Eigen::MatrixXi F(2 * ((samples - 1) * (samples - 1)), 3);
-			int f = 0;
-			for (int i = 0; i < samples - 1; ++i)
-				for (int j = 0; j < samples - 1; ++j)
-				{
-					Eigen::MatrixXi F_local(2, 3);
-					F_local << (i * samples + j), ((i + 1) * samples + j), (i * samples + j + 1),
-						(i * samples + j + 1), ((i + 1) * samples + j), ((i + 1) * samples + j + 1);
-					F.block(f, 0, 2, 3) = F_local;
-					f += 2;
-				}
-			io::OBJWriter::write(fmt::format("spline_target_{:d}.obj", rand() % 100), point_sampling, F);
-		}
-
-		interpolation_fn = std::make_unique<LazyCubicInterpolator>(dim, delta_);
-	}
-
-	void SDFTargetForm::compute_distance(const Eigen::MatrixXd &point, double &distance) const
-	{
-		distance = DBL_MAX;
-		Eigen::MatrixXd p = point.transpose();
+		utils::maybe_parallel_for(uv_sampling.rows(), [&](int start, int end, int thread_id) {
+			for (int i = start; i < end; ++i)
+				point_sampling.row(i) = patch.evaluate(uv_sampling(i, 0), uv_sampling(i, 1));
+		});
 
-		if (dim == 2)
-			for (int i = 0; i < t_or_uv_sampling.size() - 1; ++i)
+		Eigen::MatrixXi F(2 * ((samples - 1) * (samples - 1)), 3);
+		int f = 0;
+		for (int i = 0; i < samples - 1; ++i)
+			for (int j = 0; j < samples - 1; ++j)
 			{
-				const double l = (point_sampling.row(i + 1) - point_sampling.row(i)).squaredNorm();
-				double distance_to_perpendicular = ((p - point_sampling.row(i)) * (point_sampling.row(i + 1) - point_sampling.row(i)).transpose())(0) / l;
-				const double t = std::max(0., std::min(1., distance_to_perpendicular));
-				const auto project = point_sampling.row(i) * (1 - t) + point_sampling.row(i + 1) * t;
-				const double project_distance = (p - project).norm();
-				if (project_distance < distance)
-					distance = project_distance;
+				Eigen::MatrixXi F_local(2, 3);
+				F_local << (i * samples + j), ((i + 1) * samples + j), (i * samples + j + 1),
+					(i * samples + j + 1), ((i + 1) * samples + j), ((i + 1) * samples + j + 1);
+				F.block(f, 0, 2, 3) = F_local;
+				f += 2;
 			}
-		else if (dim == 3)
-		{
-			for (int i = 0; i < samples - 1; ++i)
-				for (int j = 0; j < samples - 1; ++j)
-				{
-					int loc = samples * i + j;
-					const double l1 = (point_sampling.row(loc + 1) - point_sampling.row(loc)).squaredNorm();
-					double distance_to_perpendicular = ((p - point_sampling.row(loc)) * (point_sampling.row(loc + 1) - point_sampling.row(loc)).transpose())(0) / l1;
-					const double u = std::max(0., std::min(1., distance_to_perpendicular));
-
-					const double l2 = (point_sampling.row(loc + samples) - point_sampling.row(loc)).squaredNorm();
-					distance_to_perpendicular = ((p - point_sampling.row(loc)) * (point_sampling.row(loc + samples) - point_sampling.row(loc)).transpose())(0) / l2;
-					const double v = std::max(0., std::min(1., distance_to_perpendicular));
-
-					Eigen::MatrixXd project = point_sampling.row(loc) * (1 - u) + point_sampling.row(loc + 1) * u;
-					project += v * (point_sampling.row(loc + samples) - point_sampling.row(loc));
-					const double project_distance = (p - project).norm();
-					if (project_distance < distance)
-						distance = project_distance;
-				}
-		}
+		io::OBJWriter::write(fmt::format("spline_target_{:d}.obj", rand() % 100), point_sampling, F);
+
+		target_.init(point_sampling, F);
+		if (delta_ > 0)
+			interpolation_fn = std::make_unique<LazyCubicInterpolator>(dim, delta_);
 	}
 
 	IntegrableFunctional SDFTargetForm::get_integral_functional() const
 	{
-		IntegrableFunctional j;
-		auto j_func = [this](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
-			val.setZero(u.rows(), 1);
-
-			for (int q = 0; q < u.rows(); q++)
-			{
-				double distance;
-				Eigen::MatrixXd unused_grad;
-				interpolation_fn->evaluate(u.row(q) + pts.row(q), distance, unused_grad);
-				val(q) = pow(distance, 2);
-			}
-		};
-
-		auto djdu_func = [this](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
-			val.setZero(u.rows(), u.cols());
-
-			for (int q = 0; q < u.rows(); q++)
-			{
-				double distance;
-				Eigen::MatrixXd grad;
-				interpolation_fn->evaluate(u.row(q) + pts.row(q), distance, grad);
-				val.row(q) = 2 * distance * grad.transpose();
-			}
-		};
-
-		j.set_j(j_func);
-		j.set_dj_du(djdu_func);
-		j.set_dj_dx(djdu_func);
-
-		return j;
+		return surface_distance_functional(target_, interpolation_fn);
 	}
 
 	void MeshTargetForm::set_surface_mesh_target(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const double delta)
@@ -382,92 +396,23 @@ namespace polyfem::solver
 		if ((dim != 3) || (state_.mesh->dimension() != 3))
 			log_and_throw_error("MeshTargetForm is only available for 3d scenes.");
 
-		tree_.init(V, F);
-		V_ = V;
-		F_ = F;
-
-		interpolation_fn = std::make_unique<LazyCubicInterpolator>(dim, delta_);
+		target_.init(V, F);
+		if (delta_ > 0)
+			interpolation_fn = std::make_unique<LazyCubicInterpolator>(dim, delta_);
 	}
 
 	void MeshTargetForm::solution_changed_step(const int time_step, const Eigen::VectorXd &x)
 	{
-		const auto &bases = state_.bases;
-		const auto &gbases = state_.geom_bases();
-		const int actual_dim = state_.problem->is_scalar() ? 1 : dim;
-
-		auto storage = utils::create_thread_storage(LocalThreadScalarStorage());
-		utils::maybe_parallel_for(state_.total_local_boundary.size(), [&](int start, int end, int thread_id) {
-			LocalThreadScalarStorage &local_storage = utils::get_local_thread_storage(storage, thread_id);
-
-			Eigen::MatrixXd uv, samples, gtmp;
-			Eigen::MatrixXd points, normal;
-			Eigen::VectorXd weights;
-
-			Eigen::MatrixXd u, grad_u;
-
-			for (int lb_id = start; lb_id < end; ++lb_id)
-			{
-				const auto &lb = state_.total_local_boundary[lb_id];
-				const int e = lb.element_id();
+		if (!interpolation_fn)
+			return;
 
-				for (int i = 0; i < lb.size(); i++)
-				{
-					const int global_primitive_id = lb.global_primitive_id(i);
-					if (ids_.size() != 0 && ids_.find(state_.mesh->get_boundary_id(global_primitive_id)) == ids_.end())
-						continue;
-
-					utils::BoundarySampler::boundary_quadrature(lb, state_.n_boundary_samples(), *state_.mesh, i, false, uv, points, normal, weights);
-
-					assembler::ElementAssemblyValues &vals = local_storage.vals;
-					vals.compute(e, state_.mesh->is_volume(), points, bases[e], gbases[e]);
-					io::Evaluator::interpolate_at_local_vals(e, dim, actual_dim, vals, state_.diff_cached.u(time_step), u, grad_u);
-
-					normal = normal * vals.jac_it[0]; // assuming linear geometry
-
-					for (int q = 0; q < u.rows(); q++)
-						interpolation_fn->cache_grid([this](const Eigen::MatrixXd &point, double &distance) {
-							int idx;
-							Eigen::Matrix<double, 1, 3> closest;
-							distance = pow(tree_.squared_distance(V_, F_, point.col(0), idx, closest), 0.5);
-						},
-													 vals.val.row(q) + u.row(q));
-				}
-			}
-		});
+		const Eigen::MatrixXd points = deformed_boundary_points(state_, ids_, dim, time_step);
+		interpolation_fn->cache_grid([this](const Eigen::MatrixXd &point, double &distance) { distance = target_.distance(point.col(0)); }, points);
 	}
 
 	IntegrableFunctional MeshTargetForm::get_integral_functional() const
 	{
-		IntegrableFunctional j;
-		auto j_func = [this](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
-			val.setZero(u.rows(), 1);
-
-			for (int q = 0; q < u.rows(); q++)
-			{
-				double distance;
-				Eigen::MatrixXd unused_grad;
-				interpolation_fn->evaluate(u.row(q) + pts.row(q), distance, unused_grad);
-				val(q) = pow(distance, 2);
-			}
-		};
-
-		auto djdu_func = [this](const Eigen::MatrixXd &local_pts, const Eigen::MatrixXd &pts, const Eigen::MatrixXd &u, const Eigen::MatrixXd &grad_u, const Eigen::VectorXd &lambda, const Eigen::VectorXd &mu, const Eigen::MatrixXd &reference_normals, const assembler::ElementAssemblyValues &vals, const IntegrableFunctional::ParameterType &params, Eigen::MatrixXd &val) {
-			val.setZero(u.rows(), u.cols());
-
-			for (int q = 0; q < u.rows(); q++)
-			{
-				double distance;
-				Eigen::MatrixXd grad;
-				interpolation_fn->evaluate(u.row(q) + pts.row(q), distance, grad);
-				val.row(q) = 2 * distance * grad.transpose();
-			}
-		};
-
-		j.set_j(j_func);
-		j.set_dj_du(djdu_func);
-		j.set_dj_dx(djdu_func);
-
-		return j;
+		return surface_distance_functional(target_, interpolation_fn);
 	}
 
 	NodeTargetForm::NodeTargetForm(const State &state, const VariableToSimulationGroup &variable_to_simulations, const json &args) : StaticForm(variable_to_simulations), state_(state)
@@ -2,9 +2,9 @@
 
 #include "SpatialIntegralForms.hpp"
 
-#include <igl/AABB.h>
 #include <polyfem/utils/ExpressionValue.hpp>
 #include <polyfem/utils/LazyCubicInterpolator.hpp>
+#include <polyfem/utils/SurfaceDistance.hpp>
 
 namespace polyfem::solver
 {
@@ -62,16 +62,11 @@ namespace polyfem::solver
 		IntegrableFunctional get_integral_functional() const override;
 
 	private:
-		void compute_distance(const Eigen::MatrixXd &point, double &distance) const;
-
 		int dim;
 		double delta_;
 
-		Eigen::MatrixXd t_or_uv_sampling;
-		Eigen::MatrixXd point_sampling;
-		int samples;
-
-		std::unique_ptr<LazyCubicInterpolator> interpolation_fn;
+		utils::SurfaceDistance target_; // sampled spline
+		std::unique_ptr<LazyCubicInterpolator> interpolation_fn; // only if delta_ > 0, otherwise the distance is queried directly
 	};
 
 	class MeshTargetForm : public SpatialIntegralForm
@@ -97,11 +92,8 @@ namespace polyfem::solver
 		int dim;
 		double delta_;
 
-		Eigen::MatrixXd V_;
-		Eigen::MatrixXi F_;
-		igl::AABB<Eigen::MatrixXd, 3> tree_;
-
-		std::unique_ptr<LazyCubicInterpolator> interpolation_fn;
+		utils::SurfaceDistance target_;
+		std::unique_ptr<LazyCubicInterpolator> interpolation_fn; // only if delta_ > 0, otherwise the distance is queried directly
 	};
 
 	class NodeTargetForm : public StaticForm
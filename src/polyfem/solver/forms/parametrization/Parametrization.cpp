@@ -9,6 +9,12 @@ namespace polyfem::solver
 		return Eigen::VectorXd();
 	}
 
+	Eigen::SparseMatrix<double> Parametrization::affine_jacobian(const int x_size) const
+	{
+		log_and_throw_adjoint_error("Parametrization is not affine!");
+		return Eigen::SparseMatrix<double>();
+	}
+
 	int CompositeParametrization::size(const int x_size) const
 	{
 		int cur_size = x_size;
@@ -20,6 +26,12 @@ namespace polyfem::solver
 
 	Eigen::VectorXd CompositeParametrization::inverse_eval(const Eigen::VectorXd &y)
 	{
+		{
+			std::lock_guard<std::mutex> lock(jacobian_cache_->mutex);
+			jacobian_cache_->x_size = -1;
+			jacobian_cache_->blocks.clear();
+		}
+
 		if (parametrizations_.empty())
 			return y;
 
@@ -45,6 +57,39 @@ namespace polyfem::solver
 
 		return y;
 	}
+
+	const std::vector<CompositeParametrization::AffineBlock> &CompositeParametrization::affine_blocks(const int x_size) const
+	{
+		std::lock_guard<std::mutex> lock(jacobian_cache_->mutex);
+		if (jacobian_cache_->x_size == x_size)
+			return jacobian_cache_->blocks;
+
+		std::vector<AffineBlock> &blocks = jacobian_cache_->blocks;
+		blocks.clear();
+
+		int cur_size = x_size;
+		for (int i = 0; i < parametrizations_.size(); ++i)
+		{
+			const auto &p = parametrizations_[i];
+			if (p->is_affine())
+			{
+				// J = J_i * ... * J_begin, stored transposed to be applied to gradients
+				Eigen::SparseMatrix<double> jacobian = p->affine_jacobian(cur_size);
+				if (!blocks.empty() && blocks.back().end == i)
+				{
+					blocks.back().jacobian_transpose = blocks.back().jacobian_transpose * jacobian.transpose();
+					blocks.back().end = i + 1;
+				}
+				else
+					blocks.push_back({i, i + 1, jacobian.transpose()});
+			}
+			cur_size = p->size(cur_size);
+		}
+		jacobian_cache_->x_size = x_size;
+
+		return blocks;
+	}
+
 	Eigen::VectorXd CompositeParametrization::apply_jacobian(const Eigen::VectorXd &grad_full, const Eigen::VectorXd &x) const
 	{
 		Eigen::VectorXd gradv = grad_full;
@@ -52,17 +97,66 @@ namespace polyfem::solver
 		if (parametrizations_.empty())
 			return gradv;
 
-		std::vector<Eigen::VectorXd> ys;
+		const std::vector<AffineBlock> &blocks = affine_blocks(x.size());
+
+		// only the inputs of the non-affine parametrizations are needed
+		int last_non_affine = -1;
+		for (int i = 0; i < parametrizations_.size(); ++i)
+			if (!parametrizations_[i]->is_affine())
+				last_non_affine = i;
+
+		std::vector<Eigen::VectorXd> ys(parametrizations_.size());
 		auto y = x;
-		for (const auto &p : parametrizations_)
+		for (int i = 0; i <= last_non_affine; ++i)
 		{
-			ys.emplace_back(y);
-			y = p->eval(y);
+			if (!parametrizations_[i]->is_affine())
+				ys[i] = y;
+			if (i < last_non_affine)
+				y = parametrizations_[i]->eval(y);
 		}
 
-		for (int i = parametrizations_.size() - 1; i >= 0; --i)
-			gradv = parametrizations_[i]->apply_jacobian(gradv, ys[i]);
+		int b = int(blocks.size()) - 1;
+		for (int i = parametrizations_.size() - 1; i >= 0;)
+		{
+			if (b >= 0 && blocks[b].end == i + 1)
+			{
+				gradv = blocks[b].jacobian_transpose * gradv;
+				i = blocks[b].begin - 1;
+				--b;
+			}
+			else
+			{
+				gradv = parametrizations_[i]->apply_jacobian(gradv, ys[i]);
+				--i;
+			}
+		}
 
 		return gradv;
 	}
-} // namespace polyfem::solver
\ No newline at end of file
+
+	bool CompositeParametrization::is_affine() const
+	{
+		for (const auto &p : parametrizations_)
+			if (!p->is_affine())
+				return false;
+
+		return true;
+	}
+
+	Eigen::SparseMatrix<double> CompositeParametrization::affine_jacobian(const int x_size) const
+	{
+		if (!is_affine())
+			log_and_throw_adjoint_error("Parametrization is not affine!");
+
+		const std::vector<AffineBlock> &blocks = affine_blocks(x_size);
+		if (blocks.empty())
+		{
+			Eigen::SparseMatrix<double> identity(x_size, x_size);
+			identity.setIdentity();
+			return identity;
+		}
+
+		assert(blocks.size() == 1);
+		return blocks[0].jacobian_transpose.transpose();
+	}
+} // namespace polyfem::solver
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <Eigen/Core>
+#include <Eigen/Sparse>
 
 namespace polyfem::solver
 {
@@ -21,6 +23,11 @@ namespace polyfem::solver
 		virtual int size(const int x_size) const = 0; // just for verification
 		virtual Eigen::VectorXd eval(const Eigen::VectorXd &x) const = 0;
 		virtual Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad_full, const Eigen::VectorXd &x) const = 0;
+
+		/// True if eval is affine in x, so that its Jacobian can be assembled once by affine_jacobian
+		virtual bool is_affine() const { return false; }
+		/// Jacobian dy/dx of an affine parametrization, of size size(x_size) x x_size
+		virtual Eigen::SparseMatrix<double> affine_jacobian(const int x_size) const;
 	};
 
 	class CompositeParametrization : public Parametrization
@@ -36,7 +43,30 @@ namespace polyfem::solver
 		Eigen::VectorXd eval(const Eigen::VectorXd &x) const override;
 		Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad_full, const Eigen::VectorXd &x) const override;
 
+		bool is_affine() const override;
+		Eigen::SparseMatrix<double> affine_jacobian(const int x_size) const override;
+
 	private:
+		/// Consecutive affine parametrizations [begin, end) of the chain, composed into a single transposed Jacobian
+		struct AffineBlock
+		{
+			int begin, end;
+			Eigen::SparseMatrix<double> jacobian_transpose;
+		};
+
+		/// The composed Jacobians only depend on the input size. They are rebuilt when it changes
+		/// and after inverse_eval, which is where parametrizations (re)initialize their maps.
+		/// Copies share the cache, as they share the parametrizations.
+		struct JacobianCache
+		{
+			std::mutex mutex;
+			int x_size = -1;
+			std::vector<AffineBlock> blocks;
+		};
+
+		const std::vector<AffineBlock> &affine_blocks(const int x_size) const;
+
 		const std::vector<std::shared_ptr<Parametrization>> parametrizations_;
+		std::shared_ptr<JacobianCache> jacobian_cache_ = std::make_shared<JacobianCache>();
 	};
-} // namespace polyfem::solver
\ No newline at end of file
+} // namespace polyfem::solver
@@ -97,6 +97,21 @@ namespace polyfem::solver
 			return scale_ * grad.array();
 	}
 
+	Eigen::SparseMatrix<double> Scaling::affine_jacobian(const int x_size) const
+	{
+		std::vector<Eigen::Triplet<double>> entries;
+		entries.reserve(x_size);
+		for (int i = 0; i < x_size; i++)
+		{
+			const bool scaled = from_ < 0 || (i >= from_ && i < to_);
+			entries.emplace_back(i, i, scaled ? scale_ : 1.);
+		}
+
+		Eigen::SparseMatrix<double> jac(x_size, x_size);
+		jac.setFromTriplets(entries.begin(), entries.end());
+		return jac;
+	}
+
 	Eigen::VectorXd PowerMap::inverse_eval(const Eigen::VectorXd &y)
 	{
 		if (from_ >= 0)
@@ -262,6 +277,21 @@ namespace polyfem::solver
 		return grad_body;
 	}
 
+	Eigen::SparseMatrix<double> PerBody2PerNode::affine_jacobian(const int x_size) const
+	{
+		const int dim = x_size / reduced_size_;
+
+		std::vector<Eigen::Triplet<double>> entries;
+		entries.reserve(full_size_ * dim);
+		for (int i = 0; i < full_size_; i++)
+			for (int d = 0; d < dim; d++)
+				entries.emplace_back(i * dim + d, node_id_to_body_id_(i) * dim + d, 1.);
+
+		Eigen::SparseMatrix<double> jac(size(x_size), x_size);
+		jac.setFromTriplets(entries.begin(), entries.end());
+		return jac;
+	}
+
 	PerBody2PerElem::PerBody2PerElem(const mesh::Mesh &mesh) : mesh_(mesh), full_size_(mesh_.n_elements())
 	{
 		reduced_size_ = 0;
@@ -316,6 +346,25 @@ namespace polyfem::solver
 		return grad_body;
 	}
 
+	Eigen::SparseMatrix<double> PerBody2PerElem::affine_jacobian(const int x_size) const
+	{
+		const int n_fields = x_size / reduced_size_;
+
+		std::vector<Eigen::Triplet<double>> entries;
+		entries.reserve(full_size_ * n_fields);
+		for (int e = 0; e < mesh_.n_elements(); e++)
+		{
+			const int body_id = mesh_.get_body_id(e);
+			const auto &entry = body_id_map_.at(body_id);
+			for (int k = 0; k < n_fields; k++)
+				entries.emplace_back(e + k * full_size_, entry[1] + k * reduced_size_, 1.);
+		}
+
+		Eigen::SparseMatrix<double> jac(size(x_size), x_size);
+		jac.setFromTriplets(entries.begin(), entries.end());
+		return jac;
+	}
+
 	SliceMap::SliceMap(const int from, const int to, const int total) : from_(from), to_(to), total_(total)
 	{
 		if (to_ - from_ < 0)
@@ -349,6 +398,18 @@ namespace polyfem::solver
 		return grad_full;
 	}
 
+	Eigen::SparseMatrix<double> SliceMap::affine_jacobian(const int x_size) const
+	{
+		std::vector<Eigen::Triplet<double>> entries;
+		entries.reserve(to_ - from_);
+		for (int i = 0; i < to_ - from_; i++)
+			entries.emplace_back(i, from_ + i, 1.);
+
+		Eigen::SparseMatrix<double> jac(size(x_size), x_size);
+		jac.setFromTriplets(entries.begin(), entries.end());
+		return jac;
+	}
+
 	InsertConstantMap::InsertConstantMap(const int size, const double val, const int start_index) : start_index_(start_index)
 	{
 		if (size <= 0)
@@ -411,6 +472,21 @@ namespace polyfem::solver
 		return reduced_grad;
 	}
 
+	Eigen::SparseMatrix<double> InsertConstantMap::affine_jacobian(const int x_size) const
+	{
+		std::vector<Eigen::Triplet<double>> entries;
+		entries.reserve(x_size);
+		for (int i = 0; i < x_size; i++)
+		{
+			const bool shifted = start_index_ >= 0 && i >= start_index_;
+			entries.emplace_back(shifted ? i + values_.size() : i, i, 1.);
+		}
+
+		Eigen::SparseMatrix<double> jac(size(x_size), x_size);
+		jac.setFromTriplets(entries.begin(), entries.end());
+		return jac;
+	}
+
 	LinearFilter::LinearFilter(const mesh::Mesh &mesh, const double radius)
 	{
 		std::vector<Eigen::Triplet<double>> tt_adjacency_list;
@@ -484,13 +560,17 @@ namespace polyfem::solver
 	{
 		assert(x.size() == grad.size());
 
-		Eigen::MatrixXd hess;
-		hess.setZero(x.size(), size(x.size()));
-		for (int i = 0; i < hess.rows(); ++i)
-			for (int j = 0; j <= i; ++j)
-				hess(i, j) = dt_;
+		// the Jacobian is dt_ on and below the diagonal, its transpose amounts to a suffix sum
+		Eigen::VectorXd grad_x;
+		grad_x.setZero(grad.size());
+		double sum = 0;
+		for (int i = grad.size() - 1; i >= 0; --i)
+		{
+			sum += grad(i);
+			grad_x(i) = dt_ * sum;
+		}
 
-		return hess.transpose() * grad;
+		return grad_x;
 	}
 
 } // namespace polyfem::solver
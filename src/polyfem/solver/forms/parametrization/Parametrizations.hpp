@@ -49,6 +49,9 @@ namespace polyfem::solver
 		Eigen::VectorXd eval(const Eigen::VectorXd &x) const override;
 		Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad, const Eigen::VectorXd &x) const override;
 
+		bool is_affine() const override { return true; }
+		Eigen::SparseMatrix<double> affine_jacobian(const int x_size) const override;
+
 	private:
 		const int from_, to_;
 		const double scale_;
@@ -97,6 +100,9 @@ namespace polyfem::solver
 		Eigen::VectorXd eval(const Eigen::VectorXd &x) const override;
 		Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad, const Eigen::VectorXd &x) const override;
 
+		bool is_affine() const override { return true; }
+		Eigen::SparseMatrix<double> affine_jacobian(const int x_size) const override;
+
 	private:
 		const mesh::Mesh &mesh_;
 		const std::vector<basis::ElementBases> &bases_;
@@ -114,6 +120,9 @@ namespace polyfem::solver
 		Eigen::VectorXd eval(const Eigen::VectorXd &x) const override;
 		Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad, const Eigen::VectorXd &x) const override;
 
+		bool is_affine() const override { return true; }
+		Eigen::SparseMatrix<double> affine_jacobian(const int x_size) const override;
+
 	private:
 		const mesh::Mesh &mesh_;
 		int full_size_;
@@ -132,6 +141,9 @@ namespace polyfem::solver
 		Eigen::VectorXd eval(const Eigen::VectorXd &x) const override;
 		Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad, const Eigen::VectorXd &x) const override;
 
+		bool is_affine() const override { return true; }
+		Eigen::SparseMatrix<double> affine_jacobian(const int x_size) const override;
+
 	private:
 		const int from_, to_, total_;
 	};
@@ -147,6 +159,9 @@ namespace polyfem::solver
 		Eigen::VectorXd eval(const Eigen::VectorXd &x) const override;
 		Eigen::VectorXd apply_jacobian(const Eigen::VectorXd &grad, const Eigen::VectorXd &x) const override;
 
+		bool is_affine() const override { return true; }
+		Eigen::SparseMatrix<double> affine_jacobian(const int x_size) const override;
+
 	private:
 		// const int size_;
 		// const double val_;
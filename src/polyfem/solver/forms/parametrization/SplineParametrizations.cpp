@@ -135,6 +135,35 @@ namespace polyfem::solver
 			return grad;
 	}
 
+	Eigen::SparseMatrix<double> BSplineParametrization1DTo2D::affine_jacobian(const int x_size) const
+	{
+		if (!invoked_inverse_eval_)
+			log_and_throw_error("Must call inverse eval on this parametrization first!");
+
+		Eigen::SparseMatrix<double> basis;
+		spline_->basis_matrix(basis);
+
+		// the end control points are fixed if excluded
+		const int offset = exclude_ends_ ? 1 : 0;
+		const int n_free_control_points = initial_control_points_.rows() - 2 * offset;
+		assert(x_size == 2 * n_free_control_points);
+
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int k = 0; k < basis.outerSize(); ++k)
+			for (Eigen::SparseMatrix<double>::InnerIterator it(basis, k); it; ++it)
+			{
+				const int c = it.col() - offset;
+				if (c < 0 || c >= n_free_control_points)
+					continue;
+				for (int d = 0; d < 2; ++d)
+					entries.emplace_back(it.row() * 2 + d, c * 2 + d, it.value());
+			}
+
+		Eigen::SparseMatrix<double> jac(size(x_size), x_size);
+		jac.setFromTriplets(entries.begin(), entries.end());
+		return jac;
+	}
+
 	Eigen::VectorXd BSplineParametrization2DTo3D::inverse_eval(const Eigen::VectorXd &y)
 	{
 		spline_ = std::make_shared<BSplineParametrization3D>(initial_control_point_grid_, knots_u_, knots_v_, y);
@@ -376,6 +405,25 @@ namespace polyfem::solver
 		return grad;
 	}
 
+	Eigen::SparseMatrix<double> BoundedBiharmonicWeights2Dto3D::affine_jacobian(const int x_size) const
+	{
+		if (!invoked_inverse_eval_)
+			log_and_throw_error("Must call inverse eval on this parametrization first!");
+		assert(!allow_rotations_);
+		assert(x_size == bbw_weights_.cols() * 3);
+
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int j = 0; j < bbw_weights_.cols(); ++j)
+			for (int i = 0; i < bbw_weights_.rows(); ++i)
+				if (bbw_weights_(i, j) != 0)
+					for (int d = 0; d < 3; ++d)
+						entries.emplace_back(i * 3 + d, j * 3 + d, bbw_weights_(i, j));
+
+		Eigen::SparseMatrix<double> jac(bbw_weights_.rows() * 3, x_size);
+		jac.setFromTriplets(entries.begin(), entries.end());
+		return jac;
+	}
+
 	void BoundedBiharmonicWeights2Dto3D::compute_faces_for_partial_vertices(const Eigen::MatrixXd &V, Eigen::MatrixXi &F) const
 	{
 		// The following implementation is maybe a bit wasteful, but is independent of state or surface selections
@@ -64,6 +64,24 @@ namespace polyfem
 			}
 			reduced_mat.setFromTriplets(coeffs.begin(), coeffs.end());
 		}
+
+		/// Solves A X = B for all columns of B with a solver prefactorized on A with identity Dirichlet rows and columns
+		/// (see polysolve::linear::prefactorize). The Dirichlet lifting of all right-hand sides is done with one sparse-dense product.
+		void multi_dirichlet_solve_prefactorized(polysolve::linear::Solver &solver, const StiffnessMatrix &A, const Eigen::MatrixXd &B, const std::vector<int> &dirichlet_nodes, Eigen::MatrixXd &X)
+		{
+			Eigen::MatrixXd G = B;
+			if (!B(dirichlet_nodes, Eigen::all).isZero(0))
+			{
+				Eigen::MatrixXd boundary_values = Eigen::MatrixXd::Zero(B.rows(), B.cols());
+				boundary_values(dirichlet_nodes, Eigen::all) = B(dirichlet_nodes, Eigen::all);
+				G -= A * boundary_values;
+				G(dirichlet_nodes, Eigen::all) = B(dirichlet_nodes, Eigen::all);
+			}
+
+			X.setZero(B.rows(), B.cols());
+			for (int i = 0; i < B.cols(); ++i)
+				solver.solve(G.col(i), X.col(i));
+		}
 	} // namespace
 
 	void State::get_vertices(Eigen::MatrixXd &vertices) const
@@ -101,8 +119,21 @@ namespace polyfem
 	{
 		StiffnessMatrix gradu_h(sol.size(), sol.size());
 		if (current_step == 0)
+		{
 			diff_cached.init(mesh->dimension(), ndof(), problem->is_time_dependent() ? args["time"]["time_steps"].get<int>() : 0);
 
+			if (problem->is_time_dependent())
+			{
+				const std::string scratch_file = args["solver"]["advanced"]["adjoint_scratch_file"];
+				diff_cached.set_checkpointing(
+					args["solver"]["advanced"]["adjoint_resident_steps"],
+					scratch_file.empty() ? "" : resolve_output_path(scratch_file),
+					[this](const int step, StiffnessMatrix &gradu_h, ipc::Collisions &collision_set, ipc::FrictionCollisions &friction_collision_set) {
+						recompute_transient_adjoint_quantities(step, gradu_h, collision_set, friction_collision_set);
+					});
+			}
+		}
+
 		ipc::Collisions cur_collision_set;
 		ipc::FrictionCollisions cur_friction_set;
 
@@ -122,6 +153,9 @@ namespace polyfem
 
 		if (problem->is_time_dependent())
 		{
+			if (solve_data.contact_form)
+				diff_cached.cache_barrier_stiffness(current_step, solve_data.contact_form->barrier_stiffness());
+
 			if (args["time"]["quasistatic"].get<bool>())
 			{
 				diff_cached.cache_quantities_quasistatic(current_step, sol, gradu_h, cur_collision_set, disp_grad);
@@ -161,6 +195,89 @@ namespace polyfem
 		}
 	}
 
+	void State::recompute_transient_adjoint_quantities(const int step, StiffnessMatrix &gradu_h, ipc::Collisions &collision_set, ipc::FrictionCollisions &friction_collision_set)
+	{
+		assert(step > 0); // step 0 is never evicted
+		assert(problem->is_time_dependent());
+
+		collision_set = ipc::Collisions();
+		friction_collision_set = ipc::FrictionCollisions();
+
+		if (optimization_enabled != solver::CacheLevel::Derivatives)
+		{
+			gradu_h = StiffnessMatrix(ndof(), ndof());
+			return;
+		}
+
+		const double t0 = args["time"]["t0"];
+		const double dt = args["time"]["dt"];
+		const bool quasistatic = args["time"]["quasistatic"];
+		const int last_step = diff_cached.size() - 1;
+		const bool replay_integrator = solve_data.time_integrator && !quasistatic;
+
+		// State left by the forward simulation, restored at the end
+		const double final_barrier_stiffness = solve_data.contact_form ? solve_data.contact_form->barrier_stiffness() : 0;
+		Eigen::MatrixXd final_x_prevs, final_v_prevs, final_a_prevs;
+		if (replay_integrator)
+		{
+			const auto &ti = *solve_data.time_integrator;
+			final_x_prevs.resize(ndof(), ti.steps());
+			final_v_prevs.resize(ndof(), ti.steps());
+			final_a_prevs.resize(ndof(), ti.steps());
+			for (int j = 0; j < ti.steps(); ++j)
+			{
+				final_x_prevs.col(j) = ti.x_prevs()[j];
+				final_v_prevs.col(j) = ti.v_prevs()[j];
+				final_a_prevs.col(j) = ti.a_prevs()[j];
+			}
+		}
+
+		// Replay the beginning of the step from the cached trajectory
+		if (replay_integrator)
+		{
+			const int n_prevs = diff_cached.bdf_order(step);
+			assert(n_prevs > 0 && n_prevs <= step);
+
+			Eigen::MatrixXd x_prevs(ndof(), n_prevs), v_prevs(ndof(), n_prevs), a_prevs(ndof(), n_prevs);
+			for (int j = 0; j < n_prevs; ++j)
+			{
+				x_prevs.col(j) = diff_cached.u(step - 1 - j);
+				v_prevs.col(j) = diff_cached.v(step - 1 - j);
+				a_prevs.col(j) = diff_cached.acc(step - 1 - j);
+			}
+			solve_data.time_integrator->init(x_prevs, v_prevs, a_prevs, dt);
+			solve_data.update_dt();
+		}
+
+		solve_data.nl_problem->update_quantities(t0 + step * dt, diff_cached.u(step - 1));
+		if (solve_data.contact_form)
+			solve_data.contact_form->set_barrier_stiffness(diff_cached.barrier_stiffness(step));
+		solve_data.nl_problem->FullNLProblem::init_lagging(diff_cached.u(step - 1));
+		solve_data.nl_problem->FullNLProblem::update_lagging(diff_cached.u(step), 1);
+
+		// Linearize at the converged solution of the step
+		gradu_h.resize(ndof(), ndof());
+		compute_force_jacobian(diff_cached.u(step), Eigen::MatrixXd::Zero(mesh->dimension(), mesh->dimension()), gradu_h);
+		if (solve_data.contact_form)
+			collision_set = solve_data.contact_form->collision_set();
+		if (solve_data.friction_form)
+			friction_collision_set = solve_data.friction_form->friction_collision_set();
+
+		// Restore the state left by the forward simulation
+		if (replay_integrator)
+		{
+			solve_data.time_integrator->init(final_x_prevs, final_v_prevs, final_a_prevs, dt);
+			solve_data.update_dt();
+		}
+		solve_data.nl_problem->update_quantities(t0 + (last_step + 1) * dt, diff_cached.u(last_step));
+		if (solve_data.contact_form)
+			solve_data.contact_form->set_barrier_stiffness(diff_cached.barrier_stiffness(last_step));
+		solve_data.nl_problem->FullNLProblem::update_lagging(diff_cached.u(last_step), 1);
+		if (solve_data.contact_form)
+			solve_data.contact_form->set_barrier_stiffness(final_barrier_stiffness);
+		solve_data.nl_problem->FullNLProblem::solution_changed(diff_cached.u(last_step));
+	}
+
 	void State::compute_force_jacobian(const Eigen::MatrixXd &sol, const Eigen::MatrixXd &disp_grad, StiffnessMatrix &hessian)
 	{
 		if (problem->is_time_dependent())
@@ -207,7 +324,7 @@ namespace polyfem
 		}
 	}
 
-	void State::compute_force_jacobian_prev(const int force_step, const int sol_step, StiffnessMatrix &hessian_prev) const
+	void State::compute_force_jacobian_prev(const int force_step, const int sol_step, const ipc::FrictionCollisions &force_step_friction_collision_set, StiffnessMatrix &hessian_prev) const
 	{
 		assert(force_step > 0);
 		assert(force_step > sol_step);
@@ -238,7 +355,7 @@ namespace polyfem
 
 						hessian_prev =
 							solve_data.friction_form->friction_potential().force_jacobian(
-								diff_cached.friction_collision_set(force_step),
+								force_step_friction_collision_set,
 								collision_mesh,
 								collision_mesh.rest_positions(),
 								/*lagged_displacements=*/surface_solution_prev,
@@ -247,7 +364,7 @@ namespace polyfem
 								solve_data.contact_form->barrier_stiffness(),
 								ipc::FrictionPotential::DiffWRT::LAGGED_DISPLACEMENTS)
 							+ solve_data.friction_form->friction_potential().force_jacobian(
-								  diff_cached.friction_collision_set(force_step),
+								  force_step_friction_collision_set,
 								  collision_mesh,
 								  collision_mesh.rest_positions(),
 								  /*lagged_displacements=*/surface_solution_prev,
@@ -327,7 +444,7 @@ namespace polyfem
 		diff_cached.cache_adjoints(solve_adjoint(rhs));
 	}
 
-	Eigen::MatrixXd State::solve_adjoint(const Eigen::MatrixXd &rhs) const
+	Eigen::MatrixXd State::solve_adjoint(const Eigen::MatrixXd &rhs)
 	{
 		if (problem->is_time_dependent())
 			return solve_transient_adjoint(rhs);
@@ -335,6 +452,37 @@ namespace polyfem
 			return solve_static_adjoint(rhs);
 	}
 
+	std::vector<Eigen::MatrixXd> State::solve_adjoints(const std::vector<Eigen::MatrixXd> &rhs)
+	{
+		if (problem->is_time_dependent())
+			return solve_transient_adjoints(rhs);
+
+		int n_cols = 0;
+		for (const auto &r : rhs)
+			n_cols += r.cols();
+		if (rhs.empty())
+			return {};
+
+		Eigen::MatrixXd stacked_rhs(rhs[0].rows(), n_cols);
+		n_cols = 0;
+		for (const auto &r : rhs)
+		{
+			stacked_rhs.middleCols(n_cols, r.cols()) = r;
+			n_cols += r.cols();
+		}
+
+		const Eigen::MatrixXd stacked_adjoint = solve_static_adjoint(stacked_rhs);
+
+		std::vector<Eigen::MatrixXd> adjoints;
+		n_cols = 0;
+		for (const auto &r : rhs)
+		{
+			adjoints.push_back(stacked_adjoint.middleCols(n_cols, r.cols()));
+			n_cols += r.cols();
+		}
+		return adjoints;
+	}
+
 	Eigen::MatrixXd State::solve_static_adjoint(const Eigen::MatrixXd &adjoint_rhs) const
 	{
 		Eigen::MatrixXd b = adjoint_rhs;
@@ -361,18 +509,13 @@ namespace polyfem
 			else
 				boundary_nodes_tmp = boundary_nodes;
 
-			adjoint.setZero(ndof(), adjoint_rhs.cols());
-			for (int i = 0; i < b.cols(); i++)
-			{
-				Eigen::VectorXd x, tmp;
-				tmp = b.col(i);
-				dirichlet_solve_prefactorized(*lin_solver_cached, A, tmp, boundary_nodes_tmp, x);
+			Eigen::MatrixXd x;
+			multi_dirichlet_solve_prefactorized(*lin_solver_cached, A, b, boundary_nodes_tmp, x);
 
-				if (has_periodic_bc())
-					adjoint.col(i) = periodic_bc->periodic_to_full(full_size, x);
-				else
-					adjoint.col(i) = x;
-			}
+			if (has_periodic_bc())
+				adjoint = periodic_bc->periodic_to_full(full_size, x);
+			else
+				adjoint = x;
 		}
 		else
 		{
@@ -386,19 +529,15 @@ namespace polyfem
 			*/
 			if (!is_homogenization())
 			{
-				adjoint.setZero(ndof(), adjoint_rhs.cols());
-				for (int i = 0; i < b.cols(); i++)
-				{
-					Eigen::VectorXd tmp = b.col(i);
-					tmp(boundary_nodes).setZero();
+				Eigen::MatrixXd tmp = b;
+				tmp(boundary_nodes, Eigen::all).setZero();
 
-					Eigen::VectorXd x;
-					x.setZero(tmp.size());
-					dirichlet_solve(*solver, A, tmp, boundary_nodes, x, A.rows(), "", false, false, false);
+				// factorize once for all right-hand sides
+				StiffnessMatrix A_prefactorized = A;
+				prefactorize(*solver, A_prefactorized, boundary_nodes, A.rows(), "");
+				multi_dirichlet_solve_prefactorized(*solver, A, tmp, boundary_nodes, adjoint);
 
-					adjoint.col(i) = x;
-					adjoint(boundary_nodes, i) = -b(boundary_nodes, i);
-				}
+				adjoint(boundary_nodes, Eigen::all) = -b(boundary_nodes, Eigen::all);
 			}
 			else
 			{
@@ -423,7 +562,12 @@ namespace polyfem
 		return adjoint;
 	}
 
-	Eigen::MatrixXd State::solve_transient_adjoint(const Eigen::MatrixXd &adjoint_rhs) const
+	Eigen::MatrixXd State::solve_transient_adjoint(const Eigen::MatrixXd &adjoint_rhs)
+	{
+		return solve_transient_adjoints({adjoint_rhs})[0];
+	}
+
+	std::vector<Eigen::MatrixXd> State::solve_transient_adjoints(const std::vector<Eigen::MatrixXd> &adjoint_rhs)
 	{
 		const double dt = args["time"]["dt"];
 		const int time_steps = args["time"]["time_steps"];
@@ -438,79 +582,103 @@ namespace polyfem
 		else
 			log_and_throw_adjoint_error("Integrator type not supported for differentiability.");
 
-		assert(adjoint_rhs.cols() == time_steps + 1);
+		const int n_rhs = adjoint_rhs.size();
+		for (const auto &rhs : adjoint_rhs)
+			assert(rhs.cols() == time_steps + 1);
 
 		const int cols_per_adjoint = time_steps + 1;
-		Eigen::MatrixXd adjoints;
-		adjoints.setZero(ndof(), cols_per_adjoint * 2);
+		std::vector<Eigen::MatrixXd> adjoints(n_rhs, Eigen::MatrixXd::Zero(ndof(), cols_per_adjoint * 2));
 
 		// set dirichlet rows of mass to identity
 		StiffnessMatrix reduced_mass;
 		replace_rows_by_identity(reduced_mass, mass, boundary_nodes);
 
-		Eigen::MatrixXd sum_alpha_p, sum_alpha_nu;
+		// the Jacobians and the factorization of every step are shared by all right-hand sides
+		std::vector<Eigen::VectorXd> sum_alpha_p(n_rhs), sum_alpha_nu(n_rhs), rhs_(n_rhs);
 		for (int i = time_steps; i >= 0; --i)
 		{
 			{
-				sum_alpha_p.setZero(ndof(), 1);
-				sum_alpha_nu.setZero(ndof(), 1);
-
 				const int num = std::min(bdf_order, time_steps - i);
 
 				Eigen::VectorXd bdf_coeffs = Eigen::VectorXd::Zero(num);
 				for (int j = 0; j < bdf_order && i + j < time_steps; ++j)
 					bdf_coeffs(j) = -time_integrator::BDF::alphas(std::min(bdf_order - 1, i + j))[j];
 
-				sum_alpha_p = adjoints.middleCols(i + 1, num) * bdf_coeffs;
-				sum_alpha_nu = adjoints.middleCols(cols_per_adjoint + i + 1, num) * bdf_coeffs;
+				for (int r = 0; r < n_rhs; ++r)
+				{
+					sum_alpha_p[r] = adjoints[r].middleCols(i + 1, num) * bdf_coeffs;
+					sum_alpha_nu[r] = adjoints[r].middleCols(cols_per_adjoint + i + 1, num) * bdf_coeffs;
+				}
 			}
 
-			Eigen::VectorXd rhs_ = -reduced_mass.transpose() * sum_alpha_nu - adjoint_rhs.col(i);
+			for (int r = 0; r < n_rhs; ++r)
+				rhs_[r] = -reduced_mass.transpose() * sum_alpha_nu[r] - adjoint_rhs[r].col(i);
 			for (int j = 1; j <= bdf_order; j++)
 			{
 				if (i + j > time_steps)
 					break;
 
 				StiffnessMatrix gradu_h_prev;
-				compute_force_jacobian_prev(i + j, i, gradu_h_prev);
-				Eigen::VectorXd tmp = adjoints.col(i + j) * (time_integrator::BDF::betas(diff_cached.bdf_order(i + j) - 1) * dt);
-				tmp(boundary_nodes).setZero();
-				rhs_ += -gradu_h_prev.transpose() * tmp;
+				compute_force_jacobian_prev(i + j, i, diff_cached.load(i + j)->friction_collision_set, gradu_h_prev);
+				for (int r = 0; r < n_rhs; ++r)
+				{
+					Eigen::VectorXd tmp = adjoints[r].col(i + j) * (time_integrator::BDF::betas(diff_cached.bdf_order(i + j) - 1) * dt);
+					tmp(boundary_nodes).setZero();
+					rhs_[r] += -gradu_h_prev.transpose() * tmp;
+				}
 			}
 
 			if (i > 0)
 			{
 				double beta_dt = time_integrator::BDF::betas(diff_cached.bdf_order(i) - 1) * dt;
 
-				rhs_ += (1. / beta_dt) * (diff_cached.gradu_h(i) - reduced_mass).transpose() * sum_alpha_p;
+				// the handle keeps the step in memory while the next ones are loaded
+				const solver::DiffCache::StepHandle step = diff_cached.load(i);
+				const StiffnessMatrix &gradu_h = step->gradu_h;
+				for (int r = 0; r < n_rhs; ++r)
+					rhs_[r] += (1. / beta_dt) * (gradu_h - reduced_mass).transpose() * sum_alpha_p[r];
 
 				{
-					StiffnessMatrix A = diff_cached.gradu_h(i).transpose();
-					Eigen::VectorXd b_ = rhs_;
-					b_(boundary_nodes).setZero();
+					StiffnessMatrix A = gradu_h.transpose();
+					Eigen::MatrixXd b_(A.rows(), n_rhs);
+					for (int r = 0; r < n_rhs; ++r)
+						b_.col(r) = rhs_[r];
+					b_(boundary_nodes, Eigen::all).setZero();
 
 					auto solver = polysolve::linear::Solver::create(args["solver"]["adjoint_linear"], adjoint_logger());
 
-					Eigen::VectorXd x;
-					dirichlet_solve(*solver, A, b_, boundary_nodes, x, A.rows(), "", false, false, false);
-					adjoints.col(i + cols_per_adjoint) = x;
-				}
+					StiffnessMatrix A_prefactorized = A;
+					prefactorize(*solver, A_prefactorized, boundary_nodes, A.rows(), "");
 
-				// TODO: generalize to BDFn
-				Eigen::VectorXd tmp = rhs_(boundary_nodes);
-				if (i + 1 < cols_per_adjoint)
-					tmp += (-2. / beta_dt) * adjoints(boundary_nodes, i + 1);
-				if (i + 2 < cols_per_adjoint)
-					tmp += (1. / beta_dt) * adjoints(boundary_nodes, i + 2);
+					Eigen::MatrixXd x;
+					multi_dirichlet_solve_prefactorized(*solver, A, b_, boundary_nodes, x);
+					for (int r = 0; r < n_rhs; ++r)
+						adjoints[r].col(i + cols_per_adjoint) = x.col(r);
+				}
 
-				tmp -= (diff_cached.gradu_h(i).transpose() * adjoints.col(i + cols_per_adjoint))(boundary_nodes);
-				adjoints(boundary_nodes, i + cols_per_adjoint) = tmp;
-				adjoints.col(i) = beta_dt * adjoints.col(i + cols_per_adjoint) - sum_alpha_p;
+				for (int r = 0; r < n_rhs; ++r)
+				{
+					Eigen::MatrixXd &adjoint = adjoints[r];
+
+					// TODO: generalize to BDFn
+					Eigen::VectorXd tmp = rhs_[r](boundary_nodes);
+					if (i + 1 < cols_per_adjoint)
+						tmp += (-2. / beta_dt) * adjoint(boundary_nodes, i + 1);
+					if (i + 2 < cols_per_adjoint)
+						tmp += (1. / beta_dt) * adjoint(boundary_nodes, i + 2);
+
+					tmp -= (gradu_h.transpose() * adjoint.col(i + cols_per_adjoint))(boundary_nodes);
+					adjoint(boundary_nodes, i + cols_per_adjoint) = tmp;
+					adjoint.col(i) = beta_dt * adjoint.col(i + cols_per_adjoint) - sum_alpha_p[r];
+				}
 			}
 			else
 			{
-				adjoints.col(i) = -reduced_mass.transpose() * sum_alpha_p;
-				adjoints.col(i + cols_per_adjoint) = rhs_; // adjoint_nu[0] actually stores adjoint_mu[0]
+				for (int r = 0; r < n_rhs; ++r)
+				{
+					adjoints[r].col(i) = -reduced_mass.transpose() * sum_alpha_p[r];
+					adjoints[r].col(i + cols_per_adjoint) = rhs_[r]; // adjoint_nu[0] actually stores adjoint_mu[0]
+				}
 			}
 		}
 		return adjoints;
@@ -272,6 +272,12 @@ namespace polyfem
 				elastic_assembler->set_use_robust_jacobian();
 		}
 
+		if (args["solver"]["advanced"]["psd_projection"] == "QuadraturePoint")
+		{
+			if (auto nl_assembler = std::dynamic_pointer_cast<assembler::NLAssembler>(assembler))
+				nl_assembler->set_per_point_psd_projection(true);
+		}
+
 		if (!args.contains("preset_problem"))
 		{
 			if (!assembler->is_tensor())
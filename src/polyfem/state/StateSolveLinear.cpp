@@ -2,6 +2,7 @@
 
 #include <polyfem/assembler/Mass.hpp>
 #include <polyfem/assembler/AssemblerUtils.hpp>
+#include <polyfem/assembler/SumFactorization.hpp>
 
 #include <polyfem/time_integrator/ImplicitTimeIntegrator.hpp>
 #include <polyfem/time_integrator/BDF.hpp>
@@ -47,7 +48,9 @@ namespace polyfem
 		}
 		else
 		{
-			assembler->assemble(mesh->is_volume(), n_bases, bases, geom_bases(), ass_vals_cache, 0, stiffness);
+			if (!stiffness_mat_cache)
+				stiffness_mat_cache = std::make_unique<utils::SparseMatrixCache>();
+			assembler->assemble(mesh->is_volume(), n_bases, bases, geom_bases(), ass_vals_cache, 0, *stiffness_mat_cache, stiffness);
 		}
 
 		timer.stop();
@@ -150,6 +153,9 @@ namespace polyfem
 			local_boundary, boundary_nodes, n_boundary_samples(),
 			(assembler->name() != "Bilaplacian") ? local_neumann_boundary : std::vector<LocalBoundary>(), rhs);
 
+		if (args["solver"]["advanced"]["matrix_free"] && solve_linear_matrix_free(sol))
+			return;
+
 		StiffnessMatrix A;
 		build_stiffness_mat(A);
 
@@ -160,6 +166,73 @@ namespace polyfem
 		solve_linear(lin_solver_cached, A, b, args["output"]["advanced"]["spectrum"], sol, pressure);
 	}
 
+	bool State::solve_linear_matrix_free(Eigen::MatrixXd &sol)
+	{
+		// the adjoint of optimizations needs the factorization of the assembled matrix
+		if (mixed_assembler != nullptr || has_periodic_bc() || optimization_enabled != solver::CacheLevel::None
+			|| (assembler->name() != "Laplacian" && assembler->name() != "LinearElasticity")
+			|| args["space"]["advanced"]["use_corner_quadrature"]
+			|| !assembler::SumFactorizedOperator::is_supported(*mesh, bases))
+		{
+			logger().warn("Matrix-free solve not supported for this problem, assembling the stiffness matrix");
+			return false;
+		}
+
+		POLYFEM_SCOPED_TIMER("Matrix-free solve");
+
+		// same 1D Gauss rule as the hexahedral quadrature of the bases
+		const int quadrature_order = args["space"]["advanced"]["quadrature_order"];
+		const int order = quadrature_order > 0 ? quadrature_order : assembler::AssemblerUtils::quadrature_order(assembler->name(), disc_orders.maxCoeff(), assembler::AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
+		const assembler::SumFactorizedOperator op(*assembler, *mesh, n_bases, bases, geom_bases(), order);
+
+		// the Dirichlet rows are the identity, as in dirichlet_solve, so CG runs on the free DOFs with the lifted right-hand side
+		Eigen::VectorXd is_free = Eigen::VectorXd::Ones(op.size());
+		for (const int i : boundary_nodes)
+			is_free(i) = 0;
+
+		Eigen::VectorXd diag;
+		op.diagonal(diag);
+		const Eigen::VectorXd inv_diag = is_free.cwiseQuotient(diag);
+
+		const Eigen::VectorXd b = rhs;
+		Eigen::VectorXd x = b - is_free.cwiseProduct(b);
+
+		Eigen::VectorXd Ap;
+		op.apply(x, Ap);
+		Eigen::VectorXd r = is_free.cwiseProduct(b - Ap);
+		Eigen::VectorXd z = inv_diag.cwiseProduct(r);
+		Eigen::VectorXd p = z;
+		double rz = r.dot(z);
+
+		const double tolerance = args["solver"]["advanced"]["matrix_free_tolerance"];
+		const double initial_residual = r.norm();
+		int it = 0;
+		for (; it < op.size() && r.norm() > tolerance * initial_residual; ++it)
+		{
+			op.apply(p, Ap);
+			Ap = is_free.cwiseProduct(Ap);
+
+			const double alpha = rz / p.dot(Ap);
+			x += alpha * p;
+			r -= alpha * Ap;
+
+			z = inv_diag.cwiseProduct(r);
+			const double rz_next = r.dot(z);
+			p = z + (rz_next / rz) * p;
+			rz = rz_next;
+		}
+
+		stats.solver_info = json({{"solver", "MatrixFreeCG"}, {"iterations", it}, {"residual", r.norm()}});
+
+		if (r.norm() > tolerance * initial_residual)
+			logger().error("Matrix-free CG did not converge in {} iterations, residual {}", it, r.norm());
+		else
+			logger().debug("Matrix-free CG converged in {} iterations, residual {}", it, r.norm());
+
+		sol = x;
+		return true;
+	}
+
 	void State::init_linear_solve(Eigen::MatrixXd &sol, const double t)
 	{
 		assert(sol.cols() == 1);
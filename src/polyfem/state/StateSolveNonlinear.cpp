@@ -260,6 +260,8 @@ namespace polyfem
 		for (const auto &form : forms)
 			form->set_output_dir(output_dir);
 
+		solve_data.elastic_form->set_hessian_reuse_tolerance(args["solver"]["advanced"]["hessian_reuse_tolerance"]);
+
 		if (solve_data.contact_form != nullptr)
 			solve_data.contact_form->save_ccd_debug_meshes = args["output"]["advanced"]["save_ccd_debug_meshes"];
 
@@ -293,6 +295,11 @@ namespace polyfem
 			logger().info("Lagging iteration 1:");
 		}
 
+		// the lagging above is still initialized from the previous time step, only the initial guess is warm started,
+		// the barrier stiffness is adapted as in a cold solve so that both converge to the same solution
+		if (init_lagging && apply_warm_start(t, sol))
+			logger().debug("Warm starting the solve from the previous forward solution");
+
 		// ---------------------------------------------------------------------
 
 		// Save the subsolve sequence for debugging
@@ -403,4 +410,191 @@ namespace polyfem
 			}
 		}
 	}
+
+	void State::store_warm_start()
+	{
+		warm_start_sol.resize(0, 0);
+		warm_start_dof_ordering.clear();
+
+		if (!args["solver"]["advanced"]["warm_start"] || optimization_enabled == solver::CacheLevel::None || diff_cached.size() == 0)
+			return;
+
+		const int n_steps = diff_cached.size();
+		warm_start_dof_ordering = dof_ordering;
+		warm_start_sol.resize(diff_cached.u(0).size(), n_steps);
+		for (int i = 0; i < n_steps; ++i)
+			warm_start_sol.col(i) = diff_cached.u(i);
+	}
+
+	bool State::apply_warm_start(const int t, Eigen::MatrixXd &sol) const
+	{
+		// a different size means the discretization changed, a different ordering that build_basis renumbered
+		// the nodes (e.g. the position dependent morton ordering after a shape update)
+		if (t >= warm_start_sol.cols() || warm_start_sol.rows() != sol.size() || warm_start_dof_ordering != dof_ordering)
+			return false;
+
+		const Eigen::MatrixXd warm_sol = warm_start_sol.col(t);
+		if (is_contact_enabled())
+		{
+			const Eigen::MatrixXd displaced = collision_mesh.displace_vertices(
+				utils::unflatten(warm_sol, mesh->dimension()));
+
+			if (ipc::has_intersections(collision_mesh, displaced, args["solver"]["contact"]["CCD"]["broad_phase"]))
+			{
+				logger().debug("Previous forward solution has intersections on the updated mesh, not warm starting");
+				return false;
+			}
+		}
+
+		sol = warm_sol;
+		return true;
+	}
+
+	void State::set_max_surrogate_snapshots(const int n)
+	{
+		max_surrogate_snapshots = n;
+		if (max_surrogate_snapshots <= 0)
+		{
+			surrogate_snapshots.clear();
+			surrogate_hessian.resize(0, 0);
+			surrogate_solver.reset();
+		}
+		else if (surrogate_snapshots.size() > max_surrogate_snapshots)
+			surrogate_snapshots.erase(surrogate_snapshots.begin(), surrogate_snapshots.end() - max_surrogate_snapshots);
+	}
+
+	void State::store_surrogate_snapshot(const Eigen::MatrixXd &sol)
+	{
+		if (max_surrogate_snapshots <= 0)
+			return;
+
+		// a different size means the discretization changed, the old snapshots are meaningless
+		if (!surrogate_snapshots.empty() && surrogate_snapshots.back().size() != sol.size())
+			surrogate_snapshots.clear();
+
+		surrogate_snapshots.push_back(utils::flatten(sol));
+		if (surrogate_snapshots.size() > max_surrogate_snapshots)
+			surrogate_snapshots.erase(surrogate_snapshots.begin());
+
+		// the hessian is factorized by the next surrogate solve, the forward solves whose surrogate is never used do not pay for it
+		surrogate_hessian.resize(0, 0);
+		surrogate_solver.reset();
+	}
+
+	bool State::solve_surrogate(Eigen::MatrixXd &sol)
+	{
+		// only static nonlinear elasticity, the branch of solve_problem calling solve_tensor_nonlinear
+		if (surrogate_snapshots.empty() || surrogate_snapshots.back().size() != ndof()
+			|| problem->is_time_dependent() || assembler->name() == "NavierStokes" || is_homogenization()
+			|| is_problem_linear() || problem->is_scalar() || mixed_assembler != nullptr)
+			return false;
+
+		POLYFEM_SCOPED_TIMER("Surrogate forward solve");
+
+		Eigen::MatrixXd pressure;
+		init_solve(sol, pressure);
+		init_nonlinear_tensor_solve(sol);
+
+		NLProblem &nl_problem = *(solve_data.nl_problem);
+
+		// the snapshot with the boundary conditions of the new parameters
+		sol = surrogate_snapshots.back();
+		Eigen::VectorXd x = nl_problem.full_to_reduced(sol);
+		sol = nl_problem.reduced_to_full(x);
+		if (is_contact_enabled())
+		{
+			const Eigen::MatrixXd displaced = collision_mesh.displace_vertices(utils::unflatten(sol, mesh->dimension()));
+			if (ipc::has_intersections(collision_mesh, displaced, args["solver"]["contact"]["CCD"]["broad_phase"]))
+				return false;
+		}
+
+		nl_problem.init(sol);
+		solve_data.update_barrier_stiffness(sol);
+		nl_problem.solution_changed(x);
+		if (!std::isfinite(nl_problem.value(x)) || !nl_problem.is_step_valid(x, x))
+			return false;
+
+		// the hessian at the most recent snapshot is factorized once, the surrogate solves until the next snapshot only
+		// do back substitutions
+		if (!surrogate_solver || surrogate_hessian.rows() != x.size())
+		{
+			nl_problem.hessian(x, surrogate_hessian);
+			surrogate_solver = polysolve::linear::Solver::create(args["solver"]["linear"], logger());
+			surrogate_solver->analyze_pattern(surrogate_hessian, surrogate_hessian.rows());
+			surrogate_solver->factorize(surrogate_hessian);
+		}
+
+		Eigen::VectorXd grad;
+		nl_problem.gradient(x, grad);
+
+		// reduced basis: the differences to the older snapshots and the update of the most recent one with the converged hessian
+		Eigen::MatrixXd directions(x.size(), surrogate_snapshots.size());
+		for (int i = 0; i + 1 < surrogate_snapshots.size(); ++i)
+			directions.col(i) = nl_problem.full_to_reduced(surrogate_snapshots[i]) - x;
+		{
+			Eigen::VectorXd newton_dir(x.size());
+			surrogate_solver->solve(-grad, newton_dir);
+			directions.col(surrogate_snapshots.size() - 1) = newton_dir;
+		}
+
+		Eigen::ColPivHouseholderQR<Eigen::MatrixXd> qr(directions);
+		qr.setThreshold(1e-10);
+		const int rank = qr.rank();
+		if (rank == 0)
+			return false;
+		const Eigen::MatrixXd basis = qr.householderQ() * Eigen::MatrixXd::Identity(x.size(), rank);
+
+		// quasi-Newton on the reduced coordinates with the projected converged hessian, factorized once
+		const Eigen::LDLT<Eigen::MatrixXd> reduced_hess((basis.transpose() * (surrogate_hessian * basis)).eval());
+		const int n_reduced_steps = 3;
+		double initial_grad_norm = -1;
+		for (int it = 0; it < n_reduced_steps; ++it)
+		{
+			if (it > 0)
+				nl_problem.gradient(x, grad);
+
+			const Eigen::VectorXd reduced_grad = basis.transpose() * grad;
+			if (initial_grad_norm < 0)
+				initial_grad_norm = reduced_grad.norm();
+			if (reduced_grad.norm() <= 1e-6 * initial_grad_norm)
+				break;
+
+			Eigen::VectorXd reduced_dir = -reduced_hess.solve(reduced_grad);
+			if (!reduced_dir.allFinite() || reduced_dir.dot(reduced_grad) >= 0)
+				reduced_dir = -reduced_grad;
+			const Eigen::VectorXd dir = basis * reduced_dir;
+
+			const double energy = nl_problem.value(x);
+			nl_problem.line_search_begin(x, x + dir);
+			double step = nl_problem.max_step_size(x, x + dir);
+			Eigen::VectorXd new_x;
+			bool decreased = false;
+			for (; step > 1e-10 && !decreased; step /= 2)
+			{
+				new_x = x + step * dir;
+				if (!nl_problem.is_step_valid(x, new_x) || !nl_problem.is_step_collision_free(x, new_x))
+					continue;
+				nl_problem.solution_changed(new_x);
+				const double new_energy = nl_problem.value(new_x);
+				decreased = std::isfinite(new_energy) && new_energy <= energy;
+			}
+			nl_problem.line_search_end();
+
+			if (!decreased)
+			{
+				nl_problem.solution_changed(x);
+				break;
+			}
+			x = new_x;
+		}
+		nl_problem.finish();
+
+		sol = nl_problem.reduced_to_full(x);
+		logger().debug("Surrogate forward solve on {} reduced coordinates", rank);
+
+		if (optimization_enabled != solver::CacheLevel::None)
+			cache_transient_adjoint_quantities(0, sol, Eigen::MatrixXd::Zero(mesh->dimension(), mesh->dimension()));
+
+		return true;
+	}
 } // namespace polyfem
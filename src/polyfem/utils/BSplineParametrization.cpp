@@ -110,6 +110,30 @@ namespace polyfem
 		}
 	}
 
+	void BSplineParametrization2D::basis_matrix(Eigen::SparseMatrix<double> &basis)
+	{
+		const int n_control_points = curve.get_control_points().rows();
+		nanospline::BSpline<double, 1, 3> curve_;
+		curve_.set_knots(curve.get_knots());
+
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int i = 0; i < n_control_points; ++i)
+		{
+			Eigen::MatrixXd indicator = Eigen::MatrixXd::Zero(n_control_points, 1);
+			indicator(i) = 1;
+			curve_.set_control_points(indicator);
+			for (const auto &b : node_ids_)
+			{
+				const double basis_val = curve_.evaluate(node_id_to_t_.at(b))(0);
+				if (basis_val != 0)
+					entries.emplace_back(b, i, basis_val);
+			}
+		}
+
+		basis.resize(node_ids_.size(), n_control_points);
+		basis.setFromTriplets(entries.begin(), entries.end());
+	}
+
 	void BSplineParametrization2D::gradient(const Eigen::MatrixXd &point, const Eigen::MatrixXd &control_points, const double t_parameter, const double distance, Eigen::MatrixXd &grad)
 	{
 		nanospline::BSpline<double, 2, 3> curve;
@@ -4,6 +4,7 @@
 #include <vector>
 #include <iostream>
 #include <Eigen/Dense>
+#include <Eigen/Sparse>
 
 #include <nanospline/BSpline.h>
 #include <nanospline/BSplinePatch.h>
@@ -40,6 +41,9 @@ namespace polyfem
 
 		void derivative_wrt_params(const Eigen::VectorXd &grad_boundary, Eigen::VectorXd &grad_control_points) override;
 
+		// Values of the B-spline basis functions (columns) at the parameters of the vertices (rows)
+		void basis_matrix(Eigen::SparseMatrix<double> &basis);
+
 		static void gradient(const Eigen::MatrixXd &point, const Eigen::MatrixXd &control_points, const double t_parameter, const double distance, Eigen::MatrixXd &grad);
 		static void eval(const Eigen::MatrixXd &control_points, const double t, Eigen::MatrixXd &val);
 		static void deriv(const Eigen::MatrixXd &control_points, const double t, Eigen::MatrixXd &val);
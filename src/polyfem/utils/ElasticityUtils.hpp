@@ -9,9 +9,13 @@
 
 #include <Eigen/Dense>
 
+#include <ipc/utils/eigen_ext.hpp>
+
 #include <vector>
 #include <array>
+#include <algorithm>
 #include <functional>
+#include <type_traits>
 
 namespace polyfem
 {
@@ -135,6 +139,229 @@ namespace polyfem
 		def_grad = def_grad * jac_it;
 	}
 
+	// differentiates the density w.r.t. the DIM x DIM displacement gradient only and
+	// chains with grad_t_m, instead of propagating derivatives w.r.t. all element dofs
+	template <int DIM, bool WITH_HESSIAN, typename Density>
+	void disp_grad_energy_derivatives(
+		const assembler::NonLinearAssemblerData &data,
+		const Density &density,
+		const bool project_to_psd,
+		Eigen::VectorXd &gradient,
+		Eigen::MatrixXd &hessian)
+	{
+		constexpr int N = DIM * DIM;
+		typedef Eigen::Matrix<double, N, 1> Gradient;
+		typedef Eigen::Matrix<double, N, N> Hessian;
+		typedef std::conditional_t<WITH_HESSIAN, DScalar2<double, Gradient, Hessian>, DScalar1<double, Gradient>> Diff;
+
+		const auto &basis_values = data.vals.basis_values;
+		const int n_bases = basis_values.size();
+		const int n_dofs = n_bases * DIM;
+
+		Eigen::VectorXd local_disp;
+		get_local_disp(data, DIM, local_disp);
+
+		gradient.setZero(n_dofs);
+		if constexpr (WITH_HESSIAN)
+			hessian.setZero(n_dofs, n_dofs);
+
+		DiffScalarBase::setVariableCount(N);
+
+		// d vec(grad u) / d u_local, vec is column-major
+		Eigen::Matrix<double, N, Eigen::Dynamic> B(N, n_dofs);
+		Eigen::Matrix<Diff, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> disp_grad(DIM, DIM);
+
+		const int n_pts = data.da.size();
+		for (long p = 0; p < n_pts; ++p)
+		{
+			Eigen::Matrix<double, DIM, DIM> grad_u = Eigen::Matrix<double, DIM, DIM>::Zero();
+			B.setZero();
+			for (int i = 0; i < n_bases; ++i)
+			{
+				const Eigen::Matrix<double, 1, DIM> G = basis_values[i].grad_t_m.row(p);
+				for (int d = 0; d < DIM; ++d)
+				{
+					grad_u.row(d) += local_disp(i * DIM + d) * G;
+					for (int k = 0; k < DIM; ++k)
+						B(d + k * DIM, i * DIM + d) = G(k);
+				}
+			}
+
+			for (int r = 0; r < DIM; ++r)
+				for (int c = 0; c < DIM; ++c)
+					disp_grad(r, c) = Diff(r + c * DIM, grad_u(r, c));
+
+			const Diff energy = density(p, disp_grad);
+
+			gradient.noalias() += data.da(p) * (B.transpose() * energy.getGradient());
+			if constexpr (WITH_HESSIAN)
+			{
+				const Hessian d2 = project_to_psd ? Hessian(ipc::project_to_psd(Hessian(energy.getHessian()))) : Hessian(energy.getHessian());
+				hessian.noalias() += data.da(p) * (B.transpose() * (d2 * B));
+			}
+		}
+	}
+
+	/// @brief Element gradient of \f$\int W(\nabla u)\f$, differentiating the density only w.r.t. the displacement gradient
+	/// @param size dimension of the problem
+	/// @param data element data
+	/// @param density functor (p, disp_grad) returning the energy density at quadrature point p, templated on the scalar type
+	template <typename Density>
+	Eigen::VectorXd gradient_from_disp_grad_energy(const int size, const assembler::NonLinearAssemblerData &data, const Density &density)
+	{
+		Eigen::VectorXd gradient;
+		Eigen::MatrixXd unused;
+		if (size == 2)
+			disp_grad_energy_derivatives<2, false>(data, density, false, gradient, unused);
+		else
+		{
+			assert(size == 3);
+			disp_grad_energy_derivatives<3, false>(data, density, false, gradient, unused);
+		}
+		return gradient;
+	}
+
+	/// @brief Element hessian of \f$\int W(\nabla u)\f$, differentiating the density only w.r.t. the displacement gradient
+	/// @param size dimension of the problem
+	/// @param data element data
+	/// @param density functor (p, disp_grad) returning the energy density at quadrature point p, templated on the scalar type
+	/// @param project_to_psd if true, the hessian of the density is projected to PSD at every quadrature point before the contraction
+	template <typename Density>
+	Eigen::MatrixXd hessian_from_disp_grad_energy(const int size, const assembler::NonLinearAssemblerData &data, const Density &density, const bool project_to_psd = false)
+	{
+		Eigen::VectorXd unused;
+		Eigen::MatrixXd hessian;
+		if (size == 2)
+			disp_grad_energy_derivatives<2, true>(data, density, project_to_psd, unused, hessian);
+		else
+		{
+			assert(size == 3);
+			disp_grad_energy_derivatives<3, true>(data, density, project_to_psd, unused, hessian);
+		}
+		return hessian;
+	}
+
+	/// @brief Hessian w.r.t. F of an isotropic energy Ψ(σ(F)), from its derivatives w.r.t. the singular values of F = U diag(σ) Vᵀ
+	/// @param U left singular vectors
+	/// @param V right singular vectors
+	/// @param sigmas singular values σ
+	/// @param dE_div_dsigma ∂Ψ/∂σ
+	/// @param d2E_div_dsigma2 ∂²Ψ/∂σ²
+	/// @param left_coef (∂Ψ/∂σᵢ - ∂Ψ/∂σⱼ) / 2(σᵢ - σⱼ) for the pairs (0, 1), (1, 2), (2, 0), given in closed form to avoid the division
+	/// @param project_to_psd if true, clamps the eigenvalues of the 2x2 twist/flip blocks and projects ∂²Ψ/∂σ², so the result is the PSD projection of the hessian
+	/// @return ∂²Ψ/∂F², entry (i + j * dim, r + s * dim)
+	template <int dim>
+	Eigen::Matrix<double, dim * dim, dim * dim> isotropic_hessian_from_singular_values(
+		const Eigen::Matrix<double, dim, dim> &U,
+		const Eigen::Matrix<double, dim, dim> &V,
+		const Eigen::Matrix<double, dim, 1> &sigmas,
+		const Eigen::Matrix<double, dim, 1> &dE_div_dsigma,
+		const Eigen::Matrix<double, dim, dim> &d2E_div_dsigma2,
+		const Eigen::Matrix<double, dim * (dim - 1) / 2, 1> &left_coef,
+		const bool project_to_psd)
+	{
+		constexpr int Cdim2 = dim * (dim - 1) / 2;
+		Eigen::Matrix2d B[Cdim2];
+		for (int cI = 0; cI < Cdim2; cI++)
+		{
+			B[cI].setZero();
+			int cI_post = (cI + 1) % dim;
+
+			double rightCoef = dE_div_dsigma[cI] + dE_div_dsigma[cI_post];
+			double sum_sigma = sigmas[cI] + sigmas[cI_post];
+			rightCoef /= 2.0 * std::max(sum_sigma, 1.0e-12);
+
+			double leftCoef = left_coef[cI];
+			// the eigenvalues of the block are 2 leftCoef and 2 rightCoef
+			if (project_to_psd)
+			{
+				leftCoef = std::max(leftCoef, 0.0);
+				rightCoef = std::max(rightCoef, 0.0);
+			}
+			B[cI](0, 0) = B[cI](1, 1) = leftCoef + rightCoef;
+			B[cI](0, 1) = B[cI](1, 0) = leftCoef - rightCoef;
+		}
+
+		const Eigen::Matrix<double, dim, dim> A = project_to_psd ? Eigen::Matrix<double, dim, dim>(ipc::project_to_psd(d2E_div_dsigma2)) : d2E_div_dsigma2;
+
+		// compute M using A and B
+		Eigen::Matrix<double, dim * dim, dim * dim> M;
+		M.setZero();
+		if constexpr (dim == 2)
+		{
+			M(0, 0) = A(0, 0);
+			M(0, 3) = A(0, 1);
+			M.block(1, 1, 2, 2) = B[0];
+			M(3, 0) = A(1, 0);
+			M(3, 3) = A(1, 1);
+		}
+		else
+		{
+			// A
+			M(0, 0) = A(0, 0);
+			M(0, 4) = A(0, 1);
+			M(0, 8) = A(0, 2);
+			M(4, 0) = A(1, 0);
+			M(4, 4) = A(1, 1);
+			M(4, 8) = A(1, 2);
+			M(8, 0) = A(2, 0);
+			M(8, 4) = A(2, 1);
+			M(8, 8) = A(2, 2);
+			// B01
+			M(1, 1) = B[0](0, 0);
+			M(1, 3) = B[0](0, 1);
+			M(3, 1) = B[0](1, 0);
+			M(3, 3) = B[0](1, 1);
+			// B12
+			M(5, 5) = B[1](0, 0);
+			M(5, 7) = B[1](0, 1);
+			M(7, 5) = B[1](1, 0);
+			M(7, 7) = B[1](1, 1);
+			// B20
+			M(2, 2) = B[2](1, 1);
+			M(2, 6) = B[2](1, 0);
+			M(6, 2) = B[2](0, 1);
+			M(6, 6) = B[2](0, 0);
+		}
+
+		// compute hessian
+		Eigen::Matrix<double, dim * dim, dim * dim> hessian;
+		hessian.setZero();
+		for (int i = 0; i < dim; i++)
+		{
+			for (int j = 0; j < dim; j++)
+			{
+				int ij = i + j * dim;
+				for (int r = 0; r < dim; r++)
+				{
+					for (int s = 0; s < dim; s++)
+					{
+						int rs = r + s * dim;
+						if (ij > rs)
+						{
+							// bottom left, same as upper right
+							continue;
+						}
+
+						if constexpr (dim == 2)
+						{
+							hessian(ij, rs) = M(0, 0) * U(i, 0) * V(j, 0) * U(r, 0) * V(s, 0) + M(0, 3) * U(i, 0) * V(j, 0) * U(r, 1) * V(s, 1) + M(1, 1) * U(i, 0) * V(j, 1) * U(r, 0) * V(s, 1) + M(1, 2) * U(i, 0) * V(j, 1) * U(r, 1) * V(s, 0) + M(2, 1) * U(i, 1) * V(j, 0) * U(r, 0) * V(s, 1) + M(2, 2) * U(i, 1) * V(j, 0) * U(r, 1) * V(s, 0) + M(3, 0) * U(i, 1) * V(j, 1) * U(r, 0) * V(s, 0) + M(3, 3) * U(i, 1) * V(j, 1) * U(r, 1) * V(s, 1);
+						}
+						else
+						{
+							hessian(ij, rs) = M(0, 0) * U(i, 0) * V(j, 0) * U(r, 0) * V(s, 0) + M(0, 4) * U(i, 0) * V(j, 0) * U(r, 1) * V(s, 1) + M(0, 8) * U(i, 0) * V(j, 0) * U(r, 2) * V(s, 2) + M(4, 0) * U(i, 1) * V(j, 1) * U(r, 0) * V(s, 0) + M(4, 4) * U(i, 1) * V(j, 1) * U(r, 1) * V(s, 1) + M(4, 8) * U(i, 1) * V(j, 1) * U(r, 2) * V(s, 2) + M(8, 0) * U(i, 2) * V(j, 2) * U(r, 0) * V(s, 0) + M(8, 4) * U(i, 2) * V(j, 2) * U(r, 1) * V(s, 1) + M(8, 8) * U(i, 2) * V(j, 2) * U(r, 2) * V(s, 2) + M(1, 1) * U(i, 0) * V(j, 1) * U(r, 0) * V(s, 1) + M(1, 3) * U(i, 0) * V(j, 1) * U(r, 1) * V(s, 0) + M(3, 1) * U(i, 1) * V(j, 0) * U(r, 0) * V(s, 1) + M(3, 3) * U(i, 1) * V(j, 0) * U(r, 1) * V(s, 0) + M(5, 5) * U(i, 1) * V(j, 2) * U(r, 1) * V(s, 2) + M(5, 7) * U(i, 1) * V(j, 2) * U(r, 2) * V(s, 1) + M(7, 5) * U(i, 2) * V(j, 1) * U(r, 1) * V(s, 2) + M(7, 7) * U(i, 2) * V(j, 1) * U(r, 2) * V(s, 1) + M(2, 2) * U(i, 0) * V(j, 2) * U(r, 0) * V(s, 2) + M(2, 6) * U(i, 0) * V(j, 2) * U(r, 2) * V(s, 0) + M(6, 2) * U(i, 2) * V(j, 0) * U(r, 0) * V(s, 2) + M(6, 6) * U(i, 2) * V(j, 0) * U(r, 2) * V(s, 0);
+						}
+
+						if (ij < rs)
+							hessian(rs, ij) = hessian(ij, rs);
+					}
+				}
+			}
+		}
+
+		return hessian;
+	}
+
 	// https://en.wikipedia.org/wiki/Invariants_of_tensors
 	template <typename AutoDiffGradMat>
 	typename AutoDiffGradMat::Scalar first_invariant(const AutoDiffGradMat &B)
@@ -9,6 +9,7 @@
 
 #include <tinyexpr.h>
 #include <filesystem>
+#include <regex>
 
 #include <iostream>
 
@@ -75,6 +76,18 @@ namespace polyfem
 			value_ = 0;
 		}
 
+		bool ExpressionValue::is_time_dependent() const
+		{
+			if (!t_index_.empty() || sfunc_ || tfunc_)
+				return true;
+
+			for (const auto &e : mat_expr_)
+				if (e.is_time_dependent())
+					return true;
+
+			return !expr_.empty() && std::regex_search(expr_, std::regex("\\bt\\b"));
+		}
+
 		void ExpressionValue::init(const double val)
 		{
 			clear();
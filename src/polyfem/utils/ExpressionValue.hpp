@@ -38,6 +38,9 @@ namespace polyfem
 
 			void clear();
 
+			/// true if the value can change with t: expressions using t, values per time step, and functions
+			bool is_time_dependent() const;
+
 			bool is_zero() const { return expr_.empty() && fabs(value_) < 1e-10; }
 			bool is_mat() const
 			{
@@ -1,26 +1,51 @@
 #include "LazyCubicInterpolator.hpp"
-#include <mutex>
+
+#include <polyfem/utils/Logger.hpp>
+#include <polyfem/utils/MaybeParallelFor.hpp>
+#include <polyfem/utils/RadixSort.hpp>
+
+#include <cmath>
 
 namespace polyfem
 {
-	void LazyCubicInterpolator::bicubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<std::string> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
+	namespace
+	{
+		/// Sorts and deduplicates keys, then computes the values of the keys missing from map in parallel
+		template <typename T>
+		void fill_missing(std::vector<uint64_t> &keys, GridHashMap<T> &map, const std::function<void(const uint64_t, T &)> &compute)
+		{
+			utils::radix_sort(keys);
+			keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+			std::vector<uint64_t> missing;
+			for (const uint64_t key : keys)
+				if (!map.contains(key))
+					missing.push_back(key);
+
+			std::vector<T> values(missing.size());
+			utils::maybe_parallel_for(missing.size(), [&](int start, int end, int thread_id) {
+				for (int i = start; i < end; ++i)
+					compute(missing[i], values[i]);
+			});
+
+			for (size_t i = 0; i < missing.size(); ++i)
+				map.insert(missing[i], values[i]);
+		}
+	} // namespace
+
+	void LazyCubicInterpolator::bicubic_interpolation(const Eigen::MatrixXd &corner_point, const std::array<uint64_t, 8> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
 	{
 		Eigen::MatrixXd corner_val(4, 1);
 		Eigen::MatrixXd corner_grad(4, 2);
 		Eigen::MatrixXd corner_grad_grad(4, 1);
 		for (int i = 0; i < 4; ++i)
 		{
-			{
-				std::shared_lock distance_lock(distance_mutex_);
-				corner_val(i) = implicit_function_distance.at(keys[i]);
-			}
-			{
-				std::shared_lock grad_lock(grad_mutex_);
-				auto mixed_grads = implicit_function_grads.at(keys[i]);
-				corner_grad(i, 0) = mixed_grads(0);
-				corner_grad(i, 1) = mixed_grads(1);
-				corner_grad_grad(i, 0) = mixed_grads(2);
-			}
+			CornerGrads mixed_grads;
+			if (!implicit_function_distance.find(keys[i], corner_val(i)) || !implicit_function_grads.find(keys[i], mixed_grads))
+				log_and_throw_error("Interpolation grid is not cached at the evaluation point!");
+			corner_grad(i, 0) = mixed_grads[0];
+			corner_grad(i, 1) = mixed_grads[1];
+			corner_grad_grad(i, 0) = mixed_grads[2];
 		}
 
 		Eigen::MatrixXd x(16, 1);
@@ -50,7 +75,7 @@ namespace polyfem
 		assert(!std::isnan(grad(0)) && !std::isnan(grad(1)));
 	}
 
-	void LazyCubicInterpolator::tricubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<std::string> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
+	void LazyCubicInterpolator::tricubic_interpolation(const Eigen::MatrixXd &corner_point, const std::array<uint64_t, 8> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
 	{
 		Eigen::MatrixXd corner_val(8, 1);
 		Eigen::MatrixXd corner_grad(8, 3);
@@ -58,21 +83,16 @@ namespace polyfem
 		Eigen::MatrixXd corner_grad_grad_grad(8, 1);
 		for (int i = 0; i < 8; ++i)
 		{
-			{
-				std::shared_lock distance_lock(distance_mutex_);
-				corner_val(i) = implicit_function_distance.at(keys[i]);
-			}
-			{
-				std::shared_lock grad_lock(grad_mutex_);
-				auto mixed_grads = implicit_function_grads.at(keys[i]);
-				corner_grad(i, 0) = mixed_grads(0);
-				corner_grad(i, 1) = mixed_grads(1);
-				corner_grad(i, 2) = mixed_grads(2);
-				corner_grad_grad(i, 0) = mixed_grads(3);
-				corner_grad_grad(i, 1) = mixed_grads(4);
-				corner_grad_grad(i, 2) = mixed_grads(5);
-				corner_grad_grad_grad(i, 0) = mixed_grads(6);
-			}
+			CornerGrads mixed_grads;
+			if (!implicit_function_distance.find(keys[i], corner_val(i)) || !implicit_function_grads.find(keys[i], mixed_grads))
+				log_and_throw_error("Interpolation grid is not cached at the evaluation point!");
+			corner_grad(i, 0) = mixed_grads[0];
+			corner_grad(i, 1) = mixed_grads[1];
+			corner_grad(i, 2) = mixed_grads[2];
+			corner_grad_grad(i, 0) = mixed_grads[3];
+			corner_grad_grad(i, 1) = mixed_grads[4];
+			corner_grad_grad(i, 2) = mixed_grads[5];
+			corner_grad_grad_grad(i, 0) = mixed_grads[6];
 		}
 		Eigen::MatrixXd x(64, 1);
 		x << corner_val(0), corner_val(1), corner_val(2), corner_val(3), corner_val(4), corner_val(5), corner_val(6), corner_val(7),
@@ -109,134 +129,185 @@ namespace polyfem
 		assert(!std::isnan(grad(0)) && !std::isnan(grad(1)) && !std::isnan(grad(2)));
 	}
 
-	void LazyCubicInterpolator::cache_grid(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &point)
+	std::array<int, 3> LazyCubicInterpolator::point_bin(const Eigen::MatrixXd &point) const
 	{
-		Eigen::MatrixXi keys;
-		build_corner_keys(point, keys);
-		std::vector<std::string> keys_string;
-
-		auto safe_compute_distance = [this, compute_distance](const Eigen::MatrixXd &clamped_point, const std::string &key_string) {
-			std::unique_lock lock(distance_mutex_);
-			if (implicit_function_distance.count(key_string) == 0)
-				compute_distance(clamped_point, implicit_function_distance[key_string]);
-		};
-		auto safe_distance = [this, safe_compute_distance](const Eigen::VectorXi &key) {
-			Eigen::MatrixXd point;
-			std::string key_string;
-			double distance;
-			setup_key(key, key_string, point);
-			safe_compute_distance(point, key_string);
+		std::array<int, 3> bin = {{0, 0, 0}};
+		for (int k = 0; k < dim_; ++k)
+			bin[k] = (int)std::floor(point(k) / delta_);
+		return bin;
+	}
+
+	uint64_t LazyCubicInterpolator::pack_key(const std::array<int, 3> &coords) const
+	{
+		const int bits = key_bits();
+		const int64_t offset = int64_t(1) << (bits - 1);
+
+		std::array<uint64_t, 3> shifted = {{0, 0, 0}};
+		for (int k = 0; k < dim_; ++k)
+		{
+			const int64_t c = coords[k] + offset;
+			if (c < 0 || c >= 2 * offset)
+				log_and_throw_error("Point is outside of the range of the interpolation grid, increase delta!");
+			shifted[k] = c;
+		}
+
+		uint64_t key = 0;
+		for (int b = bits - 1; b >= 0; --b)
+			for (int k = 0; k < dim_; ++k)
+				key = (key << 1) | ((shifted[k] >> b) & 1);
+		return key;
+	}
+
+	std::array<int, 3> LazyCubicInterpolator::unpack_key(uint64_t key) const
+	{
+		const int bits = key_bits();
+		const int64_t offset = int64_t(1) << (bits - 1);
+
+		std::array<int64_t, 3> shifted = {{0, 0, 0}};
+		for (int b = 0; b < bits; ++b)
+			for (int k = dim_ - 1; k >= 0; --k)
+			{
+				shifted[k] |= int64_t(key & 1) << b;
+				key >>= 1;
+			}
+
+		std::array<int, 3> coords = {{0, 0, 0}};
+		for (int k = 0; k < dim_; ++k)
+			coords[k] = int(shifted[k] - offset);
+		return coords;
+	}
+
+	void LazyCubicInterpolator::build_corner_keys(const Eigen::MatrixXd &point, std::array<uint64_t, 8> &keys, Eigen::MatrixXd &corner_point) const
+	{
+		const std::array<int, 3> bin = point_bin(point);
+		const int num_corner_points = 1 << dim_;
+
+		corner_point.resize(num_corner_points, dim_);
+		for (int i = 0; i < num_corner_points; ++i)
+		{
+			std::array<int, 3> corner = bin;
+			for (int k = 0; k < dim_; ++k)
 			{
-				std::shared_lock lock(distance_mutex_);
-				distance = implicit_function_distance[key_string];
+				corner[k] += (i >> k) & 1;
+				corner_point(i, k) = (double)corner[k] * delta_;
 			}
-			return distance;
+			keys[i] = pack_key(corner);
+		}
+	}
+
+	LazyCubicInterpolator::CornerGrads LazyCubicInterpolator::compute_grads(const std::array<int, 3> &coords) const
+	{
+		auto distance = [this](const std::array<int, 3> &key) {
+			double d = 0;
+			[[maybe_unused]] const bool found = implicit_function_distance.find(pack_key(key), d);
+			assert(found); // filled by cache_grid before the derivatives
+			return d;
 		};
-		auto centered_fd = [this, safe_distance](const Eigen::VectorXi &key, const int k) {
-			Eigen::MatrixXi key_plus, key_minus;
-			double distance_plus, distance_minus;
-			key_plus = key;
-			key_plus(k) += 1;
-			distance_plus = safe_distance(key_plus);
-			key_minus = key;
-			key_minus(k) -= 1;
-			distance_minus = safe_distance(key_minus);
-			return (1. / 2. / delta_) * (distance_plus - distance_minus);
+		auto shifted = [](std::array<int, 3> key, const int k, const int s) {
+			key[k] += s;
+			return key;
 		};
-		auto centered_mixed_fd = [this, centered_fd](const Eigen::VectorXi &key, const int k1, const int k2) {
-			Eigen::VectorXi key_plus, key_minus;
-			key_plus = key;
-			key_plus(k1) += 1;
-			key_minus = key;
-			key_minus(k1) -= 1;
-			return (1. / 2. / delta_) * (centered_fd(key_plus, k2) - centered_fd(key_minus, k2));
+		auto centered_fd = [&](const std::array<int, 3> &key, const int k) {
+			return (1. / 2. / delta_) * (distance(shifted(key, k, 1)) - distance(shifted(key, k, -1)));
 		};
-		auto centered_mixed_fd_3d = [this, centered_mixed_fd](const Eigen::VectorXi &key) {
-			Eigen::VectorXi key_plus, key_minus;
-			key_plus = key;
-			key_plus(0) += 1;
-			key_minus = key;
-			key_minus(0) -= 1;
-			return (1. / 2. / delta_) * (centered_mixed_fd(key_plus, 1, 2) - centered_mixed_fd(key_minus, 1, 2));
+		auto centered_mixed_fd = [&](const std::array<int, 3> &key, const int k1, const int k2) {
+			return (1. / 2. / delta_) * (centered_fd(shifted(key, k1, 1), k2) - centered_fd(shifted(key, k1, -1), k2));
 		};
-		auto compute_grad = [this, centered_fd, centered_mixed_fd, centered_mixed_fd_3d](const Eigen::VectorXi &key) {
-			Eigen::VectorXd mixed_grads(dim_ == 2 ? 3 : 7);
-			if (dim_ == 2)
-			{
-				mixed_grads(0) = centered_fd(key, 0);
-				mixed_grads(1) = centered_fd(key, 1);
-				mixed_grads(2) = centered_mixed_fd(key, 0, 1);
-			}
-			else if (dim_ == 3)
+
+		CornerGrads mixed_grads;
+		mixed_grads.fill(0);
+		if (dim_ == 2)
+		{
+			mixed_grads[0] = centered_fd(coords, 0);
+			mixed_grads[1] = centered_fd(coords, 1);
+			mixed_grads[2] = centered_mixed_fd(coords, 0, 1);
+		}
+		else if (dim_ == 3)
+		{
+			mixed_grads[0] = centered_fd(coords, 0);
+			mixed_grads[1] = centered_fd(coords, 1);
+			mixed_grads[2] = centered_fd(coords, 2);
+			mixed_grads[3] = centered_mixed_fd(coords, 0, 1);
+			mixed_grads[4] = centered_mixed_fd(coords, 0, 2);
+			mixed_grads[5] = centered_mixed_fd(coords, 1, 2);
+			mixed_grads[6] = (1. / 2. / delta_) * (centered_mixed_fd(shifted(coords, 0, 1), 1, 2) - centered_mixed_fd(shifted(coords, 0, -1), 1, 2));
+		}
+		return mixed_grads;
+	}
+
+	void LazyCubicInterpolator::cache_grid(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &points)
+	{
+		const int n_points = points.rows();
+		const int n_corners = 1 << dim_;
+		// the finite differences on the cell corners (offsets 0 and 1) use the distances at offsets -1 to 2
+		const int n_stencil = 1 << (2 * dim_);
+
+		// pack_key must not throw in the parallel loop, the range of the stencils is checked here
+		if (n_points > 0)
+		{
+			const double offset = double(int64_t(1) << (key_bits() - 1));
+			if (!points.leftCols(dim_).allFinite())
+				log_and_throw_error("Non-finite point in the interpolation grid!");
+			for (int k = 0; k < dim_; ++k)
 			{
-				mixed_grads(0) = centered_fd(key, 0);
-				mixed_grads(1) = centered_fd(key, 1);
-				mixed_grads(2) = centered_fd(key, 2);
-				mixed_grads(3) = centered_mixed_fd(key, 0, 1);
-				mixed_grads(4) = centered_mixed_fd(key, 0, 2);
-				mixed_grads(5) = centered_mixed_fd(key, 1, 2);
-				mixed_grads(6) = centered_mixed_fd_3d(key);
+				const double lowest = std::floor(points.col(k).minCoeff() / delta_) - 1;
+				const double highest = std::floor(points.col(k).maxCoeff() / delta_) + 2;
+				if (lowest < -offset || highest >= offset)
+					log_and_throw_error("Point is outside of the range of the interpolation grid, increase delta!");
 			}
-			return mixed_grads;
-		};
-		auto safe_compute_grad = [this, compute_grad](const Eigen::VectorXi &key) {
-			std::string key_string;
-			Eigen::MatrixXd point;
-			setup_key(key, key_string, point);
+		}
+
+		std::vector<uint64_t> corner_keys(size_t(n_points) * n_corners);
+		std::vector<uint64_t> stencil_keys(size_t(n_points) * n_stencil);
+		utils::maybe_parallel_for(n_points, [&](int start, int end, int thread_id) {
+			for (int p = start; p < end; ++p)
 			{
-				std::unique_lock lock(grad_mutex_);
-				if (implicit_function_grads.count(key_string) == 0)
+				const std::array<int, 3> bin = point_bin(points.row(p));
+				for (int i = 0; i < n_corners; ++i)
 				{
-					Eigen::MatrixXd grad = compute_grad(key);
-					implicit_function_grads[key_string] = grad;
+					std::array<int, 3> corner = bin;
+					for (int k = 0; k < dim_; ++k)
+						corner[k] += (i >> k) & 1;
+					corner_keys[size_t(p) * n_corners + i] = pack_key(corner);
+				}
+				for (int i = 0; i < n_stencil; ++i)
+				{
+					std::array<int, 3> corner = bin;
+					for (int k = 0; k < dim_; ++k)
+						corner[k] += ((i >> (2 * k)) & 3) - 1;
+					stencil_keys[size_t(p) * n_stencil + i] = pack_key(corner);
 				}
 			}
-		};
-		Eigen::MatrixXd corner_point(keys.rows(), dim_);
-		for (int i = 0; i < keys.rows(); ++i)
-		{
-			std::string key_string;
-			Eigen::MatrixXd clamped_point;
-			setup_key(keys.row(i), key_string, clamped_point);
-			safe_compute_distance(clamped_point, key_string);
-			keys_string.push_back(key_string);
-			corner_point.row(i) = clamped_point.transpose();
-			safe_compute_grad(keys.row(i));
-		}
+		});
+
+		fill_missing<double>(stencil_keys, implicit_function_distance, [&](const uint64_t key, double &distance) {
+			const std::array<int, 3> coords = unpack_key(key);
+			Eigen::MatrixXd clamped_point(dim_, 1);
+			for (int k = 0; k < dim_; ++k)
+				clamped_point(k) = (double)coords[k] * delta_;
+			compute_distance(clamped_point, distance);
+		});
+
+		fill_missing<CornerGrads>(corner_keys, implicit_function_grads, [&](const uint64_t key, CornerGrads &grads) {
+			grads = compute_grads(unpack_key(key));
+		});
 	}
 
 	void LazyCubicInterpolator::evaluate(const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const
 	{
-		Eigen::MatrixXi keys;
-		build_corner_keys(point, keys);
-
-		std::vector<std::string> keys_string;
-		Eigen::MatrixXd corner_point(keys.rows(), dim_);
-		for (int i = 0; i < keys.rows(); ++i)
-		{
-			std::string key_string;
-			Eigen::MatrixXd clamped_point;
-			setup_key(keys.row(i), key_string, clamped_point);
-			keys_string.push_back(key_string);
-			corner_point.row(i) = clamped_point.transpose();
-		}
+		std::array<uint64_t, 8> keys;
+		Eigen::MatrixXd corner_point;
+		build_corner_keys(point, keys, corner_point);
 
 		grad.setZero(dim_, 1);
 		if (dim_ == 2)
-			bicubic_interpolation(corner_point, keys_string, point, val, grad);
+			bicubic_interpolation(corner_point, keys, point, val, grad);
 		else if (dim_ == 3)
-			tricubic_interpolation(corner_point, keys_string, point, val, grad);
+			tricubic_interpolation(corner_point, keys, point, val, grad);
 
 		for (int i = 0; i < dim_; ++i)
 			if (std::isnan(grad(i)))
 				throw std::runtime_error("Nan found in gradient computation.");
 	}
 
-	void LazyCubicInterpolator::lazy_evaluate(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad)
-	{
-		cache_grid(compute_distance, point);
-
-		evaluate(point, val, grad);
-	}
-
 } // namespace polyfem
\ No newline at end of file
@@ -7,8 +7,120 @@
 #include <nanospline/BSpline.h>
 #include <nanospline/BSplinePatch.h>
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <vector>
+
 namespace polyfem
 {
+	/// @brief Hash map from packed grid keys to values, safe for concurrent lookups and insertions.
+	/// Open addressing with linear probing, striped over independently locked shards.
+	template <typename T>
+	class GridHashMap
+	{
+	public:
+		/// @brief Key marking an empty slot, never a valid key
+		static constexpr uint64_t EMPTY_KEY = std::numeric_limits<uint64_t>::max();
+
+		/// @brief Finds the value of a key
+		/// @return false if the key is not in the map
+		bool find(const uint64_t key, T &value) const
+		{
+			const uint64_t h = hash(key);
+			const Shard &shard = shards_[h >> (64 - SHARD_BITS)];
+			std::shared_lock lock(shard.mutex);
+			const int64_t slot = find_slot(shard, key, h);
+			if (slot < 0 || shard.keys[slot] != key)
+				return false;
+			value = shard.values[slot];
+			return true;
+		}
+
+		bool contains(const uint64_t key) const
+		{
+			const uint64_t h = hash(key);
+			const Shard &shard = shards_[h >> (64 - SHARD_BITS)];
+			std::shared_lock lock(shard.mutex);
+			const int64_t slot = find_slot(shard, key, h);
+			return slot >= 0 && shard.keys[slot] == key;
+		}
+
+		/// @brief Inserts a value, keeps the existing one if the key is already present
+		void insert(const uint64_t key, const T &value)
+		{
+			assert(key != EMPTY_KEY);
+			const uint64_t h = hash(key);
+			Shard &shard = shards_[h >> (64 - SHARD_BITS)];
+			std::unique_lock lock(shard.mutex);
+			if (2 * (shard.size + 1) > shard.keys.size())
+				grow(shard);
+
+			const int64_t slot = find_slot(shard, key, h);
+			if (shard.keys[slot] == key)
+				return;
+			shard.keys[slot] = key;
+			shard.values[slot] = value;
+			++shard.size;
+		}
+
+	private:
+		static constexpr int SHARD_BITS = 6;
+
+		struct Shard
+		{
+			mutable std::shared_mutex mutex;
+			std::vector<uint64_t> keys; // power of two size, EMPTY_KEY for free slots
+			std::vector<T> values;
+			size_t size = 0;
+		};
+
+		static uint64_t hash(uint64_t x)
+		{
+			// splitmix64 finalizer
+			x ^= x >> 30;
+			x *= 0xbf58476d1ce4e5b9ULL;
+			x ^= x >> 27;
+			x *= 0x94d049bb133111ebULL;
+			x ^= x >> 31;
+			return x;
+		}
+
+		/// slot holding key, or the empty slot where it would be inserted, -1 if the shard is empty
+		static int64_t find_slot(const Shard &shard, const uint64_t key, const uint64_t h)
+		{
+			if (shard.keys.empty())
+				return -1;
+			const size_t mask = shard.keys.size() - 1;
+			size_t i = h & mask;
+			while (shard.keys[i] != key && shard.keys[i] != EMPTY_KEY)
+				i = (i + 1) & mask;
+			return i;
+		}
+
+		static void grow(Shard &shard)
+		{
+			std::vector<uint64_t> old_keys(std::max<size_t>(16, 2 * shard.keys.size()), EMPTY_KEY);
+			std::vector<T> old_values(old_keys.size());
+			std::swap(old_keys, shard.keys);
+			std::swap(old_values, shard.values);
+
+			for (size_t i = 0; i < old_keys.size(); ++i)
+			{
+				if (old_keys[i] == EMPTY_KEY)
+					continue;
+				const int64_t slot = find_slot(shard, old_keys[i], hash(old_keys[i]));
+				shard.keys[slot] = old_keys[i];
+				shard.values[slot] = old_values[i];
+			}
+		}
+
+		std::array<Shard, 1 << SHARD_BITS> shards_;
+	};
 
 	class LazyCubicInterpolator
 	{
@@ -105,60 +217,36 @@ namespace polyfem
 			}
 		}
 
-		void bicubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<std::string> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const;
-		void tricubic_interpolation(const Eigen::MatrixXd &corner_point, const std::vector<std::string> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const;
-		void lazy_evaluate(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad);
-		void cache_grid(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &point);
+		void bicubic_interpolation(const Eigen::MatrixXd &corner_point, const std::array<uint64_t, 8> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const;
+		void tricubic_interpolation(const Eigen::MatrixXd &corner_point, const std::array<uint64_t, 8> &keys, const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const;
+		/// @brief Caches the distances and their derivatives on the grid corners around all points.
+		/// The missing values are computed in parallel, so compute_distance must be thread safe.
+		/// @param[in] compute_distance distance to the target, evaluated at a dim x 1 grid point
+		/// @param[in] points one point per row, throws if a point is outside of the range of the grid keys
+		void cache_grid(std::function<void(const Eigen::MatrixXd &, double &)> compute_distance, const Eigen::MatrixXd &points);
+		/// @brief Interpolates the cached grid at a point, safe to call concurrently
 		void evaluate(const Eigen::MatrixXd &point, double &val, Eigen::MatrixXd &grad) const;
 
 	private:
-		inline void build_corner_keys(const Eigen::MatrixXd &point, Eigen::MatrixXi &keys) const
-		{
-			int num_corner_points = dim_ == 2 ? 4 : 8;
-			Eigen::MatrixXi bin(dim_, 1);
-			keys.resize(num_corner_points, dim_);
-			std::vector<std::string> keys_string;
-			for (int k = 0; k < dim_; ++k)
-				bin(k) = (int)std::floor(point(k) / delta_);
-			if (dim_ == 2)
-			{
-				keys << bin(0), bin(1),
-					bin(0) + 1, bin(1),
-					bin(0), bin(1) + 1,
-					bin(0) + 1, bin(1) + 1;
-			}
-			else if (dim_ == 3)
-			{
-				keys << bin(0), bin(1), bin(2),
-					bin(0) + 1, bin(1), bin(2),
-					bin(0), bin(1) + 1, bin(2),
-					bin(0) + 1, bin(1) + 1, bin(2),
-					bin(0), bin(1), bin(2) + 1,
-					bin(0) + 1, bin(1), bin(2) + 1,
-					bin(0), bin(1) + 1, bin(2) + 1,
-					bin(0) + 1, bin(1) + 1, bin(2) + 1;
-			}
-		}
-		inline void setup_key(const Eigen::VectorXi &key, std::string &key_string, Eigen::MatrixXd &clamped_point) const
-		{
-			key_string = "";
-			clamped_point.setZero(dim_, 1);
-			for (int k = 0; k < dim_; ++k)
-			{
-				// key_string += fmt::format("{:d},", key(k));
-				key_string += std::to_string(key(k)) + ",";
-				clamped_point(k) = (double)key(k) * delta_;
-			}
-		};
+		/// finite-difference first and mixed derivatives of the distance at a grid corner (3 used in 2d, 7 in 3d)
+		using CornerGrads = std::array<double, 7>;
+
+		/// bits per coordinate in the grid keys
+		int key_bits() const { return dim_ == 2 ? 31 : 21; }
+		/// grid cell containing the point
+		std::array<int, 3> point_bin(const Eigen::MatrixXd &point) const;
+		/// Morton code of the grid coordinates, shifted to be non-negative
+		uint64_t pack_key(const std::array<int, 3> &coords) const;
+		std::array<int, 3> unpack_key(const uint64_t key) const;
+		/// keys of the corners of the cell containing point, x varying fastest
+		void build_corner_keys(const Eigen::MatrixXd &point, std::array<uint64_t, 8> &keys, Eigen::MatrixXd &corner_point) const;
+		CornerGrads compute_grads(const std::array<int, 3> &coords) const;
 
 		int dim_;
 		double delta_;
-		std::unordered_map<std::string, double> implicit_function_distance;
-		std::unordered_map<std::string, Eigen::VectorXd> implicit_function_grads;
+		GridHashMap<double> implicit_function_distance;
+		GridHashMap<CornerGrads> implicit_function_grads;
 
 		Eigen::MatrixXd cubic_mat;
-
-		mutable std::shared_mutex distance_mutex_;
-		mutable std::shared_mutex grad_mutex_;
 	};
-} // namespace polyfem
\ No newline at end of file
+} // namespace polyfem
@@ -0,0 +1,114 @@
+#include "RadixSort.hpp"
+
+#include <polyfem/utils/MaybeParallelFor.hpp>
+
+#include <array>
+#include <cassert>
+
+namespace polyfem::utils
+{
+	namespace
+	{
+		constexpr size_t CHUNK_SIZE = 1 << 16;
+		constexpr int RADIX_BITS = 8;
+		constexpr int RADIX = 1 << RADIX_BITS;
+		constexpr int N_PASSES = 64 / RADIX_BITS;
+
+		template <bool WithValues>
+		void radix_sort_impl(std::vector<uint64_t> &keys, std::vector<uint32_t> *values)
+		{
+			const size_t n = keys.size();
+			if (n <= 1)
+				return;
+
+			const size_t n_chunks = (n + CHUNK_SIZE - 1) / CHUNK_SIZE;
+			const auto chunk_begin = [&](const size_t c) { return c * CHUNK_SIZE; };
+			const auto chunk_end = [&](const size_t c) { return std::min(n, (c + 1) * CHUNK_SIZE); };
+
+			// bits that differ between at least two keys
+			std::vector<uint64_t> chunk_and(n_chunks, ~uint64_t(0)), chunk_or(n_chunks, 0);
+			maybe_parallel_for(n_chunks, [&](int start, int end, int thread_id) {
+				for (int c = start; c < end; ++c)
+				{
+					for (size_t i = chunk_begin(c); i < chunk_end(c); ++i)
+					{
+						chunk_and[c] &= keys[i];
+						chunk_or[c] |= keys[i];
+					}
+				}
+			});
+			uint64_t all_and = ~uint64_t(0), all_or = 0;
+			for (size_t c = 0; c < n_chunks; ++c)
+			{
+				all_and &= chunk_and[c];
+				all_or |= chunk_or[c];
+			}
+			const uint64_t varying = all_and ^ all_or;
+
+			std::vector<uint64_t> tmp_keys(n);
+			std::vector<uint32_t> tmp_values;
+			if constexpr (WithValues)
+				tmp_values.resize(n);
+
+			std::vector<std::array<size_t, RADIX>> offsets(n_chunks);
+
+			for (int pass = 0; pass < N_PASSES; ++pass)
+			{
+				const int shift = pass * RADIX_BITS;
+				if (((varying >> shift) & (RADIX - 1)) == 0)
+					continue;
+
+				maybe_parallel_for(n_chunks, [&](int start, int end, int thread_id) {
+					for (int c = start; c < end; ++c)
+					{
+						offsets[c].fill(0);
+						for (size_t i = chunk_begin(c); i < chunk_end(c); ++i)
+							++offsets[c][(keys[i] >> shift) & (RADIX - 1)];
+					}
+				});
+
+				// exclusive prefix sum, digit-major then chunk-major to keep the sort stable
+				size_t sum = 0;
+				for (int d = 0; d < RADIX; ++d)
+				{
+					for (size_t c = 0; c < n_chunks; ++c)
+					{
+						const size_t count = offsets[c][d];
+						offsets[c][d] = sum;
+						sum += count;
+					}
+				}
+				assert(sum == n);
+
+				maybe_parallel_for(n_chunks, [&](int start, int end, int thread_id) {
+					for (int c = start; c < end; ++c)
+					{
+						auto &offset = offsets[c];
+						for (size_t i = chunk_begin(c); i < chunk_end(c); ++i)
+						{
+							const size_t dst = offset[(keys[i] >> shift) & (RADIX - 1)]++;
+							tmp_keys[dst] = keys[i];
+							if constexpr (WithValues)
+								tmp_values[dst] = (*values)[i];
+						}
+					}
+				});
+
+				keys.swap(tmp_keys);
+				if constexpr (WithValues)
+					values->swap(tmp_values);
+			}
+		}
+	} // namespace
+
+	void radix_sort(std::vector<uint64_t> &keys, std::vector<uint32_t> &values)
+	{
+		assert(keys.size() == values.size());
+		radix_sort_impl<true>(keys, &values);
+	}
+
+	void radix_sort(std::vector<uint64_t> &keys)
+	{
+		radix_sort_impl<false>(keys, nullptr);
+	}
+} // namespace polyfem::utils
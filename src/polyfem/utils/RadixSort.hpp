@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace polyfem::utils
+{
+	/// @brief Stable parallel LSD radix sort of 64-bit keys.
+	/// Keys are processed in fixed-size chunks, so the result does not depend on the number of threads.
+	/// Byte positions that are constant across all keys are skipped.
+	/// @param[in,out] keys keys to sort
+	/// @param[in,out] values payload permuted alongside the keys (must have the same size as keys)
+	void radix_sort(std::vector<uint64_t> &keys, std::vector<uint32_t> &values);
+
+	/// @brief Stable parallel LSD radix sort of 64-bit keys.
+	/// @param[in,out] keys keys to sort
+	void radix_sort(std::vector<uint64_t> &keys);
+} // namespace polyfem::utils
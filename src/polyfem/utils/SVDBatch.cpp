@@ -0,0 +1,257 @@
+#include "SVDBatch.hpp"
+
+#include <limits>
+
+namespace polyfem::utils
+{
+	namespace
+	{
+		/// cyclic Jacobi converges quadratically, 3x3 matrices need 4 to 5 sweeps in double precision
+		constexpr int MAX_JACOBI_SWEEPS = 10;
+
+		template <int dim>
+		void set_identity(const long n_pts, TensorBatch<dim> &A)
+		{
+			A = TensorBatch<dim>::Zero(n_pts, dim * dim);
+			for (int i = 0; i < dim; ++i)
+				A.col(i + i * dim).setOnes();
+		}
+
+		/// Swaps the columns i and j of the rotations V at the points where swap holds, negating one of them to keep det(V) = 1
+		template <int dim>
+		void swap_columns(const Eigen::Array<bool, Eigen::Dynamic, 1> &swap, const int i, const int j, TensorBatch<dim> &V)
+		{
+			for (int k = 0; k < dim; ++k)
+			{
+				const Eigen::ArrayXd vi = V.col(k + i * dim);
+				V.col(k + i * dim) = swap.select(V.col(k + j * dim), vi);
+				V.col(k + j * dim) = swap.select(-vi, V.col(k + j * dim));
+			}
+		}
+
+		/// Diagonalizes the symmetric S = V Λ Vᵀ in place by cyclic Jacobi rotations, then sorts Λ decreasingly
+		template <int dim>
+		void symmetric_eigen_batch(TensorBatch<dim> &S, TensorBatch<dim> &V)
+		{
+			const auto s = [&S](const int i, const int j) { return S.col(i + j * dim); };
+			const double tol = std::numeric_limits<double>::epsilon();
+
+			set_identity<dim>(S.rows(), V);
+
+			for (int sweep = 0; sweep < MAX_JACOBI_SWEEPS; ++sweep)
+			{
+				Eigen::ArrayXd off = Eigen::ArrayXd::Zero(S.rows());
+				Eigen::ArrayXd diag = Eigen::ArrayXd::Zero(S.rows());
+				for (int i = 0; i < dim; ++i)
+				{
+					diag += s(i, i).square();
+					for (int j = i + 1; j < dim; ++j)
+						off += s(i, j).square();
+				}
+				// the only test on the whole batch, it does not branch per point
+				if ((off <= tol * tol * diag).all())
+					break;
+
+				for (int p = 0; p < dim; ++p)
+				{
+					for (int q = p + 1; q < dim; ++q)
+					{
+						// rotation by t = tan(θ) that zeroes s(p, q), t = 0 where s(p, q) = s(q, q) - s(p, p) = 0
+						const Eigen::ArrayXd apq = s(p, q);
+						const Eigen::ArrayXd d = s(q, q) - s(p, p);
+						const Eigen::ArrayXd denom = d.abs() + (d.square() + 4 * apq.square()).sqrt();
+						const Eigen::ArrayXd t = 2 * (d >= 0).select(apq, -apq) / (denom > 0).select(denom, 1);
+						const Eigen::ArrayXd c = (1 + t.square()).rsqrt();
+						const Eigen::ArrayXd sn = t * c;
+
+						for (int r = 0; r < dim; ++r)
+						{
+							if (r == p || r == q)
+								continue;
+							const Eigen::ArrayXd srp = s(r, p);
+							const Eigen::ArrayXd srq = s(r, q);
+							s(r, p) = c * srp - sn * srq;
+							s(p, r) = s(r, p);
+							s(r, q) = sn * srp + c * srq;
+							s(q, r) = s(r, q);
+						}
+						s(p, p) -= t * apq;
+						s(q, q) += t * apq;
+						s(p, q).setZero();
+						s(q, p).setZero();
+
+						for (int k = 0; k < dim; ++k)
+						{
+							const Eigen::ArrayXd vkp = V.col(k + p * dim);
+							const Eigen::ArrayXd vkq = V.col(k + q * dim);
+							V.col(k + p * dim) = c * vkp - sn * vkq;
+							V.col(k + q * dim) = sn * vkp + c * vkq;
+						}
+					}
+				}
+			}
+
+			// sorting network on the eigenvalues
+			const auto sort_pair = [&](const int i, const int j) {
+				const Eigen::Array<bool, Eigen::Dynamic, 1> swap = s(i, i) < s(j, j);
+				const Eigen::ArrayXd li = s(i, i);
+				s(i, i) = swap.select(s(j, j), li);
+				s(j, j) = swap.select(li, s(j, j));
+				swap_columns<dim>(swap, i, j, V);
+			};
+			sort_pair(0, 1);
+			if constexpr (dim == 3)
+			{
+				sort_pair(1, 2);
+				sort_pair(0, 1);
+			}
+		}
+
+		/// One-sided Jacobi rotations of the columns of B = FV (and of V) until they are orthogonal to relative precision,
+		/// then sorts them by decreasing norm. The eigenvectors of FᵀF only separate the singular values down to
+		/// √ε σ₀, this recovers the smaller ones with relative accuracy.
+		template <int dim>
+		void orthogonalize_columns_batch(TensorBatch<dim> &B, TensorBatch<dim> &V)
+		{
+			const double tol = std::numeric_limits<double>::epsilon();
+			const auto column_dot = [&B](const int i, const int j) {
+				Eigen::ArrayXd out = B.col(i * dim) * B.col(j * dim);
+				for (int k = 1; k < dim; ++k)
+					out += B.col(k + i * dim) * B.col(k + j * dim);
+				return out;
+			};
+
+			for (int sweep = 0; sweep < MAX_JACOBI_SWEEPS; ++sweep)
+			{
+				bool converged = true;
+				for (int p = 0; p < dim; ++p)
+				{
+					for (int q = p + 1; q < dim; ++q)
+					{
+						const Eigen::ArrayXd app = column_dot(p, p);
+						const Eigen::ArrayXd aqq = column_dot(q, q);
+						const Eigen::ArrayXd apq = column_dot(p, q);
+
+						// the only test on the whole batch, it does not branch per point
+						if ((apq.square() <= tol * tol * app * aqq).all())
+							continue;
+						converged = false;
+
+						// same rotation as symmetric_eigen_batch, on the 2x2 block of BᵀB
+						const Eigen::ArrayXd d = aqq - app;
+						const Eigen::ArrayXd denom = d.abs() + (d.square() + 4 * apq.square()).sqrt();
+						const Eigen::ArrayXd t = 2 * (d >= 0).select(apq, -apq) / (denom > 0).select(denom, 1);
+						const Eigen::ArrayXd c = (1 + t.square()).rsqrt();
+						const Eigen::ArrayXd sn = t * c;
+
+						for (int k = 0; k < dim; ++k)
+						{
+							const Eigen::ArrayXd bkp = B.col(k + p * dim);
+							const Eigen::ArrayXd bkq = B.col(k + q * dim);
+							B.col(k + p * dim) = c * bkp - sn * bkq;
+							B.col(k + q * dim) = sn * bkp + c * bkq;
+
+							const Eigen::ArrayXd vkp = V.col(k + p * dim);
+							const Eigen::ArrayXd vkq = V.col(k + q * dim);
+							V.col(k + p * dim) = c * vkp - sn * vkq;
+							V.col(k + q * dim) = sn * vkp + c * vkq;
+						}
+					}
+				}
+				if (converged)
+					break;
+			}
+
+			// the rotations can reorder nearly repeated singular values, the same swaps keep B = FV
+			const auto sort_pair = [&](const int i, const int j) {
+				const Eigen::Array<bool, Eigen::Dynamic, 1> swap = column_dot(i, i) < column_dot(j, j);
+				swap_columns<dim>(swap, i, j, B);
+				swap_columns<dim>(swap, i, j, V);
+			};
+			sort_pair(0, 1);
+			if constexpr (dim == 3)
+			{
+				sort_pair(1, 2);
+				sort_pair(0, 1);
+			}
+		}
+	} // namespace
+
+	template <int dim>
+	void svd_batch(const TensorBatch<dim> &F, TensorBatch<dim> &U, SingularValueBatch<dim> &sigma, TensorBatch<dim> &V)
+	{
+		const long n_pts = F.rows();
+
+		// V from the eigenvectors of FᵀF
+		TensorBatch<dim> S = TensorBatch<dim>::Zero(n_pts, dim * dim);
+		for (int j = 0; j < dim; ++j)
+			for (int i = 0; i < dim; ++i)
+				for (int k = 0; k < dim; ++k)
+					S.col(i + j * dim) += F.col(k + i * dim) * F.col(k + j * dim);
+		symmetric_eigen_batch<dim>(S, V);
+
+		// B = FV has orthogonal columns sorted by decreasing norm, its QR factorization B = UR gives U and σ = diag(R)
+		TensorBatch<dim> B = TensorBatch<dim>::Zero(n_pts, dim * dim);
+		for (int j = 0; j < dim; ++j)
+			for (int i = 0; i < dim; ++i)
+				for (int k = 0; k < dim; ++k)
+					B.col(i + j * dim) += F.col(i + k * dim) * V.col(k + j * dim);
+		orthogonalize_columns_batch<dim>(B, V);
+
+		set_identity<dim>(n_pts, U);
+		for (int i = 0; i < dim - 1; ++i)
+		{
+			for (int j = i + 1; j < dim; ++j)
+			{
+				// Givens rotation of the rows i and j that zeroes B(j, i) and leaves B(i, i) ≥ 0
+				const Eigen::ArrayXd a = B.col(i + i * dim);
+				const Eigen::ArrayXd b = B.col(j + i * dim);
+				const Eigen::ArrayXd r = (a.square() + b.square()).sqrt();
+				const Eigen::ArrayXd inv_r = (r > 0).select(r.inverse(), 0);
+				const Eigen::ArrayXd c = (r > 0).select(a * inv_r, 1);
+				const Eigen::ArrayXd s = b * inv_r;
+
+				for (int k = i; k < dim; ++k)
+				{
+					const Eigen::ArrayXd bik = B.col(i + k * dim);
+					const Eigen::ArrayXd bjk = B.col(j + k * dim);
+					B.col(i + k * dim) = c * bik + s * bjk;
+					B.col(j + k * dim) = c * bjk - s * bik;
+				}
+				for (int k = 0; k < dim; ++k)
+				{
+					const Eigen::ArrayXd uki = U.col(k + i * dim);
+					const Eigen::ArrayXd ukj = U.col(k + j * dim);
+					U.col(k + i * dim) = c * uki + s * ukj;
+					U.col(k + j * dim) = c * ukj - s * uki;
+				}
+			}
+		}
+
+		sigma.resize(n_pts, dim);
+		for (int i = 0; i < dim; ++i)
+			sigma.col(i) = B.col(i + i * dim);
+	}
+
+	template <int dim>
+	void polar_decomposition_batch(const TensorBatch<dim> &F, TensorBatch<dim> &R, TensorBatch<dim> &S)
+	{
+		TensorBatch<dim> U, V;
+		SingularValueBatch<dim> sigma;
+		svd_batch<dim>(F, U, sigma, V);
+
+		R = multiply_transpose_batch<dim>(U, V);
+
+		TensorBatch<dim> V_sigma(F.rows(), dim * dim);
+		for (int j = 0; j < dim; ++j)
+			for (int i = 0; i < dim; ++i)
+				V_sigma.col(i + j * dim) = V.col(i + j * dim) * sigma.col(j);
+		S = multiply_transpose_batch<dim>(V_sigma, V);
+	}
+
+	template void svd_batch<2>(const TensorBatch<2> &, TensorBatch<2> &, SingularValueBatch<2> &, TensorBatch<2> &);
+	template void svd_batch<3>(const TensorBatch<3> &, TensorBatch<3> &, SingularValueBatch<3> &, TensorBatch<3> &);
+
+	template void polar_decomposition_batch<2>(const TensorBatch<2> &, TensorBatch<2> &, TensorBatch<2> &);
+	template void polar_decomposition_batch<3>(const TensorBatch<3> &, TensorBatch<3> &, TensorBatch<3> &);
+} // namespace polyfem::utils
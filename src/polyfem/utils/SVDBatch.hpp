@@ -0,0 +1,36 @@
+#pragma once
+
+#include <polyfem/utils/TensorBatch.hpp>
+
+#include <Eigen/Dense>
+
+namespace polyfem::utils
+{
+	/// Singular values at all points of a TensorBatch, one column per singular value
+	template <int dim>
+	using SingularValueBatch = Eigen::Array<double, Eigen::Dynamic, dim>;
+
+	/// Singular value decompositions F = U diag(σ) Vᵀ of all tensors of the batch, with the conventions of AutoFlipSVD:
+	/// U and V are rotations, σ is sorted by decreasing magnitude, and only σ(dim - 1) can be negative (if det(F) < 0).
+	/// The eigenvectors of FᵀF are found by cyclic Jacobi rotations, refined by one-sided Jacobi rotations of FV so that
+	/// tiny singular values keep their relative accuracy, and U by a Givens QR of FV; every step is a
+	/// column-wise array expression without per-point branches, so all points are processed in SIMD lanes.
+	template <int dim>
+	void svd_batch(const TensorBatch<dim> &F, TensorBatch<dim> &U, SingularValueBatch<dim> &sigma, TensorBatch<dim> &V);
+
+	/// Polar decompositions F = RS of all tensors of the batch, R is a rotation and S is symmetric
+	template <int dim>
+	void polar_decomposition_batch(const TensorBatch<dim> &F, TensorBatch<dim> &R, TensorBatch<dim> &S);
+
+	/// ABᵀ at all points
+	template <int dim>
+	TensorBatch<dim> multiply_transpose_batch(const TensorBatch<dim> &A, const TensorBatch<dim> &B)
+	{
+		TensorBatch<dim> C = TensorBatch<dim>::Zero(A.rows(), dim * dim);
+		for (int j = 0; j < dim; ++j)
+			for (int i = 0; i < dim; ++i)
+				for (int k = 0; k < dim; ++k)
+					C.col(i + j * dim) += A.col(i + k * dim) * B.col(j + k * dim);
+		return C;
+	}
+} // namespace polyfem::utils
@@ -0,0 +1,68 @@
+#include "SurfaceDistance.hpp"
+
+#include <polyfem/utils/Logger.hpp>
+
+namespace polyfem::utils
+{
+	namespace
+	{
+		template <int DIM>
+		double squared_distance(const igl::AABB<Eigen::MatrixXd, DIM> &tree, const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::Matrix<double, 1, DIM> &point, Eigen::Matrix<double, 1, DIM> &closest)
+		{
+			int idx;
+			return tree.squared_distance(V, F, point, idx, closest);
+		}
+
+		template <int DIM>
+		void query_closest_points(const igl::AABB<Eigen::MatrixXd, DIM> &tree, const Eigen::MatrixXd &V, const Eigen::MatrixXi &F, const Eigen::MatrixXd &points, Eigen::VectorXd &sqr_distances, Eigen::MatrixXd &closest)
+		{
+			Eigen::Matrix<double, 1, DIM> c;
+			for (int i = 0; i < points.rows(); ++i)
+			{
+				sqr_distances(i) = squared_distance<DIM>(tree, V, F, points.row(i), c);
+				closest.row(i) = c;
+			}
+		}
+	} // namespace
+
+	void SurfaceDistance::init(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F)
+	{
+		V_ = V;
+		F_ = F;
+
+		if (dim() == 2)
+			tree_2d_.init(V_, F_);
+		else if (dim() == 3)
+			tree_3d_.init(V_, F_);
+		else
+			log_and_throw_error("Invalid dimension {} for surface distance queries!", dim());
+	}
+
+	void SurfaceDistance::closest_points(const Eigen::MatrixXd &points, Eigen::VectorXd &sqr_distances, Eigen::MatrixXd &closest) const
+	{
+		assert(points.cols() == dim());
+		sqr_distances.resize(points.rows());
+		closest.resize(points.rows(), dim());
+
+		if (dim() == 2)
+			query_closest_points<2>(tree_2d_, V_, F_, points, sqr_distances, closest);
+		else
+			query_closest_points<3>(tree_3d_, V_, F_, points, sqr_distances, closest);
+	}
+
+	double SurfaceDistance::distance(const Eigen::VectorXd &point) const
+	{
+		assert(point.size() == dim());
+
+		if (dim() == 2)
+		{
+			Eigen::Matrix<double, 1, 2> c;
+			return std::sqrt(squared_distance<2>(tree_2d_, V_, F_, point.transpose(), c));
+		}
+		else
+		{
+			Eigen::Matrix<double, 1, 3> c;
+			return std::sqrt(squared_distance<3>(tree_3d_, V_, F_, point.transpose(), c));
+		}
+	}
+} // namespace polyfem::utils
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Eigen/Dense>
+#include <igl/AABB.h>
+
+namespace polyfem::utils
+{
+	/// @brief Distance queries to a polyline (2d) or a triangle mesh (3d), accelerated by an AABB tree.
+	/// Queries are read-only and can run concurrently.
+	class SurfaceDistance
+	{
+	public:
+		SurfaceDistance() = default;
+
+		/// @brief Builds the tree
+		/// @param V vertices, their number of columns is the dimension
+		/// @param F segments (2d) or triangles (3d)
+		void init(const Eigen::MatrixXd &V, const Eigen::MatrixXi &F);
+
+		/// @brief Closest points on the surface of a batch of points
+		/// @param[in] points query points, one per row
+		/// @param[out] sqr_distances squared distance of every point to the surface
+		/// @param[out] closest closest point of every point, the gradient of the squared distance is 2 (points - closest)
+		void closest_points(const Eigen::MatrixXd &points, Eigen::VectorXd &sqr_distances, Eigen::MatrixXd &closest) const;
+
+		/// @brief Distance of a single point to the surface
+		double distance(const Eigen::VectorXd &point) const;
+
+		int dim() const { return V_.cols(); }
+
+	private:
+		Eigen::MatrixXd V_;
+		Eigen::MatrixXi F_;
+
+		igl::AABB<Eigen::MatrixXd, 2> tree_2d_;
+		igl::AABB<Eigen::MatrixXd, 3> tree_3d_;
+	};
+} // namespace polyfem::utils
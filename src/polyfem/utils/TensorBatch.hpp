@@ -0,0 +1,180 @@
+#pragma once
+
+#include <polyfem/assembler/ElementAssemblyValues.hpp>
+#include <polyfem/utils/Types.hpp>
+
+#include <Eigen/Dense>
+
+#include <array>
+
+namespace polyfem::utils
+{
+	/// dim x dim tensors at all quadrature points of an element in structure-of-arrays layout:
+	/// one row per point and one column per column-major entry, so point-wise formulas become
+	/// column-wise array expressions that Eigen evaluates in SIMD lanes
+	template <int dim>
+	using TensorBatch = Eigen::Array<double, Eigen::Dynamic, dim * dim>;
+
+	/// dim² x dim² tensors (e.g., ∂²Ψ/∂F²) at all quadrature points, entry (a, b) is stored in column a + b * dim²
+	template <int dim>
+	using TensorBatch4 = Eigen::Array<double, Eigen::Dynamic, dim * dim * dim * dim>;
+
+	/// Gradients of the bases at all quadrature points, G[j](p, b) = ∂φ_b/∂x_j at point p
+	template <int n_basis, int dim>
+	using BasisGradBatch = std::array<Eigen::Matrix<double, Eigen::Dynamic, n_basis>, dim>;
+
+	template <int n_basis, int dim>
+	void basis_grad_batch(const assembler::ElementAssemblyValues &vals, BasisGradBatch<n_basis, dim> &G)
+	{
+		const int n_bases = vals.basis_values.size();
+		const int n_pts = vals.basis_values.front().grad_t_m.rows();
+
+		for (int j = 0; j < dim; ++j)
+		{
+			G[j].resize(n_pts, n_bases);
+			for (int b = 0; b < n_bases; ++b)
+				G[j].col(b) = vals.basis_values[b].grad_t_m.col(j);
+		}
+	}
+
+	/// F = I + ∇u at all points, local_disp(b, i) is the i-th displacement component of the basis b
+	template <int n_basis, int dim>
+	void def_grad_batch(const BasisGradBatch<n_basis, dim> &G, const Eigen::Matrix<double, n_basis, dim> &local_disp, TensorBatch<dim> &F)
+	{
+		F.resize(G[0].rows(), dim * dim);
+		for (int j = 0; j < dim; ++j)
+		{
+			for (int i = 0; i < dim; ++i)
+			{
+				F.col(i + j * dim) = (G[j] * local_disp.col(i)).array();
+				if (i == j)
+					F.col(i + j * dim) += 1;
+			}
+		}
+	}
+
+	template <int dim>
+	Eigen::ArrayXd determinant_batch(const TensorBatch<dim> &F)
+	{
+		const auto f = [&F](const int i, const int j) { return F.col(i + j * dim); };
+
+		if constexpr (dim == 2)
+			return f(0, 0) * f(1, 1) - f(0, 1) * f(1, 0);
+		else
+			return f(0, 0) * (f(1, 1) * f(2, 2) - f(1, 2) * f(2, 1))
+				   - f(0, 1) * (f(1, 0) * f(2, 2) - f(1, 2) * f(2, 0))
+				   + f(0, 2) * (f(1, 0) * f(2, 1) - f(1, 1) * f(2, 0));
+	}
+
+	/// Cofactor matrices of F at all points, that is ∂det(F)/∂F
+	template <int dim>
+	TensorBatch<dim> cofactor_batch(const TensorBatch<dim> &F)
+	{
+		const auto f = [&F](const int i, const int j) { return F.col(i + j * dim); };
+
+		TensorBatch<dim> C(F.rows(), dim * dim);
+		if constexpr (dim == 2)
+		{
+			C.col(0) = f(1, 1);
+			C.col(1) = -f(0, 1);
+			C.col(2) = -f(1, 0);
+			C.col(3) = f(0, 0);
+		}
+		else
+		{
+			for (int j = 0; j < 3; ++j)
+			{
+				const int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+				for (int i = 0; i < 3; ++i)
+				{
+					const int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+					C.col(i + j * 3) = f(i1, j1) * f(i2, j2) - f(i1, j2) * f(i2, j1);
+				}
+			}
+		}
+		return C;
+	}
+
+	/// Adds c ∂²det(F)/∂F² to A at all points
+	template <int dim>
+	void add_det_hessian_batch(const Eigen::ArrayXd &c, const TensorBatch<dim> &F, TensorBatch4<dim> &A)
+	{
+		constexpr int n = dim * dim;
+		// sign of the permutation (a, b, 3 - a - b) for a != b
+		const auto levi_civita = [](const int a, const int b) { return (b - a + 3) % 3 == 1 ? 1. : -1.; };
+
+		for (int l = 0; l < dim; ++l)
+		{
+			for (int j = 0; j < dim; ++j)
+			{
+				if (j == l)
+					continue;
+				for (int k = 0; k < dim; ++k)
+				{
+					for (int i = 0; i < dim; ++i)
+					{
+						if (i == k)
+							continue;
+						auto col = A.col((i + j * dim) + (k + l * dim) * n);
+						if constexpr (dim == 2)
+							col += (i == 0 ? 1. : -1.) * (j == 0 ? 1. : -1.) * c;
+						else
+							col += levi_civita(i, k) * levi_civita(j, l) * c * F.col((3 - i - k) + (3 - j - l) * dim);
+					}
+				}
+			}
+		}
+	}
+
+	/// Contracts the per-point first Piola-Kirchhoff stresses P into the element gradient ∫ P : ∇φ, ordered b * dim + i
+	template <int n_basis, int dim>
+	void gradient_from_stress_batch(const BasisGradBatch<n_basis, dim> &G, const TensorBatch<dim> &P, const QuadratureVector &da, Eigen::VectorXd &gradient)
+	{
+		const int n_bases = G[0].cols();
+
+		Eigen::Matrix<double, dim, n_basis> g(dim, n_bases);
+		g.setZero();
+		for (int i = 0; i < dim; ++i)
+			for (int j = 0; j < dim; ++j)
+				g.row(i).noalias() += (da.array() * P.col(i + j * dim)).matrix().transpose() * G[j];
+
+		gradient = g.reshaped();
+	}
+
+	/// Contracts the per-point (symmetric) ∂²Ψ/∂F² into the element hessian, ordered b * dim + i
+	template <int n_basis, int dim>
+	void hessian_from_stiffness_batch(const BasisGradBatch<n_basis, dim> &G, const TensorBatch4<dim> &A, const QuadratureVector &da, Eigen::MatrixXd &hessian)
+	{
+		constexpr int n = dim * dim;
+		const int n_pts = G[0].rows();
+		const int n_bases = G[0].cols();
+
+		hessian.resize(n_bases * dim, n_bases * dim);
+
+		Eigen::Matrix<double, Eigen::Dynamic, n_basis> WG(n_pts, n_bases);
+		Eigen::Matrix<double, n_basis, n_basis> block(n_bases, n_bases);
+		for (int i = 0; i < dim; ++i)
+		{
+			for (int k = i; k < dim; ++k)
+			{
+				block.setZero();
+				for (int j = 0; j < dim; ++j)
+				{
+					WG.setZero();
+					for (int l = 0; l < dim; ++l)
+						WG.array() += G[l].array().colwise() * (da.array() * A.col((i + j * dim) + (k + l * dim) * n));
+					block.noalias() += G[j].transpose() * WG;
+				}
+
+				for (int b = 0; b < n_bases; ++b)
+				{
+					for (int c = 0; c < n_bases; ++c)
+					{
+						hessian(b * dim + i, c * dim + k) = block(b, c);
+						hessian(c * dim + k, b * dim + i) = block(b, c);
+					}
+				}
+			}
+		}
+	}
+} // namespace polyfem::utils
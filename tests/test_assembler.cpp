@@ -2,10 +2,22 @@
 
 #include <polyfem/assembler/NeoHookeanElasticity.hpp>
 #include <polyfem/assembler/NeoHookeanElasticityAutodiff.hpp>
+#include <polyfem/assembler/FixedCorotational.hpp>
+#include <polyfem/assembler/Laplacian.hpp>
+#include <polyfem/assembler/LinearElasticity.hpp>
+#include <polyfem/assembler/Mass.hpp>
+#include <polyfem/assembler/AssemblerUtils.hpp>
+#include <polyfem/assembler/SumFactorization.hpp>
+#include <polyfem/basis/LagrangeBasis3d.hpp>
+#include <polyfem/mesh/mesh3D/Mesh3D.hpp>
+#include <polyfem/mesh/MeshNodes.hpp>
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
 #include <catch2/catch_approx.hpp>
 
+#include <ipc/utils/eigen_ext.hpp>
+
 #include <iostream>
 
 using namespace polyfem;
@@ -14,6 +26,103 @@ using namespace polyfem::basis;
 using namespace polyfem::mesh;
 using namespace polyfem::utils;
 
+namespace
+{
+	/// Arguments of the quadratic ElasticExact problem on plane_hole.obj
+	json plane_hole_args(const std::string &material)
+	{
+		json in_args = json({});
+		in_args["geometry"] = {};
+		in_args["geometry"]["mesh"] = POLYFEM_DATA_DIR + std::string("/plane_hole.obj");
+		in_args["geometry"]["surface_selection"] = 7;
+
+		in_args["space"]["discr_order"] = 2;
+
+		in_args["preset_problem"] = {};
+		in_args["preset_problem"]["type"] = "ElasticExact";
+
+		in_args["materials"] = {};
+		in_args["materials"]["type"] = material;
+		in_args["materials"]["E"] = 1e5;
+		in_args["materials"]["nu"] = 0.3;
+
+		return in_args;
+	}
+
+	void init_plane_hole_state(State &state, const json &in_args)
+	{
+		state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+		state.init(in_args, true);
+		state.load_mesh();
+		state.build_basis();
+	}
+
+	/// Element stiffness from the pairwise assembly, which does not read or fill the element store
+	Eigen::MatrixXd pairwise_stiffness(const LinearElasticity &assembler, const ElementAssemblyValues &vals, const QuadratureVector &da)
+	{
+		const int dim = assembler.size();
+		const int n_bases = vals.basis_values.size();
+
+		Eigen::MatrixXd local(n_bases * dim, n_bases * dim);
+		for (int i = 0; i < n_bases; ++i)
+		{
+			for (int j = 0; j < n_bases; ++j)
+			{
+				const auto val = assembler.assemble(LinearAssemblerData(vals, 0, i, j, da));
+				for (int n = 0; n < dim; ++n)
+					for (int m = 0; m < dim; ++m)
+						local(i * dim + m, j * dim + n) = val(n * dim + m);
+			}
+		}
+		return local;
+	}
+
+	/// Displacement of the nodes of all elements by the uniform deformation gradient A
+	Eigen::MatrixXd uniform_displacement(const State &state, const Eigen::Matrix2d &A)
+	{
+		Eigen::MatrixXd displacement = Eigen::MatrixXd::Zero(state.n_bases * 2, 1);
+		for (const auto &bs : state.bases)
+		{
+			for (const auto &b : bs.bases)
+			{
+				const auto &g = b.global()[0];
+				displacement.block<2, 1>(g.index * 2, 0) = (A - Eigen::Matrix2d::Identity()) * g.node.transpose();
+			}
+		}
+		return displacement;
+	}
+
+	/// Element hessian with ∂²Ψ/∂F² eigen-clamped at every quadrature point. ∂²Ψ/∂F² is recovered from the
+	/// one-point element hessian G^T H G da, where G maps the local dofs to vec(F)
+	Eigen::MatrixXd clamped_per_point_hessian(const NLAssembler &assembler, const ElementAssemblyValues &vals, const QuadratureVector &da, const Eigen::MatrixXd &displacement)
+	{
+		const int dim = assembler.size();
+		const int n_bases = vals.basis_values.size();
+
+		Eigen::MatrixXd reference = Eigen::MatrixXd::Zero(n_bases * dim, n_bases * dim);
+		for (int q = 0; q < da.size(); ++q)
+		{
+			QuadratureVector da_q = QuadratureVector::Zero(da.size());
+			da_q(q) = da(q);
+			const Eigen::MatrixXd K = assembler.assemble_hessian(NonLinearAssemblerData(vals, 0, 0, displacement, displacement, da_q));
+
+			Eigen::MatrixXd G = Eigen::MatrixXd::Zero(dim * dim, n_bases * dim);
+			for (int a = 0; a < n_bases; ++a)
+				for (int i = 0; i < dim; ++i)
+					for (int j = 0; j < dim; ++j)
+						G(i * dim + j, a * dim + i) = vals.basis_values[a].grad_t_m(q, j);
+
+			const Eigen::MatrixXd GGt_inv = (G * G.transpose()).inverse();
+			const Eigen::MatrixXd H = GGt_inv * G * K * G.transpose() * GGt_inv / da(q);
+			const Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(0.5 * (H + H.transpose()));
+			const Eigen::MatrixXd H_clamped = eig.eigenvectors() * eig.eigenvalues().cwiseMax(0).asDiagonal() * eig.eigenvectors().transpose();
+
+			reference += G.transpose() * H_clamped * G * da(q);
+		}
+		return reference;
+	}
+} // namespace
+
 TEST_CASE("hessian_lin", "[assembler]")
 {
 	const std::string path = POLYFEM_DATA_DIR;
@@ -24,6 +133,8 @@ TEST_CASE("hessian_lin", "[assembler]")
 	// in_args["geometry"]["mesh"] = path + "/circle2.msh";
 	// in_args["force_linear_geometry"] = true;
 
+	in_args["space"]["discr_order"] = GENERATE(1, 2);
+
 	in_args["preset_problem"] = {};
 	in_args["preset_problem"]["type"] = "ElasticExact";
 
@@ -284,3 +395,503 @@ TEST_CASE("generic_elastic_assembler", "[assembler]")
 		}
 	}
 }
+
+TEST_CASE("update_basis_geometry", "[assembler]")
+{
+	const json in_args = plane_hole_args("LinearElasticity");
+
+	State moved, rebuilt;
+	init_plane_hole_state(moved, in_args);
+	init_plane_hole_state(rebuilt, in_args);
+
+	StiffnessMatrix stiffness;
+	moved.build_stiffness_mat(stiffness);
+
+	// nodal boundary conditions on a few nodes
+	moved.dirichlet_nodes = {0, moved.n_bases / 2};
+	moved.neumann_nodes = {moved.n_bases - 1};
+
+	Eigen::MatrixXd V;
+	moved.get_vertices(V);
+	for (int i = 0; i < V.rows(); ++i)
+	{
+		V(i, 0) += 1e-2 * std::sin(3 * V(i, 1));
+		V(i, 1) += 1e-2 * std::cos(2 * V(i, 0));
+		moved.set_mesh_vertex(i, V.row(i));
+		rebuilt.set_mesh_vertex(i, V.row(i));
+	}
+
+	moved.update_basis_geometry();
+	rebuilt.build_basis();
+
+	REQUIRE(moved.n_bases == rebuilt.n_bases);
+	for (int e = 0; e < moved.bases.size(); ++e)
+		for (int j = 0; j < moved.bases[e].bases.size(); ++j)
+			for (int k = 0; k < moved.bases[e].bases[j].global().size(); ++k)
+				REQUIRE((moved.bases[e].bases[j].global()[k].node - rebuilt.bases[e].bases[j].global()[k].node).norm() < 1e-12);
+
+	StiffnessMatrix moved_stiffness, rebuilt_stiffness;
+	moved.build_stiffness_mat(moved_stiffness);
+	rebuilt.build_stiffness_mat(rebuilt_stiffness);
+
+	REQUIRE(moved_stiffness.nonZeros() == stiffness.nonZeros());
+	REQUIRE((moved_stiffness - rebuilt_stiffness).norm() < 1e-8 * rebuilt_stiffness.norm());
+	REQUIRE(moved.collision_mesh.rest_positions().isApprox(rebuilt.collision_mesh.rest_positions()));
+
+	const auto rebuilt_node = [&](const int n_id) {
+		for (const auto &bs : rebuilt.bases)
+			for (const auto &b : bs.bases)
+				for (const auto &g : b.global())
+					if (g.index == n_id)
+						return g.node;
+		return RowVectorNd();
+	};
+	for (const auto &[nodes, positions] : {std::make_pair(&moved.dirichlet_nodes, &moved.dirichlet_nodes_position),
+										   std::make_pair(&moved.neumann_nodes, &moved.neumann_nodes_position)})
+	{
+		REQUIRE(positions->size() == nodes->size());
+		for (int n = 0; n < nodes->size(); ++n)
+			REQUIRE(((*positions)[n] - rebuilt_node((*nodes)[n])).norm() < 1e-12);
+	}
+}
+
+TEST_CASE("update_basis_geometry_mesh_size", "[assembler]")
+{
+	json in_args = plane_hole_args("LinearElasticity");
+	in_args["contact"]["enabled"] = true;
+
+	State moved, rebuilt;
+	init_plane_hole_state(moved, in_args);
+	init_plane_hole_state(rebuilt, in_args);
+
+	// shrinking the mesh below the default dhat sets it from dhat_percentage
+	Eigen::MatrixXd V;
+	moved.get_vertices(V);
+	for (int i = 0; i < V.rows(); ++i)
+	{
+		V(i, 0) = 1e-3 * (V(i, 0) + 1e-2 * std::sin(3 * V(i, 1)));
+		V(i, 1) = 1e-3 * V(i, 1);
+		moved.set_mesh_vertex(i, V.row(i));
+		rebuilt.set_mesh_vertex(i, V.row(i));
+	}
+
+	moved.update_basis_geometry();
+	rebuilt.build_basis();
+
+	REQUIRE(rebuilt.stats.mesh_size < 1e-2 * moved.starting_max_edge_length);
+	REQUIRE(moved.stats.mesh_size == Catch::Approx(rebuilt.stats.mesh_size));
+	REQUIRE(moved.stats.min_edge_length == Catch::Approx(rebuilt.stats.min_edge_length));
+	REQUIRE(moved.stats.average_edge_length == Catch::Approx(rebuilt.stats.average_edge_length));
+	REQUIRE(moved.min_boundary_edge_length == Catch::Approx(rebuilt.min_boundary_edge_length));
+	REQUIRE(moved.args["contact"]["dhat"].get<double>() == Catch::Approx(rebuilt.args["contact"]["dhat"].get<double>()));
+	REQUIRE(rebuilt.args["contact"]["dhat"].get<double>() < rebuilt.min_boundary_edge_length);
+}
+TEST_CASE("projected_hessian", "[assembler]")
+{
+	const json in_args = plane_hole_args("NeoHookean");
+
+	State state;
+	init_plane_hole_state(state, in_args);
+
+	NeoHookeanElasticity neo_hookean;
+	NeoHookeanAutodiff autodiff;
+	FixedCorotational corotational;
+
+	for (NLAssembler *assembler : std::vector<NLAssembler *>{&neo_hookean, &autodiff, &corotational})
+	{
+		assembler->set_size(2);
+		assembler->add_multimaterial(0, in_args["materials"], state.units);
+
+		const int el_id = 0;
+		const auto &bs = state.bases[el_id];
+
+		ElementAssemblyValues vals;
+		vals.compute(el_id, false, bs, bs);
+		const QuadratureVector da = vals.det.array() * vals.quadrature.weights.array();
+
+		Eigen::MatrixXd displacement = Eigen::MatrixXd::Zero(state.n_bases * 2, 1);
+
+		// at rest the hessian is already PSD
+		{
+			const NonLinearAssemblerData data(vals, 0, 0, displacement, displacement, da);
+			const Eigen::MatrixXd hessian = assembler->assemble_hessian(data);
+			const Eigen::MatrixXd projected = assembler->assemble_projected_hessian(data);
+			REQUIRE((hessian - projected).norm() < 1e-8 * hessian.norm());
+		}
+
+		for (int rand = 0; rand < 10; ++rand)
+		{
+			displacement.setRandom();
+			displacement *= 0.1;
+
+			const NonLinearAssemblerData data(vals, 0, 0, displacement, displacement, da);
+			const Eigen::MatrixXd projected = assembler->assemble_projected_hessian(data);
+
+			REQUIRE((projected - projected.transpose()).norm() < 1e-10 * projected.norm());
+			const Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eig(projected);
+			REQUIRE(eig.eigenvalues().minCoeff() > -1e-8 * projected.norm());
+		}
+
+		// compressed, and inverted for the material defined for J < 0
+		std::vector<Eigen::Matrix2d> deformations = {Eigen::Vector2d(0.6, 0.6).asDiagonal()};
+		if (assembler == &corotational)
+			deformations.push_back(Eigen::Vector2d(-0.5, 1).asDiagonal());
+
+		for (const Eigen::Matrix2d &A : deformations)
+		{
+			displacement = uniform_displacement(state, A);
+			const NonLinearAssemblerData data(vals, 0, 0, displacement, displacement, da);
+
+			const Eigen::MatrixXd hessian = assembler->assemble_hessian(data);
+			REQUIRE(Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd>(hessian).eigenvalues().minCoeff() < -1e-3 * hessian.norm());
+
+			const Eigen::MatrixXd projected = assembler->assemble_projected_hessian(data);
+			const Eigen::MatrixXd reference = clamped_per_point_hessian(*assembler, vals, da, displacement);
+			REQUIRE((projected - reference).norm() < 1e-6 * reference.norm());
+		}
+	}
+
+	// the global assembly projects the element hessians unless per-point projection is enabled
+	const Eigen::MatrixXd displacement = uniform_displacement(state, Eigen::Vector2d(0.6, 0.6).asDiagonal());
+	NeoHookeanElasticity &assembler = neo_hookean;
+	REQUIRE(!assembler.per_point_psd_projection());
+	for (const bool per_point : {false, true})
+	{
+		assembler.set_per_point_psd_projection(per_point);
+
+		SparseMatrixCache mat_cache;
+		StiffnessMatrix hessian;
+		assembler.assemble_hessian(false, state.n_bases, true, state.bases, state.bases, state.ass_vals_cache, 0, 0,
+								   displacement, displacement, mat_cache, hessian);
+
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int e = 0; e < state.bases.size(); ++e)
+		{
+			const auto &bs = state.bases[e];
+			ElementAssemblyValues vals;
+			vals.compute(e, false, bs, bs);
+			const QuadratureVector da = vals.det.array() * vals.quadrature.weights.array();
+
+			const NonLinearAssemblerData data(vals, 0, 0, displacement, displacement, da);
+			const Eigen::MatrixXd local = per_point ? assembler.assemble_projected_hessian(data) : ipc::project_to_psd(assembler.assemble_hessian(data));
+			for (int i = 0; i < bs.bases.size(); ++i)
+				for (int j = 0; j < bs.bases.size(); ++j)
+					for (int m = 0; m < 2; ++m)
+						for (int n = 0; n < 2; ++n)
+							entries.emplace_back(bs.bases[i].global()[0].index * 2 + m, bs.bases[j].global()[0].index * 2 + n, local(i * 2 + m, j * 2 + n));
+		}
+		StiffnessMatrix reference(hessian.rows(), hessian.cols());
+		reference.setFromTriplets(entries.begin(), entries.end());
+
+		REQUIRE((hessian - reference).norm() < 1e-8 * reference.norm());
+	}
+}
+
+TEST_CASE("sum_factorization", "[assembler]")
+{
+	// Used to init geogram
+	State state;
+	state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+
+	const int discr_order = GENERATE(1, 2, 3);
+
+	// distorted 2x2x2 hexahedral grid
+	const int n = 2;
+	const auto vid = [n](int i, int j, int k) { return i + (n + 1) * (j + (n + 1) * k); };
+	Eigen::MatrixXd V((n + 1) * (n + 1) * (n + 1), 3);
+	for (int k = 0; k <= n; ++k)
+	{
+		for (int j = 0; j <= n; ++j)
+		{
+			for (int i = 0; i <= n; ++i)
+			{
+				const double x = double(i) / n, y = double(j) / n, z = double(k) / n;
+				V.row(vid(i, j, k)) << x + 0.1 * std::sin(3 * y) + 0.2 * z * z, y + 0.15 * x * z, z + 0.1 * std::cos(2 * x);
+			}
+		}
+	}
+	Eigen::MatrixXi C(n * n * n, 8);
+	for (int k = 0; k < n; ++k)
+		for (int j = 0; j < n; ++j)
+			for (int i = 0; i < n; ++i)
+				C.row(i + n * (j + n * k)) << vid(i, j, k), vid(i + 1, j, k), vid(i + 1, j + 1, k), vid(i, j + 1, k),
+					vid(i, j, k + 1), vid(i + 1, j, k + 1), vid(i + 1, j + 1, k + 1), vid(i, j + 1, k + 1);
+
+	const auto mesh = Mesh::create(V, C);
+	REQUIRE(mesh);
+	const auto &mesh3d = dynamic_cast<const Mesh3D &>(*mesh);
+
+	std::vector<ElementBases> bases;
+	std::vector<LocalBoundary> local_boundary;
+	std::map<int, InterfaceData> poly_face_to_data;
+	std::shared_ptr<MeshNodes> mesh_nodes;
+	const int n_bases = LagrangeBasis3d::build_bases(
+		mesh3d, "LinearElasticity", -1, -1, discr_order, false, false, false, false, false,
+		bases, local_boundary, poly_face_to_data, mesh_nodes);
+
+	REQUIRE(SumFactorizedOperator::is_supported(*mesh, bases));
+
+	const json params = {{"E", 1e5}, {"nu", 0.3}, {"rho", 2}};
+	const int order = AssemblerUtils::quadrature_order("LinearElasticity", discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
+	const int mass_order = AssemblerUtils::quadrature_order("Mass", discr_order, AssemblerUtils::BasisType::CUBE_LAGRANGE, 3);
+
+	Laplacian laplacian;
+	laplacian.set_size(1);
+	LinearElasticity linear_elasticity;
+	linear_elasticity.set_size(3);
+	linear_elasticity.add_multimaterial(0, params, state.units);
+	Mass mass;
+	mass.set_size(1);
+	mass.add_multimaterial(0, params, state.units);
+
+	AssemblyValsCache cache, mass_cache;
+	cache.init(true, bases, bases);
+	mass_cache.init(true, bases, bases, true);
+
+	for (const LinearAssembler *assembler : std::vector<const LinearAssembler *>{&laplacian, &linear_elasticity, &mass})
+	{
+		const bool is_mass = assembler == &mass;
+
+		StiffnessMatrix stiffness;
+		assembler->assemble(true, n_bases, bases, bases, is_mass ? mass_cache : cache, 0, stiffness, is_mass);
+
+		const SumFactorizedOperator op(*assembler, *mesh, n_bases, bases, bases, is_mass ? mass_order : order);
+		REQUIRE(op.size() == stiffness.rows());
+
+		const Eigen::VectorXd x = Eigen::VectorXd::Random(op.size());
+		Eigen::VectorXd y;
+		op.apply(x, y);
+
+		const Eigen::VectorXd expected = stiffness * x;
+		CHECK((y - expected).norm() < 1e-10 * expected.norm());
+
+		Eigen::VectorXd diag;
+		op.diagonal(diag);
+		const Eigen::VectorXd expected_diag = stiffness.diagonal();
+		CHECK((diag - expected_diag).norm() < 1e-10 * expected_diag.norm());
+	}
+}
+
+TEST_CASE("matrix_free_solve", "[assembler]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+	const std::string material = GENERATE("Laplacian", "LinearElasticity");
+	const bool is_scalar = material == "Laplacian";
+
+	json in_args = json({});
+	in_args["geometry"] = json::array({json({})});
+	in_args["geometry"][0]["mesh"] = path + "/quad_test/hex.HYBRID";
+	in_args["space"]["discr_order"] = GENERATE(1, 2);
+
+	in_args["materials"] = {};
+	in_args["materials"]["type"] = material;
+	if (!is_scalar)
+	{
+		in_args["materials"]["E"] = 1e5;
+		in_args["materials"]["nu"] = 0.3;
+	}
+
+	in_args["boundary_conditions"] = {};
+	in_args["boundary_conditions"]["rhs"] = is_scalar ? json(10) : json({0, 0, 10});
+	in_args["boundary_conditions"]["dirichlet_boundary"] = json::array({json({})});
+	in_args["boundary_conditions"]["dirichlet_boundary"][0]["id"] = "all";
+	in_args["boundary_conditions"]["dirichlet_boundary"][0]["value"] = is_scalar ? json("x*y") : json({"0.01*x", "0.01*y*z", 0});
+
+	const auto solve = [&](const bool matrix_free) {
+		json args = in_args;
+		args["solver"]["advanced"]["matrix_free"] = matrix_free;
+
+		State state;
+		state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+		state.init(args, true);
+		state.load_mesh();
+		state.build_basis();
+		state.assemble_rhs();
+		state.assemble_mass_mat();
+
+		Eigen::MatrixXd sol, pressure;
+		state.solve_problem(sol, pressure);
+
+		CHECK((state.stats.solver_info["solver"] == "MatrixFreeCG") == matrix_free);
+		return sol;
+	};
+
+	const Eigen::MatrixXd expected = solve(false);
+	const Eigen::MatrixXd sol = solve(true);
+	REQUIRE(sol.size() == expected.size());
+	CHECK((sol - expected).norm() < 1e-8 * expected.norm());
+}
+
+TEST_CASE("element_hessian_reuse", "[assembler]")
+{
+	const json in_args = plane_hole_args("NeoHookean");
+
+	State state;
+	init_plane_hole_state(state, in_args);
+
+	NeoHookeanElasticity assembler;
+	assembler.set_size(2);
+	assembler.add_multimaterial(0, in_args["materials"], state.units);
+
+	SparseMatrixCache mat_cache;
+	const auto hessian = [&](const Eigen::MatrixXd &x, ElementHessianCache *element_cache) {
+		StiffnessMatrix hess;
+		assembler.assemble_hessian(
+			false, state.n_bases, false, state.bases, state.geom_bases(), state.ass_vals_cache,
+			0, 0, x, x, mat_cache, hess, element_cache);
+		return hess;
+	};
+
+	const int n_elements = state.bases.size();
+	const Eigen::MatrixXd x = 1e-2 * Eigen::MatrixXd::Random(state.n_bases * 2, 1);
+	const StiffnessMatrix reference = hessian(x, nullptr);
+
+	ElementHessianCache exact(0), approx(1e-3);
+	REQUIRE((hessian(x, &exact) - reference).norm() < 1e-12 * reference.norm());
+	REQUIRE(exact.n_reused() == 0);
+	REQUIRE((hessian(x, &approx) - reference).norm() < 1e-12 * reference.norm());
+
+	// only the elements sharing DOFs with the first element are recomputed
+	Eigen::MatrixXd y = x;
+	for (const auto &b : state.bases[0].bases)
+		for (const auto &g : b.global())
+			y.middleRows(g.index * 2, 2).array() += 1e-2;
+
+	const StiffnessMatrix moved = hessian(y, nullptr);
+	REQUIRE((hessian(y, &exact) - moved).norm() < 1e-12 * moved.norm());
+	REQUIRE(exact.n_reused() > 0);
+	REQUIRE(exact.n_reused() < n_elements);
+
+	// displacements below the tolerance reuse all the hessians
+	const Eigen::MatrixXd z = x.array() + 1e-5;
+	REQUIRE((hessian(z, &approx) - reference).norm() < 1e-12 * reference.norm());
+	REQUIRE(approx.n_reused() == n_elements);
+}
+
+TEST_CASE("linear_elasticity_stiffness_store", "[assembler]")
+{
+	const json in_args = plane_hole_args("LinearElasticity");
+
+	State state;
+	init_plane_hole_state(state, in_args);
+
+	const auto make_assembler = [&]() {
+		auto assembler = std::make_shared<LinearElasticity>();
+		assembler->set_size(2);
+		assembler->add_multimaterial(0, in_args["materials"], state.units);
+		return assembler;
+	};
+
+	SparseMatrixCache mat_cache;
+	const Eigen::MatrixXd x = Eigen::MatrixXd::Zero(state.n_bases * 2, 1);
+	const auto hessian = [&](const LinearElasticity &assembler) {
+		StiffnessMatrix hess;
+		assembler.assemble_hessian(
+			false, state.n_bases, false, state.bases, state.geom_bases(), state.ass_vals_cache,
+			0, 0, x, x, mat_cache, hess);
+		return hess;
+	};
+
+	const int n_elements = state.bases.size();
+	const auto assembler = make_assembler();
+
+	const StiffnessMatrix reference = hessian(*assembler);
+	REQUIRE(assembler->element_stiffness_store().n_stored() == n_elements);
+	REQUIRE((hessian(*assembler) - reference).norm() < 1e-12 * reference.norm());
+
+	// the linear assembly of build_stiffness_mat fills and reads the same store
+	const auto &state_assembler = dynamic_cast<const LinearElasticity &>(*state.assembler);
+	StiffnessMatrix stiffness;
+	state.build_stiffness_mat(stiffness);
+	REQUIRE(state_assembler.element_stiffness_store().n_stored() == n_elements);
+	REQUIRE((stiffness - reference).norm() < 1e-12 * reference.norm());
+	StiffnessMatrix restiffness;
+	state.build_stiffness_mat(restiffness);
+	REQUIRE((restiffness - stiffness).norm() < 1e-12 * stiffness.norm());
+
+	const Eigen::MatrixXd u = 1e-2 * Eigen::MatrixXd::Random(state.n_bases * 2, 1);
+	const double energy = state.assembler->assemble_energy(false, state.bases, state.geom_bases(), state.ass_vals_cache, 0, 0, u, u);
+	REQUIRE(std::abs(0.5 * (u.transpose() * stiffness * u)(0) - energy) < 1e-10 * std::abs(energy));
+
+	// heterogeneous parameters, then a change on a single element
+	Eigen::MatrixXd lambdas = 1e4 * (Eigen::MatrixXd::Random(n_elements, 1).array() + 2);
+	Eigen::MatrixXd mus = 1e4 * (Eigen::MatrixXd::Random(n_elements, 1).array() + 2);
+	for (int i = 0; i < 2; ++i)
+	{
+		assembler->update_lame_params(lambdas, mus);
+		const auto fresh = make_assembler();
+		fresh->update_lame_params(lambdas, mus);
+
+		const StiffnessMatrix expected = hessian(*fresh);
+		REQUIRE((hessian(*assembler) - expected).norm() < 1e-12 * expected.norm());
+		REQUIRE((expected - reference).norm() > 1e-3 * reference.norm());
+
+		lambdas(0) *= 2;
+	}
+	REQUIRE(assembler->element_stiffness_store().n_stored() == n_elements);
+}
+
+TEST_CASE("linear_elasticity_element_stiffness", "[assembler]")
+{
+	json in_args = plane_hole_args("LinearElasticity");
+	in_args["space"]["discr_order"] = GENERATE(1, 2);
+
+	State state;
+	init_plane_hole_state(state, in_args);
+
+	LinearElasticity assembler;
+	assembler.set_size(2);
+	assembler.add_multimaterial(0, in_args["materials"], state.units);
+
+	for (int e = 0; e < state.bases.size(); ++e)
+	{
+		ElementAssemblyValues vals;
+		vals.compute(e, false, state.bases[e], state.geom_bases()[e]);
+		const QuadratureVector da = vals.det.array() * vals.quadrature.weights.array();
+
+		const Eigen::MatrixXd expected = pairwise_stiffness(assembler, vals, da);
+		Eigen::MatrixXd local;
+		REQUIRE(assembler.assemble_element(vals, 0, da, local));
+		REQUIRE((local - expected).norm() < 1e-12 * expected.norm());
+	}
+	REQUIRE(assembler.element_stiffness_store().n_stored() == state.bases.size());
+}
+
+TEST_CASE("linear_elasticity_stiffness_store_shear", "[assembler]")
+{
+	json in_args = plane_hole_args("LinearElasticity");
+	in_args["space"]["discr_order"] = 1;
+
+	State state;
+	init_plane_hole_state(state, in_args);
+
+	LinearElasticity assembler;
+	assembler.set_size(2);
+	assembler.add_multimaterial(0, in_args["materials"], state.units);
+
+	const int el_id = 0;
+	ElementAssemblyValues vals;
+	vals.compute(el_id, false, state.bases[el_id], state.geom_bases()[el_id]);
+	const QuadratureVector da = vals.det.array() * vals.quadrature.weights.array();
+
+	Eigen::MatrixXd local;
+	assembler.assemble_element(vals, 0, da, local);
+	REQUIRE(assembler.element_stiffness_store().n_stored() == 1);
+
+	// shear around the centroid: the quadrature point of P1, the area, and the Lamé parameters do not change
+	Eigen::MatrixXd shear(2, 2);
+	shear << 1, 0.5,
+		0, 1;
+	const Eigen::RowVectorXd centroid = vals.val.colwise().mean();
+	ElementAssemblyValues sheared = vals;
+	sheared.val = ((vals.val.rowwise() - centroid) * shear.transpose()).rowwise() + centroid;
+	for (auto &b : sheared.basis_values)
+		b.grad_t_m = b.grad_t_m * shear.inverse();
+
+	const Eigen::MatrixXd expected = pairwise_stiffness(assembler, sheared, da);
+	REQUIRE((expected - local).norm() > 1e-3 * local.norm());
+
+	Eigen::MatrixXd sheared_local;
+	assembler.assemble_element(sheared, 0, da, sheared_local);
+	REQUIRE((sheared_local - expected).norm() < 1e-12 * expected.norm());
+}
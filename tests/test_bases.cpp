@@ -7,6 +7,10 @@
 #include <polyfem/quadrature/HexQuadrature.hpp>
 
 #include <polyfem/basis/LagrangeBasis3d.hpp>
+#include <polyfem/mesh/mesh3D/Mesh3D.hpp>
+#include <polyfem/mesh/MeshNodes.hpp>
+#include <polyfem/utils/par_for.hpp>
+#include <polyfem/State.hpp>
 #include <polyfem/autogen/auto_p_bases.hpp>
 #include <polyfem/autogen/auto_q_bases.hpp>
 
@@ -17,6 +21,7 @@
 #include <catch2/catch_approx.hpp>
 
 #include <iostream>
+#include <thread>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
@@ -835,6 +840,72 @@ TEST_CASE("Pk_3d", "[bases]")
 	}
 }
 
+TEST_CASE("Pk_tabulate", "[bases]")
+{
+	for (int k = 0; k <= polyfem::autogen::MAX_P_BASES + 1; ++k)
+	{
+		for (const bool bernstein : {false, true})
+		{
+			if (bernstein && (k == 0 || k > polyfem::autogen::MAX_P_BASES))
+				continue;
+
+			for (int dim = 2; dim <= 3; ++dim)
+			{
+				Eigen::MatrixXd pts;
+				if (dim == 2)
+				{
+					TriQuadrature rule;
+					Quadrature quad;
+					rule.get_quadrature(8, quad);
+					pts = quad.points;
+				}
+				else
+				{
+					TetQuadrature rule;
+					Quadrature quad;
+					rule.get_quadrature(8, quad);
+					pts = quad.points;
+				}
+
+				Eigen::MatrixXd vals, grads, val;
+				if (dim == 2)
+				{
+					polyfem::autogen::p_tabulate_basis_value_2d(bernstein, k, pts, vals);
+					polyfem::autogen::p_tabulate_grad_basis_value_2d(bernstein, k, pts, grads);
+				}
+				else
+				{
+					polyfem::autogen::p_tabulate_basis_value_3d(bernstein, k, pts, vals);
+					polyfem::autogen::p_tabulate_grad_basis_value_3d(bernstein, k, pts, grads);
+				}
+
+				const int n_bases = dim == 2 ? (k + 1) * (k + 2) / 2 : (k + 1) * (k + 2) * (k + 3) / 6;
+				REQUIRE(vals.rows() == pts.rows());
+				REQUIRE(vals.cols() == n_bases);
+				REQUIRE(grads.cols() == n_bases * dim);
+
+				for (int i = 0; i < n_bases; ++i)
+				{
+					if (dim == 2)
+						polyfem::autogen::p_basis_value_2d(bernstein, k, i, pts, val);
+					else
+						polyfem::autogen::p_basis_value_3d(bernstein, k, i, pts, val);
+					for (int j = 0; j < val.size(); ++j)
+						REQUIRE(vals(j, i) == Catch::Approx(val(j)).margin(1e-10));
+
+					if (dim == 2)
+						polyfem::autogen::p_grad_basis_value_2d(bernstein, k, i, pts, val);
+					else
+						polyfem::autogen::p_grad_basis_value_3d(bernstein, k, i, pts, val);
+					for (int d = 0; d < dim; ++d)
+						for (int j = 0; j < val.rows(); ++j)
+							REQUIRE(grads(j, i * dim + d) == Catch::Approx(val(j, d)).margin(1e-10));
+				}
+			}
+		}
+	}
+}
+
 TEST_CASE("Q1_2d", "[bases]")
 {
 	QuadQuadrature rule;
@@ -1178,3 +1249,107 @@ TEST_CASE("WS_2d", "[bases]")
 		}
 	}
 }
+
+TEST_CASE("parallel_nodes_3d", "[bases]")
+{
+	// Used to init geogram
+	polyfem::State state;
+
+	const auto mesh = polyfem::mesh::Mesh::create(POLYFEM_DATA_DIR + std::string("/contact/meshes/3D/simple/cube.msh"));
+	REQUIRE(mesh);
+	const auto &mesh3d = dynamic_cast<const polyfem::mesh::Mesh3D &>(*mesh);
+
+	const int max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+	const auto build = [&](const int discr_order, const bool lazy, std::shared_ptr<polyfem::mesh::MeshNodes> &mesh_nodes) {
+		std::vector<polyfem::basis::ElementBases> bases;
+		std::vector<polyfem::mesh::LocalBoundary> local_boundary;
+		std::map<int, polyfem::basis::InterfaceData> poly_face_to_data;
+		polyfem::basis::LagrangeBasis3d::build_bases(
+			mesh3d, "Laplacian", -1, -1, discr_order, false, false, false, false, false,
+			bases, local_boundary, poly_face_to_data, mesh_nodes, lazy);
+
+		std::vector<std::vector<int>> global_ids(bases.size());
+		for (size_t e = 0; e < bases.size(); ++e)
+			for (const auto &b : bases[e].bases)
+				global_ids[e].push_back(b.global()[0].index);
+		return global_ids;
+	};
+
+	for (int discr_order = 1; discr_order <= 4; ++discr_order)
+	{
+		// serial lazy numbering, the baseline of the two-phase numbering
+		std::shared_ptr<polyfem::mesh::MeshNodes> reference_nodes;
+		const std::vector<std::vector<int>> reference = build(discr_order, true, reference_nodes);
+
+		for (const int n_threads : {1, max_threads})
+		{
+			polyfem::utils::NThread::get().set_num_threads(n_threads);
+
+			std::shared_ptr<polyfem::mesh::MeshNodes> mesh_nodes;
+			const std::vector<std::vector<int>> global_ids = build(discr_order, false, mesh_nodes);
+
+			REQUIRE(global_ids == reference);
+			REQUIRE(mesh_nodes->n_nodes() == reference_nodes->n_nodes());
+			REQUIRE(mesh_nodes->node_to_primitive() == reference_nodes->node_to_primitive());
+			REQUIRE(mesh_nodes->primitive_to_node() == reference_nodes->primitive_to_node());
+			for (int n = 0; n < reference_nodes->n_nodes(); ++n)
+			{
+				REQUIRE(mesh_nodes->node_position(n) == reference_nodes->node_position(n));
+				REQUIRE(mesh_nodes->is_boundary(n) == reference_nodes->is_boundary(n));
+			}
+		}
+	}
+
+	polyfem::utils::NThread::get().set_num_threads(-1);
+}
+
+TEST_CASE("dof_reordering", "[bases]")
+{
+	const std::string path = POLYFEM_DATA_DIR;
+
+	const auto bandwidth = [](const polyfem::StiffnessMatrix &mat) {
+		int res = 0;
+		for (int k = 0; k < mat.outerSize(); ++k)
+			for (polyfem::StiffnessMatrix::InnerIterator it(mat, k); it; ++it)
+				res = std::max(res, int(std::abs(it.row() - it.col())));
+		return res;
+	};
+
+	std::map<std::string, polyfem::StiffnessMatrix> stiffness;
+	for (const std::string method : {"none", "rcm", "morton"})
+	{
+		json in_args = json({});
+		in_args["geometry"] = {};
+		in_args["geometry"]["mesh"] = path + "/plane_hole.obj";
+		in_args["space"]["discr_order"] = 2;
+		in_args["space"]["advanced"]["dof_reordering"] = method;
+
+		in_args["preset_problem"] = {};
+		in_args["preset_problem"]["type"] = "Linear";
+		in_args["materials"] = {};
+		in_args["materials"]["type"] = "Laplacian";
+
+		polyfem::State state;
+		state.init_logger("", spdlog::level::err, spdlog::level::off, false);
+		state.init(in_args, true);
+		state.load_mesh();
+		state.build_basis();
+
+		for (const auto &bs : state.bases)
+			for (const auto &b : bs.bases)
+				for (const auto &lg : b.global())
+					REQUIRE((state.mesh_nodes->node_position(lg.index) - lg.node).norm() == Catch::Approx(0).margin(1e-12));
+
+		state.build_stiffness_mat(stiffness[method]);
+	}
+
+	const auto &reference = stiffness.at("none");
+	for (const auto &[method, mat] : stiffness)
+	{
+		REQUIRE(mat.rows() == reference.rows());
+		REQUIRE(mat.nonZeros() == reference.nonZeros());
+		REQUIRE(mat.norm() == Catch::Approx(reference.norm()).epsilon(1e-10));
+	}
+	REQUIRE(bandwidth(stiffness.at("rcm")) <= bandwidth(reference));
+}
@@ -1,15 +1,225 @@
 ////////////////////////////////////////////////////////////////////////////////
 #include <polyfem/mesh/mesh2D/CMesh2D.hpp>
+#include <polyfem/mesh/mesh3D/CMesh3D.hpp>
+#include <polyfem/mesh/mesh3D/MeshProcessing3D.hpp>
+#include <polyfem/utils/par_for.hpp>
 #include <polyfem/State.hpp>
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <map>
+#include <thread>
+#include <tuple>
 ////////////////////////////////////////////////////////////////////////////////
 
 using namespace polyfem;
 using namespace polyfem::mesh;
 
+namespace
+{
+	// n x n x n grid of cubes, each split in 6 tets, with faces shared as done by the loaders
+	Mesh3DStorage tet_grid_storage(const int n)
+	{
+		Mesh3DStorage storage;
+		storage.type = MeshType::TET;
+
+		const auto vid = [n](int i, int j, int k) { return uint32_t(i + (n + 1) * (j + (n + 1) * k)); };
+		const int n_vertices = (n + 1) * (n + 1) * (n + 1);
+		storage.points.resize(3, n_vertices);
+		storage.vertices.resize(n_vertices);
+		for (int k = 0; k <= n; ++k)
+			for (int j = 0; j <= n; ++j)
+				for (int i = 0; i <= n; ++i)
+				{
+					storage.points.col(vid(i, j, k)) << i, j, k;
+					storage.vertices[vid(i, j, k)].id = vid(i, j, k);
+					storage.vertices[vid(i, j, k)].v = {double(i), double(j), double(k)};
+				}
+
+		const int cube_tets[6][4] = {{0, 1, 2, 6}, {0, 2, 3, 6}, {0, 3, 7, 6}, {0, 7, 4, 6}, {0, 4, 5, 6}, {0, 5, 1, 6}};
+		std::map<std::array<uint32_t, 3>, int> face_ids;
+		for (int k = 0; k < n; ++k)
+			for (int j = 0; j < n; ++j)
+				for (int i = 0; i < n; ++i)
+				{
+					const uint32_t c[8] = {vid(i, j, k), vid(i + 1, j, k), vid(i + 1, j + 1, k), vid(i, j + 1, k),
+										   vid(i, j, k + 1), vid(i + 1, j, k + 1), vid(i + 1, j + 1, k + 1), vid(i, j + 1, k + 1)};
+					for (const auto &t : cube_tets)
+					{
+						Element h;
+						h.id = storage.elements.size();
+						h.hex = false;
+						for (int lf = 0; lf < 4; ++lf)
+						{
+							std::vector<uint32_t> fvs(3);
+							for (int lv = 0; lv < 3; ++lv)
+								fvs[lv] = c[t[MeshProcessing3D::tet_faces[lf][lv]]];
+							std::array<uint32_t, 3> key = {fvs[0], fvs[1], fvs[2]};
+							std::sort(key.begin(), key.end());
+
+							const auto it = face_ids.find(key);
+							if (it == face_ids.end())
+							{
+								Face f;
+								f.id = storage.faces.size();
+								f.vs = fvs;
+								face_ids[key] = f.id;
+								storage.faces.push_back(f);
+								h.fs.push_back(f.id);
+								h.fs_flag.push_back(true);
+							}
+							else
+							{
+								h.fs.push_back(it->second);
+								h.fs_flag.push_back(false);
+							}
+						}
+						for (int lv = 0; lv < 4; ++lv)
+							h.vs.push_back(c[t[lv]]);
+						storage.elements.push_back(h);
+					}
+				}
+
+		return storage;
+	}
+
+	// serial construction of the TET connectivity as done before build_connectivity was parallelized,
+	// used as a baseline: one tuple sort for the edges and push_backs for every neighbor relation
+	void serial_tet_connectivity(Mesh3DStorage &hmi)
+	{
+		hmi.edges.clear();
+
+		std::vector<bool> bf_flag(hmi.faces.size(), false);
+		for (const auto &h : hmi.elements)
+			for (auto f : h.fs)
+				bf_flag[f] = !bf_flag[f];
+		for (auto &f : hmi.faces)
+			f.boundary = bf_flag[f.id];
+
+		std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>> temp;
+		for (uint32_t i = 0; i < hmi.faces.size(); ++i)
+		{
+			const int fl = hmi.faces[i].vs.size();
+			for (uint32_t j = 0; j < fl; ++j)
+			{
+				uint32_t v0 = hmi.faces[i].vs[j], v1 = hmi.faces[i].vs[(j + 1) % fl];
+				if (v0 > v1)
+					std::swap(v0, v1);
+				temp.push_back(std::make_tuple(v0, v1, i, j));
+			}
+			hmi.faces[i].es.resize(fl);
+		}
+		std::sort(temp.begin(), temp.end());
+		uint32_t E_num = 0;
+		for (uint32_t i = 0; i < temp.size(); ++i)
+		{
+			if (i == 0 || std::get<0>(temp[i]) != std::get<0>(temp[i - 1]) || std::get<1>(temp[i]) != std::get<1>(temp[i - 1]))
+			{
+				Edge e;
+				e.id = E_num++;
+				e.boundary = false;
+				e.vs = {std::get<0>(temp[i]), std::get<1>(temp[i])};
+				hmi.edges.push_back(e);
+			}
+			hmi.faces[std::get<2>(temp[i])].es[std::get<3>(temp[i])] = E_num - 1;
+		}
+
+		for (auto &v : hmi.vertices)
+		{
+			v.boundary = false;
+			v.neighbor_vs.clear();
+			v.neighbor_es.clear();
+			v.neighbor_fs.clear();
+			v.neighbor_hs.clear();
+		}
+		for (const auto &f : hmi.faces)
+			if (f.boundary)
+				for (uint32_t j = 0; j < f.vs.size(); ++j)
+				{
+					hmi.edges[f.es[j]].boundary = true;
+					hmi.vertices[f.vs[j]].boundary = true;
+				}
+
+		for (auto &f : hmi.faces)
+			f.neighbor_hs.clear();
+		for (uint32_t i = 0; i < hmi.elements.size(); ++i)
+			for (auto f : hmi.elements[i].fs)
+				hmi.faces[f].neighbor_hs.push_back(i);
+
+		for (uint32_t i = 0; i < hmi.faces.size(); ++i)
+		{
+			for (auto e : hmi.faces[i].es)
+				hmi.edges[e].neighbor_fs.push_back(i);
+			for (auto v : hmi.faces[i].vs)
+				hmi.vertices[v].neighbor_fs.push_back(i);
+		}
+
+		for (uint32_t i = 0; i < hmi.edges.size(); ++i)
+		{
+			const uint32_t v0 = hmi.edges[i].vs[0], v1 = hmi.edges[i].vs[1];
+			hmi.vertices[v0].neighbor_es.push_back(i);
+			hmi.vertices[v1].neighbor_es.push_back(i);
+			hmi.vertices[v0].neighbor_vs.push_back(v1);
+			hmi.vertices[v1].neighbor_vs.push_back(v0);
+		}
+
+		for (auto &h : hmi.elements)
+			h.es.clear();
+		for (uint32_t i = 0; i < hmi.edges.size(); ++i)
+		{
+			std::vector<uint32_t> nhs;
+			for (auto f : hmi.edges[i].neighbor_fs)
+				nhs.insert(nhs.end(), hmi.faces[f].neighbor_hs.begin(), hmi.faces[f].neighbor_hs.end());
+			std::sort(nhs.begin(), nhs.end());
+			nhs.erase(std::unique(nhs.begin(), nhs.end()), nhs.end());
+			hmi.edges[i].neighbor_hs = nhs;
+			for (auto h : nhs)
+				hmi.elements[h].es.push_back(i);
+		}
+
+		for (uint32_t i = 0; i < hmi.elements.size(); ++i)
+		{
+			std::vector<uint32_t> vs;
+			for (auto f : hmi.elements[i].fs)
+				vs.insert(vs.end(), hmi.faces[f].vs.begin(), hmi.faces[f].vs.end());
+			std::sort(vs.begin(), vs.end());
+			vs.erase(std::unique(vs.begin(), vs.end()), vs.end());
+			hmi.elements[i].vs = vs;
+			for (auto v : vs)
+				hmi.vertices[v].neighbor_hs.push_back(i);
+		}
+
+		hmi.FH.resize(2, hmi.faces.size());
+		hmi.FHi.resize(2, hmi.faces.size());
+		for (const auto &f : hmi.faces)
+			for (int k = 0; k < 2; ++k)
+			{
+				hmi.FH(k, f.id) = -1;
+				hmi.FHi(k, f.id) = -1;
+				if (k >= f.neighbor_hs.size())
+					continue;
+				hmi.FH(k, f.id) = f.neighbor_hs[k];
+				const auto &fs = hmi.elements[f.neighbor_hs[k]].fs;
+				for (int i = 0; i < fs.size(); ++i)
+					if (fs[i] == f.id)
+						hmi.FHi(k, f.id) = i;
+			}
+	}
+
+	std::vector<int> thread_counts()
+	{
+		std::vector<int> counts;
+		const int max_threads = std::max(1u, std::thread::hardware_concurrency());
+		for (int n = 1; n < max_threads; n *= 2)
+			counts.push_back(n);
+		counts.push_back(max_threads);
+		return counts;
+	}
+} // namespace
+
 TEST_CASE("append_2d", "[mesh_test]")
 {
 	// Used to init geogram
@@ -21,3 +231,133 @@ TEST_CASE("append_2d", "[mesh_test]")
 
 	m1->append(m2);
 }
+
+TEST_CASE("compressed_storage_3d", "[mesh_test]")
+{
+	// Used to init geogram
+	State state;
+
+	const auto m = Mesh::create(POLYFEM_DATA_DIR + std::string("/contact/meshes/3D/simple/cube.msh"));
+	REQUIRE(m);
+	const CMesh3D &reference = dynamic_cast<const CMesh3D &>(*m);
+
+	auto m_copy = m->copy();
+	CMesh3D &compressed = dynamic_cast<CMesh3D &>(*m_copy);
+	compressed.set_compressed_storage(true);
+	REQUIRE(compressed.is_storage_compressed());
+
+	REQUIRE(compressed.n_vertices() == reference.n_vertices());
+	REQUIRE(compressed.n_edges() == reference.n_edges());
+	REQUIRE(compressed.n_faces() == reference.n_faces());
+	REQUIRE(compressed.n_cells() == reference.n_cells());
+
+	for (int c = 0; c < reference.n_cells(); ++c)
+	{
+		REQUIRE(compressed.n_cell_vertices(c) == reference.n_cell_vertices(c));
+		for (int lv = 0; lv < reference.n_cell_vertices(c); ++lv)
+			REQUIRE(compressed.cell_vertex(c, lv) == reference.cell_vertex(c, lv));
+		for (int lf = 0; lf < reference.n_cell_faces(c); ++lf)
+			REQUIRE(compressed.cell_face(c, lf) == reference.cell_face(c, lf));
+		for (int le = 0; le < reference.n_cell_edges(c); ++le)
+			REQUIRE(compressed.cell_edge(c, le) == reference.cell_edge(c, le));
+
+		const auto idx0 = reference.switch_face(reference.switch_edge(reference.get_index_from_element(c)));
+		const auto idx1 = compressed.switch_face(compressed.switch_edge(compressed.get_index_from_element(c)));
+		REQUIRE(idx0.vertex == idx1.vertex);
+		REQUIRE(idx0.edge == idx1.edge);
+		REQUIRE(idx0.face == idx1.face);
+		REQUIRE(reference.switch_element(idx0).element == compressed.switch_element(idx1).element);
+	}
+
+	for (int v = 0; v < reference.n_vertices(); ++v)
+		REQUIRE(compressed.vertex_neighs(v) == reference.vertex_neighs(v));
+
+	for (int f = 0; f < reference.n_faces(); ++f)
+		REQUIRE(compressed.is_boundary_face(f) == reference.is_boundary_face(f));
+
+	compressed.refine(1, 0.5);
+	REQUIRE(compressed.is_storage_compressed());
+	REQUIRE(compressed.n_cells() == 8 * reference.n_cells());
+
+	compressed.set_compressed_storage(false);
+	REQUIRE(!compressed.is_storage_compressed());
+}
+
+TEST_CASE("parallel_connectivity_3d", "[mesh_test]")
+{
+	// 82944 tets, so every radix sort spans several 65536-key chunks
+	const Mesh3DStorage input = tet_grid_storage(24);
+	REQUIRE(input.elements.size() > (1 << 16));
+
+	Mesh3DStorage reference = input;
+	serial_tet_connectivity(reference);
+
+	for (const int n_threads : thread_counts())
+	{
+		utils::NThread::get().set_num_threads(n_threads);
+		Mesh3DStorage storage = input;
+		MeshProcessing3D::build_connectivity(storage);
+
+		REQUIRE(storage.edges.size() == reference.edges.size());
+
+		bool same_vertices = true;
+		for (int v = 0; v < reference.vertices.size(); ++v)
+		{
+			same_vertices &= storage.vertices[v].neighbor_vs == reference.vertices[v].neighbor_vs;
+			same_vertices &= storage.vertices[v].neighbor_es == reference.vertices[v].neighbor_es;
+			same_vertices &= storage.vertices[v].neighbor_fs == reference.vertices[v].neighbor_fs;
+			same_vertices &= storage.vertices[v].neighbor_hs == reference.vertices[v].neighbor_hs;
+			same_vertices &= storage.vertices[v].boundary == reference.vertices[v].boundary;
+		}
+		CHECK(same_vertices);
+
+		bool same_edges = true;
+		for (int e = 0; e < reference.edges.size(); ++e)
+		{
+			same_edges &= storage.edges[e].vs == reference.edges[e].vs;
+			same_edges &= storage.edges[e].neighbor_fs == reference.edges[e].neighbor_fs;
+			same_edges &= storage.edges[e].neighbor_hs == reference.edges[e].neighbor_hs;
+			same_edges &= storage.edges[e].boundary == reference.edges[e].boundary;
+		}
+		CHECK(same_edges);
+
+		bool same_faces = true;
+		for (int f = 0; f < reference.faces.size(); ++f)
+		{
+			same_faces &= storage.faces[f].es == reference.faces[f].es;
+			same_faces &= storage.faces[f].neighbor_hs == reference.faces[f].neighbor_hs;
+			same_faces &= storage.faces[f].boundary == reference.faces[f].boundary;
+		}
+		CHECK(same_faces);
+
+		bool same_elements = true;
+		for (int h = 0; h < reference.elements.size(); ++h)
+		{
+			same_elements &= storage.elements[h].vs == reference.elements[h].vs;
+			same_elements &= storage.elements[h].es == reference.elements[h].es;
+		}
+		CHECK(same_elements);
+
+		CHECK(storage.FH == reference.FH);
+		CHECK(storage.FHi == reference.FHi);
+	}
+
+	utils::NThread::get().set_num_threads(-1);
+}
+
+TEST_CASE("parallel_connectivity_3d_benchmark", "[.][mesh_test][benchmark]")
+{
+	const Mesh3DStorage input = tet_grid_storage(40);
+
+	for (const int n_threads : thread_counts())
+	{
+		utils::NThread::get().set_num_threads(n_threads);
+		BENCHMARK_ADVANCED("build_connectivity " + std::to_string(n_threads) + " threads")(Catch::Benchmark::Chronometer meter)
+		{
+			std::vector<Mesh3DStorage> storages(meter.runs(), input);
+			meter.measure([&](int i) { MeshProcessing3D::build_connectivity(storages[i]); });
+		};
+	}
+
+	utils::NThread::get().set_num_threads(-1);
+}
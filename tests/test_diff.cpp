@@ -2,6 +2,7 @@
 #include <polyfem/assembler/AssemblerUtils.hpp>
 #include <iostream>
 #include <fstream>
+#include <filesystem>
 #include <cmath>
 
 #include <polyfem/State.hpp>
@@ -13,9 +14,13 @@
 #include <polyfem/solver/forms/parametrization/Parametrizations.hpp>
 #include <polyfem/solver/forms/parametrization/NodeCompositeParametrizations.hpp>
 #include <polyfem/solver/AdjointNLProblem.hpp>
+#include <polyfem/utils/par_for.hpp>
+#include <polyfem/time_integrator/BDF.hpp>
 
 #include <finitediff.hpp>
 
+#include <Eigen/SparseLU>
+
 #include <catch2/catch_all.hpp>
 #include <math.h>
 ////////////////////////////////////////////////////////////////////////////////
@@ -173,6 +178,113 @@ namespace
 
 		return {obj, var2sim, states};
 	}
+
+	/// solves A x = b on the rows and columns of the free DOFs with a direct sparse LU, x = 0 on the Dirichlet nodes
+	Eigen::MatrixXd direct_dirichlet_solve(const StiffnessMatrix &A, const Eigen::MatrixXd &b, const std::vector<int> &boundary_nodes)
+	{
+		std::vector<int> free_id(A.rows(), 0);
+		for (int i : boundary_nodes)
+			free_id[i] = -1;
+		int n_free = 0;
+		for (int i = 0; i < A.rows(); ++i)
+			if (free_id[i] >= 0)
+				free_id[i] = n_free++;
+
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int k = 0; k < A.outerSize(); ++k)
+			for (StiffnessMatrix::InnerIterator it(A, k); it; ++it)
+				if (free_id[it.row()] >= 0 && free_id[it.col()] >= 0)
+					entries.emplace_back(free_id[it.row()], free_id[it.col()], it.value());
+		StiffnessMatrix A_free(n_free, n_free);
+		A_free.setFromTriplets(entries.begin(), entries.end());
+
+		Eigen::MatrixXd b_free(n_free, b.cols());
+		for (int i = 0; i < A.rows(); ++i)
+			if (free_id[i] >= 0)
+				b_free.row(free_id[i]) = b.row(i);
+
+		Eigen::SparseLU<StiffnessMatrix> solver;
+		solver.compute(A_free);
+		REQUIRE(solver.info() == Eigen::Success);
+		const Eigen::MatrixXd x_free = solver.solve(b_free);
+
+		Eigen::MatrixXd x = Eigen::MatrixXd::Zero(A.rows(), b.cols());
+		for (int i = 0; i < A.rows(); ++i)
+			if (free_id[i] >= 0)
+				x.row(i) = x_free.row(free_id[i]);
+		return x;
+	}
+
+	/// adjoint of a transient state, going backward in time and solving the adjoint system of every step with a direct sparse LU
+	Eigen::MatrixXd direct_transient_adjoint(State &state, const Eigen::MatrixXd &adjoint_rhs)
+	{
+		const double dt = state.args["time"]["dt"];
+		const int time_steps = state.args["time"]["time_steps"];
+		const int bdf_order = state.args["time"]["integrator"].is_string() || state.args["time"]["integrator"]["type"] == "ImplicitEuler"
+								  ? 1
+								  : state.args["time"]["integrator"]["steps"].get<int>();
+		const std::vector<int> &boundary_nodes = state.boundary_nodes;
+
+		// mass with the Dirichlet rows replaced by identity
+		std::vector<bool> is_boundary(state.ndof(), false);
+		for (int i : boundary_nodes)
+			is_boundary[i] = true;
+		std::vector<Eigen::Triplet<double>> entries;
+		for (int k = 0; k < state.mass.outerSize(); ++k)
+			for (StiffnessMatrix::InnerIterator it(state.mass, k); it; ++it)
+				if (!is_boundary[it.row()])
+					entries.emplace_back(it.row(), it.col(), it.value());
+		for (int i : boundary_nodes)
+			entries.emplace_back(i, i, 1.);
+		StiffnessMatrix reduced_mass(state.mass.rows(), state.mass.cols());
+		reduced_mass.setFromTriplets(entries.begin(), entries.end());
+
+		const int n_cols = time_steps + 1;
+		Eigen::MatrixXd adjoint = Eigen::MatrixXd::Zero(state.ndof(), 2 * n_cols);
+		for (int i = time_steps; i >= 0; --i)
+		{
+			const int num = std::min(bdf_order, time_steps - i);
+			Eigen::VectorXd bdf_coeffs = Eigen::VectorXd::Zero(num);
+			for (int j = 0; j < bdf_order && i + j < time_steps; ++j)
+				bdf_coeffs(j) = -time_integrator::BDF::alphas(std::min(bdf_order - 1, i + j))[j];
+			const Eigen::VectorXd sum_alpha_p = adjoint.middleCols(i + 1, num) * bdf_coeffs;
+			const Eigen::VectorXd sum_alpha_nu = adjoint.middleCols(n_cols + i + 1, num) * bdf_coeffs;
+
+			Eigen::VectorXd rhs = -reduced_mass.transpose() * sum_alpha_nu - adjoint_rhs.col(i);
+			for (int j = 1; j <= bdf_order && i + j <= time_steps; j++)
+			{
+				StiffnessMatrix gradu_h_prev;
+				state.compute_force_jacobian_prev(i + j, i, state.diff_cached.load(i + j)->friction_collision_set, gradu_h_prev);
+				Eigen::VectorXd tmp = adjoint.col(i + j) * (time_integrator::BDF::betas(state.diff_cached.bdf_order(i + j) - 1) * dt);
+				tmp(boundary_nodes).setZero();
+				rhs -= gradu_h_prev.transpose() * tmp;
+			}
+
+			if (i == 0)
+			{
+				adjoint.col(0) = -reduced_mass.transpose() * sum_alpha_p;
+				adjoint.col(n_cols) = rhs;
+				continue;
+			}
+
+			const double beta_dt = time_integrator::BDF::betas(state.diff_cached.bdf_order(i) - 1) * dt;
+			const StiffnessMatrix gradu_h = state.diff_cached.load(i)->gradu_h;
+			rhs += (1. / beta_dt) * (gradu_h - reduced_mass).transpose() * sum_alpha_p;
+
+			const StiffnessMatrix A = gradu_h.transpose();
+			adjoint.col(i + n_cols) = direct_dirichlet_solve(A, rhs, boundary_nodes);
+
+			Eigen::VectorXd tmp = rhs(boundary_nodes);
+			if (i + 1 < n_cols)
+				tmp += (-2. / beta_dt) * adjoint(boundary_nodes, i + 1);
+			if (i + 2 < n_cols)
+				tmp += (1. / beta_dt) * adjoint(boundary_nodes, i + 2);
+			tmp -= (A * adjoint.col(i + n_cols))(boundary_nodes);
+			adjoint(boundary_nodes, i + n_cols) = tmp;
+			adjoint.col(i) = beta_dt * adjoint.col(i + n_cols) - sum_alpha_p;
+		}
+		return adjoint;
+	}
 } // namespace
 
 TEST_CASE("laplacian", "[test_adjoint]")
@@ -323,6 +435,57 @@ TEST_CASE("neohookean-stress-3d", tagsdiff)
 	verify_adjoint(*nl_problem, x, velocity_discrete, 1e-7, 1e-5);
 }
 
+TEST_CASE("surrogate-line-search", "[test_adjoint]")
+{
+	json opt_args;
+	load_json(append_root_path("neohookean-stress-3d-opt.json"), opt_args);
+	json reference_args = opt_args;
+	auto [obj, var2sim, states] = prepare_test(opt_args);
+	auto [reference_obj, reference_var2sim, reference_states] = prepare_test(reference_args);
+
+	opt_args["solver"]["advanced"]["surrogate_line_search"] = 2;
+	auto nl_problem = std::make_shared<AdjointNLProblem>(obj, var2sim, states, opt_args);
+	auto reference_problem = std::make_shared<AdjointNLProblem>(reference_obj, reference_var2sim, reference_states, reference_args);
+
+	Eigen::MatrixXd V;
+	states[0]->get_vertices(V);
+	const Eigen::VectorXd x0 = utils::flatten(V);
+
+	nl_problem->solution_changed(x0);
+	Eigen::VectorXd grad0;
+	nl_problem->gradient(x0, grad0);
+	REQUIRE(nl_problem->n_forward_solves() == 1);
+	REQUIRE(nl_problem->n_surrogate_solves() == 0);
+
+	// an ascent trial, the surrogate rejects it without a forward solve
+	const Eigen::VectorXd x1 = x0 + 1e-4 * grad0.normalized();
+	nl_problem->line_search_begin(x0, x1);
+	nl_problem->solution_changed(x1);
+	nl_problem->line_search_end();
+	CHECK(nl_problem->n_surrogate_solves() == 1);
+	CHECK(nl_problem->n_surrogate_rejections() == 1);
+	CHECK(nl_problem->n_forward_solves() == 1);
+
+	// the same trial without surrogate
+	reference_problem->solution_changed(x0);
+	reference_problem->line_search_begin(x0, x1);
+	reference_problem->solution_changed(x1);
+	reference_problem->line_search_end();
+	CHECK(reference_problem->n_surrogate_solves() == 0);
+	CHECK(reference_problem->n_forward_solves() == 2);
+
+	// the value and the gradient afterwards come from actual forward solves
+	const double reference_value = reference_problem->value(x1);
+	Eigen::VectorXd reference_grad;
+	reference_problem->gradient(x1, reference_grad);
+
+	Eigen::VectorXd grad1;
+	nl_problem->gradient(x1, grad1);
+	CHECK(nl_problem->value(x1) == Catch::Approx(reference_value).epsilon(1e-6));
+	CHECK((grad1 - reference_grad).norm() <= 1e-5 * reference_grad.norm());
+	CHECK(nl_problem->n_forward_solves() == 2);
+}
+
 TEST_CASE("shape-neumann-nodes", "[test_adjoint]")
 {
 	const std::string path = POLYFEM_DIFF_DIR + std::string("/input/");
@@ -937,6 +1100,97 @@ TEST_CASE("shape-contact", "[test_adjoint]")
 	verify_adjoint(*nl_problem, x, one_form.normalized(), 1e-7, 1e-5);
 }
 
+TEST_CASE("warm-start-dof-reordering", "[test_adjoint]")
+{
+	json in_args = R"(
+	{
+		"geometry": {
+			"surface_selection": 7
+		},
+		"space": {
+			"discr_order": 2,
+			"advanced": {
+				"dof_reordering": "morton"
+			}
+		},
+		"preset_problem": {
+			"type": "ElasticExact"
+		},
+		"materials": {
+			"type": "NeoHookean",
+			"E": 1e5,
+			"nu": 0.3
+		},
+		"solver": {
+			"advanced": {
+				"warm_start": true
+			}
+		}
+	})"_json;
+	in_args["geometry"]["mesh"] = POLYFEM_DATA_DIR + std::string("/plane_hole.obj");
+
+	auto state_ptr = AdjointOptUtils::create_state(in_args, solver::CacheLevel::Derivatives, -1);
+	State &state = *state_ptr;
+	AdjointOptUtils::solve_pde(state);
+
+	REQUIRE(!state.dof_ordering.empty());
+	REQUIRE(state.warm_start_sol.cols() == 1);
+	Eigen::MatrixXd sol = Eigen::MatrixXd::Zero(state.ndof(), 1);
+	REQUIRE(state.apply_warm_start(0, sol));
+	REQUIRE((sol - state.diff_cached.u(0)).norm() == 0);
+
+	// the warm start only changes the initial guess: on a slightly scaled mesh, whose normalized morton ordering is
+	// the same, the warm solve converges to the cold solution in fewer Newton iterations
+	const auto scale_mesh = [](State &s) {
+		for (int v = 0; v < s.mesh->n_vertices(); ++v)
+			s.mesh->set_point(v, 1.01 * s.mesh->point(v));
+		s.build_basis();
+	};
+	const auto newton_iterations = [](const State &s) {
+		int iterations = 0;
+		for (const auto &info : s.stats.solver_info)
+			iterations += info["info"]["iterations"].get<int>();
+		return iterations;
+	};
+
+	json cold_args = in_args;
+	cold_args["solver"]["advanced"]["warm_start"] = false;
+	auto cold_ptr = AdjointOptUtils::create_state(cold_args, solver::CacheLevel::Derivatives, -1);
+	State &cold = *cold_ptr;
+	scale_mesh(cold);
+	AdjointOptUtils::solve_pde(cold);
+	REQUIRE(cold.warm_start_sol.size() == 0);
+
+	const std::vector<int> unscaled_ordering = state.dof_ordering;
+	scale_mesh(state);
+	REQUIRE(state.dof_ordering == unscaled_ordering);
+	REQUIRE(state.dof_ordering == cold.dof_ordering);
+	AdjointOptUtils::solve_pde(state);
+
+	const Eigen::MatrixXd &warm_sol = state.diff_cached.u(0);
+	const Eigen::MatrixXd &cold_sol = cold.diff_cached.u(0);
+	CHECK((warm_sol - cold_sol).norm() <= 1e-6 * cold_sol.norm());
+	CHECK(newton_iterations(state) < newton_iterations(cold));
+
+	// the rotated mesh has the same size but a different morton ordering, the stored solution does not match its nodes
+	const std::vector<int> old_ordering = state.dof_ordering;
+	for (int v = 0; v < state.mesh->n_vertices(); ++v)
+	{
+		const RowVectorNd p = state.mesh->point(v);
+		state.mesh->set_point(v, (RowVectorNd(2) << -p(1), p(0)).finished());
+	}
+	state.build_basis();
+
+	REQUIRE(state.dof_ordering != old_ordering);
+	sol.setZero();
+	CHECK(!state.apply_warm_start(0, sol));
+	CHECK(sol.norm() == 0);
+
+	// the next solve stores a warm start on the new ordering
+	AdjointOptUtils::solve_pde(state);
+	CHECK(state.apply_warm_start(0, sol));
+}
+
 TEST_CASE("node-trajectory", "[test_adjoint]")
 {
 	const std::string path = POLYFEM_DIFF_DIR + std::string("/input/");
@@ -972,6 +1226,42 @@ TEST_CASE("node-trajectory", "[test_adjoint]")
 	verify_adjoint(*nl_problem, x, velocity_discrete, 1e-5, 1e-4);
 }
 
+TEST_CASE("batched-adjoint", "[test_adjoint]")
+{
+	const std::string path = POLYFEM_DIFF_DIR + std::string("/input/");
+	for (const std::string name : {"linear_elasticity-surface-3d", "damping-transient"})
+	{
+		json in_args;
+		load_json(path + name + ".json", in_args);
+		std::shared_ptr<State> state_ptr = create_state_and_solve(in_args);
+		State &state = *state_ptr;
+
+		const int n_cols = state.problem->is_time_dependent() ? state.args["time"]["time_steps"].get<int>() + 1 : 1;
+		std::vector<Eigen::MatrixXd> rhs;
+		for (int i = 0; i < 3; ++i)
+			rhs.push_back(Eigen::MatrixXd::Random(state.ndof(), n_cols));
+
+		const std::vector<Eigen::MatrixXd> adjoints = state.solve_adjoints(rhs);
+		REQUIRE(adjoints.size() == rhs.size());
+		for (int i = 0; i < rhs.size(); ++i)
+		{
+			if (state.problem->is_time_dependent())
+			{
+				const Eigen::MatrixXd reference = direct_transient_adjoint(state, rhs[i]);
+				REQUIRE((adjoints[i] - reference).norm() <= 1e-8 * std::max(1., reference.norm()));
+			}
+			else
+			{
+				// the Dirichlet rows of the static adjoint depend on the solver path, compare the free DOFs
+				const Eigen::MatrixXd reference = direct_dirichlet_solve(state.diff_cached.gradu_h(0), rhs[i], state.boundary_nodes);
+				Eigen::MatrixXd adjoint = adjoints[i];
+				adjoint(state.boundary_nodes, Eigen::all).setZero();
+				REQUIRE((adjoint - reference).norm() <= 1e-8 * std::max(1., reference.norm()));
+			}
+		}
+	}
+}
+
 TEST_CASE("damping-transient", "[test_adjoint]")
 {
 	const std::string path = POLYFEM_DIFF_DIR + std::string("/input/");
@@ -1010,6 +1300,57 @@ TEST_CASE("damping-transient", "[test_adjoint]")
 	verify_adjoint(*nl_problem, x, velocity_discrete, opt_args["solver"]["nonlinear"]["debug_fd_eps"], 1e-4);
 }
 
+TEST_CASE("damping-transient-parallel", "[test_adjoint]")
+{
+	const std::string path = POLYFEM_DIFF_DIR + std::string("/input/");
+
+	// independent: the optimized and the reference states are solved in the same level
+	// dependent: the optimized state is the initial guess of the reference state and of a copy of it,
+	// so the parent runs alone in the first level and both children run concurrently in the second one
+	const bool dependent = GENERATE(false, true);
+
+	const auto evaluate = [&](const bool solve_in_parallel) {
+		json in_args, in_args_ref, opt_args;
+		load_json(path + "damping-transient.json", in_args);
+		load_json(path + "damping-transient-target.json", in_args_ref);
+		load_json(path + "damping-transient-opt.json", opt_args);
+		opt_args = AdjointOptUtils::apply_opt_json_spec(opt_args, false);
+		opt_args["solver"]["advanced"]["solve_in_parallel"] = solve_in_parallel;
+
+		std::shared_ptr<State> state_ptr = AdjointOptUtils::create_state(in_args, solver::CacheLevel::Derivatives, -1);
+		std::shared_ptr<State> state_reference = AdjointOptUtils::create_state(in_args_ref, solver::CacheLevel::Derivatives, -1);
+
+		VariableToSimulationGroup variable_to_simulations;
+		variable_to_simulations.push_back(std::make_unique<DampingCoeffientVariableToSimulation>(state_ptr, CompositeParametrization()));
+
+		std::vector<std::shared_ptr<State>> states = {state_ptr, state_reference};
+		if (dependent)
+		{
+			states.push_back(AdjointOptUtils::create_state(in_args_ref, solver::CacheLevel::Derivatives, -1));
+			opt_args["states"].push_back(opt_args["states"][1]);
+			opt_args["states"][1]["initial_guess"] = 0;
+			opt_args["states"][2]["initial_guess"] = 0;
+		}
+		auto obj = AdjointOptUtils::create_form(opt_args["functionals"], variable_to_simulations, states);
+		auto nl_problem = std::make_shared<AdjointNLProblem>(obj, variable_to_simulations, states, opt_args);
+
+		Eigen::VectorXd x(2);
+		x << state_ptr->args["materials"]["psi"], state_ptr->args["materials"]["phi"];
+		x *= 1.1;
+
+		nl_problem->solution_changed(x);
+		const double value = nl_problem->value(x);
+		Eigen::VectorXd gradient;
+		nl_problem->gradient(x, gradient);
+		return std::make_pair(value, gradient);
+	};
+
+	const auto [serial_value, serial_gradient] = evaluate(false);
+	const auto [parallel_value, parallel_gradient] = evaluate(true);
+	REQUIRE(parallel_value == Catch::Approx(serial_value).epsilon(1e-10));
+	REQUIRE((parallel_gradient - serial_gradient).norm() <= 1e-8 * serial_gradient.norm());
+}
+
 TEST_CASE("material-transient", "[test_adjoint]")
 {
 	json opt_args;
@@ -1069,6 +1410,77 @@ TEST_CASE("shape-transient-friction-sdf", "[test_adjoint]")
 	verify_adjoint(*nl_problem, x, velocity_discrete, 1e-7, 1e-5);
 }
 
+TEST_CASE("transient-adjoint-parallel", "[test_adjoint]")
+{
+	// the time steps of the transient shape and material derivatives are accumulated in parallel, also when the
+	// steps evicted from the adjoint cache are loaded back
+	const std::string name = GENERATE("shape-transient-friction-opt.json", "material-transient-opt.json");
+	const int resident_steps = GENERATE(-1, 2);
+
+	// a new problem for every run, the gradient is cached in the problem
+	const auto gradient = [&](const int n_threads) {
+		utils::NThread::get().set_num_threads(n_threads);
+
+		json opt_args;
+		load_json(append_root_path(name), opt_args);
+		auto [obj, var2sim, states] = prepare_test(opt_args);
+		for (auto &state : states)
+			state->args["solver"]["advanced"]["adjoint_resident_steps"] = resident_steps;
+
+		auto nl_problem = std::make_shared<AdjointNLProblem>(obj, var2sim, states, opt_args);
+
+		const Eigen::VectorXd x = var2sim[0]->inverse_eval();
+		nl_problem->solution_changed(x);
+		Eigen::VectorXd one_form;
+		nl_problem->gradient(x, one_form);
+		return one_form;
+	};
+
+	const Eigen::VectorXd serial = gradient(1);
+	const Eigen::VectorXd parallel = gradient(-1);
+	utils::NThread::get().set_num_threads(-1);
+
+	REQUIRE(serial.norm() > 0);
+	REQUIRE((parallel - serial).norm() <= 1e-8 * serial.norm());
+}
+
+TEST_CASE("transient-adjoint-checkpointing", "[test_adjoint]")
+{
+	// the force Jacobians and collision sets evicted from memory are recomputed or read back from the scratch file
+	const auto gradient = [](const int resident_steps, const std::string &scratch_file) {
+		json opt_args;
+		load_json(append_root_path("shape-transient-friction-opt.json"), opt_args);
+		auto [obj, var2sim, states] = prepare_test(opt_args);
+		for (auto &state : states)
+		{
+			state->args["solver"]["advanced"]["adjoint_resident_steps"] = resident_steps;
+			state->args["solver"]["advanced"]["adjoint_scratch_file"] = scratch_file;
+		}
+
+		auto nl_problem = std::make_shared<AdjointNLProblem>(obj, var2sim, states, opt_args);
+
+		Eigen::MatrixXd V;
+		states[0]->get_vertices(V);
+		const Eigen::VectorXd x = utils::flatten(V);
+
+		nl_problem->solution_changed(x);
+		Eigen::VectorXd one_form;
+		nl_problem->gradient(x, one_form);
+		return one_form;
+	};
+
+	const Eigen::VectorXd reference = gradient(-1, "");
+
+	const std::string scratch_file = (std::filesystem::temp_directory_path() / "polyfem_adjoint_scratch.bin").string();
+	for (const std::string &file : {std::string(), scratch_file})
+	{
+		// 2 is raised to DiffCache::MIN_RESIDENT_STEPS, fewer than the time steps of the problem
+		const Eigen::VectorXd checkpointed = gradient(2, file);
+		REQUIRE((checkpointed - reference).norm() <= 1e-8 * reference.norm());
+	}
+	std::filesystem::remove(scratch_file);
+}
+
 TEST_CASE("3d-shape-mesh-target", "[.][test_adjoint]")
 {
 	json opt_args;
@@ -68,6 +68,39 @@ namespace
 			}
 			)"_json;
 		}
+		else if (material_type == "LinearElasticity")
+		{
+			material = R"(
+			{
+				"type": "LinearElasticity",
+				"E": 20000,
+				"nu": 0.3,
+				"rho": 1000
+			}
+			)"_json;
+		}
+		else if (material_type == "LinearElasticityTimeDependent")
+		{
+			material = R"(
+			{
+				"type": "LinearElasticity",
+				"E": "20000 * (1 + t)",
+				"nu": 0.3,
+				"rho": 1000
+			}
+			)"_json;
+		}
+		else if (material_type == "SaintVenant")
+		{
+			material = R"(
+			{
+				"type": "SaintVenant",
+				"E": 20000,
+				"nu": 0.3,
+				"rho": 1000
+			}
+			)"_json;
+		}
 		else
 			assert(false);
 
@@ -303,7 +336,7 @@ TEST_CASE("contact form derivatives", "[form][form_derivatives][contact_form]")
 TEST_CASE("elastic form derivatives", "[form][form_derivatives][elastic_form]")
 {
 	const int dim = GENERATE(2, 3);
-	const auto state_ptr = get_state(dim, GENERATE("NeoHookean", "MooneyRivlin3ParamSymbolic"));
+	const auto state_ptr = get_state(dim, GENERATE("NeoHookean", "MooneyRivlin3ParamSymbolic", "SaintVenant"));
 	ElasticForm form(
 		state_ptr->n_bases,
 		state_ptr->bases,
@@ -316,6 +349,44 @@ TEST_CASE("elastic form derivatives", "[form][form_derivatives][elastic_form]")
 	test_form(form, *state_ptr, 1e-7);
 }
 
+TEST_CASE("linear elastic form", "[form][elastic_form]")
+{
+	const int dim = GENERATE(2, 3);
+	const std::string material = GENERATE("LinearElasticity", "LinearElasticityTimeDependent");
+	const auto state_ptr = get_state(dim, material);
+	const State &state = *state_ptr;
+	const double dt = state.args["time"]["dt"];
+
+	REQUIRE(state.assembler->has_time_dependent_params() == (material == "LinearElasticityTimeDependent"));
+
+	ElasticForm form(
+		state.n_bases,
+		state_ptr->bases,
+		state.geom_bases(),
+		*state.assembler,
+		state_ptr->ass_vals_cache,
+		0,
+		dt,
+		state.mesh->is_volume());
+
+	// the energy and gradient from the cached stiffness match the element assembly, also after moving the time
+	const Eigen::VectorXd x = 1e-2 * Eigen::VectorXd::Random(state.n_bases * dim);
+	const double t = 0.5;
+	form.update_quantities(t, x);
+
+	const double energy = state.assembler->assemble_energy(
+		state.mesh->is_volume(), state.bases, state.geom_bases(), state.ass_vals_cache, t, dt, x, x);
+	CHECK(abs(form.value(x) - energy) < 1e-10 * abs(energy));
+	CHECK(abs(form.value_per_element(x).sum() - energy) < 1e-10 * abs(energy));
+
+	Eigen::MatrixXd grad;
+	state.assembler->assemble_gradient(
+		state.mesh->is_volume(), state.n_bases, state.bases, state.geom_bases(), state.ass_vals_cache, t, dt, x, x, grad);
+	Eigen::VectorXd form_grad;
+	form.first_derivative(x, form_grad);
+	CHECK((form_grad - grad).norm() < 1e-10 * grad.norm());
+}
+
 TEST_CASE("pressure form derivatives", "[form][form_derivatives][pressure_form]")
 {
 	const int dim = GENERATE(3);
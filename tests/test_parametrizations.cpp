@@ -66,4 +66,47 @@ TEST_CASE("bbw-test", "[parametrization]")
 	verify_apply_jacobian(lbs_with_bbw, y);
 }
 
+TEST_CASE("composite-affine-jacobian", "[parametrization]")
+{
+	// affine maps around non-affine ones, so that some are composed into cached Jacobians
+	CompositeParametrization composite({std::make_shared<ExponentialMap>(0, 3),
+										std::make_shared<Scaling>(2.0),
+										std::make_shared<InsertConstantMap>(3, 0.5, 2),
+										std::make_shared<PowerMap>(2, 1, 4),
+										std::make_shared<Scaling>(0.5, 3, 7),
+										std::make_shared<SliceMap>(1, 8, 9),
+										std::make_shared<ScalarVelocityParametrization>(1, 0.1)});
+
+	Eigen::VectorXd x;
+	x.setRandom(6);
+	const Eigen::VectorXd y = composite.eval(x);
+	REQUIRE(y.size() == composite.size(x.size()));
+
+	Eigen::MatrixXd dydx(x.size(), y.size());
+	double eps = 1e-7;
+	for (int i = 0; i < x.size(); ++i)
+	{
+		Eigen::VectorXd x_ = x;
+		x_(i) += eps;
+		auto y_plus = composite.eval(x_);
+		x_(i) -= 2 * eps;
+		auto y_minus = composite.eval(x_);
+		dydx.row(i) = (y_plus - y_minus) / (2 * eps);
+	}
+
+	// twice, the second time from the cache
+	for (int k = 0; k < 2; ++k)
+	{
+		for (int i = 0; i < y.size(); ++i)
+		{
+			Eigen::VectorXd grad_y;
+			grad_y.setZero(y.size());
+			grad_y(i) = 1;
+
+			const Eigen::VectorXd grad_x = composite.apply_jacobian(grad_y, x);
+			REQUIRE((grad_x - (dydx * grad_y)).norm() < 1e-7);
+		}
+	}
+}
+
 #endif
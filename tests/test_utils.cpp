@@ -6,12 +6,22 @@
 #include <polyfem/io/MshReader.hpp>
 #include <polyfem/mesh/Mesh.hpp>
 #include <polyfem/utils/MatrixUtils.hpp>
+#include <polyfem/utils/SVDBatch.hpp>
+#include <polyfem/utils/SurfaceDistance.hpp>
+#include <polyfem/utils/LazyCubicInterpolator.hpp>
+#include <polyfem/utils/svd.hpp>
 
 #include <wmtk/TriMesh.h>
 
+#include <igl/point_simplex_squared_distance.h>
+
 #include <Eigen/Dense>
 
+#include <filesystem>
+#include <fstream>
+
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
 #include <catch2/catch_approx.hpp>
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -116,6 +126,56 @@ TEST_CASE("mshreader", "[utils]")
 	REQUIRE(mesh);
 }
 
+TEST_CASE("mshreader_flat", "[utils]")
+{
+	// two P1 triangles in physical group 5, one P2 triangle in physical group 7, and a line element that is skipped
+	const std::string mesh_path = (std::filesystem::temp_directory_path() / "polyfem_mshreader_flat.msh").string();
+	{
+		std::ofstream out(mesh_path);
+		out << "$MeshFormat\n4.1 0 8\n$EndMeshFormat\n"
+			<< "$Entities\n0 1 2 0\n"
+			<< "1 0 0 0 1 0 0 0 0\n"
+			<< "1 0 0 0 1 1 0 1 5 0\n"
+			<< "2 1 0 0 2 1 0 1 7 0\n"
+			<< "$EndEntities\n"
+			<< "$Nodes\n2 8 1 8\n"
+			<< "2 1 0 4\n1\n2\n3\n4\n0 0 0\n1 0 0\n1 1 0\n0 1 0\n"
+			<< "2 2 0 4\n5\n6\n7\n8\n2 0 0\n1.5 0 0\n1.5 0.5 0\n1 0.5 0\n"
+			<< "$EndNodes\n"
+			<< "$Elements\n3 4 1 10\n"
+			<< "1 1 1 1\n10 1 2\n"
+			<< "2 1 2 2\n1 1 2 3\n2 1 3 4\n"
+			<< "2 2 9 1\n3 2 5 3 6 7 8\n"
+			<< "$EndElements\n";
+	}
+
+	Eigen::MatrixXd vertices;
+	Eigen::MatrixXi cells;
+	std::vector<int> element_nodes, element_offsets, body_ids;
+	std::vector<std::string> node_data_name;
+	std::vector<std::vector<double>> node_data;
+	REQUIRE(MshReader::load(mesh_path, vertices, cells, element_nodes, element_offsets, body_ids, node_data_name, node_data));
+
+	Eigen::MatrixXd expected_vertices(8, 2);
+	expected_vertices << 0, 0, 1, 0, 1, 1, 0, 1, 2, 0, 1.5, 0, 1.5, 0.5, 1, 0.5;
+	Eigen::MatrixXi expected_cells(3, 3);
+	expected_cells << 0, 1, 2, 0, 2, 3, 1, 4, 2;
+
+	REQUIRE(vertices == expected_vertices);
+	REQUIRE(cells == expected_cells);
+	REQUIRE(element_nodes == std::vector<int>{0, 1, 2, 0, 2, 3, 1, 4, 2, 5, 6, 7});
+	REQUIRE(element_offsets == std::vector<int>{0, 3, 6, 12});
+	REQUIRE(body_ids == std::vector<int>{5, 5, 7});
+
+	// the nested overload is built from the flat storage
+	std::vector<std::vector<int>> elements;
+	std::vector<std::vector<double>> weights;
+	REQUIRE(MshReader::load(mesh_path, vertices, cells, elements, weights, body_ids));
+	REQUIRE(elements == std::vector<std::vector<int>>{{0, 1, 2}, {0, 2, 3}, {1, 4, 2, 5, 6, 7}});
+
+	std::filesystem::remove(mesh_path);
+}
+
 TEST_CASE("inverse", "[utils]")
 {
 	Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, 3, 3> mat = Eigen::MatrixXd::Random(1, 1);
@@ -130,6 +190,261 @@ TEST_CASE("inverse", "[utils]")
 	REQUIRE(((utils::inverse(mat3) - mat3_inv)).norm() == Catch::Approx(0).margin(1e-12));
 }
 
+namespace
+{
+	template <int dim>
+	void check_svd_batch(const TensorBatch<dim> &F)
+	{
+		using MatrixNd = Eigen::Matrix<double, dim, dim>;
+		using VectorNd = Eigen::Matrix<double, dim, 1>;
+
+		TensorBatch<dim> U, V, R, S;
+		SingularValueBatch<dim> sigmas;
+		svd_batch<dim>(F, U, sigmas, V);
+		polar_decomposition_batch<dim>(F, R, S);
+
+		for (int p = 0; p < F.rows(); ++p)
+		{
+			const MatrixNd Fp = F.row(p).reshaped(dim, dim);
+			const MatrixNd Up = U.row(p).reshaped(dim, dim);
+			const MatrixNd Vp = V.row(p).reshaped(dim, dim);
+			const VectorNd sp = sigmas.row(p).transpose();
+
+			AutoFlipSVD<MatrixNd> svd(Fp, Eigen::ComputeFullU | Eigen::ComputeFullV);
+
+			// U and V are not unique for repeated singular values, only the factorization is compared
+			REQUIRE((sp - svd.singularValues()).norm() == Catch::Approx(0).margin(1e-12));
+			REQUIRE((Up * sp.asDiagonal() * Vp.transpose() - Fp).norm() == Catch::Approx(0).margin(1e-12));
+			REQUIRE((Up * Up.transpose() - MatrixNd::Identity()).norm() == Catch::Approx(0).margin(1e-12));
+			REQUIRE((Vp * Vp.transpose() - MatrixNd::Identity()).norm() == Catch::Approx(0).margin(1e-12));
+			REQUIRE(Up.determinant() == Catch::Approx(1).margin(1e-12));
+			REQUIRE(Vp.determinant() == Catch::Approx(1).margin(1e-12));
+
+			const MatrixNd Rp = R.row(p).reshaped(dim, dim);
+			const MatrixNd Sp = S.row(p).reshaped(dim, dim);
+			REQUIRE((Rp * Rp.transpose() - MatrixNd::Identity()).norm() == Catch::Approx(0).margin(1e-12));
+			REQUIRE((Sp - Sp.transpose()).norm() == Catch::Approx(0).margin(1e-12));
+			REQUIRE((Rp * Sp - Fp).norm() == Catch::Approx(0).margin(1e-12));
+		}
+	}
+
+	/// Q₁ diag(sigmas) Q₂ with random rotations Q₁ and Q₂
+	template <int dim>
+	Eigen::Matrix<double, 1, dim * dim> rotated_diagonal(const Eigen::Matrix<double, dim, 1> &sigmas)
+	{
+		using MatrixNd = Eigen::Matrix<double, dim, dim>;
+
+		MatrixNd Q1 = MatrixNd(MatrixNd::Random()).householderQr().householderQ();
+		MatrixNd Q2 = MatrixNd(MatrixNd::Random()).householderQr().householderQ();
+		if (Q1.determinant() < 0)
+			Q1.col(0) *= -1;
+		if (Q2.determinant() < 0)
+			Q2.col(0) *= -1;
+
+		return (Q1 * sigmas.asDiagonal() * Q2).reshaped().transpose();
+	}
+} // namespace
+
+TEST_CASE("svd_batch", "[utils]")
+{
+	const int n_pts = 100;
+
+	SECTION("3D")
+	{
+		TensorBatch<3> F = TensorBatch<3>::Random(n_pts, 9);
+		// inverted, rank deficient, and identity
+		F.row(0) << -1, 0, 0, 0, 1, 0, 0, 0, 1;
+		F.row(1) << 1, 2, 3, 2, 4, 6, 0, 0, 1;
+		F.row(2) << 1, 0, 0, 0, 1, 0, 0, 0, 1;
+		// nearly repeated singular values
+		F.row(3) = rotated_diagonal<3>(Eigen::Vector3d(1, 1 - 1e-9, 1 - 2e-9));
+		F.row(4) = rotated_diagonal<3>(Eigen::Vector3d(2, 1 + 1e-10, 1));
+		F.row(5) = rotated_diagonal<3>(Eigen::Vector3d(1 + 1e-10, 1, -0.5));
+		// tiny singular values
+		F.row(6) = rotated_diagonal<3>(Eigen::Vector3d(1, 1e-8, 1e-14));
+		F.row(7) = rotated_diagonal<3>(Eigen::Vector3d(1, 1e-13, -1e-13));
+		F.row(8) = 1e-13 * F.row(9);
+
+		check_svd_batch<3>(F);
+	}
+
+	SECTION("2D")
+	{
+		TensorBatch<2> F = TensorBatch<2>::Random(n_pts, 4);
+		// inverted, rank deficient, and identity
+		F.row(0) << -1, 0, 0, 1;
+		F.row(1) << 1, 2, 2, 4;
+		F.row(2) << 1, 0, 0, 1;
+		// nearly repeated singular values
+		F.row(3) = rotated_diagonal<2>(Eigen::Vector2d(1, 1 - 1e-9));
+		F.row(4) = rotated_diagonal<2>(Eigen::Vector2d(1 + 1e-10, -1));
+		// tiny singular values
+		F.row(5) = rotated_diagonal<2>(Eigen::Vector2d(1, 1e-14));
+		F.row(6) = rotated_diagonal<2>(Eigen::Vector2d(1, -1e-12));
+		F.row(7) = 1e-13 * F.row(8);
+
+		check_svd_batch<2>(F);
+	}
+}
+
+TEST_CASE("surface_distance", "[utils]")
+{
+	// exact distances used by the sdf and mesh target forms when delta is not positive
+	const int samples = 20;
+	const int dim = GENERATE(2, 3);
+
+	Eigen::MatrixXd V;
+	Eigen::MatrixXi F;
+	if (dim == 2)
+	{
+		// arc of a circle
+		V.resize(samples, 2);
+		for (int i = 0; i < samples; ++i)
+			V.row(i) << std::cos(3. * i / (samples - 1)), std::sin(3. * i / (samples - 1));
+		F.resize(samples - 1, 2);
+		F.col(0) = Eigen::VectorXi::LinSpaced(samples - 1, 0, samples - 2);
+		F.col(1) = Eigen::VectorXi::LinSpaced(samples - 1, 1, samples - 1);
+	}
+	else
+	{
+		// curved height field
+		V.resize(samples * samples, 3);
+		for (int i = 0; i < samples; ++i)
+		{
+			for (int j = 0; j < samples; ++j)
+			{
+				const double u = double(j) / (samples - 1), v = double(i) / (samples - 1);
+				V.row(i * samples + j) << u, v, 0.3 * std::sin(3 * u) * std::cos(2 * v);
+			}
+		}
+		F.resize(2 * (samples - 1) * (samples - 1), 3);
+		for (int i = 0; i < samples - 1; ++i)
+		{
+			for (int j = 0; j < samples - 1; ++j)
+			{
+				const int f = 2 * (i * (samples - 1) + j);
+				F.row(f) << i * samples + j, (i + 1) * samples + j, i * samples + j + 1;
+				F.row(f + 1) << i * samples + j + 1, (i + 1) * samples + j, (i + 1) * samples + j + 1;
+			}
+		}
+	}
+
+	SurfaceDistance target;
+	target.init(V, F);
+
+	const Eigen::MatrixXd points = Eigen::MatrixXd::Random(50, dim);
+	Eigen::VectorXd sqr_distances;
+	Eigen::MatrixXd closest;
+	target.closest_points(points, sqr_distances, closest);
+
+	const double h = 1e-7;
+	for (int p = 0; p < points.rows(); ++p)
+	{
+		// brute force over all the segments or triangles
+		double expected = std::numeric_limits<double>::max();
+		for (int f = 0; f < F.rows(); ++f)
+		{
+			double sqr_d;
+			Eigen::RowVectorXd c(dim);
+			if (dim == 2)
+				igl::point_simplex_squared_distance<2>(points.row(p), V, F, f, sqr_d, c);
+			else
+				igl::point_simplex_squared_distance<3>(points.row(p), V, F, f, sqr_d, c);
+			expected = std::min(expected, sqr_d);
+		}
+		REQUIRE(sqr_distances(p) == Catch::Approx(expected).margin(1e-12));
+		REQUIRE(std::pow(target.distance(points.row(p).transpose()), 2) == Catch::Approx(expected).margin(1e-12));
+
+		// the gradient of the squared distance is 2 (p - closest)
+		const Eigen::RowVectorXd grad = 2 * (points.row(p) - closest.row(p));
+		for (int d = 0; d < dim; ++d)
+		{
+			Eigen::MatrixXd shifted(2, dim);
+			shifted.row(0) = points.row(p);
+			shifted.row(1) = points.row(p);
+			shifted(0, d) += h;
+			shifted(1, d) -= h;
+
+			Eigen::VectorXd shifted_sqr_distances;
+			Eigen::MatrixXd unused;
+			target.closest_points(shifted, shifted_sqr_distances, unused);
+			const double fd = (shifted_sqr_distances(0) - shifted_sqr_distances(1)) / (2 * h);
+			REQUIRE(grad(d) == Catch::Approx(fd).margin(1e-6));
+		}
+	}
+}
+
+TEST_CASE("lazy_cubic_interpolator", "[utils]")
+{
+	const int dim = GENERATE(2, 3);
+	const double delta = 1e-2;
+	const int bits = dim == 2 ? 31 : 21;
+	const double limit = double(int64_t(1) << (bits - 1));
+
+	// the bicubic and tricubic Hermite interpolations of a quadratic with its finite-difference derivatives are exact
+	const Eigen::VectorXd a = Eigen::VectorXd::Random(dim);
+	Eigen::MatrixXd B = Eigen::MatrixXd::Random(dim, dim);
+	B = (B + B.transpose()).eval();
+	const auto f = [&](const Eigen::MatrixXd &p, double &val) { val = 0.3 + a.dot(p.col(0)) + 0.5 * p.col(0).dot(B * p.col(0)); };
+
+	// random points around the origin and next to both ends of the key range, whose stencils span the cells from
+	// one below to two above the bin of the point
+	const int n_points = 60;
+	Eigen::MatrixXd points = Eigen::MatrixXd::Random(n_points, dim);
+	for (int p = 0; p < n_points; ++p)
+	{
+		const int side = p % 3;
+		for (int k = 0; k < dim; ++k)
+		{
+			const double frac = 0.5 + 0.4 * points(p, k);
+			if (side == 0)
+				points(p, k) *= 0.5;
+			else if (side == 1)
+				points(p, k) = (limit - 3 + frac) * delta;
+			else
+				points(p, k) = (-limit + 1 + frac) * delta;
+		}
+	}
+
+	LazyCubicInterpolator batched(dim, delta);
+	batched.cache_grid(f, points);
+
+	for (int p = 0; p < n_points; ++p)
+	{
+		const Eigen::MatrixXd point = points.row(p).transpose();
+		double val;
+		Eigen::MatrixXd grad;
+		batched.evaluate(point, val, grad);
+
+		// the previous per-point caching
+		LazyCubicInterpolator single(dim, delta);
+		single.cache_grid(f, points.row(p));
+		double single_val;
+		Eigen::MatrixXd single_grad;
+		single.evaluate(point, single_val, single_grad);
+		CHECK(val == single_val);
+		CHECK(grad == single_grad);
+
+		double exact_val;
+		f(point, exact_val);
+		const Eigen::VectorXd exact_grad = a + B * point;
+		CHECK(std::abs(val - exact_val) <= 1e-8 * (1 + std::abs(exact_val)));
+		// the finite differences of the large values far from the origin lose about |f| eps / delta
+		const double fd_roundoff = 1e3 * std::numeric_limits<double>::epsilon() * std::abs(exact_val) / delta;
+		CHECK((grad - exact_grad).norm() <= 1e-6 * (1 + exact_grad.norm()) + fd_roundoff);
+	}
+
+	// the range is checked before any distance is computed
+	Eigen::MatrixXd outside = points.topRows(1);
+	outside(0, 0) = (limit - 2 + 0.5) * delta;
+	int n_calls = 0;
+	LazyCubicInterpolator out_of_range(dim, delta);
+	REQUIRE_THROWS(out_of_range.cache_grid([&](const Eigen::MatrixXd &p, double &val) { ++n_calls; f(p, val); }, outside));
+	CHECK(n_calls == 0);
+	outside(0, 0) = (-limit + 0.5) * delta;
+	REQUIRE_THROWS(out_of_range.cache_grid(f, outside));
+}
+
 TEST_CASE("wmtk_instatiation", "[utils]")
 {
 	wmtk::TriMesh mesh;